@@ -0,0 +1,141 @@
+dnl
+dnl				acx_lapacke.m4
+dnl
+dnl Figure out if the LAPACKE (OpenBLAS or reference) library and header files
+dnl are installed.
+dnl
+dnl %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+dnl
+dnl	This file part of:	AstrOmatic software
+dnl
+dnl	Copyright:		(C) 2003-2026 Emmanuel Bertin -- IAP/CNRS/UPMC
+dnl
+dnl	License:		GNU General Public License
+dnl
+dnl	AstrOmatic software is free software: you can redistribute it and/or
+dnl	modify it under the terms of the GNU General Public License as
+dnl	published by the Free Software Foundation, either version 3 of the
+dnl	License, or (at your option) any later version.
+dnl	AstrOmatic software is distributed in the hope that it will be useful,
+dnl	but WITHOUT ANY WARRANTY; without even the implied warranty of
+dnl	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+dnl	GNU General Public License for more details.
+dnl	You should have received a copy of the GNU General Public License
+dnl	along with AstrOmatic software.
+dnl	If not, see <http://www.gnu.org/licenses/>.
+dnl
+dnl	Last modified:		19/10/2026
+dnl
+dnl %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+dnl
+dnl @synopsis ACX_LAPACKE([LAPACKE_LIBDIR, LAPACKE_INCDIR, LAPACKE_FLAVOUR,
+dnl                     [ACTION-IF-FOUND[, ACTION-IF-NOT-FOUND]]])
+dnl LAPACKE_FLAVOUR is either "openblas" or "lapacke" (reference LAPACKE
+dnl on top of any CBLAS/LAPACK implementation).
+dnl You may wish to use these variables in your default LIBS:
+dnl
+dnl        LIBS="$LAPACKE_LIB $LIBS"
+dnl
+dnl ACTION-IF-FOUND is a list of shell commands to run if LAPACKE
+dnl is found (HAVE_LAPACKE is defined first), and ACTION-IF-NOT-FOUND
+dnl is a list of commands to run it if it is not found.
+
+AC_DEFUN([ACX_LAPACKE], [
+AC_REQUIRE([AC_CANONICAL_HOST])
+
+dnl --------------------
+dnl Search include files
+dnl --------------------
+
+acx_lapacke_ok=no
+if test x$2 = x; then
+  if test x$1 = x; then
+    lapacke_incs=". openblas"
+  else
+    lapacke_incs="$1/include ."
+  fi
+else
+  lapacke_incs="$2"
+fi
+for lapacke_inc in $lapacke_incs; do
+  if test x$lapacke_inc = x.; then
+    lapacke_pre=""
+  else
+    lapacke_pre="$lapacke_inc/"
+  fi
+  AC_CHECK_HEADER([${lapacke_pre}cblas.h],
+	[AC_CHECK_HEADER([${lapacke_pre}lapacke.h],[acx_lapacke_ok=yes])])
+  if test x$acx_lapacke_ok = xyes; then
+    AC_DEFINE_UNQUOTED(BLAS_H, "${lapacke_pre}cblas.h",
+		[BLAS header filename.])
+    AC_DEFINE_UNQUOTED(LAPACKE_H, "${lapacke_pre}lapacke.h",
+		[LAPACKE header filename.])
+    break
+  fi
+done
+if test x$acx_lapacke_ok = xno; then
+  LAPACKE_ERROR="CBLAS/LAPACKE include files not found in $lapacke_incs!"
+fi
+
+dnl --------------------
+dnl Search library files
+dnl --------------------
+
+if test x$acx_lapacke_ok = xyes; then
+  OLIBS="$LIBS"
+  LIBS=""
+  if test x$1 = x; then
+    LAPACKE_LIBPATH=""
+  else
+    LAPACKE_LIBPATH="-L$1"
+  fi
+  if test x$3 = xopenblas; then
+dnl OpenBLAS generally embeds LAPACKE, but some distributions split it
+    AC_CHECK_LIB(openblas, [LAPACKE_dpotrf],
+	[LAPACKE_LIB="$LAPACKE_LIBPATH -lopenblas"],
+	[acx_lapacke_ok=no], [$LAPACKE_LIBPATH -lm])
+    if test x$acx_lapacke_ok = xno; then
+      unset ac_cv_lib_openblas_LAPACKE_dpotrf
+      acx_lapacke_ok=yes
+      AC_CHECK_LIB(lapacke, [LAPACKE_dpotrf],
+	[LAPACKE_LIB="$LAPACKE_LIBPATH -llapacke -lopenblas"],
+	[acx_lapacke_ok=no], [$LAPACKE_LIBPATH -lopenblas -lm])
+    fi
+    if test x$acx_lapacke_ok = xyes; then
+      AC_DEFINE(HAVE_OPENBLAS,1,
+	[Define if you have the OpenBLAS libraries and header files.])
+    else
+      LAPACKE_ERROR="OpenBLAS/LAPACKE library files not found!"
+    fi
+  else
+    AC_CHECK_LIB(lapacke, [LAPACKE_dpotrf],
+	[LAPACKE_LIB="$LAPACKE_LIBPATH -llapacke -llapack -lcblas"],
+	[acx_lapacke_ok=no], [$LAPACKE_LIBPATH -llapack -lcblas -lm])
+    if test x$acx_lapacke_ok = xno; then
+      unset ac_cv_lib_lapacke_LAPACKE_dpotrf
+      acx_lapacke_ok=yes
+      AC_CHECK_LIB(lapacke, [LAPACKE_dpotrf],
+	[LAPACKE_LIB="$LAPACKE_LIBPATH -llapacke -llapack -lblas"],
+	[acx_lapacke_ok=no], [$LAPACKE_LIBPATH -llapack -lblas -lm])
+    fi
+    if test x$acx_lapacke_ok = xno; then
+      LAPACKE_ERROR="LAPACKE library files not found!"
+    fi
+  fi
+  LIBS="$OLIBS"
+fi
+
+dnl -------------------------------------------------------------------------
+dnl Finally, execute ACTION-IF-FOUND/ACTION-IF-NOT-FOUND
+dnl -------------------------------------------------------------------------
+if test x"$acx_lapacke_ok" = xyes; then
+  AC_DEFINE(HAVE_LAPACKE,1,
+	[Define if you have the LAPACKE libraries and header files.])
+  AC_SUBST(LAPACKE_LIB)
+  $4
+else
+  AC_SUBST(LAPACKE_ERROR)
+  $5
+fi
+
+])dnl ACX_LAPACKE
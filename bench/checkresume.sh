@@ -0,0 +1,103 @@
+#! /bin/sh
+#
+#				checkresume.sh
+#
+# Check that a run killed and resumed from its checkpoint gives the same PSF
+# models as an uninterrupted run.
+#
+#%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+#
+#	This file part of:	PSFEx
+#
+#	Copyright:		(C) 2026 The PSFEx contributors
+#
+#	License:		GNU General Public License
+#
+#	PSFEx is free software: you can redistribute it and/or modify
+#	it under the terms of the GNU General Public License as published by
+#	the Free Software Foundation, either version 3 of the License, or
+# 	(at your option) any later version.
+#	PSFEx is distributed in the hope that it will be useful,
+#	but WITHOUT ANY WARRANTY; without even the implied warranty of
+#	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#	GNU General Public License for more details.
+#	You should have received a copy of the GNU General Public License
+#	along with PSFEx. If not, see <http://www.gnu.org/licenses/>.
+#
+#	Last modified:		19/10/2026
+#
+#%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+#
+# Usage: checkresume.sh psfex_binary bench_bindir work_dir
+#
+# The checkpointed run is killed once two catalogues have their PSF saved,
+# and a torn record is appended to the state file before resuming.
+
+PSFEX=$1
+BINDIR=$2
+WORKDIR=${3:-check-resume}
+NCAT=6
+
+if test -z "$PSFEX" || test -z "$BINDIR"; then
+  echo "Usage: $0 psfex_binary bench_bindir [work_dir]" 1>&2
+  exit 1
+fi
+
+rm -rf $WORKDIR
+mkdir -p $WORKDIR/data $WORKDIR/ref $WORKDIR/ckpt || exit 1
+CATS=""
+i=1
+while test $i -le $NCAT; do
+  $BINDIR/psfexgen -n 400 -x 2 -v 25 -f 2.$i -r $i $WORKDIR/data/f$i.cat \
+	> /dev/null || exit 1
+  CATS="$CATS $WORKDIR/data/f$i.cat"
+  i=`expr $i + 1`
+done
+$PSFEX -dd > $WORKDIR/check.psfex || exit 1
+COMMON="-c $WORKDIR/check.psfex -CHECKPLOT_TYPE NONE -CHECKIMAGE_TYPE NONE \
+	-WRITE_XML N -NTHREADS 1"
+STATE=$WORKDIR/psfex.chk
+
+# Reference
+$PSFEX $CATS $COMMON -PSF_DIR $WORKDIR/ref -VERBOSE_TYPE QUIET || exit 1
+
+# Interrupted run
+$PSFEX $CATS $COMMON -PSF_DIR $WORKDIR/ckpt -VERBOSE_TYPE QUIET \
+	-WRITE_CHECKPOINT Y -CHECKPOINT_NAME $STATE &
+pid=$!
+while kill -0 $pid 2> /dev/null; do
+  if test `ls $WORKDIR/ckpt | grep -c '\.psf$'` -ge 2; then
+    kill -9 $pid
+    break
+  fi
+  sleep 1
+done
+wait $pid 2> /dev/null
+if test ! -f $STATE; then
+  echo "checkresume: the run completed before it could be interrupted" 1>&2
+  exit 1
+fi
+
+# Simulate a record torn by the interruption, then resume
+printf 'PSFEXCKP' >> $STATE
+$PSFEX $CATS $COMMON -PSF_DIR $WORKDIR/ckpt -VERBOSE_TYPE NORMAL \
+	-WRITE_CHECKPOINT Y -CHECKPOINT_NAME $STATE > $WORKDIR/resume.log 2>&1 \
+	|| exit 1
+if ! grep -q 'Resuming from' $WORKDIR/resume.log; then
+  echo "checkresume: the checkpoint was not used" 1>&2
+  exit 1
+fi
+if test -f $STATE; then
+  echo "checkresume: state file left after a complete run" 1>&2
+  exit 1
+fi
+
+status=0
+for psf in $WORKDIR/ref/*.psf; do
+  if ! cmp -s $psf $WORKDIR/ckpt/`basename $psf`; then
+    echo "checkresume: `basename $psf` differs after resuming" 1>&2
+    status=1
+  fi
+done
+test $status = 0 && echo "checkresume: resumed run matches the reference"
+exit $status
@@ -0,0 +1,77 @@
+#! /bin/sh
+#
+#				checkshard.sh
+#
+# Check that a SEQUENCE fit shared between worker processes gives the same PSF
+# models as a fit in a single process.
+#
+#%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+#
+#	This file part of:	PSFEx
+#
+#	Copyright:		(C) 2026 The PSFEx contributors
+#
+#	License:		GNU General Public License
+#
+#	PSFEx is free software: you can redistribute it and/or modify
+#	it under the terms of the GNU General Public License as published by
+#	the Free Software Foundation, either version 3 of the License, or
+# 	(at your option) any later version.
+#	PSFEx is distributed in the hope that it will be useful,
+#	but WITHOUT ANY WARRANTY; without even the implied warranty of
+#	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#	GNU General Public License for more details.
+#	You should have received a copy of the GNU General Public License
+#	along with PSFEx. If not, see <http://www.gnu.org/licenses/>.
+#
+#	Last modified:		19/10/2026
+#
+#%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+#
+# Usage: checkshard.sh psfex_binary bench_bindir [work_dir]
+#
+# The workers sum their partial normal equations in a different order, so
+# models are compared within a tolerance rather than byte for byte.
+
+PSFEX=$1
+BINDIR=$2
+WORKDIR=${3:-check-shard}
+NCAT=4
+
+if test -z "$PSFEX" || test -z "$BINDIR"; then
+  echo "Usage: $0 psfex_binary bench_bindir [work_dir]" 1>&2
+  exit 1
+fi
+
+rm -rf $WORKDIR
+mkdir -p $WORKDIR/data $WORKDIR/single $WORKDIR/shard || exit 1
+CATS=""
+i=1
+while test $i -le $NCAT; do
+  $BINDIR/psfexgen -n 200 -x 1 -v 25 -f 2.$i -r $i $WORKDIR/data/f$i.cat \
+	> /dev/null || exit 1
+  CATS="$CATS $WORKDIR/data/f$i.cat"
+  i=`expr $i + 1`
+done
+$PSFEX -dd > $WORKDIR/check.psfex || exit 1
+COMMON="-c $WORKDIR/check.psfex -STABILITY_TYPE SEQUENCE \
+	-CHECKPLOT_TYPE NONE -CHECKIMAGE_TYPE NONE -WRITE_XML N -NTHREADS 1 \
+	-VERBOSE_TYPE QUIET"
+
+$PSFEX $CATS $COMMON -PSF_DIR $WORKDIR/single || exit 1
+$PSFEX $CATS $COMMON -PSF_DIR $WORKDIR/shard -SHARD_NUMBER 3 \
+	-SHARD_DIR $WORKDIR || exit 1
+if test -n "`ls $WORKDIR | grep '\.shd$'`"; then
+  echo "checkshard: work files left after the run" 1>&2
+  exit 1
+fi
+
+status=0
+for psf in $WORKDIR/single/*.psf; do
+  if ! $BINDIR/psfcmp $psf $WORKDIR/shard/`basename $psf`; then
+    echo "checkshard: `basename $psf` differs when sharded" 1>&2
+    status=1
+  fi
+done
+test $status = 0 && echo "checkshard: sharded fit matches the single-process fit"
+exit $status
@@ -0,0 +1,220 @@
+/*
+*				checktile.c
+*
+* Check that tile-compressed images are read back as they were written.
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*
+*	This file part of:	PSFEx
+*
+*	Copyright:		(C) 2026 The PSFEx contributors
+*
+*	License:		GNU General Public License
+*
+*	PSFEx is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+* 	(at your option) any later version.
+*	PSFEx is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*	You should have received a copy of the GNU General Public License
+*	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
+*
+*	Last modified:		19/10/2026
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+#ifdef HAVE_CONFIG_H
+#include        "config.h"
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "define.h"
+#include "fits/fitscat.h"
+
+#define		TILE_SYNTAX	"checktile [-d work_directory]\n"
+
+#define		TILE_WIDTH	157	/* Image width (pixels) */
+#define		TILE_HEIGHT	203	/* Image height, not a multiple of 16 */
+#define		TILE_NPLANE	3	/* Number of image planes */
+#define		TILE_NOISE	10.0	/* Background noise RMS */
+#define		TILE_QLEVEL	16.0	/* RICE quantization level */
+
+static int	tile_check(char *filename, PIXTYPE *pix, int compress_type,
+			int tilenrow);
+
+static double	tile_rand(void);
+
+static unsigned long long	tile_state = 0x9E3779B97F4A7C15ULL;
+
+/********************************** main ************************************/
+
+int main(int argc, char *argv[])
+  {
+   static int	tilenrow[] = {1, 16, 1000};
+   char		filename[MAXCHAR],
+		*dirname;
+   unsigned short	ashort=1;
+   PIXTYPE	*pix;
+   double	r;
+   int		a,i,n, npix, nfail;
+
+  dirname = ".";
+  for (a=1; a<argc; a++)
+    if (!strcmp(argv[a], "-d") && a+1<argc)
+      dirname = argv[++a];
+    else
+      error(EXIT_FAILURE, "SYNTAX: ", TILE_SYNTAX);
+
+/* Test if byteswapping will be needed */
+  bswapflag = *((char *)&ashort);
+
+/* Noise, a few bright sources on a gradient, and a blank pixel */
+  npix = TILE_WIDTH*TILE_HEIGHT*TILE_NPLANE;
+  QMALLOC(pix, PIXTYPE, npix);
+  for (i=0; i<npix; i++)
+    {
+    r = sqrt(-2.0*log(tile_rand()))*cos(2.0*PI*tile_rand());
+    pix[i] = (PIXTYPE)(TILE_NOISE*r + 0.1*(i%TILE_WIDTH));
+    if (tile_rand() < 0.001)
+      pix[i] += (PIXTYPE)(1.0e5*tile_rand());
+    }
+  pix[npix/2] = (PIXTYPE)sqrt(-1.0);
+
+  snprintf(filename, MAXCHAR, "%s/checktile.fits", dirname);
+  nfail = 0;
+  for (n=0; n<3; n++)
+    {
+    nfail += tile_check(filename, pix, COMPRESS_RICE, tilenrow[n]);
+#ifdef HAVE_ZLIB
+    nfail += tile_check(filename, pix, COMPRESS_GZIP, tilenrow[n]);
+#endif
+    }
+  remove(filename);
+  free(pix);
+
+  return nfail? EXIT_FAILURE : EXIT_SUCCESS;
+  }
+
+
+/****** tile_check ***********************************************************
+PROTO	int tile_check(char *filename, PIXTYPE *pix, int compress_type,
+			int tilenrow)
+PURPOSE	Write a tile-compressed datacube, read it back and compare.
+INPUT	Name of the temporary file,
+	pointer to the original pixels,
+	compression type (COMPRESS_RICE or COMPRESS_GZIP),
+	number of image rows per tile.
+OUTPUT	0 if the pixels read back match, 1 otherwise.
+NOTES	GZIP must be lossless; RICE may not deviate by more than one
+	quantization step (noise RMS / QLEVEL) from the original, allowing
+	for the noise being estimated separately in each tile.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static int	tile_check(char *filename, PIXTYPE *pix, int compress_type,
+			int tilenrow)
+  {
+   catstruct	*cat;
+   tabstruct	*tab;
+   PIXTYPE	*pixout;
+   double	dpix, dmax, tol;
+   char		*cname;
+   int		i, npix, nbad;
+
+  npix = TILE_WIDTH*TILE_HEIGHT*TILE_NPLANE;
+  cname = compress_type==COMPRESS_RICE? "RICE" : "GZIP";
+
+/* Write */
+  cat = new_cat(1);
+  init_cat(cat);
+  strcpy(cat->filename, filename);
+  if (open_cat(cat, WRITE_ONLY) != RETURN_OK)
+    error(EXIT_FAILURE, "*Error*: cannot open for writing ", filename);
+  save_tab(cat, cat->tab);
+  tab = new_tab("TILETEST");
+  tab->bitpix = BP_FLOAT;
+  tab->bytepix = t_size[T_FLOAT];
+  tab->naxis = 3;
+  QREALLOC(tab->naxisn, int, tab->naxis);
+  tab->naxisn[0] = TILE_WIDTH;
+  tab->naxisn[1] = TILE_HEIGHT;
+  tab->naxisn[2] = TILE_NPLANE;
+  tab->tabsize = tab->bytepix*npix;
+  QMALLOC(tab->bodybuf, char, tab->tabsize);
+  memcpy(tab->bodybuf, pix, tab->tabsize);
+  tab->compress_type = compress_type;
+  tab->compress_qlevel = TILE_QLEVEL;
+  tab->compress_tilenrow = tilenrow;
+  save_tab(cat, tab);
+  free_tab(tab);
+  free_cat(&cat, 1);
+
+/* Read back */
+  if (!(cat = read_cat(filename)))
+    error(EXIT_FAILURE, "*Error*: cannot read back ", filename);
+  tab = cat->tab->nexttab;
+  if (tab->compress_type != compress_type || tab->naxis != 3
+	|| tab->naxisn[0] != TILE_WIDTH || tab->naxisn[1] != TILE_HEIGHT
+	|| tab->naxisn[2] != TILE_NPLANE)
+    {
+    fprintf(stderr, "checktile: %s, %d row(s) per tile: bad geometry\n",
+	cname, tilenrow);
+    free_cat(&cat, 1);
+    return 1;
+    }
+  QMALLOC(pixout, PIXTYPE, npix);
+  QFSEEK(cat->file, tab->bodypos, SEEK_SET, filename);
+  read_body(tab, pixout, npix);
+  free_cat(&cat, 1);
+
+/* Compare */
+  tol = compress_type==COMPRESS_RICE? TILE_NOISE/TILE_QLEVEL : 0.0;
+  dmax = 0.0;
+  nbad = 0;
+  for (i=0; i<npix; i++)
+    {
+    if (isnan(pix[i]) || isnan(pixout[i]))
+      {
+      if (!isnan(pix[i]) || !isnan(pixout[i]))
+        nbad++;
+      continue;
+      }
+    dpix = fabs((double)pixout[i] - (double)pix[i]);
+    if (dpix > dmax)
+      dmax = dpix;
+    if (dpix > tol*1.0001)
+      nbad++;
+    }
+  free(pixout);
+  printf("checktile: %s, %4d row(s) per tile: max. error %.3g, %d bad pixel(s)"
+	"\n", cname, tilenrow, dmax, nbad);
+
+  return nbad? 1 : 0;
+  }
+
+
+/****** tile_rand ************************************************************
+PROTO	double tile_rand(void)
+PURPOSE	Return a uniform random deviate in ]0,1[.
+INPUT	-.
+OUTPUT	Random deviate.
+NOTES	xorshift64* generator, for the same data on every platform.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static double	tile_rand(void)
+  {
+  tile_state ^= tile_state >> 12;
+  tile_state ^= tile_state << 25;
+  tile_state ^= tile_state >> 27;
+  return ((double)((tile_state*0x2545F4914F6CDD1DULL) >> 11) + 0.5)
+	/ 9007199254740992.0;
+  }
+
@@ -0,0 +1,213 @@
+/*
+*				checkwcs.c
+*
+* Check batch pixel/sky conversions against the per-point functions.
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*
+*	This file part of:	PSFEx
+*
+*	Copyright:		(C) 2026 The PSFEx contributors
+*
+*	License:		GNU General Public License
+*
+*	PSFEx is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+* 	(at your option) any later version.
+*	PSFEx is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*	You should have received a copy of the GNU General Public License
+*	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
+*
+*	Last modified:		19/10/2026
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+#ifdef HAVE_CONFIG_H
+#include        "config.h"
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "define.h"
+#include "fits/fitscat.h"
+#include "fitswcs.h"
+
+#define		WCS_NPOS	2000	/* Number of test positions */
+#define		WCS_WIDTH	2048	/* Image width (pixels) */
+#define		WCS_HEIGHT	4096	/* Image height (pixels) */
+#define		WCS_MAXDWCS	1e-9	/* Max. sky coordinate difference (deg) */
+#define		WCS_MAXDPIX	1e-6	/* Max. pixel coordinate difference */
+
+static int	wcs_check(char *label, char **cards);
+
+static double	wcs_rand(void);
+
+static unsigned long long	wcs_state = 0x9E3779B97F4A7C15ULL;
+
+/* The CD matrix is common to most cases */
+#define	WCS_CD	"CD1_1   = -7.3E-5", "CD1_2   = 1.0E-6", \
+		"CD2_1   = 1.2E-6", "CD2_2   = 7.3E-5"
+
+static char	*wcs_tan[] = {"CTYPE1  = 'RA---TAN'", "CTYPE2  = 'DEC--TAN'",
+			"CRVAL1  = 150.0", "CRVAL2  = 2.0",
+			"CRPIX1  = 1024.5", "CRPIX2  = 2048.5", WCS_CD,
+			"EQUINOX = 2000.0", "RADESYS = 'ICRS'", NULL},
+		*wcs_tpv[] = {"CTYPE1  = 'RA---TAN'", "CTYPE2  = 'DEC--TAN'",
+			"CRVAL1  = 10.0", "CRVAL2  = -45.0",
+			"CRPIX1  = -3000.", "CRPIX2  = 5000.", WCS_CD,
+			"EQUINOX = 2000.0",
+			"PV1_0   = 0.001", "PV1_1   = 1.01", "PV1_2   = 0.002",
+			"PV1_4   = 0.05", "PV1_7   = -0.3",
+			"PV2_0   = -0.001", "PV2_1   = 0.99", "PV2_2   = 0.003",
+			"PV2_5   = 0.04", "PV2_10  = -0.2", NULL},
+		*wcs_swap[] = {"CTYPE1  = 'DEC--TAN'", "CTYPE2  = 'RA---TAN'",
+			"CRVAL1  = 30.0", "CRVAL2  = 200.0",
+			"CRPIX1  = 1024.5", "CRPIX2  = 2048.5",
+			"CD1_1   = 0.0", "CD1_2   = 7.3E-5",
+			"CD2_1   = -7.3E-5", "CD2_2   = 0.0",
+			"EQUINOX = 2000.0", NULL},
+		*wcs_pole[] = {"CTYPE1  = 'RA---TAN'", "CTYPE2  = 'DEC--TAN'",
+			"CRVAL1  = 0.0", "CRVAL2  = 89.95",
+			"CRPIX1  = 1024.5", "CRPIX2  = 2048.5", WCS_CD,
+			"EQUINOX = 2000.0", NULL},
+		*wcs_gal[] = {"CTYPE1  = 'GLON-TAN'", "CTYPE2  = 'GLAT-TAN'",
+			"CRVAL1  = 0.1", "CRVAL2  = 0.05",
+			"CRPIX1  = 1024.5", "CRPIX2  = 2048.5", WCS_CD, NULL},
+		*wcs_sin[] = {"CTYPE1  = 'RA---SIN'", "CTYPE2  = 'DEC--SIN'",
+			"CRVAL1  = 250.0", "CRVAL2  = 60.0",
+			"CRPIX1  = 1024.5", "CRPIX2  = 2048.5", WCS_CD,
+			"EQUINOX = 2000.0", NULL};
+
+/********************************** main ************************************/
+
+int main(int argc, char *argv[])
+  {
+   int		nfail;
+
+  if (argc>1)
+    error(EXIT_FAILURE, "SYNTAX: ", "checkwcs\n");
+
+  nfail = wcs_check("TAN", wcs_tan);
+  nfail += wcs_check("TAN+PV, far off-axis", wcs_tpv);
+  nfail += wcs_check("TAN, swapped axes", wcs_swap);
+  nfail += wcs_check("TAN, near the pole", wcs_pole);
+  nfail += wcs_check("TAN, galactic", wcs_gal);
+  nfail += wcs_check("SIN (per-point path)", wcs_sin);
+
+  return nfail? EXIT_FAILURE : EXIT_SUCCESS;
+  }
+
+
+/****** wcs_check ************************************************************
+PROTO	int wcs_check(char *label, char **cards)
+PURPOSE	Convert random positions with the batch and per-point functions, in
+	both directions, and compare.
+INPUT	Description of the test case,
+	NULL-terminated array of FITS header cards.
+OUTPUT	0 if the conversions agree, 1 otherwise.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static int	wcs_check(char *label, char **cards)
+  {
+   tabstruct	*tab;
+   wcsstruct	*wcs;
+   double	*pix, *wcspos1,*wcspos2, *pix1,*pix2,
+		d, dwcs,dpix;
+   int		i, n, nblock;
+
+/* Build the header */
+  for (n=0; cards[n]; n++);
+  nblock = (n*80+80+2879)/2880;
+  tab = new_tab("WCSTEST");
+  free(tab->headbuf);
+  QMALLOC(tab->headbuf, char, nblock*2880);
+  memset(tab->headbuf, ' ', nblock*2880);
+  for (i=0; i<n; i++)
+    memcpy(tab->headbuf+80*i, cards[i], strlen(cards[i]));
+  memcpy(tab->headbuf+80*n, "END", 3);
+  tab->headnblock = nblock;
+  tab->naxis = 2;
+  QREALLOC(tab->naxisn, int, 2);
+  tab->naxisn[0] = WCS_WIDTH;
+  tab->naxisn[1] = WCS_HEIGHT;
+  wcs = read_wcs(tab);
+
+  QMALLOC(pix, double, 2*WCS_NPOS);
+  QMALLOC(pix1, double, 2*WCS_NPOS);
+  QMALLOC(pix2, double, 2*WCS_NPOS);
+  QMALLOC(wcspos1, double, 2*WCS_NPOS);
+  QMALLOC(wcspos2, double, 2*WCS_NPOS);
+  for (i=0; i<WCS_NPOS; i++)
+    {
+    pix[2*i] = 1.0 + (WCS_WIDTH-1)*wcs_rand();
+    pix[2*i+1] = 1.0 + (WCS_HEIGHT-1)*wcs_rand();
+    }
+
+/* Pixel to sky */
+  for (i=0; i<WCS_NPOS; i++)
+    raw_to_wcs(wcs, pix+2*i, wcspos1+2*i);
+  raw_to_wcs_batch(wcs, pix, wcspos2, WCS_NPOS);
+  dwcs = 0.0;
+  for (i=0; i<2*WCS_NPOS; i++)
+    {
+    d = fabs(wcspos2[i] - wcspos1[i]);
+    if (d>180.0)
+      d = fabs(d-360.0);
+    if (d>dwcs)
+      dwcs = d;
+    }
+
+/* Sky to pixel (wcs_to_raw() may modify its input) */
+  wcs_to_raw_batch(wcs, wcspos1, pix2, WCS_NPOS);
+  for (i=0; i<WCS_NPOS; i++)
+    wcs_to_raw(wcs, wcspos1+2*i, pix1+2*i);
+  dpix = 0.0;
+  for (i=0; i<2*WCS_NPOS; i++)
+    {
+    d = fabs(pix2[i] - pix1[i]);
+    if (d>dpix)
+      dpix = d;
+    }
+
+  printf("checkwcs: %-24s pix->sky %.3g deg, sky->pix %.3g pix\n",
+	label, dwcs, dpix);
+
+  free(pix);
+  free(pix1);
+  free(pix2);
+  free(wcspos1);
+  free(wcspos2);
+  end_wcs(wcs);
+  free_tab(tab);
+
+  return (dwcs>WCS_MAXDWCS || dpix>WCS_MAXDPIX)? 1 : 0;
+  }
+
+
+/****** wcs_rand *************************************************************
+PROTO	double wcs_rand(void)
+PURPOSE	Return a uniform random deviate in ]0,1[.
+INPUT	-.
+OUTPUT	Random deviate.
+NOTES	xorshift64* generator, for the same positions on every platform.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static double	wcs_rand(void)
+  {
+  wcs_state ^= wcs_state >> 12;
+  wcs_state ^= wcs_state << 25;
+  wcs_state ^= wcs_state >> 27;
+  return ((double)((wcs_state*0x2545F4914F6CDD1DULL) >> 11) + 0.5)
+	/ 9007199254740992.0;
+  }
+
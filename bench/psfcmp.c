@@ -0,0 +1,164 @@
+/*
+*				psfcmp.c
+*
+* Compare the PSF models of two PSF files within a tolerance.
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*
+*	This file part of:	PSFEx
+*
+*	Copyright:		(C) 2026 The PSFEx contributors
+*
+*	License:		GNU General Public License
+*
+*	PSFEx is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+* 	(at your option) any later version.
+*	PSFEx is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*	You should have received a copy of the GNU General Public License
+*	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
+*
+*	Last modified:		19/10/2026
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+#ifdef HAVE_CONFIG_H
+#include        "config.h"
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "define.h"
+#include "fits/fitscat.h"
+
+#define		CMP_SYNTAX	"psfcmp [-t tolerance] reference.psf test.psf\n"
+#define		CMP_TOLERANCE	1e-5	/* Default tolerance (rel. to max.) */
+
+static tabstruct	*cmp_nexttab(catstruct *cat, tabstruct *tab);
+
+/********************************** main ************************************/
+
+int main(int argc, char *argv[])
+  {
+   catstruct	*cat[2];
+   tabstruct	*tab[2];
+   keystruct	*key[2];
+   char		*filename[2];
+   unsigned short	ashort=1;
+   float	*pix[2];
+   double	dpix, dmax, pmax, tol;
+   int		a,i,e, n, nfile, nval, nfail, ival[2];
+
+  tol = CMP_TOLERANCE;
+  nfile = 0;
+  for (a=1; a<argc; a++)
+    if (!strcmp(argv[a], "-t") && a+1<argc)
+      tol = atof(argv[++a]);
+    else if (nfile<2 && *argv[a] != '-')
+      filename[nfile++] = argv[a];
+    else
+      error(EXIT_FAILURE, "SYNTAX: ", CMP_SYNTAX);
+  if (nfile<2)
+    error(EXIT_FAILURE, "SYNTAX: ", CMP_SYNTAX);
+
+/* Test if byteswapping will be needed */
+  bswapflag = *((char *)&ashort);
+
+  for (n=0; n<2; n++)
+    if (!(cat[n] = read_cat(filename[n])))
+      error(EXIT_FAILURE, "*Error*: cannot read ", filename[n]);
+
+  nfail = 0;
+  tab[0] = tab[1] = NULL;
+  for (e=0; (tab[0]=cmp_nexttab(cat[0], tab[0])); e++)
+    {
+    if (!(tab[1] = cmp_nexttab(cat[1], tab[1])))
+      {
+      printf("psfcmp: extension %d missing from %s\n", e+1, filename[1]);
+      nfail++;
+      break;
+      }
+/*-- Sample counts must match exactly */
+    for (n=0; n<2; n++)
+      if (fitsread(tab[n]->headbuf, "ACCEPTED", &ival[n], H_INT, T_LONG)
+		!= RETURN_OK)
+        ival[n] = -1;
+    if (ival[0] != ival[1])
+      {
+      printf("psfcmp: extension %d: %d vs %d accepted samples\n",
+		e+1, ival[0], ival[1]);
+      nfail++;
+      }
+    for (n=0; n<2; n++)
+      if (!(key[n] = read_key(tab[n], "PSF_MASK")))
+        error(EXIT_FAILURE, "*Error*: no PSF_MASK in ", filename[n]);
+    if (key[0]->nbytes != key[1]->nbytes)
+      {
+      printf("psfcmp: extension %d: PSF_MASK sizes differ\n", e+1);
+      nfail++;
+      continue;
+      }
+    pix[0] = (float *)key[0]->ptr;
+    pix[1] = (float *)key[1]->ptr;
+    nval = key[0]->nbytes/sizeof(float);
+    pmax = dmax = 0.0;
+    for (i=0; i<nval; i++)
+      {
+      if (fabs(pix[0][i]) > pmax)
+        pmax = fabs(pix[0][i]);
+      dpix = fabs((double)pix[1][i] - (double)pix[0][i]);
+      if (dpix > dmax)
+        dmax = dpix;
+      }
+    if (pmax>0.0)
+      dmax /= pmax;
+    if (dmax > tol)
+      {
+      printf("psfcmp: extension %d: max. relative difference %.3g\n",
+		e+1, dmax);
+      nfail++;
+      }
+    }
+  if (!e || (!nfail && cmp_nexttab(cat[1], tab[1])))
+    {
+    printf("psfcmp: PSF extension counts differ\n");
+    nfail++;
+    }
+  free_cat(&cat[0], 1);
+  free_cat(&cat[1], 1);
+
+  return nfail? EXIT_FAILURE : EXIT_SUCCESS;
+  }
+
+
+/****** cmp_nexttab **********************************************************
+PROTO	tabstruct *cmp_nexttab(catstruct *cat, tabstruct *tab)
+PURPOSE	Find the next PSF_DATA extension of a PSF file.
+INPUT	Pointer to the catalogue,
+	pointer to the current extension (NULL to start from the beginning).
+OUTPUT	Pointer to the next PSF_DATA extension, or NULL if there is none.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static tabstruct	*cmp_nexttab(catstruct *cat, tabstruct *tab)
+  {
+/* The list of extensions is circular */
+  if (tab && tab->nexttab==cat->tab)
+    return NULL;
+  for (tab=tab? tab->nexttab : cat->tab; ; tab=tab->nexttab)
+    {
+    if (!strcmp(tab->extname, "PSF_DATA"))
+      return tab;
+    if (tab->nexttab==cat->tab)
+      return NULL;
+    }
+  }
+
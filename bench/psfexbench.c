@@ -0,0 +1,149 @@
+/*
+*				psfexbench.c
+*
+* Run a benchmark command and log its throughput and peak memory usage.
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*
+*	This file part of:	PSFEx
+*
+*	Copyright:		(C) 2026 Emmanuel Bertin -- IAP/CNRS/UPMC
+*
+*	License:		GNU General Public License
+*
+*	PSFEx is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+* 	(at your option) any later version.
+*	PSFEx is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*	You should have received a copy of the GNU General Public License
+*	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
+*
+*	Last modified:		19/10/2026
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+#ifdef HAVE_CONFIG_H
+#include        "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define		BENCH_SYNTAX \
+"psfexbench -o result_file -l label -s nsources -p npsfs -- command [args]\n"
+
+/********************************** main ************************************/
+/*
+Run the command following "--", wait for it and append a JSON record to the
+result file, one line per run. Throughputs are computed from the numbers of
+sources and PSF models given on the command line and the elapsed time; they
+are null for runs that failed.
+*/
+int main(int argc, char *argv[])
+  {
+   struct rusage	ru;
+   struct timeval	tv0, tv1;
+   FILE			*file;
+   char			*filename, *label;
+   double		dtime, nsource, npsf, maxrss;
+   pid_t		pid;
+   int			a, status;
+
+  filename = label = NULL;
+  nsource = npsf = 0.0;
+  for (a=1; a<argc; a++)
+    {
+    if (!strcmp(argv[a], "--"))
+      {
+      a++;
+      break;
+      }
+    if (a+1>=argc)
+      break;
+    if (!strcmp(argv[a], "-o"))
+      filename = argv[++a];
+    else if (!strcmp(argv[a], "-l"))
+      label = argv[++a];
+    else if (!strcmp(argv[a], "-s"))
+      nsource = atof(argv[++a]);
+    else if (!strcmp(argv[a], "-p"))
+      npsf = atof(argv[++a]);
+    else
+      break;
+    }
+  if (!filename || !label || a>=argc)
+    {
+    fprintf(stderr, "SYNTAX: %s", BENCH_SYNTAX);
+    return EXIT_FAILURE;
+    }
+
+  gettimeofday(&tv0, NULL);
+  if ((pid = fork()) < 0)
+    {
+    perror("psfexbench: fork");
+    return EXIT_FAILURE;
+    }
+  if (!pid)
+    {
+    execvp(argv[a], argv+a);
+    perror(argv[a]);
+    _exit(127);
+    }
+  if (wait4(pid, &status, 0, &ru) < 0)
+    {
+    perror("psfexbench: wait4");
+    return EXIT_FAILURE;
+    }
+  gettimeofday(&tv1, NULL);
+  dtime = (tv1.tv_sec - tv0.tv_sec) + (tv1.tv_usec - tv0.tv_usec)/1.0e6;
+  if (dtime<1.0e-6)
+    dtime = 1.0e-6;
+/* ru_maxrss is in bytes on Darwin, and in kilobytes elsewhere */
+#ifdef __APPLE__
+  maxrss = ru.ru_maxrss/1024.0;
+#else
+  maxrss = (double)ru.ru_maxrss;
+#endif
+  status = WIFEXITED(status)? WEXITSTATUS(status) : 128+WTERMSIG(status);
+
+  if (!(file = fopen(filename, "a")))
+    {
+    perror(filename);
+    return EXIT_FAILURE;
+    }
+/* Failed runs are timed, but no throughput is derived from them */
+  fprintf(file, "{\"label\": \"%s\", \"status\": %d, "
+	"\"nsources\": %.0f, \"npsfs\": %.0f, "
+	"\"wall_s\": %.3f, \"user_s\": %.3f, \"sys_s\": %.3f, ",
+	label, status, nsource, npsf,
+	dtime,
+	ru.ru_utime.tv_sec + ru.ru_utime.tv_usec/1.0e6,
+	ru.ru_stime.tv_sec + ru.ru_stime.tv_usec/1.0e6);
+  if (status)
+    fprintf(file, "\"sources_per_s\": null, \"psfs_per_s\": null, ");
+  else
+    fprintf(file, "\"sources_per_s\": %.2f, \"psfs_per_s\": %.4f, ",
+	nsource/dtime, npsf/dtime);
+  fprintf(file, "\"maxrss_kb\": %.0f}\n", maxrss);
+  fclose(file);
+
+  if (status)
+    fprintf(stderr, "%-16s %8.2f s  FAILED (exit status %d)\n",
+	label, dtime, status);
+  else
+    fprintf(stderr, "%-16s %8.2f s %10.1f sources/s %8.3f PSFs/s %8.0f kB\n",
+	label, dtime, nsource/dtime, npsf/dtime, maxrss);
+
+  return status;
+  }
+
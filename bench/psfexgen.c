@@ -0,0 +1,556 @@
+/*
+*				psfexgen.c
+*
+* Generate synthetic SExtractor FITS-LDAC catalogues for benchmarking.
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*
+*	This file part of:	PSFEx
+*
+*	Copyright:		(C) 2026 Emmanuel Bertin -- IAP/CNRS/UPMC
+*
+*	License:		GNU General Public License
+*
+*	PSFEx is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+* 	(at your option) any later version.
+*	PSFEx is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*	You should have received a copy of the GNU General Public License
+*	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
+*
+*	Last modified:		19/10/2026
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+#ifdef HAVE_CONFIG_H
+#include        "config.h"
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "define.h"
+#include "fits/fitscat.h"
+
+#define		GEN_SYNTAX \
+"psfexgen [-n nstars][-g galaxy_fraction][-v vignet_size][-x nextensions]\n" \
+"\t\t[-W chip_width][-H chip_height][-f fwhm][-b moffat_beta]\n" \
+"\t\t[-e max_ellipticity][-s backnoise][-a gain][-r seed] catalog\n"
+
+#define		GEN_OVERSAMP	3	/* Pixel oversampling of the models */
+#define		GEN_CHIPGAP	100	/* Gap between chips (pixels) */
+#define		GEN_PIXSCALE	0.2	/* Pixel scale (arcsec) */
+#define		GEN_FLAGFRAC	0.03	/* Fraction of flagged detections */
+#define		GEN_FMIN	5000.0	/* Minimum source flux (ADU) */
+#define		GEN_FSLOPE	1.5	/* Slope of the flux distribution */
+
+typedef struct genpar
+  {
+  int		nstar;			/* Number of sources per extension */
+  double	galfrac;		/* Fraction of extended sources */
+  int		vigsize;		/* Vignette side (pixels) */
+  int		next;			/* Number of extensions */
+  int		width, height;		/* Chip dimensions (pixels) */
+  double	fwhm;			/* PSF FWHM at focal-plane centre */
+  double	beta;			/* Moffat beta */
+  double	ellipmax;		/* Max. PSF ellipticity in the field */
+  double	backnoise;		/* Background noise RMS (ADU) */
+  double	gain;			/* Detector gain (e-/ADU) */
+  unsigned long	seed;			/* Random seed */
+  }	genparstruct;
+
+static void	gen_ext(catstruct *cat, genparstruct *par, int ext),
+		gen_moffat(float *vig, int vigw, double cx, double cy,
+			double flux, double fwhm, double beta,
+			double e1, double e2),
+		gen_vignoise(float *vig, int npix, double backnoise,
+			double gain);
+
+static tabstruct	*gen_imhead(genparstruct *par, int ext);
+
+static keystruct	*gen_key(tabstruct *tab, char *name, char *comment,
+			char *unit, t_type ttype, h_type htype, void *ptr,
+			int naxis, int naxis1, int naxis2);
+
+static double	gen_rand(void),
+		gen_gauss(void);
+
+static unsigned long long	gen_state;
+
+/********************************** main ************************************/
+
+int main(int argc, char *argv[])
+  {
+   genparstruct	par;
+   catstruct	*cat;
+   char		*filename;
+   unsigned short	ashort=1;
+   int		a, ext;
+
+  par.nstar = 500;
+  par.galfrac = 0.2;
+  par.vigsize = 35;
+  par.next = 1;
+  par.width = 2048;
+  par.height = 4096;
+  par.fwhm = 3.0;
+  par.beta = 2.8;
+  par.ellipmax = 0.08;
+  par.backnoise = 10.0;
+  par.gain = 2.0;
+  par.seed = 1;
+  filename = NULL;
+
+  for (a=1; a<argc; a++)
+    if (*argv[a]=='-' && argv[a][1] && !argv[a][2])
+      {
+      if (a+1>=argc)
+        error(EXIT_FAILURE, "SYNTAX: ", GEN_SYNTAX);
+      switch((int)argv[a][1])
+        {
+        case 'n':	par.nstar = atoi(argv[++a]); break;
+        case 'g':	par.galfrac = atof(argv[++a]); break;
+        case 'v':	par.vigsize = atoi(argv[++a]); break;
+        case 'x':	par.next = atoi(argv[++a]); break;
+        case 'W':	par.width = atoi(argv[++a]); break;
+        case 'H':	par.height = atoi(argv[++a]); break;
+        case 'f':	par.fwhm = atof(argv[++a]); break;
+        case 'b':	par.beta = atof(argv[++a]); break;
+        case 'e':	par.ellipmax = atof(argv[++a]); break;
+        case 's':	par.backnoise = atof(argv[++a]); break;
+        case 'a':	par.gain = atof(argv[++a]); break;
+        case 'r':	par.seed = strtoul(argv[++a], NULL, 10); break;
+        default:	error(EXIT_FAILURE, "SYNTAX: ", GEN_SYNTAX);
+        }
+      }
+    else
+      filename = argv[a];
+
+  if (!filename)
+    error(EXIT_FAILURE, "SYNTAX: ", GEN_SYNTAX);
+  if (par.nstar<1 || par.next<1 || par.vigsize<5 || par.beta<=1.0
+	|| par.width<=par.vigsize || par.height<=par.vigsize)
+    error(EXIT_FAILURE, "*Error*: invalid generator parameters for ",
+	filename);
+
+/* Test if byteswapping will be needed */
+  bswapflag = *((char *)&ashort);
+
+  gen_state = 0x9E3779B97F4A7C15ULL ^ (unsigned long long)par.seed;
+
+  cat = new_cat(1);
+  init_cat(cat);
+  strcpy(cat->filename, filename);
+  if (open_cat(cat, WRITE_ONLY) != RETURN_OK)
+    error(EXIT_FAILURE, "*Error*: cannot open for writing ", cat->filename);
+/* Write primary HDU */
+  save_tab(cat, cat->tab);
+
+  for (ext=0; ext<par.next; ext++)
+    gen_ext(cat, &par, ext);
+
+  free_cat(&cat, 1);
+
+  return EXIT_SUCCESS;
+  }
+
+
+/****** gen_ext **************************************************************
+PROTO	void gen_ext(catstruct *cat, genparstruct *par, int ext)
+PURPOSE	Write the LDAC_IMHEAD and LDAC_OBJECTS tables of one extension.
+INPUT	Pointer to the output catalogue,
+	pointer to the generator parameters,
+	extension number.
+OUTPUT	-.
+NOTES	Chips are laid out on a square grid in the focal plane. The PSF FWHM
+	grows quadratically and the ellipticity follows a tangential pattern
+	with the distance to the focal-plane centre.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	gen_ext(catstruct *cat, genparstruct *par, int ext)
+  {
+   tabstruct	*imatab, *tab;
+   keystruct	*key;
+   char		*buf;
+   float	*vig, *vigt,
+		fluxaper, fluxerraper, fluxmax, fluxrad, elong;
+   double	xm,ym, u,v, fpw,fph, xoff,yoff, flux, fwhm, e1,e2, e, theta,
+		alpha, beta, dx,dy, r2ap, margin;
+   short	flags;
+   int		i,j,n, vigw, ncol, nrow, npix, naper;
+
+  vigw = par->vigsize;
+  npix = vigw*vigw;
+  QMALLOC(vig, float, npix);
+
+/* Focal-plane geometry */
+  ncol = (int)ceil(sqrt((double)par->next));
+  nrow = (par->next+ncol-1)/ncol;
+  fpw = ncol*par->width + (ncol-1)*GEN_CHIPGAP;
+  fph = nrow*par->height + (nrow-1)*GEN_CHIPGAP;
+  xoff = (ext%ncol)*(par->width + GEN_CHIPGAP);
+  yoff = (ext/ncol)*(par->height + GEN_CHIPGAP);
+
+/* Image header, stored as an LDAC "Field Header Card" */
+  imatab = gen_imhead(par, ext);
+  tab = new_tab("LDAC_IMHEAD");
+  key = gen_key(tab, "Field Header Card", "", "", T_STRING, H_STRING,
+	imatab->headbuf, 2, 80, imatab->headnblock*(FBSIZE/80));
+  key->nobj = 1;
+  save_tab(cat, tab);
+  blank_keys(tab);
+  free_tab(tab);
+  free_tab(imatab);
+
+/* Object table */
+  tab = new_tab("LDAC_OBJECTS");
+  gen_key(tab, "X_IMAGE", "Object position along x", "pixel",
+	T_DOUBLE, H_FLOAT, &xm, 0,0,0);
+  gen_key(tab, "Y_IMAGE", "Object position along y", "pixel",
+	T_DOUBLE, H_FLOAT, &ym, 0,0,0);
+  gen_key(tab, "FLUX_APER", "Flux vector within fixed circular aperture(s)",
+	"count", T_FLOAT, H_FLOAT, &fluxaper, 0,0,0);
+  gen_key(tab, "FLUXERR_APER", "RMS error vector for aperture flux(es)",
+	"count", T_FLOAT, H_FLOAT, &fluxerraper, 0,0,0);
+  gen_key(tab, "FLUX_MAX", "Peak flux above background", "count",
+	T_FLOAT, H_FLOAT, &fluxmax, 0,0,0);
+  gen_key(tab, "FLUX_RADIUS", "Fraction-of-light radii", "pixel",
+	T_FLOAT, H_FLOAT, &fluxrad, 0,0,0);
+  gen_key(tab, "ELONGATION", "A_IMAGE/B_IMAGE", "",
+	T_FLOAT, H_FLOAT, &elong, 0,0,0);
+  gen_key(tab, "FLAGS", "Extraction flags", "",
+	T_SHORT, H_INT, &flags, 0,0,0);
+  gen_key(tab, "VIGNET", "Pixel data around detection", "count",
+	T_FLOAT, H_FLOAT, vig, 2, vigw, vigw);
+  tab->cat = cat;
+  init_writeobj(cat, tab, &buf);
+
+  margin = vigw/2 + 1.0;
+  for (n=par->nstar; n--;)
+    {
+    xm = margin + gen_rand()*(par->width - 2.0*margin);
+    ym = margin + gen_rand()*(par->height - 2.0*margin);
+/*-- Normalised focal-plane coordinates */
+    u = 2.0*(xm + xoff)/fpw - 1.0;
+    v = 2.0*(ym + yoff)/fph - 1.0;
+    fwhm = par->fwhm*(1.0 + 0.15*(u*u + v*v));
+    e1 = par->ellipmax*(u*u - v*v)/2.0;
+    e2 = par->ellipmax*u*v;
+    beta = par->beta;
+    flux = GEN_FMIN*pow(gen_rand(), -1.0/GEN_FSLOPE);
+    if (gen_rand() < par->galfrac)
+      {
+/*---- Extended source: a broader, flatter and more elongated profile */
+      fwhm *= 1.5 + 2.5*gen_rand();
+      beta = 1.5 + gen_rand();
+      e = 0.5*gen_rand();
+      theta = 2.0*PI*gen_rand();
+      e1 = e*cos(theta);
+      e2 = e*sin(theta);
+      }
+    dx = xm - (int)(xm+0.49999);
+    dy = ym - (int)(ym+0.49999);
+    gen_moffat(vig, vigw, vigw/2 + dx, vigw/2 + dy, flux, fwhm, beta, e1,e2);
+    gen_vignoise(vig, npix, par->backnoise, par->gain);
+
+/*-- Measurements */
+    r2ap = 2.25*par->fwhm*par->fwhm;
+    fluxaper = fluxmax = 0.0;
+    naper = 0;
+    vigt = vig;
+    for (j=0; j<vigw; j++)
+      for (i=0; i<vigw; i++, vigt++)
+        {
+        if (*vigt>fluxmax)
+          fluxmax = *vigt;
+        if ((i-vigw/2-dx)*(i-vigw/2-dx) + (j-vigw/2-dy)*(j-vigw/2-dy) < r2ap)
+          {
+          fluxaper += *vigt;
+          naper++;
+          }
+        }
+    fluxerraper = (float)sqrt(naper*par->backnoise*par->backnoise
+		+ (fluxaper>0.0? fluxaper/par->gain : 0.0));
+    alpha = fwhm/(2.0*sqrt(pow(2.0, 1.0/beta) - 1.0));
+    fluxrad = (float)(alpha*sqrt(pow(2.0, 1.0/(beta-1.0)) - 1.0)
+		*(1.0 + 0.01*gen_gauss()));
+    e = sqrt(e1*e1 + e2*e2);
+    elong = (float)((1.0 + e)/(1.0 - e));
+    flags = gen_rand()<GEN_FLAGFRAC? 2 : 0;
+    write_obj(tab, buf);
+    }
+
+  end_writeobj(cat, tab, buf);
+  blank_keys(tab);
+  free_tab(tab);
+  free(vig);
+
+  return;
+  }
+
+
+/****** gen_imhead ***********************************************************
+PROTO	tabstruct *gen_imhead(genparstruct *par, int ext)
+PURPOSE	Build the image header of a chip, with a TAN WCS common to the
+	focal plane.
+INPUT	Pointer to the generator parameters,
+	extension number.
+OUTPUT	Pointer to a new table structure containing the header.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static tabstruct	*gen_imhead(genparstruct *par, int ext)
+  {
+   static char	imatemplate[][80] = {
+"SIMPLE  =                    T / This is a FITS file",
+"BITPIX  =                  -32 / ",
+"NAXIS   =                    2 / ",
+"END                            "};
+   tabstruct	*tab;
+   char		str[80], *buf;
+   double	dval, fpw,fph;
+   int		i, ncol,nrow;
+
+  QCALLOC(tab, tabstruct, 1);
+  QCALLOC(tab->headbuf, char, FBSIZE);
+  memcpy(tab->headbuf, imatemplate, sizeof(imatemplate));
+  for (buf = tab->headbuf, i=FBSIZE; i--; buf++)
+    if (!*buf)
+      *buf = ' ';
+  tab->headnblock = 1;
+
+  ncol = (int)ceil(sqrt((double)par->next));
+  nrow = (par->next+ncol-1)/ncol;
+  fpw = ncol*par->width + (ncol-1)*GEN_CHIPGAP;
+  fph = nrow*par->height + (nrow-1)*GEN_CHIPGAP;
+
+  addkeywordto_head(tab, "NAXIS1  ", "Number of pixels along x");
+  fitswrite(tab->headbuf, "NAXIS1  ", &par->width, H_INT, T_LONG);
+  addkeywordto_head(tab, "NAXIS2  ", "Number of pixels along y");
+  fitswrite(tab->headbuf, "NAXIS2  ", &par->height, H_INT, T_LONG);
+  sprintf(str, "psfexgen chip %d", ext+1);
+  addkeywordto_head(tab, "OBJECT  ", "Synthetic field");
+  fitswrite(tab->headbuf, "OBJECT  ", str, H_STRING, T_STRING);
+  addkeywordto_head(tab, "EQUINOX ", "Mean equinox");
+  dval = 2000.0;
+  fitswrite(tab->headbuf, "EQUINOX ", &dval, H_FLOAT, T_DOUBLE);
+  addkeywordto_head(tab, "RADESYS ", "Astrometric system");
+  fitswrite(tab->headbuf, "RADESYS ", "ICRS", H_STRING, T_STRING);
+  addkeywordto_head(tab, "CTYPE1  ", "WCS projection type for this axis");
+  fitswrite(tab->headbuf, "CTYPE1  ", "RA---TAN", H_STRING, T_STRING);
+  addkeywordto_head(tab, "CTYPE2  ", "WCS projection type for this axis");
+  fitswrite(tab->headbuf, "CTYPE2  ", "DEC--TAN", H_STRING, T_STRING);
+  addkeywordto_head(tab, "CRVAL1  ", "World coordinate on this axis");
+  dval = 150.0;
+  fitswrite(tab->headbuf, "CRVAL1  ", &dval, H_EXPO, T_DOUBLE);
+  addkeywordto_head(tab, "CRVAL2  ", "World coordinate on this axis");
+  dval = 2.0;
+  fitswrite(tab->headbuf, "CRVAL2  ", &dval, H_EXPO, T_DOUBLE);
+/* All chips share the same tangent point at the focal-plane centre */
+  addkeywordto_head(tab, "CRPIX1  ", "Reference pixel on this axis");
+  dval = fpw/2.0 - (ext%ncol)*(par->width + GEN_CHIPGAP);
+  fitswrite(tab->headbuf, "CRPIX1  ", &dval, H_EXPO, T_DOUBLE);
+  addkeywordto_head(tab, "CRPIX2  ", "Reference pixel on this axis");
+  dval = fph/2.0 - (ext/ncol)*(par->height + GEN_CHIPGAP);
+  fitswrite(tab->headbuf, "CRPIX2  ", &dval, H_EXPO, T_DOUBLE);
+  addkeywordto_head(tab, "CD1_1   ", "Linear projection matrix");
+  dval = -GEN_PIXSCALE/3600.0;
+  fitswrite(tab->headbuf, "CD1_1   ", &dval, H_EXPO, T_DOUBLE);
+  addkeywordto_head(tab, "CD1_2   ", "Linear projection matrix");
+  dval = 0.0;
+  fitswrite(tab->headbuf, "CD1_2   ", &dval, H_EXPO, T_DOUBLE);
+  addkeywordto_head(tab, "CD2_1   ", "Linear projection matrix");
+  fitswrite(tab->headbuf, "CD2_1   ", &dval, H_EXPO, T_DOUBLE);
+  addkeywordto_head(tab, "CD2_2   ", "Linear projection matrix");
+  dval = GEN_PIXSCALE/3600.0;
+  fitswrite(tab->headbuf, "CD2_2   ", &dval, H_EXPO, T_DOUBLE);
+  addkeywordto_head(tab, "SEXBKDEV", "Background RMS (ADU)");
+  fitswrite(tab->headbuf, "SEXBKDEV", &par->backnoise, H_EXPO, T_DOUBLE);
+  addkeywordto_head(tab, "SEXGAIN ", "Gain used (e-/ADU)");
+  fitswrite(tab->headbuf, "SEXGAIN ", &par->gain, H_EXPO, T_DOUBLE);
+
+  return tab;
+  }
+
+
+/****** gen_key **************************************************************
+PROTO	keystruct *gen_key(tabstruct *tab, char *name, char *comment,
+			char *unit, t_type ttype, h_type htype, void *ptr,
+			int naxis, int naxis1, int naxis2)
+PURPOSE	Append a new column to a table.
+INPUT	Pointer to the table,
+	column name,
+	column comment,
+	column unit,
+	column binary type,
+	column display type,
+	pointer to the data,
+	number of dimensions (0 for scalars),
+	size along the first dimension,
+	size along the second dimension.
+OUTPUT	Pointer to the new key.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static keystruct	*gen_key(tabstruct *tab, char *name, char *comment,
+			char *unit, t_type ttype, h_type htype, void *ptr,
+			int naxis, int naxis1, int naxis2)
+  {
+   keystruct	*key;
+
+  key = new_key(name);
+  strcpy(key->comment, comment);
+  strcpy(key->unit, unit);
+  key->ttype = ttype;
+  key->htype = htype;
+  key->nbytes = t_size[ttype];
+  if ((key->naxis = naxis))
+    {
+    QMALLOC(key->naxisn, int, naxis);
+    key->naxisn[0] = naxis1;
+    key->nbytes *= naxis1;
+    if (naxis>1)
+      {
+      key->naxisn[1] = naxis2;
+      key->nbytes *= naxis2;
+      }
+    }
+  key->nobj = 0;
+  key->ptr = ptr;
+  add_key(key, tab, 0);
+
+  return key;
+  }
+
+
+/****** gen_moffat ***********************************************************
+PROTO	void gen_moffat(float *vig, int vigw, double cx, double cy,
+			double flux, double fwhm, double beta,
+			double e1, double e2)
+PURPOSE	Render an elliptical Moffat profile in a square vignette.
+INPUT	Pointer to the vignette,
+	vignette side,
+	profile centre along x (pixels, vignette frame),
+	profile centre along y (pixels, vignette frame),
+	total flux,
+	FWHM along the geometric mean of the axes,
+	Moffat beta,
+	first ellipticity component ((a-b)/(a+b) units),
+	second ellipticity component.
+OUTPUT	-.
+NOTES	Each pixel is integrated on a GEN_OVERSAMP x GEN_OVERSAMP grid.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	gen_moffat(float *vig, int vigw, double cx, double cy,
+			double flux, double fwhm, double beta,
+			double e1, double e2)
+  {
+   double	alpha, e, q, ct,st, cxx,cyy,cxy, norm, x,y, x0,y0, dstep, sum;
+   int		i,j, si,sj;
+
+  alpha = fwhm/(2.0*sqrt(pow(2.0, 1.0/beta) - 1.0));
+  e = sqrt(e1*e1 + e2*e2);
+  q = (1.0 - e)/(1.0 + e);
+  ct = e>0.0? cos(0.5*atan2(e2, e1)) : 1.0;
+  st = e>0.0? sin(0.5*atan2(e2, e1)) : 0.0;
+  cxx = (q*ct*ct + st*st/q)/(alpha*alpha);
+  cyy = (q*st*st + ct*ct/q)/(alpha*alpha);
+  cxy = 2.0*ct*st*(q - 1.0/q)/(alpha*alpha);
+  dstep = 1.0/GEN_OVERSAMP;
+  norm = flux*(beta-1.0)/(PI*alpha*alpha)*dstep*dstep;
+  for (j=0; j<vigw; j++)
+    {
+    y0 = j - cy - 0.5 + 0.5*dstep;
+    for (i=0; i<vigw; i++)
+      {
+      x0 = i - cx - 0.5 + 0.5*dstep;
+      sum = 0.0;
+      for (sj=0; sj<GEN_OVERSAMP; sj++)
+        {
+        y = y0 + sj*dstep;
+        for (si=0; si<GEN_OVERSAMP; si++)
+          {
+          x = x0 + si*dstep;
+          sum += pow(1.0 + cxx*x*x + cyy*y*y + cxy*x*y, -beta);
+          }
+        }
+      *(vig++) = (float)(norm*sum);
+      }
+    }
+
+  return;
+  }
+
+
+/****** gen_vignoise *********************************************************
+PROTO	void gen_vignoise(float *vig, int npix, double backnoise, double gain)
+PURPOSE	Add background and photon noise to a vignette.
+INPUT	Pointer to the vignette,
+	number of pixels,
+	background noise RMS (ADU),
+	gain (e-/ADU).
+OUTPUT	-.
+NOTES	Photon noise is approximated by a Gaussian.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	gen_vignoise(float *vig, int npix, double backnoise,
+			double gain)
+  {
+   double	var;
+   int		i;
+
+  for (i=npix; i--; vig++)
+    {
+    var = backnoise*backnoise + (*vig>0.0 && gain>0.0? *vig/gain : 0.0);
+    *vig += (float)(sqrt(var)*gen_gauss());
+    }
+
+  return;
+  }
+
+
+/****** gen_rand *************************************************************
+PROTO	double gen_rand(void)
+PURPOSE	Return a uniform random deviate in ]0,1[.
+INPUT	-.
+OUTPUT	Random deviate.
+NOTES	xorshift64* generator: the output only depends on the seed, which
+	keeps benchmark datasets identical across platforms.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static double	gen_rand(void)
+  {
+  gen_state ^= gen_state >> 12;
+  gen_state ^= gen_state << 25;
+  gen_state ^= gen_state >> 27;
+  return ((double)((gen_state*0x2545F4914F6CDD1DULL) >> 11) + 0.5)
+	/ 9007199254740992.0;
+  }
+
+
+/****** gen_gauss ************************************************************
+PROTO	double gen_gauss(void)
+PURPOSE	Return a Gaussian random deviate with zero mean and unit variance.
+INPUT	-.
+OUTPUT	Random deviate.
+NOTES	Box-Muller method.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static double	gen_gauss(void)
+  {
+  return sqrt(-2.0*log(gen_rand()))*cos(2.0*PI*gen_rand());
+  }
+
@@ -0,0 +1,727 @@
+/*
+*				psfexmicro.c
+*
+* Microbenchmarks of the core PSFEx numerical kernels.
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*
+*	This file part of:	PSFEx
+*
+*	Copyright:		(C) 2026 Emmanuel Bertin -- IAP/CNRS/UPMC
+*
+*	License:		GNU General Public License
+*
+*	PSFEx is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+* 	(at your option) any later version.
+*	PSFEx is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*	You should have received a copy of the GNU General Public License
+*	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
+*
+*	Last modified:		19/10/2026
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+#ifdef HAVE_CONFIG_H
+#include        "config.h"
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include FFTW_H
+
+#include "define.h"
+#include "types.h"
+#include "globals.h"
+#include "fits/fitscat.h"
+#include "prefs.h"
+#include "context.h"
+#include "diagnostic.h"
+#include "field.h"
+#include "fft.h"
+#include "misc.h"
+#include "pca.h"
+#include "poly.h"
+#include "psf.h"
+#include "sample.h"
+#include "vignet.h"
+
+#define		MICRO_SYNTAX \
+"psfexmicro [-t min_time][-r nrepeat][-f name_filter][-o result_file]\n"
+
+#define		MICRO_MINTIME	0.2	/* Default min. time per measurement (s)*/
+#define		MICRO_NREPEAT	5	/* Default number of measurements */
+#define		MICRO_VIGSIZE	35	/* Side of the sample vignettes */
+#define		MICRO_FWHM	3.0	/* FWHM of the synthetic sources */
+#define		MICRO_NPOS	256	/* Number of cycled input positions */
+
+/*
+Each kernel runs on fixed synthetic inputs. The number of calls per
+measurement is calibrated to last at least min_time; the best and median
+timings over nrepeat measurements are reported. bytes/op is the size of the
+arrays read and written by one call, i.e. a lower bound of its memory traffic.
+*/
+
+typedef void	(*microfunc)(void *data);
+
+static void	micro_run(char *name, microfunc func, void *data, double bytes),
+		micro_moffat(float *pix, int w, int h, double xc, double yc,
+			double fwhm),
+		micro_randfill(float *pix, int n, double amp);
+
+static double	micro_rand(void),
+		micro_time(void);
+
+static setstruct	*micro_set(contextstruct *context, int nsample);
+
+static double	micro_mintime = MICRO_MINTIME;
+static int	micro_nrepeat = MICRO_NREPEAT;
+static char	*micro_filter = NULL;
+static FILE	*micro_file = NULL;
+static unsigned long long	micro_state = 0x9E3779B97F4A7C15ULL;
+
+/*------------------------------ Kernel wrappers ----------------------------*/
+
+typedef struct
+  {
+  float		*pix1, *pix2;
+  int		w1,h1, w2,h2;
+  float		step2;
+  }	resampledata;
+
+static void	run_resample(void *data)
+  {
+   resampledata	*d = (resampledata *)data;
+
+  vignet_resample(d->pix1, d->w1, d->h1, d->pix2, d->w2, d->h2,
+	0.31, -0.17, d->step2, 1.0);
+  }
+
+typedef struct
+  {
+  polystruct	*poly;
+  double	*pos, *x, *y;
+  int		ndata, ipos;
+  }	polydata;
+
+static void	run_polyfunc(void *data)
+  {
+   polydata	*d = (polydata *)data;
+
+  poly_func(d->poly, d->pos + 2*d->ipos);
+  d->ipos = (d->ipos+1)%MICRO_NPOS;
+  }
+
+static void	run_polyfit(void *data)
+  {
+   polydata	*d = (polydata *)data;
+
+  poly_fit(d->poly, d->x, d->y, NULL, d->ndata, NULL);
+  }
+
+typedef struct
+  {
+  psfstruct	*psf;
+  setstruct	*set;
+  double	*pos;
+  float		*basis;
+  int		ipos;
+  }	psfdata;
+
+static void	run_psfbuild(void *data)
+  {
+   psfdata	*d = (psfdata *)data;
+
+  psf_build(d->psf, d->pos + 2*d->ipos);
+  d->ipos = (d->ipos+1)%MICRO_NPOS;
+  }
+
+static void	run_psfrefine(void *data)
+  {
+   psfdata	*d = (psfdata *)data;
+
+/* psf_refine() updates the basis coefficients in place: start afresh */
+  memset(d->psf->comp, 0, d->psf->npix*sizeof(float));
+  psf_freerefine(d->psf);
+  psf_refine(d->psf, d->set);
+  }
+
+static void	run_psfrefinewarm(void *data)
+  {
+   psfdata	*d = (psfdata *)data;
+
+/* Same, but reusing the solution and factorisation of the previous call */
+  memset(d->psf->comp, 0, d->psf->npix*sizeof(float));
+  psf_refine(d->psf, d->set);
+  }
+
+typedef struct
+  {
+  psfstruct	*psf;
+  double	dparam[PSF_DIAGNPARAM], *fvec;
+  int		m;
+  }	diagdata;
+
+static void	run_diagresi(void *data)
+  {
+   diagdata	*d = (diagdata *)data;
+
+  psf_diagresi(d->dparam, d->fvec, d->m, PSF_DIAGNPARAM, d->psf);
+  }
+
+typedef struct
+  {
+  setstruct	*set;
+  float		dx,dy, fluxrad;
+  }	sampledata;
+
+static void	run_recenter(void *data)
+  {
+   sampledata	*d = (sampledata *)data;
+
+  d->set->sample->dx = d->dx;
+  d->set->sample->dy = d->dy;
+  recenter_sample(d->set->sample, d->set, d->fluxrad);
+  }
+
+static void	run_weights(void *data)
+  {
+   sampledata	*d = (sampledata *)data;
+
+  make_weights(d->set, d->set->sample);
+  }
+
+typedef struct
+  {
+  float		*arr, *arr0;
+  double	*mat, *mat0;
+  float		*fdata;
+  int		n, w,h;
+  }	arraydata;
+
+static void	run_median(void *data)
+  {
+   arraydata	*d = (arraydata *)data;
+
+/* fast_median() sorts its input partially: restore it first */
+  memcpy(d->arr, d->arr0, d->n*sizeof(float));
+  fast_median(d->arr, d->n);
+  }
+
+static void	run_fftconv(void *data)
+  {
+   arraydata	*d = (arraydata *)data;
+
+  fft_conv(d->arr, d->fdata, d->w, d->h);
+  }
+
+static void	run_pcafindpc(void *data)
+  {
+   arraydata	*d = (arraydata *)data;
+
+/* pca_findpc() deflates the covariance matrix: restore it first */
+  memcpy(d->mat, d->mat0, (size_t)d->n*d->n*sizeof(double));
+  pca_findpc(d->mat, d->arr, d->n);
+  }
+
+/********************************** main ************************************/
+
+int main(int argc, char *argv[])
+  {
+   static char		*names[2] = {"X_IMAGE", "Y_IMAGE"};
+   static int		group[2] = {1,1},
+			sizes[3] = {25, 51, 101},
+			fftsizes[3] = {64, 128, 256},
+			medsizes[3] = {25, 1225, 100000},
+			pcasizes[2] = {64, 512};
+   static float		steps[3] = {0.5, 1.0, 2.0};
+   contextstruct	*context;
+   resampledata		rdata;
+   polydata		pdata;
+   psfdata		psfd;
+   diagdata		ddata;
+   sampledata		sdata;
+   arraydata		adata;
+   char			name[MAXCHAR];
+   double		*dmat;
+   float		*kernel, pixsize[2];
+   int			degree[1], size[2],
+			a,i,j,k, n, w, npix;
+
+  for (a=1; a<argc; a++)
+    {
+    if (a+1>=argc)
+      error(EXIT_FAILURE, "SYNTAX: ", MICRO_SYNTAX);
+    if (!strcmp(argv[a], "-t"))
+      micro_mintime = atof(argv[++a]);
+    else if (!strcmp(argv[a], "-r"))
+      micro_nrepeat = atoi(argv[++a]);
+    else if (!strcmp(argv[a], "-f"))
+      micro_filter = argv[++a];
+    else if (!strcmp(argv[a], "-o"))
+      {
+      if (!(micro_file = fopen(argv[++a], "w")))
+        error(EXIT_FAILURE, "*Error*: cannot open for writing ", argv[a]);
+      }
+    else
+      error(EXIT_FAILURE, "SYNTAX: ", MICRO_SYNTAX);
+    }
+  if (micro_nrepeat<1)
+    micro_nrepeat = 1;
+
+/* Internal defaults only */
+  readprefs("/dev/null", NULL, NULL, 0);
+  prefs.nthreads = 1;
+  useprefs();
+  pixsize[0] = pixsize[1] = 1.0;
+
+  fprintf(OUTPUT, "%-36s %14s %14s %12s\n",
+	"kernel", "ns/op (best)", "ns/op (med)", "bytes/op");
+
+/*-- vignet_resample() */
+  for (i=0; i<3; i++)
+    for (j=0; j<3; j++)
+      {
+      rdata.w1 = rdata.h1 = rdata.w2 = rdata.h2 = sizes[i];
+      rdata.step2 = steps[j];
+      QMALLOC(rdata.pix1, float, sizes[i]*sizes[i]);
+      QMALLOC(rdata.pix2, float, sizes[i]*sizes[i]);
+      micro_moffat(rdata.pix1, sizes[i], sizes[i], sizes[i]/2, sizes[i]/2,
+		MICRO_FWHM);
+      sprintf(name, "vignet_resample/%dx%d/step%.1f", sizes[i], sizes[i],
+		steps[j]);
+      micro_run(name, run_resample, &rdata, 2.0*sizes[i]*sizes[i]*sizeof(float));
+      free(rdata.pix1);
+      free(rdata.pix2);
+      }
+
+/*-- poly_func() and poly_fit() */
+  for (k=1; k<=5; k+=2)
+    {
+    degree[0] = k;
+    pdata.poly = poly_init(group, 2, degree, 1);
+    pdata.ndata = 1000;
+    QMALLOC(pdata.pos, double, 2*MICRO_NPOS);
+    for (i=0; i<2*MICRO_NPOS; i++)
+      pdata.pos[i] = 2.0*micro_rand() - 1.0;
+    pdata.ipos = 0;
+    QMALLOC(pdata.x, double, 2*pdata.ndata);
+    QMALLOC(pdata.y, double, pdata.ndata);
+    for (i=0; i<pdata.ndata; i++)
+      {
+      pdata.x[2*i] = 2.0*micro_rand() - 1.0;
+      pdata.x[2*i+1] = 2.0*micro_rand() - 1.0;
+      pdata.y[i] = 1.0 + pdata.x[2*i]*pdata.x[2*i+1] + 0.01*micro_rand();
+      }
+    sprintf(name, "poly_func/2D/deg%d", k);
+    micro_run(name, run_polyfunc, &pdata,
+	(2.0 + 2.0*pdata.poly->ncoeff)*sizeof(double));
+    sprintf(name, "poly_fit/2D/deg%d/n%d", k, pdata.ndata);
+    micro_run(name, run_polyfit, &pdata,
+	(3.0 + pdata.poly->ncoeff)*pdata.ndata*sizeof(double));
+    free(pdata.pos);
+    free(pdata.x);
+    free(pdata.y);
+    poly_end(pdata.poly);
+    }
+
+/*-- psf_build() */
+  degree[0] = 3;
+  context = context_init(names, group, 2, degree, 1, CONTEXT_REMOVEHIDDEN);
+  for (i=0; i<3; i++)
+    {
+    size[0] = size[1] = sizes[i];
+    psfd.psf = psf_init(context, size, 1.0, pixsize, 1000);
+    micro_randfill(psfd.psf->comp, psfd.psf->npix, 1.0);
+    QMALLOC(psfd.pos, double, 2*MICRO_NPOS);
+    for (j=0; j<2*MICRO_NPOS; j++)
+      psfd.pos[j] = micro_rand() - 0.5;
+    psfd.ipos = 0;
+    sprintf(name, "psf_build/%dx%d/deg3", sizes[i], sizes[i]);
+    micro_run(name, run_psfbuild, &psfd,
+	(double)psfd.psf->npix*sizeof(float)
+	+ (double)sizes[i]*sizes[i]*sizeof(float));
+    free(psfd.pos);
+    psf_end(psfd.psf);
+    }
+  context_end(context);
+
+/*-- psf_refine(), with a pixel basis and a linear dependency on position */
+  degree[0] = 1;
+  context = context_init(names, group, 2, degree, 1, CONTEXT_REMOVEHIDDEN);
+  for (n=100; n<=400; n*=4)
+    {
+    size[0] = size[1] = MICRO_VIGSIZE;
+    psfd.set = micro_set(context, n);
+    psfd.psf = psf_init(context, size, 1.0, pixsize, n);
+    micro_moffat(psfd.psf->comp, size[0], size[1], size[0]/2, size[1]/2,
+	MICRO_FWHM);
+    psf_makebasis(psfd.psf, psfd.set, BASIS_PIXEL, 6);
+    w = psfd.psf->nbasis*psfd.psf->poly->ncoeff;
+    sprintf(name, "psf_refine/%dx%d/nbasis%d/n%d", size[0], size[1],
+	psfd.psf->nbasis, n);
+    micro_run(name, run_psfrefine, &psfd,
+	(double)n*psfd.set->nvig*2*sizeof(float) + (double)w*w*sizeof(double));
+    sprintf(name, "psf_refine_warm/%dx%d/nbasis%d/n%d", size[0], size[1],
+	psfd.psf->nbasis, n);
+    micro_run(name, run_psfrefinewarm, &psfd,
+	(double)n*psfd.set->nvig*2*sizeof(float) + (double)w*w*sizeof(double));
+    psf_end(psfd.psf);
+    end_set(psfd.set);
+    }
+  context_end(context);
+
+/*-- psf_diagresi() */
+  degree[0] = 0;
+  context = context_init(names, group, 0, degree, 0, CONTEXT_REMOVEHIDDEN);
+  for (i=0; i<2; i++)
+    for (k=1; k<=3; k+=2)
+      {
+      size[0] = size[1] = sizes[i];
+      ddata.psf = psf_init(context, size, 1.0, pixsize, 1);
+      ddata.psf->nsubpix = k;
+      micro_moffat(ddata.psf->loc, size[0], size[1], size[0]/2, size[1]/2,
+		MICRO_FWHM);
+      ddata.m = size[0]*size[1];
+      QMALLOC(ddata.fvec, double, ddata.m);
+      moffat_parammin[0] = 0.1/(MICRO_FWHM*MICRO_FWHM);
+      moffat_parammax[0] = 10.0/(MICRO_FWHM*MICRO_FWHM);
+      moffat_parammin[1] = moffat_parammin[2] = 0.0;
+      moffat_parammax[1] = moffat_parammax[2] = size[0] - 1.0;
+      moffat_parammin[3] = moffat_parammin[4] = MICRO_FWHM/3.0;
+      moffat_parammax[3] = moffat_parammax[4] = MICRO_FWHM*3.0;
+      moffat_parammin[5] = moffat_parammax[5] = 90.0;
+      moffat_parammin[6] = PSF_BETAMIN;
+      moffat_parammax[6] = 10.0;
+       {
+        float	param[PSF_DIAGNPARAM] = {1.0/(MICRO_FWHM*MICRO_FWHM),
+			0.0, 0.0, MICRO_FWHM, MICRO_FWHM*0.9, 30.0, 3.0};
+
+        param[1] = param[2] = (size[0]-1)/2.0;
+        psf_boundtounbound(param, ddata.dparam);
+       }
+      sprintf(name, "psf_diagresi/%dx%d/nsubpix%d", size[0], size[1], k);
+      micro_run(name, run_diagresi, &ddata,
+	(double)ddata.m*(sizeof(float)+sizeof(double)));
+      free(ddata.fvec);
+      psf_end(ddata.psf);
+      }
+  context_end(context);
+
+/*-- recenter_sample() and make_weights() */
+  degree[0] = 0;
+  context = context_init(names, group, 0, degree, 0, CONTEXT_REMOVEHIDDEN);
+  sdata.set = micro_set(context, 1);
+  sdata.dx = sdata.set->sample->dx;
+  sdata.dy = sdata.set->sample->dy;
+  sdata.fluxrad = MICRO_FWHM/2.0;
+  npix = sdata.set->nvig;
+  sprintf(name, "recenter_sample/%dx%d", MICRO_VIGSIZE, MICRO_VIGSIZE);
+  micro_run(name, run_recenter, &sdata, 2.0*npix*sizeof(float));
+  sprintf(name, "make_weights/%dx%d", MICRO_VIGSIZE, MICRO_VIGSIZE);
+  micro_run(name, run_weights, &sdata, 2.0*npix*sizeof(float));
+  end_set(sdata.set);
+  context_end(context);
+
+/*-- fast_median() */
+  for (i=0; i<3; i++)
+    {
+    adata.n = medsizes[i];
+    QMALLOC(adata.arr, float, adata.n);
+    QMALLOC(adata.arr0, float, adata.n);
+    micro_randfill(adata.arr0, adata.n, 1000.0);
+    sprintf(name, "fast_median/n%d", adata.n);
+    micro_run(name, run_median, &adata, 2.0*adata.n*sizeof(float));
+    free(adata.arr);
+    free(adata.arr0);
+    }
+
+/*-- fft_conv() */
+  fft_init(1);
+  for (i=0; i<3; i++)
+    {
+    adata.w = adata.h = fftsizes[i];
+    npix = adata.w*adata.h;
+    QMALLOC(adata.arr, float, npix);
+    QCALLOC(kernel, float, npix);
+    micro_randfill(adata.arr, npix, 1.0);
+    micro_moffat(kernel, adata.w, adata.h, 0.0, 0.0, MICRO_FWHM);
+    adata.fdata = fft_rtf(kernel, adata.w, adata.h);
+    sprintf(name, "fft_conv/%dx%d", adata.w, adata.h);
+    micro_run(name, run_fftconv, &adata,
+	2.0*npix*sizeof(float) + (adata.w/2+1)*adata.h*2.0*sizeof(float));
+    QFFTWFREE(adata.fdata);
+    free(kernel);
+    free(adata.arr);
+    }
+  fft_end(1);
+
+/*-- pca_findpc(), on the covariance matrix of random vectors */
+  for (i=0; i<2; i++)
+    {
+    adata.n = n = pcasizes[i];
+    QMALLOC(adata.mat, double, n*n);
+    QMALLOC(adata.mat0, double, n*n);
+    QMALLOC(adata.arr, float, n);
+    QMALLOC(dmat, double, 8*n);
+    for (j=0; j<8*n; j++)
+      dmat[j] = micro_rand() - 0.5;
+    for (j=0; j<n; j++)
+      for (k=0; k<n; k++)
+        {
+         double	dval;
+         int	l;
+
+        dval = 0.0;
+        for (l=0; l<8; l++)
+          dval += dmat[l*n+j]*dmat[l*n+k];
+        adata.mat0[j*n+k] = dval;
+        }
+    sprintf(name, "pca_findpc/n%d", n);
+    micro_run(name, run_pcafindpc, &adata,
+	(double)n*n*sizeof(double) + n*sizeof(float));
+    free(dmat);
+    free(adata.arr);
+    free(adata.mat);
+    free(adata.mat0);
+    }
+
+  if (micro_file)
+    fclose(micro_file);
+
+  return EXIT_SUCCESS;
+  }
+
+
+/****** micro_run ************************************************************
+PROTO	void micro_run(char *name, microfunc func, void *data, double bytes)
+PURPOSE	Time a kernel and print the result.
+INPUT	Benchmark name,
+	pointer to the function running the kernel once,
+	pointer to the kernel data,
+	number of bytes read and written per call.
+OUTPUT	-.
+NOTES	Benchmarks whose name does not contain the filter string are skipped.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	micro_run(char *name, microfunc func, void *data, double bytes)
+  {
+   double	*dt, t, tbest, tmed;
+   long		i, n;
+   int		r;
+
+  if (micro_filter && !strstr(name, micro_filter))
+    return;
+
+/* Warm-up, then calibrate the number of calls per measurement */
+  func(data);
+  for (n=1;; n*=2)
+    {
+    t = micro_time();
+    for (i=n; i--;)
+      func(data);
+    t = micro_time() - t;
+    if (t >= micro_mintime)
+      break;
+    if (t > micro_mintime/8.0)
+      {
+      n = (long)(n*micro_mintime/t) + 1;
+      break;
+      }
+    }
+
+  QMALLOC(dt, double, micro_nrepeat);
+  for (r=0; r<micro_nrepeat; r++)
+    {
+    t = micro_time();
+    for (i=n; i--;)
+      func(data);
+    dt[r] = (micro_time() - t)*1.0e9/n;
+    }
+  tbest = dt[0];
+  for (r=1; r<micro_nrepeat; r++)
+    if (dt[r]<tbest)
+      tbest = dt[r];
+  tmed = dqmedian(dt, micro_nrepeat);
+  free(dt);
+
+  fprintf(OUTPUT, "%-36s %14.1f %14.1f %12.0f\n", name, tbest, tmed, bytes);
+  if (micro_file)
+    {
+    fprintf(micro_file, "{\"name\": \"%s\", \"ns_per_op\": %.2f, "
+	"\"ns_per_op_median\": %.2f, \"bytes_per_op\": %.0f, "
+	"\"iterations\": %ld, \"repeats\": %d}\n",
+	name, tbest, tmed, bytes, n, micro_nrepeat);
+    fflush(micro_file);
+    }
+
+  return;
+  }
+
+
+/****** micro_set ************************************************************
+PROTO	setstruct *micro_set(contextstruct *context, int nsample)
+PURPOSE	Build a set of noisy synthetic star samples.
+INPUT	Pointer to the context structure,
+	number of samples.
+OUTPUT	Pointer to the new set.
+NOTES	Contexts are spread uniformly over [-0.5,0.5].
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static setstruct	*micro_set(contextstruct *context, int nsample)
+  {
+   setstruct	*set;
+   samplestruct	*sample;
+   float	*vig;
+   int		i,n;
+
+  set = init_set(context);
+  set->vigsize[0] = set->vigsize[1] = MICRO_VIGSIZE;
+  set->nvig = MICRO_VIGSIZE*MICRO_VIGSIZE;
+  set->fwhm = MICRO_FWHM;
+  for (i=0; i<set->ncontext; i++)
+    {
+    set->contextoffset[i] = 0.0;
+    set->contextscale[i] = 1.0;
+    }
+  malloc_samples(set, nsample);
+  for (n=0, sample=set->sample; n<nsample; n++, sample++)
+    {
+    sample->catindex = sample->extindex = 0;
+    sample->dx = micro_rand() - 0.5;
+    sample->dy = micro_rand() - 0.5;
+    sample->x = 1000.0 + sample->dx;
+    sample->y = 1000.0 + sample->dy;
+    sample->norm = 1.0e4;
+    sample->backnoise2 = 100.0;
+    sample->gain = 1.0;
+    for (i=0; i<set->ncontext; i++)
+      sample->context[i] = micro_rand() - 0.5;
+    vig = sample->vig;
+    micro_moffat(vig, MICRO_VIGSIZE, MICRO_VIGSIZE,
+	MICRO_VIGSIZE/2 + sample->dx, MICRO_VIGSIZE/2 + sample->dy,
+	MICRO_FWHM);
+    for (i=set->nvig; i--; vig++)
+      *vig = *vig*sample->norm + 10.0*(micro_rand() - 0.5)*3.4641;
+    make_weights(set, sample);
+    }
+  set->nsample = nsample;
+
+  return set;
+  }
+
+
+/****** micro_moffat *********************************************************
+PROTO	void micro_moffat(float *pix, int w, int h, double xc, double yc,
+			double fwhm)
+PURPOSE	Render a normalised, round Moffat profile (beta=3).
+INPUT	Pointer to the image,
+	image width,
+	image height,
+	profile centre along x,
+	profile centre along y,
+	profile FWHM.
+OUTPUT	-.
+NOTES	Coordinates wrap around the image borders, so that a profile centred
+	on (0,0) can be used as a convolution kernel.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	micro_moffat(float *pix, int w, int h, double xc, double yc,
+			double fwhm)
+  {
+   double	inva2, norm, dx,dy;
+   int		x,y;
+
+  inva2 = 4.0*(pow(2.0, 1.0/3.0) - 1.0)/(fwhm*fwhm);
+  norm = 2.0*inva2/PI;
+  for (y=0; y<h; y++)
+    {
+    dy = y - yc;
+    if (dy > h/2)
+      dy -= h;
+    else if (dy < -h/2)
+      dy += h;
+    for (x=0; x<w; x++)
+      {
+      dx = x - xc;
+      if (dx > w/2)
+        dx -= w;
+      else if (dx < -w/2)
+        dx += w;
+      *(pix++) = (float)(norm*pow(1.0 + inva2*(dx*dx+dy*dy), -3.0));
+      }
+    }
+
+  return;
+  }
+
+
+/****** micro_randfill *******************************************************
+PROTO	void micro_randfill(float *pix, int n, double amp)
+PURPOSE	Fill an array with uniform random values.
+INPUT	Pointer to the array,
+	number of elements,
+	amplitude of the values.
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	micro_randfill(float *pix, int n, double amp)
+  {
+  for (; n--;)
+    *(pix++) = (float)(amp*(micro_rand() - 0.5));
+
+  return;
+  }
+
+
+/****** micro_rand ***********************************************************
+PROTO	double micro_rand(void)
+PURPOSE	Return a uniform random deviate in [0,1[.
+INPUT	-.
+OUTPUT	Random deviate.
+NOTES	xorshift64* generator with a fixed seed, so that inputs are identical
+	from run to run.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static double	micro_rand(void)
+  {
+  micro_state ^= micro_state >> 12;
+  micro_state ^= micro_state << 25;
+  micro_state ^= micro_state >> 27;
+  return (double)((micro_state*0x2545F4914F6CDD1DULL) >> 11)
+	/ 9007199254740992.0;
+  }
+
+
+/****** micro_time ***********************************************************
+PROTO	double micro_time(void)
+PURPOSE	Return the current wall-clock time.
+INPUT	-.
+OUTPUT	Time in seconds.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static double	micro_time(void)
+  {
+   struct timeval	tv;
+
+  gettimeofday(&tv, NULL);
+
+  return tv.tv_sec + tv.tv_usec/1.0e6;
+  }
+
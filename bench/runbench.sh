@@ -0,0 +1,102 @@
+#! /bin/sh
+#
+#				runbench.sh
+#
+# End-to-end PSFEx benchmark on synthetic FITS-LDAC catalogues.
+#
+#%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+#
+#	This file part of:	PSFEx
+#
+#	Copyright:		(C) 2026 Emmanuel Bertin -- IAP/CNRS/UPMC
+#
+#	License:		GNU General Public License
+#
+#	PSFEx is free software: you can redistribute it and/or modify
+#	it under the terms of the GNU General Public License as published by
+#	the Free Software Foundation, either version 3 of the License, or
+# 	(at your option) any later version.
+#	PSFEx is distributed in the hope that it will be useful,
+#	but WITHOUT ANY WARRANTY; without even the implied warranty of
+#	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#	GNU General Public License for more details.
+#	You should have received a copy of the GNU General Public License
+#	along with PSFEx. If not, see <http://www.gnu.org/licenses/>.
+#
+#	Last modified:		19/10/2026
+#
+#%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+#
+# Usage: runbench.sh psfex_binary bench_bindir output_dir
+#
+# The dataset can be tuned through the environment:
+#   BENCH_NCAT      number of catalogues (exposures)		[4]
+#   BENCH_NEXT      number of extensions (chips) per catalogue	[4]
+#   BENCH_NSTAR     number of sources per extension		[1000]
+#   BENCH_VIGSIZE   vignette side in pixels			[35]
+#   BENCH_NOISE     background noise RMS in ADU			[10]
+#   BENCH_NTHREADS  NTHREADS passed to PSFEx			[0]
+# One JSON record per configuration is written to output_dir/results.json
+
+PSFEX=$1
+BINDIR=$2
+OUTDIR=${3:-bench-results}
+
+NCAT=${BENCH_NCAT:-4}
+NEXT=${BENCH_NEXT:-4}
+NSTAR=${BENCH_NSTAR:-1000}
+VIGSIZE=${BENCH_VIGSIZE:-35}
+NOISE=${BENCH_NOISE:-10}
+NTHREADS=${BENCH_NTHREADS:-0}
+
+if test -z "$PSFEX" || test -z "$BINDIR"; then
+  echo "Usage: $0 psfex_binary bench_bindir [output_dir]" 1>&2
+  exit 1
+fi
+
+mkdir -p $OUTDIR/data $OUTDIR/psf || exit 1
+RESULTS=$OUTDIR/results.json
+rm -f $RESULTS
+
+# Generate the catalogues; the seeing changes from exposure to exposure so
+# that hidden dependencies have something to find
+echo "Generating $NCAT catalogues of $NEXT x $NSTAR sources..."
+CATS=""
+i=1
+while test $i -le $NCAT; do
+  FWHM=`echo $i | awk '{printf "%.2f", 2.6 + 0.3*($1-1)}'`
+  $BINDIR/psfexgen -n $NSTAR -x $NEXT -v $VIGSIZE -s $NOISE -f $FWHM -r $i \
+	$OUTDIR/data/field$i.cat || exit 1
+  CATS="$CATS $OUTDIR/data/field$i.cat"
+  i=`expr $i + 1`
+done
+
+NSOURCE=`expr $NCAT \* $NEXT \* $NSTAR`
+$PSFEX -dd > $OUTDIR/bench.psfex || exit 1
+COMMON="-c $OUTDIR/bench.psfex -PSF_DIR $OUTDIR/psf -CHECKPLOT_TYPE NONE \
+	-CHECKIMAGE_TYPE NONE -WRITE_XML N -VERBOSE_TYPE QUIET \
+	-NTHREADS $NTHREADS"
+
+# Usage: run label number_of_psf_models [psfex options]
+status=0
+run () {
+  label=$1
+  npsf=$2
+  shift 2
+  $BINDIR/psfexbench -o $RESULTS -l $label -s $NSOURCE -p $npsf -- \
+	$PSFEX $CATS $COMMON "$@" || status=1
+}
+
+NPSF=`expr $NCAT \* $NEXT`
+run pixel $NPSF -BASIS_TYPE PIXEL_AUTO
+run gauss-laguerre $NPSF -BASIS_TYPE GAUSS-LAGUERRE -BASIS_NUMBER 10
+run pca $NPSF -NEWBASIS_TYPE PCA_INDEPENDENT -NEWBASIS_NUMBER 8
+run hidden $NPSF -STABILITY_TYPE SEQUENCE \
+	-PSFVAR_KEYS X_IMAGE,Y_IMAGE,HIDDEN1 -PSFVAR_GROUPS 1,1,2 \
+	-PSFVAR_DEGREES 2,1
+run homo $NPSF -HOMOBASIS_TYPE GAUSS-LAGUERRE -HOMOKERNEL_DIR $OUTDIR/psf
+run focal-plane $NCAT -MEF_TYPE COMMON -PSFVAR_KEYS %FOCAL_X,%FOCAL_Y \
+	-PSFVAR_GROUPS 1,1 -PSFVAR_DEGREES 3
+
+echo "Results written to $RESULTS"
+exit $status
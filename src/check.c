@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		10/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -42,11 +42,345 @@
 #include	"check.h"
 #include	"diagnostic.h"
 #include	"field.h"
+#include	"linalg.h"
 #include	"poly.h"
 #include	"prefs.h"
 #include	"psf.h"
 #include	"sample.h"
 #include	"vignet.h"
+#ifdef USE_THREADS
+#include	"threads.h"
+#endif
+
+static void	check_save(catstruct *cat, tabstruct *tab, int flags),
+		check_savemosaic(catstruct *cat, tabstruct *tab, setstruct *set,
+			checkenum checktype, int flags),
+		check_savetab(checkqueuestruct *item),
+		check_submit(checkqueuestruct *item);
+
+#ifdef USE_THREADS
+static void	*pthread_check_writer(void *arg);
+
+static pthread_t	checkthread;
+static pthread_mutex_t	checkmutex;
+static pthread_cond_t	checkcond_in, checkcond_out;
+static checkqueuestruct	checkqueue[CHECK_MAXQUEUE];
+static int		checkqueue_first, checkqueue_n, checkqueue_nstrip,
+			checkbusyflag, checkendflag, checkthreadflag,
+			checknworkers;
+#endif
+
+/****** check_init *********************************************************
+PROTO	void	check_init(void)
+PURPOSE	Start the check-image writer thread.
+INPUT	-.
+OUTPUT  -.
+NOTES   Once started, check-image HDUs are written asynchronously, in the
+	order they were submitted. Without thread support check-images are
+	written synchronously. Tile-compression workers started by the writer
+	get half of the thread budget.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+ ***/
+void	check_init(void)
+  {
+#ifdef USE_THREADS
+  if (checkthreadflag)
+    return;
+  checkqueue_first = checkqueue_n = checkqueue_nstrip = checkbusyflag
+	= checkendflag = 0;
+  QPTHREAD_MUTEX_INIT(&checkmutex, NULL);
+  QPTHREAD_COND_INIT(&checkcond_in, NULL);
+  QPTHREAD_COND_INIT(&checkcond_out, NULL);
+  QPTHREAD_CREATE(&checkthread, NULL, pthread_check_writer, NULL);
+  checkthreadflag = 1;
+/* The writer thread now competes with BLAS for the thread budget; while */
+/* compressing tiles it just waits for its workers, which take its place */
+  checknworkers = 1;
+  if (prefs.check_compress != CHECKCOMPRESS_NONE)
+    {
+    if ((checknworkers = linalg_getnthreads()/2) < 1)
+      checknworkers = 1;
+    set_tilenthreads(checknworkers);
+    }
+  linalg_share(checknworkers);
+#endif
+
+  return;
+  }
+
+
+/****** check_end **********************************************************
+PROTO	void	check_end(void)
+PURPOSE	Flush pending check-image HDUs and stop the writer thread.
+INPUT	-.
+OUTPUT  -.
+NOTES   -.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+ ***/
+void	check_end(void)
+  {
+#ifdef USE_THREADS
+  if (!checkthreadflag)
+    return;
+  QPTHREAD_MUTEX_LOCK(&checkmutex);
+  checkendflag = 1;
+  QPTHREAD_COND_SIGNAL(&checkcond_in);
+  QPTHREAD_MUTEX_UNLOCK(&checkmutex);
+  QPTHREAD_JOIN(checkthread, NULL);
+  QPTHREAD_MUTEX_DESTROY(&checkmutex);
+  QPTHREAD_COND_DESTROY(&checkcond_in);
+  QPTHREAD_COND_DESTROY(&checkcond_out);
+  checkthreadflag = 0;
+  linalg_share(-checknworkers);
+#endif
+
+  return;
+  }
+
+
+/****** check_flush ********************************************************
+PROTO	void	check_flush(void)
+PURPOSE	Wait until all the check-image HDUs submitted so far are written.
+INPUT	-.
+OUTPUT  -.
+NOTES   The writer thread keeps running.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+ ***/
+void	check_flush(void)
+  {
+#ifdef USE_THREADS
+  if (!checkthreadflag)
+    return;
+  QPTHREAD_MUTEX_LOCK(&checkmutex);
+  while (checkqueue_n || checkbusyflag)
+    QPTHREAD_COND_WAIT(&checkcond_out, &checkmutex);
+  QPTHREAD_MUTEX_UNLOCK(&checkmutex);
+#endif
+
+  return;
+  }
+
+
+/****** check_save *********************************************************
+PROTO	void	check_save(catstruct *cat, tabstruct *tab, int flags)
+PURPOSE	Submit a check-image HDU for writing.
+INPUT	Pointer to the (opened) check-image catalog,
+	Pointer to the HDU,
+	Flags (CHECK_FREETAB and/or CHECK_CLOSECAT).
+OUTPUT  -.
+NOTES   Blocks if CHECK_MAXQUEUE HDUs are already waiting to be written.
+	With CHECK_FREETAB the HDU is owned by the writer after the call,
+	with CHECK_CLOSECAT the catalog as well.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+ ***/
+static void	check_save(catstruct *cat, tabstruct *tab, int flags)
+  {
+   checkqueuestruct	item;
+
+  item.cat = cat;
+  item.tab = tab;
+  item.flags = flags;
+  item.strip = NULL;
+  item.npix = 0;
+  check_submit(&item);
+
+  return;
+  }
+
+
+/****** check_savemosaic ***************************************************
+PROTO	void	check_savemosaic(catstruct *cat, tabstruct *tab,
+			setstruct *set, checkenum checktype, int flags)
+PURPOSE	Compose and submit a mosaic of sample vignets band by band.
+INPUT	Pointer to the (opened) check-image catalog,
+	Pointer to the HDU (header only, naxisn[] set),
+	Pointer to the set of samples,
+	Check-image type (PSF_CHI, PSF_RESIDUALS, PSF_SAMPLES or PSF_WEIGHTS),
+	Flags (CHECK_FREETAB and/or CHECK_CLOSECAT).
+OUTPUT  -.
+NOTES   Each band is one row of vignets; it is handed over to the writer
+	as soon as it is composed. At most CHECK_MAXSTRIP bands are queued
+	or being written at a time, which bounds memory use independently
+	of the number of samples.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+ ***/
+static void	check_savemosaic(catstruct *cat, tabstruct *tab, setstruct *set,
+			checkenum checktype, int flags)
+  {
+   checkqueuestruct	item;
+   samplestruct		*sample;
+   float		*pix, *fpix;
+   int			j,n,x,y, w,h, nw,nh, step;
+
+  w = set->vigsize[0];
+  h = set->vigdim>1? set->vigsize[1] : 1;
+  nw = tab->naxisn[0]/w;
+  nh = tab->naxisn[1]/h;
+  step = (nw-1)*w;
+  item.cat = cat;
+  item.tab = tab;
+  item.flags = CHECK_HEADONLY;
+  item.strip = NULL;
+  item.npix = 0;
+  check_submit(&item);
+  n = 0;
+  sample = set->sample;
+  for (j=0; j<nh; j++)
+    {
+    item.flags = CHECK_STRIP;
+    item.npix = (size_t)nw*w*h;
+    QCALLOC(item.strip, float, item.npix);
+    for (; n<set->nsample && n/nw==j; n++, sample++)
+      {
+      pix = item.strip + (n%nw)*w;
+      switch(checktype)
+        {
+        case PSF_CHI:
+          fpix = sample->vigchi;
+          break;
+        case PSF_RESIDUALS:
+          fpix = sample->vigresi;
+          break;
+        case PSF_WEIGHTS:
+          fpix = sample->vigweight;
+          break;
+        default:
+          fpix = sample->vig;
+          break;
+        }
+      for (y=h; y--; pix += step)
+        for (x=w; x--;)
+          *(pix++) = *(fpix++);
+      }
+    check_submit(&item);
+    }
+  item.flags = CHECK_PAD | flags;
+  item.strip = NULL;
+  item.npix = 0;
+  check_submit(&item);
+
+  return;
+  }
+
+
+/****** check_submit *******************************************************
+PROTO	void	check_submit(checkqueuestruct *item)
+PURPOSE	Queue a write request for the check-image writer.
+INPUT	Pointer to the queue item (copied).
+OUTPUT  -.
+NOTES   Blocks if CHECK_MAXQUEUE requests are already waiting, or if
+	CHECK_MAXSTRIP mosaic bands are in flight and item is a band.
+	Requests are processed immediately if the writer is not running.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+ ***/
+static void	check_submit(checkqueuestruct *item)
+  {
+#ifdef USE_THREADS
+  if (checkthreadflag)
+    {
+    QPTHREAD_MUTEX_LOCK(&checkmutex);
+    while (checkqueue_n >= CHECK_MAXQUEUE
+	|| ((item->flags & CHECK_STRIP) && checkqueue_nstrip>=CHECK_MAXSTRIP))
+      QPTHREAD_COND_WAIT(&checkcond_out, &checkmutex);
+    checkqueue[(checkqueue_first+checkqueue_n++)%CHECK_MAXQUEUE] = *item;
+    if ((item->flags & CHECK_STRIP))
+      checkqueue_nstrip++;
+    QPTHREAD_COND_SIGNAL(&checkcond_in);
+    QPTHREAD_MUTEX_UNLOCK(&checkmutex);
+    return;
+    }
+#endif
+  check_savetab(item);
+
+  return;
+  }
+
+
+/****** check_savetab ******************************************************
+PROTO	void	check_savetab(checkqueuestruct *item)
+PURPOSE	Write a check-image HDU (or part of it) and free what needs to be
+	freed.
+INPUT	Pointer to the queue item.
+OUTPUT  -.
+NOTES   -.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+ ***/
+static void	check_savetab(checkqueuestruct *item)
+  {
+   catstruct	*cat;
+
+  cat = item->cat;
+  if ((item->flags & CHECK_HEADONLY))
+    save_head(cat, item->tab);
+  else if ((item->flags & CHECK_STRIP))
+    {
+    if (bswapflag)
+      swapbytes(item->strip, sizeof(float), (int)item->npix);
+    QFWRITE(item->strip, item->npix*sizeof(float), cat->file, cat->filename);
+    free(item->strip);
+    }
+  else if ((item->flags & CHECK_PAD))
+    pad_tab(cat, item->tab->tabsize);
+  else
+    save_tab(cat, item->tab);
+  if ((item->flags & CHECK_FREETAB))
+    free_tab(item->tab);
+  if ((item->flags & CHECK_CLOSECAT))
+    free_cat(&cat, 1);
+
+  return;
+  }
+
+
+#ifdef USE_THREADS
+/****** pthread_check_writer ***********************************************
+PROTO	void	*pthread_check_writer(void *arg)
+PURPOSE	Writer thread: write queued check-image HDUs in order.
+INPUT	Pointer to the thread number (unused).
+OUTPUT  NULL void pointer.
+NOTES   Exits once the queue is empty and check_end() has been called.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+ ***/
+static void	*pthread_check_writer(void *arg)
+  {
+   checkqueuestruct	item;
+
+  QPTHREAD_MUTEX_LOCK(&checkmutex);
+  for (;;)
+    {
+    while (!checkqueue_n && !checkendflag)
+      QPTHREAD_COND_WAIT(&checkcond_in, &checkmutex);
+    if (!checkqueue_n)
+      break;
+    item = checkqueue[checkqueue_first];
+    checkqueue_first = (checkqueue_first+1)%CHECK_MAXQUEUE;
+    checkqueue_n--;
+    checkbusyflag = 1;
+    QPTHREAD_COND_BROADCAST(&checkcond_out);
+    QPTHREAD_MUTEX_UNLOCK(&checkmutex);
+    check_savetab(&item);
+    QPTHREAD_MUTEX_LOCK(&checkmutex);
+    checkbusyflag = 0;
+    if ((item.flags & CHECK_STRIP))
+      checkqueue_nstrip--;
+/*-- Wake up both submitters and check_flush() */
+    QPTHREAD_COND_BROADCAST(&checkcond_out);
+    }
+  QPTHREAD_MUTEX_UNLOCK(&checkmutex);
+
+  pthread_exit(NULL);
+
+  return (void *)NULL;
+  }
+#endif
 
 
 /****** check_write ********************************************************
@@ -61,9 +395,12 @@ INPUT	Pointer to the field,
 	Number of extensions,
 	Datacube flag.
 OUTPUT  -.
-NOTES   Check-image is written as a datacube if cubeflag!=0.
+NOTES   Check-image is written as a datacube if cubeflag!=0. The HDU is
+	handed over to the check-image writer (see check_init()). Images are
+	tile-compressed according to CHECKIMAGE_COMPRESS. Uncompressed sample
+	mosaics are never held in memory as a whole (see check_savemosaic()).
 AUTHOR  E. Bertin (IAP)
-VERSION 24/04/2010
+VERSION 19/10/2026
  ***/
 void	check_write(fieldstruct *field, setstruct *set, char *checkname,
 		checkenum checktype, int ext, int next, int cubeflag)
@@ -79,7 +416,7 @@ void	check_write(fieldstruct *field, setstruct *set, char *checkname,
    float		*pix,*pix0, *vig,*vig0, *fpix,*fpixsym,
 			val;
    int			i,j,l,x,y, w,h,n, npc,nt, nw,nh,np,
-			step, ival1,ival2, npix;
+			step, ival1,ival2, npix, mosaicflag;
 
 /* Create the new cat (well it is not a "cat", but simply a FITS table */
   if (!ext)
@@ -96,11 +433,12 @@ void	check_write(fieldstruct *field, setstruct *set, char *checkname,
     sprintf(pstr, "_%s.fits", filename);
     if (open_cat(cat, WRITE_ONLY) != RETURN_OK)
       error(EXIT_FAILURE, "*Error*: cannot open for writing ", cat->filename);
-    if (next>1)
+/*-- Tile-compressed images cannot be stored in the primary HDU */
+    if (next>1 || prefs.check_compress != CHECKCOMPRESS_NONE)
       {
       addkeywordto_head(cat->tab, "NEXTEND ", "Number of extensions");
       fitswrite(cat->tab->headbuf, "NEXTEND", &next, H_INT, T_LONG);
-      save_tab(cat, cat->tab);
+      check_save(cat, cat->tab, 0);
       }
     field->ccat[checktype] = cat;
     }
@@ -114,6 +452,21 @@ void	check_write(fieldstruct *field, setstruct *set, char *checkname,
   head = tab->headbuf;
   tab->bitpix =  BP_FLOAT;
   tab->bytepix = t_size[T_FLOAT];
+  switch(prefs.check_compress)
+    {
+    case CHECKCOMPRESS_RICE:
+      tab->compress_type = COMPRESS_RICE;
+      break;
+    case CHECKCOMPRESS_GZIP:
+      tab->compress_type = COMPRESS_GZIP;
+      break;
+    default:
+      tab->compress_type = COMPRESS_NONE;
+      break;
+    }
+  tab->compress_qlevel = prefs.check_qlevel;
+  tab->compress_tilenrow = prefs.check_tilenrow;
+  mosaicflag = 0;
 
   switch(checktype)
     {
@@ -206,6 +559,12 @@ void	check_write(fieldstruct *field, setstruct *set, char *checkname,
         tab->naxisn[1] = nh*h;
         step = (nw-1)*w;
         tab->tabsize = tab->bytepix*tab->naxisn[0]*tab->naxisn[1];
+        if (tab->compress_type == COMPRESS_NONE)
+          {
+/*-------- Composed and written by bands of vignets (see check_savemosaic())*/
+          mosaicflag = 1;
+          break;
+          }
         QCALLOC(pix0, float, tab->tabsize);
         tab->bodybuf = (char *)pix0; 
         sample = set->sample;
@@ -301,6 +660,12 @@ void	check_write(fieldstruct *field, setstruct *set, char *checkname,
         tab->naxisn[1] = nh*h;
         step = (nw-1)*w;
         tab->tabsize = tab->bytepix*tab->naxisn[0]*tab->naxisn[1];
+        if (tab->compress_type == COMPRESS_NONE)
+          {
+/*-------- Composed and written by bands of vignets (see check_savemosaic())*/
+          mosaicflag = 1;
+          break;
+          }
         QCALLOC(pix0, float, tab->tabsize);
         tab->bodybuf = (char *)pix0; 
         sample = set->sample;
@@ -348,6 +713,12 @@ void	check_write(fieldstruct *field, setstruct *set, char *checkname,
         tab->naxisn[1] = nh*h;
         step = (nw-1)*w;
         tab->tabsize = tab->bytepix*tab->naxisn[0]*tab->naxisn[1];
+        if (tab->compress_type == COMPRESS_NONE)
+          {
+/*-------- Composed and written by bands of vignets (see check_savemosaic())*/
+          mosaicflag = 1;
+          break;
+          }
         QCALLOC(pix0, float, tab->tabsize);
         tab->bodybuf = (char *)pix0; 
         sample = set->sample;
@@ -395,6 +766,12 @@ void	check_write(fieldstruct *field, setstruct *set, char *checkname,
         tab->naxisn[1] = nh*h;
         step = (nw-1)*w;
         tab->tabsize = tab->bytepix*tab->naxisn[0]*tab->naxisn[1];
+        if (tab->compress_type == COMPRESS_NONE)
+          {
+/*-------- Composed and written by bands of vignets (see check_savemosaic())*/
+          mosaicflag = 1;
+          break;
+          }
         QCALLOC(pix0, float, tab->tabsize);
         tab->bodybuf = (char *)pix0; 
         sample = set->sample;
@@ -903,14 +1280,15 @@ void	check_write(fieldstruct *field, setstruct *set, char *checkname,
         }
     }
 
-  if (next == 1)
+  if (next == 1 && prefs.check_compress == CHECKCOMPRESS_NONE)
     prim_head(tab);
   fitswrite(head, "XTENSION", "IMAGE   ", H_STRING, T_STRING);
 /* save table */
-  save_tab(cat, tab);
-  free_tab(tab);
-  if (ext==next-1)
-    free_cat(&cat, 1);
+  if (mosaicflag)
+    check_savemosaic(cat, tab, set, checktype,
+	CHECK_FREETAB | (ext==next-1? CHECK_CLOSECAT : 0));
+  else
+    check_save(cat, tab, CHECK_FREETAB | (ext==next-1? CHECK_CLOSECAT : 0));
 
   return;
   }
@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		10/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -36,6 +36,13 @@
 /*----------------------------- Internal constants --------------------------*/
 
 #define		MAXCHECK	16		/* max. # of CHECKimages */
+#define		CHECK_MAXQUEUE	32	/* max. # of HDUs waiting for writing */
+#define		CHECK_FREETAB	0x01	/* Free HDU once written */
+#define		CHECK_CLOSECAT	0x02	/* Close check-image once HDU written */
+#define		CHECK_HEADONLY	0x04	/* Write only the HDU header */
+#define		CHECK_STRIP	0x08	/* Write a band of pixels of the HDU */
+#define		CHECK_PAD	0x10	/* Pad the HDU data area to FBSIZE */
+#define		CHECK_MAXSTRIP	2	/* max. # of mosaic bands in flight */
 
 /*----------------------------- Type definitions --------------------------*/
 typedef enum {PSF_NONE, PSF_BASIS, PSF_CHI, PSF_PROTO, PSF_RESIDUALS,
@@ -43,8 +50,20 @@ typedef enum {PSF_NONE, PSF_BASIS, PSF_CHI, PSF_PROTO, PSF_RESIDUALS,
 		PSF_WEIGHTS, PSF_MOFFAT,PSF_SUBMOFFAT,PSF_SUBSYM}
 	checkenum;
 
+typedef struct checkqueue
+  {
+  catstruct	*cat;			/* Check-image catalog */
+  tabstruct	*tab;			/* HDU to be written */
+  int		flags;			/* CHECK_FREETAB, CHECK_CLOSECAT... */
+  float		*strip;			/* Band of pixels (CHECK_STRIP) */
+  size_t	npix;			/* Number of pixels in band */
+  }	checkqueuestruct;
+
 /*---------------------------------- protos --------------------------------*/
-extern void		check_write(fieldstruct *field,	setstruct *set,
+extern void		check_end(void),
+			check_flush(void),
+			check_init(void),
+			check_write(fieldstruct *field,	setstruct *set,
 				char *checkname, checkenum checktype,
 				int ext, int next, int cubeflag);
 
@@ -0,0 +1,736 @@
+/*
+*				checkpoint.c
+*
+* Save and resume the intermediate results of long multi-catalogue runs.
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*
+*	This file part of:	PSFEx
+*
+*	Copyright:		(C) 2026 Emmanuel Bertin -- IAP/CNRS/UPMC
+*
+*	License:		GNU General Public License
+*
+*	PSFEx is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+* 	(at your option) any later version.
+*	PSFEx is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*	You should have received a copy of the GNU General Public License
+*	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
+*
+*	Last modified:		19/10/2026
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+#ifdef HAVE_CONFIG_H
+#include	"config.h"
+#endif
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<sys/types.h>
+#include	<unistd.h>
+
+
+#include	"define.h"
+#include	"types.h"
+#include	"globals.h"
+#include	"fits/fitscat.h"
+#include	"checkpoint.h"
+#include	"context.h"
+#include	"field.h"
+#include	"misc.h"
+#include	"prefs.h"
+#include	"psf.h"
+
+static char	*checkpoint_diagio(psfstruct *psf, char *buf, int putflag);
+
+static int	checkpoint_read(checkpointstruct *ckpt),
+		checkpoint_fread(void *ptr, size_t size, FILE *file);
+
+static void	checkpoint_append(checkpointstruct *ckpt, checkrecenum type,
+			int index, void *ptr, int nval),
+		checkpoint_create(checkpointstruct *ckpt);
+
+/****** checkpoint_init *******************************************************
+PROTO	checkpointstruct *checkpoint_init(char *filename, char **catnames,
+				int ncat, int next)
+PURPOSE	Create a checkpoint state and resume from an existing state file if
+	it matches the current configuration and input catalogues.
+INPUT	State file name,
+	array of input catalogue file names,
+	number of input catalogues,
+	number of extensions per catalogue.
+OUTPUT	Pointer to the new checkpoint structure.
+NOTES	A state file left by a different configuration, or by a run on
+	input catalogues whose content has changed since, is overwritten.
+	The state file is kept open for appending until checkpoint_end().
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+checkpointstruct	*checkpoint_init(char *filename, char **catnames,
+				int ncat, int next)
+  {
+   checkpointstruct	*ckpt;
+   int			c, ndone;
+
+  QCALLOC(ckpt, checkpointstruct, 1);
+  strcpy(ckpt->filename, filename);
+  ckpt->ncat = ncat;
+  ckpt->next = next;
+  ckpt->prefshash = prefs_hash(0);
+  QMALLOC(ckpt->cathash, unsigned long long, ncat);
+  NFPRINTF(OUTPUT, "Computing input catalogue checksums...");
+  for (c=0; c<ncat; c++)
+    ckpt->cathash[c] = hash_file(catnames[c]);
+  QCALLOC(ckpt->basis, float *, next);
+  QCALLOC(ckpt->nbasisval, int, next);
+  QCALLOC(ckpt->pc, double *, next);
+  QCALLOC(ckpt->npcval, int, next);
+  QCALLOC(ckpt->catdiag, char *, ncat);
+
+  if (access(filename, F_OK))
+    {
+    checkpoint_create(ckpt);
+    return ckpt;
+    }
+
+  if (checkpoint_read(ckpt) != RETURN_OK)
+    {
+    warning(filename, " does not match the current run: starting afresh");
+    checkpoint_create(ckpt);
+    return ckpt;
+    }
+
+  if (!(ckpt->file = fopen(filename, "ab")))
+    error(EXIT_FAILURE, "*Error*: cannot open for writing ", filename);
+  ndone = 0;
+  for (c=0; c<ncat; c++)
+    ndone += ckpt->catdiag[c]? 1 : 0;
+  QPRINTF(OUTPUT, "----- Resuming from %s: %d/%d catalogue%s done\n\n",
+	filename, ndone, ncat, ncat>1? "s":"");
+
+  return ckpt;
+  }
+
+
+/****** checkpoint_end ********************************************************
+PROTO	void checkpoint_end(checkpointstruct *ckpt, int removeflag)
+PURPOSE	Free a checkpoint structure and optionally remove the state file.
+INPUT	Pointer to the checkpoint structure (may be NULL),
+	flag set to remove the state file (the run has completed).
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+void	checkpoint_end(checkpointstruct *ckpt, int removeflag)
+  {
+   int	c,e;
+
+  if (!ckpt)
+    return;
+
+  if (ckpt->file)
+    fclose(ckpt->file);
+  if (removeflag)
+    remove(ckpt->filename);
+
+  for (e=0; e<ckpt->next; e++)
+    {
+    free(ckpt->basis[e]);
+    free(ckpt->pc[e]);
+    }
+  for (c=0; c<ckpt->ncat; c++)
+    free(ckpt->catdiag[c]);
+  free(ckpt->basis);
+  free(ckpt->nbasisval);
+  free(ckpt->pc);
+  free(ckpt->npcval);
+  free(ckpt->psfsteps);
+  free(ckpt->cathash);
+  free(ckpt->catdiag);
+  free(ckpt);
+
+  return;
+  }
+
+
+/****** checkpoint_getsteps ***************************************************
+PROTO	int checkpoint_getsteps(checkpointstruct *ckpt, float *psfstep,
+				float **psfsteps)
+PURPOSE	Retrieve the PSF sampling steps from a checkpoint.
+INPUT	Pointer to the checkpoint structure (may be NULL),
+	pointer to the common PSF step,
+	pointer to the array of per-extension steps (reallocated if needed).
+OUTPUT	1 if the steps were restored, 0 otherwise.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+int	checkpoint_getsteps(checkpointstruct *ckpt, float *psfstep,
+			float **psfsteps)
+  {
+  if (!ckpt || !ckpt->stepflag)
+    return 0;
+
+  *psfstep = ckpt->psfstep;
+  if (ckpt->npsfsteps)
+    {
+    free(*psfsteps);
+    QMEMCPY(ckpt->psfsteps, *psfsteps, float, ckpt->npsfsteps);
+    }
+
+  return 1;
+  }
+
+
+/****** checkpoint_putsteps ***************************************************
+PROTO	void checkpoint_putsteps(checkpointstruct *ckpt, float psfstep,
+				float *psfsteps, int nsteps)
+PURPOSE	Save the PSF sampling steps to a checkpoint.
+INPUT	Pointer to the checkpoint structure (may be NULL),
+	common PSF step,
+	array of per-extension steps (or NULL),
+	number of per-extension steps.
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+void	checkpoint_putsteps(checkpointstruct *ckpt, float psfstep,
+			float *psfsteps, int nsteps)
+  {
+   float	*steps;
+
+  if (!ckpt)
+    return;
+
+  ckpt->stepflag = 1;
+  ckpt->psfstep = psfstep;
+  free(ckpt->psfsteps);
+  ckpt->psfsteps = NULL;
+  ckpt->npsfsteps = psfsteps? nsteps : 0;
+/* The common step comes first in the record */
+  QMALLOC(steps, float, ckpt->npsfsteps+1);
+  steps[0] = psfstep;
+  if (ckpt->npsfsteps)
+    {
+    QMEMCPY(psfsteps, ckpt->psfsteps, float, nsteps);
+    memcpy(steps+1, psfsteps, nsteps*sizeof(float));
+    }
+  checkpoint_append(ckpt, CHECKPOINT_STEPS, 0, steps, ckpt->npsfsteps+1);
+  free(steps);
+
+  return;
+  }
+
+
+/****** checkpoint_getbasis ***************************************************
+PROTO	float *checkpoint_getbasis(checkpointstruct *ckpt, int index)
+PURPOSE	Retrieve a copy of a PCA image basis from a checkpoint.
+INPUT	Pointer to the checkpoint structure (may be NULL),
+	extension index (0 for a basis common to all extensions).
+OUTPUT	Pointer to a new copy of the basis, or NULL if not available.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+float	*checkpoint_getbasis(checkpointstruct *ckpt, int index)
+  {
+   float	*basis;
+
+  basis = NULL;
+  if (!ckpt || !ckpt->nbasisval[index])
+    return NULL;
+
+  QMEMCPY(ckpt->basis[index], basis, float, ckpt->nbasisval[index]);
+
+  return basis;
+  }
+
+
+/****** checkpoint_putbasis ***************************************************
+PROTO	void checkpoint_putbasis(checkpointstruct *ckpt, int index,
+				float *basis, int nval)
+PURPOSE	Save a PCA image basis to a checkpoint.
+INPUT	Pointer to the checkpoint structure (may be NULL),
+	extension index (0 for a basis common to all extensions),
+	pointer to the basis,
+	number of basis elements.
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+void	checkpoint_putbasis(checkpointstruct *ckpt, int index,
+			float *basis, int nval)
+  {
+  if (!ckpt)
+    return;
+
+  free(ckpt->basis[index]);
+  QMEMCPY(basis, ckpt->basis[index], float, nval);
+  ckpt->nbasisval[index] = nval;
+  checkpoint_append(ckpt, CHECKPOINT_BASIS, index, basis, nval);
+
+  return;
+  }
+
+
+/****** checkpoint_getpc ******************************************************
+PROTO	double *checkpoint_getpc(checkpointstruct *ckpt, int index)
+PURPOSE	Retrieve a copy of the hidden-dependency principal components from a
+	checkpoint.
+INPUT	Pointer to the checkpoint structure (may be NULL),
+	extension index (0 for PCs common to all extensions).
+OUTPUT	Pointer to a new copy of the PCs, or NULL if not available.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+double	*checkpoint_getpc(checkpointstruct *ckpt, int index)
+  {
+   double	*pc;
+
+  pc = NULL;
+  if (!ckpt || !ckpt->npcval[index])
+    return NULL;
+
+  QMEMCPY(ckpt->pc[index], pc, double, ckpt->npcval[index]);
+
+  return pc;
+  }
+
+
+/****** checkpoint_putpc ******************************************************
+PROTO	void checkpoint_putpc(checkpointstruct *ckpt, int index,
+				double *pc, int nval)
+PURPOSE	Save the hidden-dependency principal components to a checkpoint.
+INPUT	Pointer to the checkpoint structure (may be NULL),
+	extension index (0 for PCs common to all extensions),
+	pointer to the PCs,
+	number of elements.
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+void	checkpoint_putpc(checkpointstruct *ckpt, int index,
+			double *pc, int nval)
+  {
+  if (!ckpt)
+    return;
+
+  free(ckpt->pc[index]);
+  QMEMCPY(pc, ckpt->pc[index], double, nval);
+  ckpt->npcval[index] = nval;
+  checkpoint_append(ckpt, CHECKPOINT_PC, index, pc, nval);
+
+  return;
+  }
+
+
+/****** checkpoint_catdone ****************************************************
+PROTO	int checkpoint_catdone(checkpointstruct *ckpt, int c)
+PURPOSE	Tell whether a catalogue was fully processed in a previous run.
+INPUT	Pointer to the checkpoint structure (may be NULL),
+	catalogue index.
+OUTPUT	1 if the catalogue has been processed and its PSF saved, 0 otherwise.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+int	checkpoint_catdone(checkpointstruct *ckpt, int c)
+  {
+  return (ckpt && ckpt->catdiag[c])? 1 : 0;
+  }
+
+
+/****** checkpoint_getcat *****************************************************
+PROTO	void checkpoint_getcat(checkpointstruct *ckpt, int c,
+			fieldstruct *field, contextstruct *context)
+PURPOSE	Restore the PSF diagnostics of a catalogue processed in a previous
+	run.
+INPUT	Pointer to the checkpoint structure,
+	catalogue index,
+	pointer to the field structure,
+	pointer to the context structure.
+OUTPUT	-.
+NOTES	The PSF models of the catalogue are already on disk: if they have not
+	been recomputed, empty ones are created to carry the diagnostics.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+void	checkpoint_getcat(checkpointstruct *ckpt, int c, fieldstruct *field,
+			contextstruct *context)
+  {
+   psfstruct		*psf;
+   char			*buf;
+   float		pixsize[2];
+   int			e;
+
+  pixsize[0] = (float)prefs.psf_pixsize[0];
+  pixsize[1] = (float)prefs.psf_pixsize[1];
+  buf = ckpt->catdiag[c];
+  for (e=0; e<field->next && e<ckpt->next; e++)
+    {
+    if (!(psf=field->psf[e]))
+      {
+/*---- The PSF step comes from the packed diagnostics */
+      psf = field->psf[e] = psf_init(context, prefs.psf_size,
+		*(float *)(buf + 3*sizeof(int) + sizeof(double)), pixsize,
+		10000);
+      }
+    buf = checkpoint_diagio(psf, buf, 0);
+    }
+
+  return;
+  }
+
+
+/****** checkpoint_putcat *****************************************************
+PROTO	void checkpoint_putcat(checkpointstruct *ckpt, int c,
+			fieldstruct *field)
+PURPOSE	Record a catalogue as fully processed, with its PSF diagnostics.
+INPUT	Pointer to the checkpoint structure (may be NULL),
+	catalogue index,
+	pointer to the field structure.
+OUTPUT	-.
+NOTES	Must be called only once the PSF files and check-images of the
+	catalogue are written.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+void	checkpoint_putcat(checkpointstruct *ckpt, int c, fieldstruct *field)
+  {
+   char			*buf;
+   int			e;
+
+  if (!ckpt)
+    return;
+
+  free(ckpt->catdiag[c]);
+  QCALLOC(ckpt->catdiag[c], char, ckpt->next*CHECKPOINT_DIAGSIZE);
+  buf = ckpt->catdiag[c];
+  for (e=0; e<field->next && e<ckpt->next; e++)
+    buf = checkpoint_diagio(field->psf[e], buf, 1);
+  checkpoint_append(ckpt, CHECKPOINT_CAT, c, ckpt->catdiag[c], ckpt->next);
+
+  return;
+  }
+
+
+/*i**** checkpoint_diagio *****************************************************
+PROTO	char *checkpoint_diagio(psfstruct *psf, char *buf, int putflag)
+PURPOSE	Pack the diagnostics of a PSF to a buffer, or unpack them.
+INPUT	Pointer to the PSF structure,
+	pointer to the buffer,
+	1 to pack (PSF to buffer), 0 to unpack (buffer to PSF).
+OUTPUT	Pointer to the buffer, past the CHECKPOINT_DIAGSIZE bytes processed.
+NOTES	Fields are copied one by one, so the state file does not depend on
+	the layout of the PSF structure. The PSF step must remain the first
+	float (see checkpoint_getcat()).
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static char	*checkpoint_diagio(psfstruct *psf, char *buf, int putflag)
+  {
+   void		*field[7+CHECKPOINT_NMOFFAT];
+   size_t	size;
+   int		i;
+
+  field[0] = &psf->samples_loaded;
+  field[1] = &psf->samples_accepted;
+  field[2] = &psf->npass;
+  field[3] = &psf->chi2;
+  field[4] = &psf->pixstep;
+  field[5] = &psf->fwhm;
+  field[6] = &psf->fit_timesaved;
+  field[7] = &psf->moffat_fwhm_min;
+  field[8] = &psf->moffat_fwhm;
+  field[9] = &psf->moffat_fwhm_max;
+  field[10] = &psf->moffat_ellipticity_min;
+  field[11] = &psf->moffat_ellipticity;
+  field[12] = &psf->moffat_ellipticity_max;
+  field[13] = &psf->moffat_beta_min;
+  field[14] = &psf->moffat_beta;
+  field[15] = &psf->moffat_beta_max;
+  field[16] = &psf->moffat_residuals_min;
+  field[17] = &psf->moffat_residuals;
+  field[18] = &psf->moffat_residuals_max;
+  field[19] = &psf->moffat_score_min;
+  field[20] = &psf->moffat_score;
+  field[21] = &psf->moffat_score_max;
+  field[22] = &psf->pfmoffat_fwhm_min;
+  field[23] = &psf->pfmoffat_fwhm;
+  field[24] = &psf->pfmoffat_fwhm_max;
+  field[25] = &psf->pfmoffat_ellipticity_min;
+  field[26] = &psf->pfmoffat_ellipticity;
+  field[27] = &psf->pfmoffat_ellipticity_max;
+  field[28] = &psf->pfmoffat_beta_min;
+  field[29] = &psf->pfmoffat_beta;
+  field[30] = &psf->pfmoffat_beta_max;
+  field[31] = &psf->pfmoffat_residuals_min;
+  field[32] = &psf->pfmoffat_residuals;
+  field[33] = &psf->pfmoffat_residuals_max;
+  field[34] = &psf->sym_residuals_min;
+  field[35] = &psf->sym_residuals;
+  field[36] = &psf->sym_residuals_max;
+
+/* 3 ints, 1 double, then floats */
+  for (i=0; i<7+CHECKPOINT_NMOFFAT; i++)
+    {
+    size = i<3? sizeof(int) : (i==3? sizeof(double) : sizeof(float));
+    if (putflag)
+      memcpy(buf, field[i], size);
+    else
+      memcpy(field[i], buf, size);
+    buf += size;
+    }
+
+  return buf;
+  }
+
+
+/*i**** checkpoint_fread ******************************************************
+PROTO	int checkpoint_fread(void *ptr, size_t size, FILE *file)
+PURPOSE	Read a block of data from a state file without exiting on failure.
+INPUT	Pointer to the destination,
+	size of the block in bytes,
+	file pointer.
+OUTPUT	RETURN_OK if the block could be read, RETURN_ERROR otherwise.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static int	checkpoint_fread(void *ptr, size_t size, FILE *file)
+  {
+  if (!size)
+    return RETURN_OK;
+
+  return fread(ptr, size, 1, file)==1? RETURN_OK : RETURN_ERROR;
+  }
+
+
+/*i**** checkpoint_read *******************************************************
+PROTO	int checkpoint_read(checkpointstruct *ckpt)
+PURPOSE	Load the content of a state file into a checkpoint structure.
+INPUT	Pointer to the checkpoint structure.
+OUTPUT	RETURN_OK if the state file could be read and matches the current
+	configuration and input catalogues, RETURN_ERROR otherwise.
+NOTES	Records are replayed in order. A truncated or damaged trailing
+	record (interrupted write) is dropped from the file so that new
+	records can be appended after the last valid one.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static int	checkpoint_read(checkpointstruct *ckpt)
+  {
+   FILE			*file;
+   unsigned long long	hash;
+   char			magic[8],
+			*buf;
+   size_t		size;
+   long			pos;
+   int			rec[3],
+			c, val;
+
+  if (!(file = fopen(ckpt->filename, "rb")))
+    return RETURN_ERROR;
+
+/* Header: the checkpoint must come from the same configuration and */
+/* input data */
+  if (checkpoint_fread(magic, 8, file) != RETURN_OK
+	|| strncmp(magic, CHECKPOINT_MAGIC, 8)
+	|| checkpoint_fread(&val, sizeof(int), file) != RETURN_OK
+	|| val != CHECKPOINT_VERSION
+	|| checkpoint_fread(&hash, sizeof(hash), file) != RETURN_OK
+	|| hash != ckpt->prefshash
+	|| checkpoint_fread(&val, sizeof(int), file) != RETURN_OK
+	|| val != ckpt->ncat
+	|| checkpoint_fread(&val, sizeof(int), file) != RETURN_OK
+	|| val != ckpt->next)
+    {
+    fclose(file);
+    return RETURN_ERROR;
+    }
+  for (c=0; c<ckpt->ncat; c++)
+    if (checkpoint_fread(&hash, sizeof(hash), file) != RETURN_OK
+	|| hash != ckpt->cathash[c])
+      {
+      fclose(file);
+      return RETURN_ERROR;
+      }
+
+/* Records: type, index, number of elements, data and signature */
+  for (;;)
+    {
+    pos = ftell(file);
+    if (checkpoint_fread(rec, 3*sizeof(int), file) != RETURN_OK
+	|| rec[2]<0)
+      break;
+    switch(rec[0])
+      {
+      case CHECKPOINT_STEPS:
+        size = sizeof(float);
+        val = (rec[1]==0 && rec[2]>0 && rec[2]<=ckpt->next+1);
+        break;
+      case CHECKPOINT_BASIS:
+        size = sizeof(float);
+        val = (rec[1]>=0 && rec[1]<ckpt->next);
+        break;
+      case CHECKPOINT_PC:
+        size = sizeof(double);
+        val = (rec[1]>=0 && rec[1]<ckpt->next);
+        break;
+      case CHECKPOINT_CAT:
+        size = CHECKPOINT_DIAGSIZE;
+        val = (rec[1]>=0 && rec[1]<ckpt->ncat && rec[2]==ckpt->next);
+        break;
+      default:
+        val = 0;
+        break;
+      }
+    if (!val)
+      break;
+    QMALLOC(buf, char, rec[2]*size+1);
+    if (checkpoint_fread(buf, rec[2]*size, file) != RETURN_OK
+	|| checkpoint_fread(magic, 8, file) != RETURN_OK
+	|| strncmp(magic, CHECKPOINT_MAGIC, 8))
+      {
+      free(buf);
+      break;
+      }
+    switch(rec[0])
+      {
+      case CHECKPOINT_STEPS:
+        ckpt->stepflag = 1;
+        ckpt->psfstep = *(float *)buf;
+        free(ckpt->psfsteps);
+        ckpt->psfsteps = NULL;
+        if ((ckpt->npsfsteps = rec[2]-1))
+          QMEMCPY((float *)buf+1, ckpt->psfsteps, float, ckpt->npsfsteps);
+        free(buf);
+        break;
+      case CHECKPOINT_BASIS:
+        free(ckpt->basis[rec[1]]);
+        ckpt->basis[rec[1]] = (float *)buf;
+        ckpt->nbasisval[rec[1]] = rec[2];
+        break;
+      case CHECKPOINT_PC:
+        free(ckpt->pc[rec[1]]);
+        ckpt->pc[rec[1]] = (double *)buf;
+        ckpt->npcval[rec[1]] = rec[2];
+        break;
+      case CHECKPOINT_CAT:
+        free(ckpt->catdiag[rec[1]]);
+        ckpt->catdiag[rec[1]] = buf;
+        break;
+      }
+    }
+  fclose(file);
+
+/* Drop whatever follows the last valid record */
+  if (pos<0 || truncate(ckpt->filename, (off_t)pos))
+    error(EXIT_FAILURE, "*Error*: cannot truncate ", ckpt->filename);
+
+  return RETURN_OK;
+  }
+
+
+/*i**** checkpoint_create *****************************************************
+PROTO	void checkpoint_create(checkpointstruct *ckpt)
+PURPOSE	Create a new state file with the header of the current run.
+INPUT	Pointer to the checkpoint structure.
+OUTPUT	-.
+NOTES	The header is written to a temporary file that replaces any previous
+	state file once it is safely on disk. The state file is left open for
+	appending.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	checkpoint_create(checkpointstruct *ckpt)
+  {
+   FILE		*file;
+   char		tmpname[MAXCHAR+8];
+   int		val;
+
+  snprintf(tmpname, MAXCHAR+8, "%s.tmp", ckpt->filename);
+  if (!(file = fopen(tmpname, "wb")))
+    error(EXIT_FAILURE, "*Error*: cannot open for writing ", tmpname);
+
+  QFWRITE(CHECKPOINT_MAGIC, 8, file, tmpname);
+  val = CHECKPOINT_VERSION;
+  QFWRITE(&val, sizeof(int), file, tmpname);
+  QFWRITE(&ckpt->prefshash, sizeof(ckpt->prefshash), file, tmpname);
+  QFWRITE(&ckpt->ncat, sizeof(int), file, tmpname);
+  QFWRITE(&ckpt->next, sizeof(int), file, tmpname);
+  QFWRITE(ckpt->cathash, ckpt->ncat*sizeof(unsigned long long), file,
+	tmpname);
+
+  if (fflush(file) || fsync(fileno(file)))
+    error(EXIT_FAILURE, "*Error* while writing ", tmpname);
+  fclose(file);
+  if (rename(tmpname, ckpt->filename))
+    error(EXIT_FAILURE, "*Error*: cannot create ", ckpt->filename);
+  if (!(ckpt->file = fopen(ckpt->filename, "ab")))
+    error(EXIT_FAILURE, "*Error*: cannot open for writing ", ckpt->filename);
+
+  return;
+  }
+
+
+/*i**** checkpoint_append *****************************************************
+PROTO	void checkpoint_append(checkpointstruct *ckpt, checkrecenum type,
+			int index, void *ptr, int nval)
+PURPOSE	Append a record to the state file.
+INPUT	Pointer to the checkpoint structure,
+	record type,
+	extension or catalogue index,
+	pointer to the data,
+	number of data elements.
+OUTPUT	-.
+NOTES	Only the new record is written and synced: the cost of a checkpoint
+	does not grow with the number of catalogues already processed. A
+	record that supersedes an earlier one of the same type and index
+	wins when the file is read back.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	checkpoint_append(checkpointstruct *ckpt, checkrecenum type,
+			int index, void *ptr, int nval)
+  {
+   size_t	size;
+   int		rec[3];
+
+  switch(type)
+    {
+    case CHECKPOINT_PC:
+      size = sizeof(double);
+      break;
+    case CHECKPOINT_CAT:
+      size = CHECKPOINT_DIAGSIZE;
+      break;
+    default:
+      size = sizeof(float);
+      break;
+    }
+  rec[0] = (int)type;
+  rec[1] = index;
+  rec[2] = nval;
+  QFWRITE(rec, 3*sizeof(int), ckpt->file, ckpt->filename);
+  if (nval)
+    QFWRITE(ptr, nval*size, ckpt->file, ckpt->filename);
+  QFWRITE(CHECKPOINT_MAGIC, 8, ckpt->file, ckpt->filename);
+  if (fflush(ckpt->file) || fsync(fileno(ckpt->file)))
+    error(EXIT_FAILURE, "*Error* while writing ", ckpt->filename);
+
+  return;
+  }
+
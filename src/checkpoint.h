@@ -0,0 +1,113 @@
+/*
+*				checkpoint.h
+*
+* Include file for checkpoint.c.
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*
+*	This file part of:	PSFEx
+*
+*	Copyright:		(C) 2026 Emmanuel Bertin -- IAP/CNRS/UPMC
+*
+*	License:		GNU General Public License
+*
+*	PSFEx is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+* 	(at your option) any later version.
+*	PSFEx is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*	You should have received a copy of the GNU General Public License
+*	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
+*
+*	Last modified:		19/10/2026
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+#ifdef HAVE_CONFIG_H
+#include	"config.h"
+#endif
+
+#ifndef _CHECKPOINT_H_
+#define _CHECKPOINT_H_
+
+#include	<stdio.h>
+
+#ifndef _CONTEXT_H_
+#include	"context.h"
+#endif
+
+#ifndef _PSFMEF_H_
+#include	"field.h"
+#endif
+
+#ifndef _PSF_H_
+#include	"psf.h"
+#endif
+
+/*----------------------------- Internal constants --------------------------*/
+
+#define	CHECKPOINT_MAGIC	"PSFEXCKP"	/* State file signature */
+#define	CHECKPOINT_VERSION	2		/* State file format version */
+#define	CHECKPOINT_NMOFFAT	30		/* Moffat/asymmetry diagnostics */
+/* Size of the diagnostics of one extension in the state file */
+#define	CHECKPOINT_DIAGSIZE	(3*sizeof(int) + sizeof(double) \
+				+ (3+CHECKPOINT_NMOFFAT)*sizeof(float))
+
+/*--------------------------------- typedefs --------------------------------*/
+/* State file records */
+typedef enum {CHECKPOINT_STEPS, CHECKPOINT_BASIS, CHECKPOINT_PC,
+		CHECKPOINT_CAT}
+		checkrecenum;
+
+/*--------------------------- structure definitions -------------------------*/
+/* Checkpoint state */
+typedef struct checkpoint
+  {
+  char		filename[MAXCHAR];	/* State file name */
+  FILE		*file;			/* State file, open for appending */
+  unsigned long long	prefshash;	/* Hash of the configuration */
+  unsigned long long	*cathash;	/* Hashes of the input catalogues */
+  int		ncat;			/* Number of input catalogues */
+  int		next;			/* Number of extensions per catalogue */
+  int		stepflag;		/* PSF steps saved? */
+  float		psfstep;		/* Common PSF step */
+  float		*psfsteps;		/* Per-extension PSF steps (or NULL) */
+  int		npsfsteps;		/* Number of per-extension steps */
+  float		**basis;		/* PCA bases (one per extension) */
+  int		*nbasisval;		/* Number of basis elements (0=none) */
+  double	**pc;			/* Hidden-dependency PCs (per ext.) */
+  int		*npcval;		/* Number of PC elements (0=none) */
+  char		**catdiag;		/* Packed diagnostics of processed */
+					/* catalogues (NULL if not done) */
+  }	checkpointstruct;
+
+/*---------------------------------- protos --------------------------------*/
+extern checkpointstruct	*checkpoint_init(char *filename, char **catnames,
+				int ncat, int next);
+
+extern double		*checkpoint_getpc(checkpointstruct *ckpt, int index);
+
+extern float		*checkpoint_getbasis(checkpointstruct *ckpt,
+				int index);
+
+extern int		checkpoint_catdone(checkpointstruct *ckpt, int c),
+			checkpoint_getsteps(checkpointstruct *ckpt,
+				float *psfstep, float **psfsteps);
+
+extern void		checkpoint_end(checkpointstruct *ckpt, int removeflag),
+			checkpoint_getcat(checkpointstruct *ckpt, int c,
+				fieldstruct *field, contextstruct *context),
+			checkpoint_putbasis(checkpointstruct *ckpt, int index,
+				float *basis, int nval),
+			checkpoint_putcat(checkpointstruct *ckpt, int c,
+				fieldstruct *field),
+			checkpoint_putpc(checkpointstruct *ckpt, int index,
+				double *pc, int nval),
+			checkpoint_putsteps(checkpointstruct *ckpt,
+				float psfstep, float *psfsteps, int nsteps);
+
+#endif
+
@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		10/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -43,10 +43,27 @@
 #include	"globals.h"
 #include	"fits/fitscat.h"
 #include	"cplot.h"
+#include	"linalg.h"
 #include	"fitswcs.h"
 #include	"prefs.h"
 #include	"field.h"
 #include	"psf.h"
+#ifdef USE_THREADS
+#include	"threads.h"
+#endif
+
+static void	cplot_render(fieldstruct *field);
+
+#ifdef USE_THREADS
+static void	*pthread_cplot_renderer(void *arg);
+
+static pthread_t	cplotthread;
+static pthread_mutex_t	cplotmutex;
+static pthread_cond_t	cplotcond_in, cplotcond_out;
+static fieldstruct	*cplotqueue[CPLOT_MAXQUEUE];
+static int		cplotqueue_first, cplotqueue_n,
+			cplotendflag, cplotthreadflag;
+#endif
 
 struct {cplotdevenum device; char *devname; char *extension;}
 		cplot_device[] = {{CPLOT_NULL, "null", ""},
@@ -98,6 +115,167 @@ int	 cplot_check(cplotenum cplottype)
   }
 
 
+/****** cplot_queueinit ******************************************************
+PROTO	void	cplot_queueinit(void)
+PURPOSE	Start the check-plot rendering thread.
+INPUT	-.
+OUTPUT	-.
+NOTES	Once started, the check-plots of submitted fields are rendered in the
+	background, in the order the fields were submitted. As PLplot keeps a
+	global state, a single rendering thread is used. Interactive devices,
+	or the lack of thread support, make rendering synchronous.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+void	cplot_queueinit(void)
+  {
+#ifdef USE_THREADS
+   int		j;
+
+  if (cplotthreadflag || !prefs.ncplot_type)
+    return;
+  for (j=0; j<prefs.ncplot_device; j++)
+    if (prefs.cplot_device[j] == CPLOT_XWIN
+	|| prefs.cplot_device[j] == CPLOT_TK
+	|| prefs.cplot_device[j] == CPLOT_XTERM
+	|| prefs.cplot_device[j] == CPLOT_AQT)
+      return;
+  cplotqueue_first = cplotqueue_n = cplotendflag = 0;
+  QPTHREAD_MUTEX_INIT(&cplotmutex, NULL);
+  QPTHREAD_COND_INIT(&cplotcond_in, NULL);
+  QPTHREAD_COND_INIT(&cplotcond_out, NULL);
+  QPTHREAD_CREATE(&cplotthread, NULL, pthread_cplot_renderer, NULL);
+  cplotthreadflag = 1;
+/* The rendering thread now competes with BLAS for the thread budget */
+  linalg_share(1);
+#endif
+
+  return;
+  }
+
+
+/****** cplot_queueend *******************************************************
+PROTO	void	cplot_queueend(void)
+PURPOSE	Render pending check-plots and stop the rendering thread.
+INPUT	-.
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+void	cplot_queueend(void)
+  {
+#ifdef USE_THREADS
+  if (!cplotthreadflag)
+    return;
+  QPTHREAD_MUTEX_LOCK(&cplotmutex);
+  cplotendflag = 1;
+  QPTHREAD_COND_SIGNAL(&cplotcond_in);
+  QPTHREAD_MUTEX_UNLOCK(&cplotmutex);
+  QPTHREAD_JOIN(cplotthread, NULL);
+  QPTHREAD_MUTEX_DESTROY(&cplotmutex);
+  QPTHREAD_COND_DESTROY(&cplotcond_in);
+  QPTHREAD_COND_DESTROY(&cplotcond_out);
+  cplotthreadflag = 0;
+  linalg_share(-1);
+#endif
+
+  return;
+  }
+
+
+/****** cplot_submit *********************************************************
+PROTO	void	cplot_submit(fieldstruct *field)
+PURPOSE	Submit all the check-plots of a field for rendering.
+INPUT	Pointer to the field.
+OUTPUT	-.
+NOTES	The field must not be modified nor freed before cplot_queueend() has
+	been called. Blocks if CPLOT_MAXQUEUE fields are already waiting.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+void	cplot_submit(fieldstruct *field)
+  {
+#ifdef USE_THREADS
+  if (cplotthreadflag)
+    {
+    QPTHREAD_MUTEX_LOCK(&cplotmutex);
+    while (cplotqueue_n >= CPLOT_MAXQUEUE)
+      QPTHREAD_COND_WAIT(&cplotcond_out, &cplotmutex);
+    cplotqueue[(cplotqueue_first+cplotqueue_n++)%CPLOT_MAXQUEUE] = field;
+    QPTHREAD_COND_SIGNAL(&cplotcond_in);
+    QPTHREAD_MUTEX_UNLOCK(&cplotmutex);
+    return;
+    }
+#endif
+  cplot_render(field);
+
+  return;
+  }
+
+
+/****** cplot_render *********************************************************
+PROTO	void	cplot_render(fieldstruct *field)
+PURPOSE	Render all the check-plots of a field.
+INPUT	Pointer to the field.
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	cplot_render(fieldstruct *field)
+  {
+  cplot_ellipticity(field);
+  cplot_fwhm(field);
+  cplot_moffatresi(field);
+  cplot_asymresi(field);
+  cplot_counts(field);
+  cplot_countfrac(field);
+  cplot_modchi2(field);
+  cplot_modresi(field);
+
+  return;
+  }
+
+
+#ifdef USE_THREADS
+/****** pthread_cplot_renderer ***********************************************
+PROTO	void	*pthread_cplot_renderer(void *arg)
+PURPOSE	Rendering thread: render the check-plots of queued fields in order.
+INPUT	Pointer to the thread number (unused).
+OUTPUT	NULL void pointer.
+NOTES	Exits once the queue is empty and cplot_queueend() has been called.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	*pthread_cplot_renderer(void *arg)
+  {
+   fieldstruct	*field;
+
+  QPTHREAD_MUTEX_LOCK(&cplotmutex);
+  for (;;)
+    {
+    while (!cplotqueue_n && !cplotendflag)
+      QPTHREAD_COND_WAIT(&cplotcond_in, &cplotmutex);
+    if (!cplotqueue_n)
+      break;
+    field = cplotqueue[cplotqueue_first];
+    cplotqueue_first = (cplotqueue_first+1)%CPLOT_MAXQUEUE;
+    cplotqueue_n--;
+    QPTHREAD_COND_SIGNAL(&cplotcond_out);
+    QPTHREAD_MUTEX_UNLOCK(&cplotmutex);
+    cplot_render(field);
+    QPTHREAD_MUTEX_LOCK(&cplotmutex);
+    }
+  QPTHREAD_MUTEX_UNLOCK(&cplotmutex);
+
+  pthread_exit(NULL);
+
+  return (void *)NULL;
+  }
+#endif
+
+
 /****** cplot_init ***********************************************************
 PROTO	int cplot_init(char *name, int nx, int ny, cplotenum cplottype)
 PURPOSE	Initialize a check plot.
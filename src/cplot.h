@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		10/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -52,6 +52,7 @@
 #define		CPLOT_ASTNSUBPLOTS 3	/* Number of subplot/dim/detector*/
 #define		CPLOT_NTYPES	 128 /* Number of CPLOT types (typedef below)*/
 #define		CPLOT_NSHADES	  32	/* Number of shading levels */
+#define		CPLOT_MAXQUEUE	  64	/* max. # of fields waiting for plots */
 
 /*---------------------------- return messages ------------------------------*/
 /*-------------------------------- macros -----------------------------------*/
@@ -87,6 +88,10 @@ extern int		cplot_modchi2(fieldstruct *field),
 				cplotenum cplottype),
 			cplot_moffatresi(fieldstruct *field),
 			cplot_asymresi(fieldstruct *field);
+
+extern void		cplot_queueend(void),
+			cplot_queueinit(void),
+			cplot_submit(fieldstruct *field);
 			
 char			*cplot_degtosexal(char *str, double alpha,double step),
 			*cplot_degtosexde(char *str, double delta,double step);
@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		10/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -45,25 +45,80 @@
 #include	"poly.h"
 #include	"psf.h"
 
+static void	psf_nextsnap(double *dpos, int npc, double dstart,
+			double dstep);
+
+/****** diag_plan ***********************************************************
+PROTO	int	diag_plan(void)
+PURPOSE	Find out which diagnostics are consumed by the requested outputs.
+INPUT	-.
+OUTPUT  DIAG_* flags.
+NOTES   Quantities at the median snapshot are always computed, as they are
+	reported on the console. The XML meta-data, CHECKPLOT_TYPE FWHM,
+	ELLIPTICITY, MOFFAT_RESIDUALS and ASYMMETRY, and CHECKIMAGE_TYPE
+	MOFFAT and -MOFFAT need them at every snapshot.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+ ***/
+int	diag_plan(void)
+  {
+   int	i, flags;
+
+  flags = 0;
+/* Ranges over snapshots are reported in the XML meta-data */
+  if (prefs.xml_flag)
+    flags |= DIAG_ALL;
+#ifdef HAVE_PLPLOT
+  if (prefs.ncplot_device && prefs.cplot_device[0] != CPLOT_NULL)
+    for (i=0; i<prefs.ncplot_type; i++)
+      switch(prefs.cplot_type[i])
+        {
+        case CPLOT_FWHM:
+        case CPLOT_ELLIPTICITY:
+          flags |= DIAG_MOFFAT;
+          break;
+        case CPLOT_MOFFATRESI:
+          flags |= DIAG_PFMOFFAT;
+          break;
+        case CPLOT_ASYMRESI:
+          flags |= DIAG_SYMRESI;
+          break;
+        default:
+          break;
+        }
+#endif
+  for (i=0; i<prefs.ncheck_type; i++)
+    if (prefs.check_type[i]==PSF_MOFFAT || prefs.check_type[i]==PSF_SUBMOFFAT)
+      flags |= DIAG_PFMOFFAT;
+
+  return flags;
+  }
+
+
 /****** psf_diagnostic *******************************************************
-PROTO	void	psf_diagnostic(psfstruct *psf)
-PURPOSE	Free a PSF structure and everything it contains.
-INPUT	Pointer to the PSF structure.
+PROTO	void	psf_diagnostic(psfstruct *psf, int flags)
+PURPOSE	Compute Moffat fits and residual metrics over the PSF snapshots.
+INPUT	Pointer to the PSF structure,
+	DIAG_* flags (see diag_plan()).
 OUTPUT  -.
-NOTES   -.
+NOTES   Without DIAG_MOFFAT (resp. DIAG_PFMOFFAT) only the median snapshot
+	is fitted with a normal (resp. pixel-free) Moffat, and min/max ranges
+	reduce to the median value. Same for asymmetry residuals without
+	DIAG_SYMRESI. The levmar workspace is allocated once per call (hence
+	private to the calling thread) and shared by all snapshot fits.
 AUTHOR  E. Bertin (IAP, Leiden observatory & ESO)
-VERSION 26/07/2010
+VERSION 19/10/2026
  ***/
-void	psf_diagnostic(psfstruct *psf)
+void	psf_diagnostic(psfstruct *psf, int flags)
   {
    moffatstruct		*moffat, *pfmoffat;
    double		lm_opts[5],
 			dpos[POLY_MAXDIM],
 			dparam[PSF_DIAGNPARAM],
-			*dresi;
+			*dresi, *lm_work;
    float		param[PSF_DIAGNPARAM],
 			dstep,dstart, fwhm, temp;
-   int			i,m,n, w,h, npc,nt, nmed, niter;
+   int			i,m,n, w,h, npc,nt, nmed, niter, fitflag,symflag;
 
   nmed = 0;
   npc = psf->poly->ndim;
@@ -77,7 +132,9 @@ void	psf_diagnostic(psfstruct *psf)
   w = psf->size[0];
   h = psf->size[1];
   m = w*h;
+/* Residual vector and levmar workspace are shared by all snapshot fits */
   QMALLOC(dresi, double, m);
+  QMALLOC(lm_work, double, LM_DIF_WORKSZ(PSF_DIAGNPARAM, m));
   dstep = 1.0/psf->nsnap;
   dstart = (1.0-dstep)/2.0;
 
@@ -105,9 +162,18 @@ void	psf_diagnostic(psfstruct *psf)
 /* For each snapshot of the PSF */ 
   for (n=0; n<nt; n++)
     {
-    if (psf->samples_accepted)
+    fitflag = (flags & DIAG_MOFFAT) || n==nmed;
+    symflag = (flags & DIAG_SYMRESI) || n==nmed;
+    if (!fitflag && !symflag)
       {
+      memset(&moffat[n], 0, sizeof(moffatstruct));
+      psf_nextsnap(dpos, npc, dstart, dstep);
+      continue;
+      }
+    if (psf->samples_accepted)
       psf_build(psf, dpos);
+    if (fitflag && psf->samples_accepted)
+      {
 /*---- Initialize PSF parameters */
       fwhm = psf->fwhm / psf->pixstep;
 /*---- Amplitude */
@@ -142,11 +208,26 @@ void	psf_diagnostic(psfstruct *psf)
       niter = dlevmar_dif(psf_diagresi, dparam, dresi,
 	PSF_DIAGNPARAM, m, 
 	PSF_DIAGMAXITER, 
-	lm_opts, NULL, NULL, NULL, psf);
+	lm_opts, NULL, lm_work, NULL, psf);
       psf_unboundtobound(dparam,param);
       }
     else
       memset(param, 0, PSF_DIAGNPARAM*sizeof(float));
+    for (i=0; i<npc; i++)
+      moffat[n].context[i] = dpos[i]*psf->contextscale[i]+psf->contextoffset[i];
+    moffat[n].symresiduals = symflag? psf_symresi(psf) : 0.0;
+    if (symflag)
+      {
+      if (moffat[n].symresiduals < psf->sym_residuals_min)
+        psf->sym_residuals_min = moffat[n].symresiduals;
+      if (moffat[n].symresiduals > psf->sym_residuals_max)
+        psf->sym_residuals_max = moffat[n].symresiduals;
+      }
+    if (!fitflag)
+      {
+      psf_nextsnap(dpos, npc, dstart, dstep);
+      continue;
+      }
 
     moffat[n].nsubpix = psf->nsubpix;
     moffat[n].amplitude = param[0]/(psf->pixstep*psf->pixstep);
@@ -167,10 +248,7 @@ void	psf_diagnostic(psfstruct *psf)
     if (moffat[n].theta > 90.0)
       moffat[n].theta -= 180.0;
     moffat[n].beta = param[6];
-    for (i=0; i<npc; i++)
-      moffat[n].context[i] = dpos[i]*psf->contextscale[i]+psf->contextoffset[i];
     moffat[n].residuals = psf_normresi(param, psf);
-    moffat[n].symresiduals = psf_symresi(psf);
     if ((temp=0.5*(psf->moffat[n].fwhm_min+psf->moffat[n].fwhm_max))
 		< psf->moffat_fwhm_min)
       psf->moffat_fwhm_min = temp;
@@ -190,19 +268,7 @@ void	psf_diagnostic(psfstruct *psf)
       psf->moffat_residuals_min = psf->moffat[n].residuals;
     if (psf->moffat[n].residuals > psf->moffat_residuals_max)
       psf->moffat_residuals_max = psf->moffat[n].residuals;
-    if (psf->moffat[n].symresiduals < psf->sym_residuals_min)
-      psf->sym_residuals_min = psf->moffat[n].symresiduals;
-    if (psf->moffat[n].symresiduals > psf->sym_residuals_max)
-      psf->sym_residuals_max = psf->moffat[n].symresiduals;
-
-    for (i=0; i<npc; i++)
-      if (dpos[i]<dstart-0.01)
-        {
-        dpos[i] += dstep;
-        break;
-        }
-      else
-        dpos[i] = -dstart;
+    psf_nextsnap(dpos, npc, dstart, dstep);
     }
 
   psf->moffat_fwhm = 0.5*(psf->moffat[nmed].fwhm_min
@@ -230,6 +296,12 @@ void	psf_diagnostic(psfstruct *psf)
 /* For each snapshot of the PSF */ 
   for (n=0; n<nt; n++)
     {
+    if (!(flags & DIAG_PFMOFFAT) && n!=nmed)
+      {
+      memset(&pfmoffat[n], 0, sizeof(moffatstruct));
+      psf_nextsnap(dpos, npc, dstart, dstep);
+      continue;
+      }
     if (psf->samples_accepted)
       {
       psf_build(psf, dpos);
@@ -267,7 +339,7 @@ void	psf_diagnostic(psfstruct *psf)
       niter = dlevmar_dif(psf_diagresi, dparam, dresi,
 	PSF_DIAGNPARAM, m, 
 	PSF_DIAGMAXITER, 
-	lm_opts, NULL, NULL, NULL, psf);
+	lm_opts, NULL, lm_work, NULL, psf);
       psf_unboundtobound(dparam, param);
       }
     else
@@ -295,7 +367,8 @@ void	psf_diagnostic(psfstruct *psf)
     for (i=0; i<npc; i++)
       pfmoffat[n].context[i] = dpos[i]*psf->contextscale[i]+psf->contextoffset[i];
     pfmoffat[n].residuals = psf_normresi(param, psf);
-    pfmoffat[n].symresiduals = psf_symresi(psf);
+/*-- Same PSF snapshot as for the normal Moffat fit */
+    pfmoffat[n].symresiduals = moffat[n].symresiduals;
     if ((temp=0.5*(psf->pfmoffat[n].fwhm_min+psf->pfmoffat[n].fwhm_max))
 		< psf->pfmoffat_fwhm_min)
       psf->pfmoffat_fwhm_min = temp;
@@ -315,15 +388,7 @@ void	psf_diagnostic(psfstruct *psf)
       psf->pfmoffat_residuals_min = psf->pfmoffat[n].residuals;
     if (psf->pfmoffat[n].residuals > psf->pfmoffat_residuals_max)
       psf->pfmoffat_residuals_max = psf->pfmoffat[n].residuals;
-
-    for (i=0; i<npc; i++)
-      if (dpos[i]<dstart-0.01)
-        {
-        dpos[i] += dstep;
-        break;
-        }
-      else
-        dpos[i] = -dstart;
+    psf_nextsnap(dpos, npc, dstart, dstep);
     }
 
   psf->pfmoffat_fwhm = 0.5*(psf->pfmoffat[nmed].fwhm_min
@@ -334,6 +399,38 @@ void	psf_diagnostic(psfstruct *psf)
   psf->pfmoffat_beta = psf->pfmoffat[nmed].beta;
   psf->pfmoffat_residuals = psf->pfmoffat[nmed].residuals;
 
+  free(dresi);
+  free(lm_work);
+
+  return;
+  }
+
+
+/****** psf_nextsnap *********************************************************
+PROTO	void psf_nextsnap(double *dpos, int npc, double dstart, double dstep)
+PURPOSE	Move to the next position in the grid of PSF snapshots.
+INPUT	Pointer to the current (reduced) position,
+	number of dimensions,
+	grid start (negative),
+	grid step.
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	psf_nextsnap(double *dpos, int npc, double dstart, double dstep)
+  {
+   int	i;
+
+  for (i=0; i<npc; i++)
+    if (dpos[i]<dstart-0.01)
+      {
+      dpos[i] += dstep;
+      break;
+      }
+    else
+      dpos[i] = -dstart;
+
   return;
   }
 
@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		10/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -40,6 +40,12 @@
 #define		PSF_BETAMIN	0.5	/* Minimum Moffat beta for fit */
 #define		PSF_NSUBPIX	5	/* Oversamp. factor to mimick top-hat */
 
+/* Quantities required over the full grid of PSF snapshots (see diag_plan())*/
+#define		DIAG_MOFFAT	0x01	/* "Normal" Moffat fits */
+#define		DIAG_PFMOFFAT	0x02	/* "Pixel-free" Moffat fits */
+#define		DIAG_SYMRESI	0x04	/* Asymmetry residuals */
+#define		DIAG_ALL	(DIAG_MOFFAT|DIAG_PFMOFFAT|DIAG_SYMRESI)
+
 /*-------------------------------- macros -----------------------------------*/
 
 #define         PSFEX_POW(x,a)	(x>0.01? exp(a*log(x)) : pow(x,a))
@@ -50,7 +56,7 @@ float	moffat_parammin[PSF_DIAGNPARAM], moffat_parammax[PSF_DIAGNPARAM];
 
 /*---------------------------------- protos --------------------------------*/
 extern void	psf_boundtounbound(float *param, double *dparam),
-		psf_diagnostic(psfstruct *psf),
+		psf_diagnostic(psfstruct *psf, int flags),
 		psf_diagprintout(int n_par, float *par, int m_dat,
 			float *fvec, void *data, int iflag,int iter,int nfev),
 		psf_diagresi(double *par, double *fvec, int m, int n,
@@ -58,6 +64,8 @@ extern void	psf_boundtounbound(float *param, double *dparam),
 		psf_moffat(psfstruct *psf, moffatstruct *moffat),
 		psf_unboundtobound(double *dparam, float *param);
 
+extern int	diag_plan(void);
+
 extern double	psf_normresi(float *par, psfstruct *psf),
 		psf_symresi(psfstruct *psf);
 
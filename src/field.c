@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		03/11/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -34,6 +34,7 @@
 #include	<stdio.h>
 #include	<stdlib.h>
 #include	<string.h>
+#include	<unistd.h>
 
 #include	"define.h"
 #include	"types.h"
@@ -53,7 +54,7 @@ INPUT	Catalog filename.
 OUTPUT  fieldstruct pointer.
 NOTES   .
 AUTHOR  E. Bertin (IAP)
-VERSION 08/04/2010
+VERSION 19/10/2026
  ***/
 fieldstruct	*field_init(char *catname)
   {
@@ -82,7 +83,7 @@ fieldstruct	*field_init(char *catname)
     next0++;
     }
   field->next = next0;
-  QMALLOC(field->psf, psfstruct *, next0);
+  QCALLOC(field->psf, psfstruct *, next0);
   strcpy(field->catname, catname);
 /* A short, "relative" version of the filename */
   if (!(field->rcatname = strrchr(field->catname, '/')))
@@ -377,9 +378,10 @@ INPUT   Pointer to the PSF structure,
 	Extension number,
 	Number of extensions.
 OUTPUT  -.
-NOTES   -.
+NOTES   The INHASH keyword is written only if the input hash of the field is
+	set, together with the NPASS and FITSAVED fit statistics.
 AUTHOR  E. Bertin (IAP)
-VERSION 30/10/2009
+VERSION 19/10/2026
  ***/
 void	field_psfsave(fieldstruct *field, char *filename)
   {
@@ -412,6 +414,18 @@ void	field_psfsave(fieldstruct *field, char *filename)
     fitswrite(head, "ACCEPTED", &psf->samples_accepted, H_INT, T_LONG);
     addkeywordto_head(tab, "CHI2", "Final Chi2");
     fitswrite(head, "CHI2", &psf->chi2, H_FLOAT, T_DOUBLE);
+    if (field->inhash)
+      {
+      sprintf(str, "%016llx", field->inhash);
+      addkeywordto_head(tab, "INHASH", "Hash of the input data and config");
+      fitswrite(head, "INHASH", str, H_STRING, T_STRING);
+/*---- Fit statistics, restored with the PSF if the inputs are unchanged */
+      addkeywordto_head(tab, "NPASS", "Number of fitting passes run");
+      fitswrite(head, "NPASS", &psf->npass, H_INT, T_LONG);
+      addkeywordto_head(tab, "FITSAVED",
+		"Fitting time saved by skipped passes (s)");
+      fitswrite(head, "FITSAVED", &psf->fit_timesaved, H_FLOAT, T_FLOAT);
+      }
     addkeywordto_head(tab, "POLNAXIS", "Number of context parameters");
     fitswrite(head, "POLNAXIS", &psf->poly->ndim, H_INT, T_LONG);
     for (i=0; i<psf->poly->ndim; i++)
@@ -499,3 +513,66 @@ void	field_psfsave(fieldstruct *field, char *filename)
   }
 
 
+/****** field_psfload *********************************************************
+PROTO   int	field_psfload(fieldstruct *field, char *filename)
+PURPOSE Load the PSFs of a field from a previously saved PSF file, provided that
+	it was computed from the same input data and configuration.
+INPUT   Pointer to the field structure,
+	Filename.
+OUTPUT  RETURN_OK if the PSFs were loaded, RETURN_ERROR otherwise.
+NOTES   Every PSF_DATA extension must carry an INHASH keyword matching the
+	input hash of the field. Field PSFs are left untouched in case of error.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+ ***/
+int	field_psfload(fieldstruct *field, char *filename)
+  {
+   catstruct	*cat;
+   tabstruct	*tab;
+   psfstruct	**psfs;
+   char		str[80];
+   int		e, i, next;
+
+  if (!field->inhash || access(filename, R_OK))
+    return RETURN_ERROR;
+  if (!(cat = read_cat(filename)))
+    return RETURN_ERROR;
+
+/* Check that all extensions are up-to-date */
+  next = 0;
+  tab = cat->tab;
+  for (i=cat->ntab; i--; tab=tab->nexttab)
+    if (!strcmp(tab->extname, "PSF_DATA"))
+      {
+      if (fitsread(tab->headbuf, "INHASH", str, H_STRING, T_STRING)
+		!= RETURN_OK
+	|| strtoull(str, NULL, 16) != field->inhash)
+        break;
+      next++;
+      }
+  free_cat(&cat, 1);
+  if (i>=0 || next != field->next)
+    return RETURN_ERROR;
+
+  QCALLOC(psfs, psfstruct *, field->next);
+  for (e=0; e<field->next; e++)
+    if (!(psfs[e] = psf_load(filename, e)))
+      {
+      for (i=0; i<e; i++)
+        psf_end(psfs[i]);
+      free(psfs);
+      return RETURN_ERROR;
+      }
+
+  for (e=0; e<field->next; e++)
+    {
+    if (field->psf[e])
+      psf_end(field->psf[e]);
+    field->psf[e] = psfs[e];
+    }
+  free(psfs);
+
+  return RETURN_OK;
+  }
+
+
@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		03/11/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -72,11 +72,14 @@ typedef struct field
   int		**count;		/* Count detections in stats */
   double	**modchi2;		/* Sum of chi2's per image area */
   double	**modresi;		/* Sum of res. indices per image area */
+  unsigned long long	inhash;		/* Hash of input data and config */
   }	fieldstruct;
 
 /*---------------------------------- protos --------------------------------*/
 extern fieldstruct	*field_init(char *catname);
 
+extern int		field_psfload(fieldstruct *field, char *filename);
+
 extern void		field_count(fieldstruct **fields, setstruct *set,
 				int counttype),
 			field_end(fieldstruct *field),
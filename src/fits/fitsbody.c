@@ -23,7 +23,7 @@
 *	along with AstrOmatic software.
 *	If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		09/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -204,7 +204,7 @@ INPUT	A pointer to the tab structure,
 OUTPUT	-.
 NOTES	.
 AUTHOR	E. Bertin (IAP)
-VERSION	24/08/2010
+VERSION	19/10/2026
  ***/
 void	read_body(tabstruct *tab, PIXTYPE *ptr, size_t size)
   {
@@ -493,6 +493,12 @@ void	read_body(tabstruct *tab, PIXTYPE *ptr, size_t size)
       tab->compress_npix = npix;
       break;
 
+/*-- Tile-compressed image */
+    case COMPRESS_RICE:
+    case COMPRESS_GZIP:
+      read_tilebody(tab, ptr, size);
+      break;
+
     default:
       error(EXIT_FAILURE,"*Internal Error*: unknown compression mode in ",
                                 "read_body()");
@@ -23,7 +23,7 @@
 *	along with AstrOmatic software.
 *	If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		09/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -76,6 +76,14 @@
 
 #define		PADEXTRA(x)	((FBSIZE - (x%FBSIZE))% FBSIZE)
 
+/* default quantization level of tile-compressed floating-point images */
+
+#define		TILE_DEFQLEVEL	16.0
+
+/* default number of image rows per compressed tile */
+
+#define		TILE_DEFNROW	16
+
 /*--------------------------------- typedefs --------------------------------*/
 
 typedef enum            {H_INT, H_FLOAT, H_EXPO, H_BOOL, H_STRING, H_STRINGS,
@@ -163,8 +171,11 @@ typedef struct structtab
   double	bzero;			/* data offset parameter */
   int		blank;			/* integer code for undefined values */
   int		blankflag;		/* set if a blank keyword was found */
-  enum {COMPRESS_NONE, COMPRESS_BASEBYTE, COMPRESS_PREVPIX}
+  enum {COMPRESS_NONE, COMPRESS_BASEBYTE, COMPRESS_PREVPIX,
+	COMPRESS_RICE, COMPRESS_GZIP}
 		compress_type;		/* image compression type */
+  double	compress_qlevel;	/* quantization level (tiled images) */
+  int		compress_tilenrow;	/* image rows per tile (tiled images) */
   char		*compress_buf;		/* de-compression buffer */
   char		*compress_bufptr;	/* present pixel in buffer */
   int		compress_curval;	/* current pixel or checksum value */
@@ -232,11 +243,14 @@ extern void	add_cleanupfilename(char *filename),
 			int nkeys, unsigned char *mask),
 		read_basic(tabstruct *tab),
 		read_body(tabstruct *tab, PIXTYPE *ptr, size_t size),
+		read_tilebody(tabstruct *tab, PIXTYPE *ptr, size_t size),
 		read_ibody(tabstruct *tab, FLAGTYPE *ptr, size_t size),
 		readbasic_head(tabstruct *tab),
+		readtile_head(tabstruct *tab),
 		remove_cleanupfilename(char *filename),
 		save_cat(catstruct *cat, char *filename),
 		save_tab(catstruct *cat, tabstruct *tab),
+		save_tiletab(catstruct *cat, tabstruct *tab),
 		show_keys(tabstruct *tab, char **keynames, keystruct **keys,
 			int nkeys, unsigned char *mask, FILE *stream,
 			int strflag,int banflag, int leadflag,
@@ -310,6 +324,7 @@ extern int	about_cat(catstruct *cat, FILE *stream),
 		set_maxram(size_t maxram),
 		set_maxvram(size_t maxvram),
 		set_swapdir(char *dirname),
+		set_tilenthreads(int nthreads),
 		tab_row_len(char *, char *),
 		tformof(char *str, t_type ttype, int n),
 		tsizeof(char *str),
@@ -324,7 +339,8 @@ extern PIXTYPE	*alloc_body(tabstruct *tab,
 
 extern t_type	ttypeof(char *str);
 
-extern  void	error(int, char *, char *),
+extern  void	copyswapbytes(void *ptrin, void *ptrout, int nb, int n),
+		error(int, char *, char *),
 		swapbytes(void *ptr, int nb, int n),
 		warning(char *msg1, char *msg2);
 
@@ -23,7 +23,7 @@
 *	along with AstrOmatic software.
 *	If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		09/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -101,7 +101,7 @@ INPUT	pointer to catstruct.
 OUTPUT	-.
 NOTES	-.
 AUTHOR	E. Bertin (IAP)
-VERSION	25/09/2004
+VERSION	19/10/2026
  ***/
 void	readbasic_head(tabstruct *tab)
 
@@ -109,7 +109,7 @@ void	readbasic_head(tabstruct *tab)
    char		str[88];
    char		key[12], name[16],
 		*filename;
-   int		i;
+   int		i, zflag;
    KINGSIZE_T	tabsize;
 
   filename = (tab->cat? tab->cat->filename : strcpy(name, "internal header"));
@@ -184,6 +184,12 @@ void	readbasic_head(tabstruct *tab)
       warning("Compression skipped: unknown IMAGECOD parameter:", str);
     }
 
+/* Tile-compressed image stored in a binary table */
+  zflag = 0;
+  if (fitsread(tab->headbuf, "ZIMAGE  ", &zflag, H_BOOL, T_LONG)==RETURN_OK
+	&& zflag)
+    readtile_head(tab);
+
 /* Checksum */
   if (fitsread(tab->headbuf, "DATASUM ", str, H_STRING, T_STRING)==RETURN_OK)
     tab->bodysum = (unsigned int)atoi(str);
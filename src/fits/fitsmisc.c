@@ -23,7 +23,7 @@
 *	along with AstrOmatic software.
 *	If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		09/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -186,6 +186,69 @@ void    swapbytes(void *ptr, int nb, int n)
   }
 
 
+/***************************** copyswapbytes ********************************/
+/*
+Copy and swap bytes for doubles, longs and shorts, leaving the source
+untouched. Input and output arrays must not overlap.
+*/
+void    copyswapbytes(void *ptrin, void *ptrout, int nb, int n)
+  {
+   unsigned char	*cpin,*cpout;
+   int			j;
+
+  cpin = (unsigned char *)ptrin;
+  cpout = (unsigned char *)ptrout;
+
+  if (nb&4)
+    {
+    for (j=n; j--; cpin+=4, cpout+=4)
+      {
+      cpout[0] = cpin[3];
+      cpout[1] = cpin[2];
+      cpout[2] = cpin[1];
+      cpout[3] = cpin[0];
+      }
+    return;
+    }
+
+  if (nb&2)
+    {
+    for (j=n; j--; cpin+=2, cpout+=2)
+      {
+      cpout[0] = cpin[1];
+      cpout[1] = cpin[0];
+      }
+    return;
+    }
+
+  if (nb&1)
+    {
+    memcpy(ptrout, ptrin, (size_t)n);
+    return;
+    }
+
+  if (nb&8)
+    {
+    for (j=n; j--; cpin+=8, cpout+=8)
+      {
+      cpout[0] = cpin[7];
+      cpout[1] = cpin[6];
+      cpout[2] = cpin[5];
+      cpout[3] = cpin[4];
+      cpout[4] = cpin[3];
+      cpout[5] = cpin[2];
+      cpout[6] = cpin[1];
+      cpout[7] = cpin[0];
+      }
+    return;
+    }
+
+  error(EXIT_FAILURE, "*Internal Error*: Unknown size in ", "copyswapbytes()");
+
+  return;
+  }
+
+
 /****** wstrncmp ***************************************************************
 PROTO	int wstrncmp(char *cs, char *ct, int n)
 PURPOSE	simple wildcard strcmp.
@@ -0,0 +1,1290 @@
+/*
+*				fitstile.c
+*
+* Read and write tile-compressed FITS images (Rice and GZIP).
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*
+*	This file part of:	AstrOmatic FITS/LDAC library
+*
+*	Copyright:		(C) 2026 Emmanuel Bertin -- IAP/CNRS/UPMC
+*
+*	License:		GNU General Public License
+*
+*	AstrOmatic software is free software: you can redistribute it and/or
+*	modify it under the terms of the GNU General Public License as
+*	published by the Free Software Foundation, either version 3 of the
+*	License, or (at your option) any later version.
+*	AstrOmatic software is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*	You should have received a copy of the GNU General Public License
+*	along with AstrOmatic software.
+*	If not, see <http://www.gnu.org/licenses/>.
+*
+*	Last modified:		19/10/2026
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+#ifdef HAVE_CONFIG_H
+#include	"config.h"
+#endif
+
+#include	<limits.h>
+#include	<math.h>
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+
+#ifdef USE_THREADS
+#include	<pthread.h>
+#endif
+#ifdef HAVE_ZLIB
+#include	<zlib.h>
+#endif
+
+#include	"fitscat_defs.h"
+#include	"fitscat.h"
+
+/*------------------------------- constants ---------------------------------*/
+
+#define	TILE_RICEBLOCK	32		/* Rice block size (pixels) */
+#define	TILE_NULLVAL	(-2147483647)	/* Quantized value of NaNs */
+#define	TILE_QMAX	2.0e9		/* Max. range of quantized values */
+#define	TILE_NRANDOM	10000		/* Size of the dithering sequence */
+
+/*--------------------------- structure definitions -------------------------*/
+
+typedef struct tilebits
+  {
+  unsigned char		*buf;		/* Byte stream */
+  unsigned char		*bufend;	/* End of the input stream */
+  size_t		size;		/* Allocated size (output streams) */
+  size_t		pos;		/* Current position (output streams) */
+  unsigned long long	acc;		/* Bit accumulator */
+  int			nacc;		/* Number of bits in accumulator */
+  }	tilebitstruct;
+
+typedef struct tilejob
+  {
+  PIXTYPE		*pix;		/* Input pixels */
+  int			npix;		/* Number of pixels */
+  unsigned char		*cbuf;		/* Compressed data */
+  int			cbytes;		/* Size of compressed data */
+  double		zscale, zzero;	/* Quantization parameters */
+  }	tilejobstruct;
+
+typedef struct tileset
+  {
+  tilejobstruct		*job;		/* Array of tiles */
+  int			njob;		/* Number of tiles */
+  int			compress_type;	/* COMPRESS_RICE or COMPRESS_GZIP */
+  double		qlevel;		/* Quantization level (RICE) */
+  int			id, nthreads;	/* Thread number and # of threads */
+  }	tilesetstruct;
+
+/*-------------------------------- protos -----------------------------------*/
+
+static void	tile_compress(tilesetstruct *tileset),
+		tile_putbits(tilebitstruct *bits, unsigned int val, int n),
+		tile_quantize(PIXTYPE *pix, int npix, double qlevel,
+			int *ipix, float *work, double *zscale, double *zzero);
+
+static int	tile_ricecomp(int *ipix, int npix, tilebitstruct *bits),
+		tile_ricedecomp(unsigned char *cbuf, int cbytes, int *ipix,
+			int npix, int bytepix, int nblock),
+		tile_tformsize(char *tform);
+
+static unsigned int	tile_getbits(tilebitstruct *bits, int n);
+
+static size_t	tile_descval(unsigned char *ptr, int nb);
+
+static float	tile_median(float *data, int n);
+
+#ifdef HAVE_ZLIB
+static int	tile_gzip(unsigned char *buf, int nbytes, unsigned char **cbuf),
+		tile_gunzip(unsigned char *cbuf, int cbytes, unsigned char *buf,
+			int nbytes);
+#endif
+
+#ifdef USE_THREADS
+static void	*pthread_tile_compress(void *arg);
+#endif
+
+static int	tile_nthreads = 1;
+
+/******* set_tilenthreads *****************************************************
+PROTO	int set_tilenthreads(int nthreads)
+PURPOSE	Set the number of threads used for compressing tiles.
+INPUT	Number of threads.
+OUTPUT	RETURN_OK if within limits, RETURN_ERROR otherwise.
+NOTES	.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+int	set_tilenthreads(int nthreads)
+  {
+
+  if (nthreads<1)
+    return RETURN_ERROR;
+
+  tile_nthreads = nthreads;
+
+  return RETURN_OK;
+  }
+
+
+/****** save_tiletab **********************************************************
+PROTO	void save_tiletab(catstruct *cat, tabstruct *tab)
+PURPOSE	Save an in-memory image as a tile-compressed FITS extension.
+INPUT	pointer to the catalog structure,
+	pointer to the table structure.
+OUTPUT	-.
+NOTES	Tiles are made of tab->compress_tilenrow image rows (TILE_DEFNROW by
+	default). With COMPRESS_RICE, pixel values are quantized to
+	tab->compress_qlevel levels per noise r.m.s. (NO_DITHER) and Rice
+	encoded; with COMPRESS_GZIP, pixel values are GZIP'ed losslessly.
+	Tiles are compressed in parallel on set_tilenthreads() threads.
+	Only single precision floating-point images are handled; other
+	images are saved uncompressed. Heap descriptors are 32-bit (1PB), so
+	the compressed data must not exceed INT_MAX bytes.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+void	save_tiletab(catstruct *cat, tabstruct *tab)
+  {
+   tilesetstruct	*tilesets;
+   tilejobstruct	*job;
+   tabstruct		*ctab;
+   char			str[88], card[88],
+			*cardt, *rowbuf,*rowbuft;
+   KINGSIZE_T		heapsize;
+   int			i,n,t, naxis, ntile, tilew, tileh, imh, nplane,
+			ntileh, maxlen, rowlen, tfields, nthreads,
+			compress_type, zbitpix, zval;
+#ifdef USE_THREADS
+   pthread_t		*thread;
+#endif
+
+  compress_type = tab->compress_type;
+#ifndef HAVE_ZLIB
+  if (compress_type == COMPRESS_GZIP)
+    {
+    warning("GZIP tile-compression not available: using RICE for ",
+	cat->filename);
+    compress_type = COMPRESS_RICE;
+    }
+#endif
+  if (tab->bitpix != BP_FLOAT || !tab->bodybuf || !tab->naxis
+	|| !tab->tabsize)
+    {
+    tab->compress_type = COMPRESS_NONE;
+    save_tab(cat, tab);
+    tab->compress_type = compress_type;
+    return;
+    }
+
+/* Make the image header reflect its content */
+  update_tab(tab);
+  update_head(tab);
+
+/* Tiles are made of whole image rows, and do not straddle image planes */
+  naxis = tab->naxis;
+  tilew = tab->naxisn[0];
+  imh = naxis>1? tab->naxisn[1] : 1;
+  tileh = tab->compress_tilenrow>0? tab->compress_tilenrow : TILE_DEFNROW;
+  if (tileh > imh)
+    tileh = imh;
+  ntileh = (imh+tileh-1)/tileh;
+  nplane = (int)(tab->tabsize/tab->bytepix/tilew/imh);
+  ntile = ntileh*nplane;
+  QCALLOC(job, tilejobstruct, ntile);
+  for (t=0; t<ntile; t++)
+    {
+    n = (t%ntileh)*tileh;
+    job[t].pix = (PIXTYPE *)tab->bodybuf
+		+ ((size_t)(t/ntileh)*imh + n)*tilew;
+    job[t].npix = (imh-n<tileh? imh-n : tileh)*tilew;
+    }
+
+/* Compress the tiles */
+  nthreads = tile_nthreads<ntile? tile_nthreads : ntile;
+  if (nthreads<1)
+    nthreads = 1;
+  QMALLOC(tilesets, tilesetstruct, nthreads);
+  for (i=0; i<nthreads; i++)
+    {
+    tilesets[i].job = job;
+    tilesets[i].njob = ntile;
+    tilesets[i].compress_type = compress_type;
+    tilesets[i].qlevel = tab->compress_qlevel>0.0? tab->compress_qlevel
+						: TILE_DEFQLEVEL;
+    tilesets[i].id = i;
+    tilesets[i].nthreads = nthreads;
+    }
+#ifdef USE_THREADS
+  if (nthreads>1)
+    {
+    QMALLOC(thread, pthread_t, nthreads);
+    for (i=0; i<nthreads; i++)
+      if (pthread_create(&thread[i], NULL, pthread_tile_compress,
+		&tilesets[i]))
+        error(EXIT_FAILURE, "*Error*: pthread_create() failed in ",
+		"save_tiletab()");
+    for (i=0; i<nthreads; i++)
+      if (pthread_join(thread[i], NULL))
+        error(EXIT_FAILURE, "*Error*: pthread_join() failed in ",
+		"save_tiletab()");
+    free(thread);
+    }
+  else
+#endif
+    tile_compress(tilesets);
+  free(tilesets);
+
+  heapsize = 0;
+  maxlen = 0;
+  for (t=0; t<ntile; t++)
+    {
+    heapsize += job[t].cbytes;
+    if (job[t].cbytes > maxlen)
+      maxlen = job[t].cbytes;
+    }
+/* PCOUNT and the heap offsets are stored as 32-bit integers */
+  if (heapsize > (KINGSIZE_T)INT_MAX)
+    error(EXIT_FAILURE, "*Error*: compressed image exceeds 2GB in ",
+	cat->filename);
+
+/* Build the binary table header */
+  rowlen = (compress_type==COMPRESS_RICE)? 24 : 8;
+  tfields = (compress_type==COMPRESS_RICE)? 3 : 1;
+  ctab = new_tab(*tab->extname? tab->extname : "COMPRESSED_IMAGE");
+  fitswrite(ctab->headbuf, "EXTNAME ", ctab->extname, H_STRING, T_STRING);
+  fitswrite(ctab->headbuf, "NAXIS1  ", &rowlen, H_INT, T_LONG);
+  fitswrite(ctab->headbuf, "NAXIS2  ", &ntile, H_INT, T_LONG);
+  n = (int)heapsize;
+  fitswrite(ctab->headbuf, "PCOUNT  ", &n, H_INT, T_LONG);
+  fitswrite(ctab->headbuf, "TFIELDS ", &tfields, H_INT, T_LONG);
+  addkeywordto_head(ctab, "TTYPE1  ", "Compressed tile data");
+  fitswrite(ctab->headbuf, "TTYPE1  ", "COMPRESSED_DATA", H_STRING,T_STRING);
+  addkeywordto_head(ctab, "TFORM1  ", "Variable length array of bytes");
+  snprintf(str, sizeof(str), "1PB(%d)", maxlen);
+  fitswrite(ctab->headbuf, "TFORM1  ", str, H_STRING, T_STRING);
+  if (compress_type==COMPRESS_RICE)
+    {
+    addkeywordto_head(ctab, "TTYPE2  ", "Tile quantization scale");
+    fitswrite(ctab->headbuf, "TTYPE2  ", "ZSCALE", H_STRING, T_STRING);
+    addkeywordto_head(ctab, "TFORM2  ", "");
+    fitswrite(ctab->headbuf, "TFORM2  ", "1D", H_STRING, T_STRING);
+    addkeywordto_head(ctab, "TTYPE3  ", "Tile quantization offset");
+    fitswrite(ctab->headbuf, "TTYPE3  ", "ZZERO", H_STRING, T_STRING);
+    addkeywordto_head(ctab, "TFORM3  ", "");
+    fitswrite(ctab->headbuf, "TFORM3  ", "1D", H_STRING, T_STRING);
+    }
+  zval = 1;
+  addkeywordto_head(ctab, "ZIMAGE  ", "This is a tile-compressed image");
+  fitswrite(ctab->headbuf, "ZIMAGE  ", &zval, H_BOOL, T_LONG);
+  addkeywordto_head(ctab, "ZCMPTYPE", "Compression algorithm");
+  fitswrite(ctab->headbuf, "ZCMPTYPE",
+	compress_type==COMPRESS_RICE? "RICE_1" : "GZIP_1",
+	H_STRING, T_STRING);
+  zbitpix = tab->bitpix;
+  addkeywordto_head(ctab, "ZBITPIX ", "Data type of original image");
+  fitswrite(ctab->headbuf, "ZBITPIX ", &zbitpix, H_INT, T_LONG);
+  addkeywordto_head(ctab, "ZNAXIS  ", "Dimension of original image");
+  fitswrite(ctab->headbuf, "ZNAXIS  ", &naxis, H_INT, T_LONG);
+  for (i=0; i<naxis; i++)
+    {
+    snprintf(str, sizeof(str), "ZNAXIS%-2d", i+1);
+    addkeywordto_head(ctab, str, "Length of original image axis");
+    fitswrite(ctab->headbuf, str, &tab->naxisn[i], H_INT, T_LONG);
+    }
+  for (i=0; i<naxis; i++)
+    {
+    snprintf(str, sizeof(str), "ZTILE%-3d", i+1);
+    n = i? (i==1? tileh : 1) : tilew;
+    addkeywordto_head(ctab, str, "Size of tiles to be compressed");
+    fitswrite(ctab->headbuf, str, &n, H_INT, T_LONG);
+    }
+  if (compress_type==COMPRESS_RICE)
+    {
+    addkeywordto_head(ctab, "ZNAME1  ", "Compression parameter name");
+    fitswrite(ctab->headbuf, "ZNAME1  ", "BLOCKSIZE", H_STRING, T_STRING);
+    n = TILE_RICEBLOCK;
+    addkeywordto_head(ctab, "ZVAL1   ", "Pixels per block");
+    fitswrite(ctab->headbuf, "ZVAL1   ", &n, H_INT, T_LONG);
+    addkeywordto_head(ctab, "ZNAME2  ", "Compression parameter name");
+    fitswrite(ctab->headbuf, "ZNAME2  ", "BYTEPIX", H_STRING, T_STRING);
+    n = 4;
+    addkeywordto_head(ctab, "ZVAL2   ", "Bytes per pixel");
+    fitswrite(ctab->headbuf, "ZVAL2   ", &n, H_INT, T_LONG);
+    addkeywordto_head(ctab, "ZQUANTIZ", "Quantization method");
+    fitswrite(ctab->headbuf, "ZQUANTIZ", "NO_DITHER", H_STRING, T_STRING);
+    n = TILE_NULLVAL;
+    addkeywordto_head(ctab, "ZBLANK  ", "Quantized value of NaN pixels");
+    fitswrite(ctab->headbuf, "ZBLANK  ", &n, H_INT, T_LONG);
+    }
+  else
+    {
+    addkeywordto_head(ctab, "ZQUANTIZ", "Quantization method");
+    fitswrite(ctab->headbuf, "ZQUANTIZ", "NONE", H_STRING, T_STRING);
+    }
+/* Append the other keywords of the original image header */
+  for (cardt=tab->headbuf; strncmp(cardt, "END     ", 8); cardt+=80)
+    {
+    if (!strncmp(cardt, "SIMPLE  ", 8) || !strncmp(cardt, "XTENSION", 8)
+	|| !strncmp(cardt, "BITPIX  ", 8) || !strncmp(cardt, "NAXIS", 5)
+	|| !strncmp(cardt, "PCOUNT  ", 8) || !strncmp(cardt, "GCOUNT  ", 8)
+	|| !strncmp(cardt, "EXTEND  ", 8) || !strncmp(cardt, "EXTNAME ", 8)
+	|| !strncmp(cardt, "TFIELDS ", 8) || !strncmp(cardt, "CHECKSUM", 8)
+	|| !strncmp(cardt, "DATASUM ", 8) || !strncmp(cardt, "        ", 8))
+      continue;
+    strncpy(card, cardt, 8);
+    card[8] = '\0';
+    n = addkeywordto_head(ctab, card, "");
+    if (n>=0)
+      memcpy(ctab->headbuf+80*n, cardt, 80);
+    }
+  QFTELL(cat->file, ctab->headpos, cat->filename);
+  tab->headpos = ctab->headpos;
+  QFWRITE(ctab->headbuf, ctab->headnblock*FBSIZE, cat->file, cat->filename);
+
+/* Write the table rows (descriptors and quantization parameters) */
+  QMALLOC(rowbuf, char, (size_t)ntile*rowlen);
+  heapsize = 0;
+  for (rowbuft=rowbuf, t=0; t<ntile; t++, rowbuft+=rowlen)
+    {
+    n = job[t].cbytes;
+    memcpy(rowbuft, &n, 4);
+    n = (int)heapsize;
+    memcpy(rowbuft+4, &n, 4);
+    if (bswapflag)
+      swapbytes(rowbuft, 4, 2);
+    if (compress_type==COMPRESS_RICE)
+      {
+      memcpy(rowbuft+8, &job[t].zscale, 8);
+      memcpy(rowbuft+16, &job[t].zzero, 8);
+      if (bswapflag)
+        swapbytes(rowbuft+8, 8, 2);
+      }
+    heapsize += job[t].cbytes;
+    }
+  QFWRITE(rowbuf, (size_t)ntile*rowlen, cat->file, cat->filename);
+  free(rowbuf);
+
+/* Write the heap */
+  for (t=0; t<ntile; t++)
+    {
+    if (job[t].cbytes)
+      QFWRITE(job[t].cbuf, job[t].cbytes, cat->file, cat->filename);
+    free(job[t].cbuf);
+    }
+  free(job);
+
+/* FITS padding*/
+  pad_tab(cat, (KINGSIZE_T)ntile*rowlen + heapsize);
+
+  free_tab(ctab);
+
+  return;
+  }
+
+
+/****** readtile_head *********************************************************
+PROTO	void readtile_head(tabstruct *tab)
+PURPOSE	Turn the parameters of a tile-compressed image table into those of
+	the original image.
+INPUT	pointer to the table structure.
+OUTPUT	-.
+NOTES	tab->tabsize is left untouched (it still reflects the size of the
+	table in the file). Called by readbasic_head() when ZIMAGE = T.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+void	readtile_head(tabstruct *tab)
+  {
+   char		str[88], key[20];
+   int		i, naxis;
+
+  if (fitsread(tab->headbuf, "ZCMPTYPE", str, H_STRING, T_STRING)
+	!= RETURN_OK)
+    return;
+  if (!strncmp(str, "RICE_1", 6) || !strncmp(str, "RICE_ONE", 8))
+    tab->compress_type = COMPRESS_RICE;
+  else if (!strncmp(str, "GZIP_1", 6))
+    tab->compress_type = COMPRESS_GZIP;
+  else
+    {
+    warning("Unsupported tile-compression algorithm: ", str);
+    return;
+    }
+  if (fitsread(tab->headbuf, "ZBITPIX ", &tab->bitpix, H_INT, T_LONG)
+		!= RETURN_OK
+	|| fitsread(tab->headbuf, "ZNAXIS  ", &naxis, H_INT, T_LONG)
+		!= RETURN_OK)
+    error(EXIT_FAILURE, "*Error*: incomplete tile-compressed image header in ",
+	tab->cat? tab->cat->filename : "internal header");
+  tab->bytepix = tab->bitpix>0?(tab->bitpix/8):(-tab->bitpix/8);
+  tab->naxis = naxis;
+  QFREE(tab->naxisn);
+  QMALLOC(tab->naxisn, int, naxis>0? naxis : 1);
+  for (i=0; i<naxis; i++)
+    {
+    snprintf(key, sizeof(key), "ZNAXIS%-2d", i+1);
+    if (fitsread(tab->headbuf, key, &tab->naxisn[i], H_INT, T_LONG)
+	!= RETURN_OK)
+      error(EXIT_FAILURE, "*Error*: incoherent tile-compressed header in ",
+	tab->cat? tab->cat->filename : "internal header");
+    }
+/* Not a binary table any longer (from the outside) */
+  tab->tfields = 0;
+
+  return;
+  }
+
+
+/****** read_tilebody *********************************************************
+PROTO	void read_tilebody(tabstruct *tab, PIXTYPE *ptr, size_t size)
+PURPOSE	Read (and decompress) floating point values from a tile-compressed
+	image.
+INPUT	A pointer to the tab structure,
+	a pointer to the array in memory,
+	the number of elements to be read.
+OUTPUT	-.
+NOTES	The whole image is decompressed at the first call, and kept in
+	tab->compress_buf until free_body() is called; pixels are then
+	delivered sequentially.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+void	read_tilebody(tabstruct *tab, PIXTYPE *ptr, size_t size)
+  {
+   static float	randval[TILE_NRANDOM];
+   catstruct	*cat;
+   char		str[88], key[20],
+		*tabbuf, *rowt, *heap;
+   unsigned char *cbuf, *gbuf;
+   double	zscale, zzero, dval;
+   PIXTYPE	*pix,*pixt, bs,bz;
+   size_t	npix, tpix;
+   int		*ipix, ztile[16], tstart[16], tdim[16], ntiled[16],
+		d,i,j,t,x, col, zscalecol, zzerocol, pos, rowlen, nrow,
+		tfields, heapoff, cbytes, coff, ndesc, blocksize, zbytepix,
+		quantflag, ditherflag, dither0, zblank, blankflag, iseed,
+		nextrand, naxis, rem, nline, tilew;
+
+  if (!(cat = tab->cat))
+    return;
+  if (!tab->compress_buf)
+    {
+/*-- Table geometry */
+    rowlen = nrow = tfields = 0;
+    fitsread(tab->headbuf, "NAXIS1  ", &rowlen, H_INT, T_LONG);
+    fitsread(tab->headbuf, "NAXIS2  ", &nrow, H_INT, T_LONG);
+    fitsread(tab->headbuf, "TFIELDS ", &tfields, H_INT, T_LONG);
+    heapoff = rowlen*nrow;
+    fitsread(tab->headbuf, "THEAP   ", &heapoff, H_INT, T_LONG);
+    col = zscalecol = zzerocol = -1;
+    ndesc = 0;
+    for (pos=0, i=0; i<tfields; i++)
+      {
+      snprintf(key, sizeof(key), "TTYPE%-3d", i+1);
+      str[0] = '\0';
+      fitsread(tab->headbuf, key, str, H_STRING, T_STRING);
+      if (!strncmp(str, "COMPRESSED_DATA", 15))
+        col = pos;
+      else if (!strncmp(str, "ZSCALE", 6))
+        zscalecol = pos;
+      else if (!strncmp(str, "ZZERO", 5))
+        zzerocol = pos;
+      snprintf(key, sizeof(key), "TFORM%-3d", i+1);
+      str[0] = '\0';
+      fitsread(tab->headbuf, key, str, H_STRING, T_STRING);
+      if (col == pos && !ndesc)
+        ndesc = strchr(str, 'Q')? 8 : 4;
+      if ((zscalecol==pos || zzerocol==pos) && !strchr(str, 'D'))
+        error(EXIT_FAILURE, "*Error*: unsupported ZSCALE/ZZERO format in ",
+		cat->filename);
+      pos += tile_tformsize(str);
+      }
+    if (col<0 || pos != rowlen)
+      error(EXIT_FAILURE, "*Error*: malformed tile-compressed image in ",
+		cat->filename);
+/*-- Compression parameters */
+    blocksize = TILE_RICEBLOCK;
+    zbytepix = 4;
+    for (i=1; i<10; i++)
+      {
+      snprintf(key, sizeof(key), "ZNAME%-3d", i);
+      if (fitsread(tab->headbuf, key, str, H_STRING, T_STRING) != RETURN_OK)
+        break;
+      snprintf(key, sizeof(key), "ZVAL%-4d", i);
+      if (!strncmp(str, "BLOCKSIZE", 9))
+        fitsread(tab->headbuf, key, &blocksize, H_INT, T_LONG);
+      else if (!strncmp(str, "BYTEPIX", 7))
+        fitsread(tab->headbuf, key, &zbytepix, H_INT, T_LONG);
+      }
+    quantflag = (tab->bitpix<0 && zscalecol>=0 && zzerocol>=0);
+    ditherflag = 0;
+    dither0 = 1;
+    if (fitsread(tab->headbuf, "ZQUANTIZ", str, H_STRING, T_STRING)
+	== RETURN_OK)
+      {
+      if (!strncmp(str, "SUBTRACTIVE_DITHER_1", 20))
+        ditherflag = 1;
+      else if (!strncmp(str, "SUBTRACTIVE_DITHER_2", 20))
+        ditherflag = 2;
+      else if (!strncmp(str, "NONE", 4))
+        quantflag = 0;
+      }
+    fitsread(tab->headbuf, "ZDITHER0", &dither0, H_INT, T_LONG);
+    zblank = TILE_NULLVAL;
+    blankflag = (fitsread(tab->headbuf, "ZBLANK  ", &zblank, H_INT, T_LONG)
+		== RETURN_OK) || quantflag;
+    if (tab->compress_type==COMPRESS_RICE && !quantflag && tab->bitpix<0)
+      error(EXIT_FAILURE, "*Error*: missing quantization parameters in ",
+		cat->filename);
+#ifndef HAVE_ZLIB
+    if (tab->compress_type==COMPRESS_GZIP)
+      error(EXIT_FAILURE, "*Error*: GZIP tile-compression not supported"
+		" (zlib missing) in ", cat->filename);
+#endif
+    if (ditherflag)
+      {
+/*---- Random sequence of the FITS tiled image convention */
+       double	seed, temp;
+
+      for (seed=1.0, i=0; i<TILE_NRANDOM; i++)
+        {
+        temp = 16807.0*seed;
+        seed = temp - 2147483647.0*(int)(temp/2147483647.0);
+        randval[i] = (float)(seed/2147483647.0);
+        }
+      }
+/*-- Tile geometry */
+    naxis = tab->naxis;
+    npix = 1;
+    for (d=0; d<naxis; d++)
+      {
+      snprintf(key, sizeof(key), "ZTILE%-3d", d+1);
+      ztile[d] = d? 1 : tab->naxisn[0];
+      fitsread(tab->headbuf, key, &ztile[d], H_INT, T_LONG);
+      ntiled[d] = (tab->naxisn[d]+ztile[d]-1)/ztile[d];
+      npix *= tab->naxisn[d];
+      }
+/*-- Read the whole table with its heap */
+    QMALLOC(tabbuf, char, tab->tabsize? tab->tabsize : 1);
+    QFSEEK(cat->file, tab->bodypos, SEEK_SET, cat->filename);
+    QFREAD(tabbuf, tab->tabsize, cat->file, cat->filename);
+    heap = tabbuf + heapoff;
+    QMALLOC(pix, PIXTYPE, npix);
+    tpix = 1;
+    for (d=0; d<naxis; d++)
+      tpix *= ztile[d];
+    QMALLOC(ipix, int, tpix);
+    QMALLOC(gbuf, unsigned char, tpix*(zbytepix>tab->bytepix?
+					zbytepix : tab->bytepix));
+    bs = (PIXTYPE)tab->bscale;
+    bz = (PIXTYPE)tab->bzero;
+    for (t=0, rowt=tabbuf; t<nrow; t++, rowt+=rowlen)
+      {
+/*---- Locate the tile in the image */
+      rem = t;
+      tpix = 1;
+      for (d=0; d<naxis; d++)
+        {
+        tstart[d] = (rem%ntiled[d])*ztile[d];
+        rem /= ntiled[d];
+        tdim[d] = tab->naxisn[d]-tstart[d];
+        if (tdim[d] > ztile[d])
+          tdim[d] = ztile[d];
+        tpix *= tdim[d];
+        }
+/*---- Compressed data descriptor (big-endian integers) */
+      cbytes = (int)tile_descval((unsigned char *)rowt+col, ndesc);
+      coff = (int)tile_descval((unsigned char *)rowt+col+ndesc, ndesc);
+      cbuf = (unsigned char *)heap + coff;
+      zscale = 1.0;
+      zzero = 0.0;
+      if (quantflag)
+        {
+        memcpy(&zscale, rowt+zscalecol, 8);
+        memcpy(&zzero, rowt+zzerocol, 8);
+        if (bswapflag)
+          {
+          swapbytes(&zscale, 8, 1);
+          swapbytes(&zzero, 8, 1);
+          }
+        }
+/*---- Decompress into a tile of (integer or floating-point) pixels */
+      pixt = pix;
+      if (tab->compress_type==COMPRESS_RICE)
+        tile_ricedecomp(cbuf, cbytes, ipix, (int)tpix, zbytepix, blocksize);
+#ifdef HAVE_ZLIB
+      else
+        {
+        tile_gunzip(cbuf, cbytes, gbuf,
+		(int)tpix*(quantflag? 4 : tab->bytepix));
+        if (bswapflag)
+          swapbytes(gbuf, quantflag? 4 : tab->bytepix, (int)tpix);
+        if (quantflag || tab->bitpix==BP_LONG)
+          memcpy(ipix, gbuf, tpix*sizeof(int));
+        }
+#endif
+/*---- Convert to PIXTYPE */
+      if (tab->compress_type==COMPRESS_GZIP && !quantflag)
+        {
+        for (j=0; j<(int)tpix; j++)
+          switch(tab->bitpix)
+            {
+            case BP_FLOAT:
+              ((PIXTYPE *)ipix)[j] = ((float *)gbuf)[j];
+              break;
+            case BP_DOUBLE:
+              ((PIXTYPE *)ipix)[j] = (PIXTYPE)((double *)gbuf)[j];
+              break;
+            case BP_BYTE:
+              ((PIXTYPE *)ipix)[j] = gbuf[j]*bs + bz;
+              break;
+            case BP_SHORT:
+              ((PIXTYPE *)ipix)[j] = ((short *)gbuf)[j]*bs + bz;
+              break;
+            case BP_LONG:
+              ((PIXTYPE *)ipix)[j] = ipix[j]*bs + bz;
+              break;
+            default:
+              error(EXIT_FAILURE, "*Error*: unsupported ZBITPIX in ",
+			cat->filename);
+            }
+        }
+      else if (quantflag)
+        {
+        iseed = (t + dither0 - 1)%TILE_NRANDOM;
+        nextrand = ditherflag? (int)(randval[iseed]*500.0) : 0;
+        for (j=0; j<(int)tpix; j++)
+          {
+          if (blankflag && ipix[j]==zblank)
+            ((PIXTYPE *)ipix)[j] = (PIXTYPE)sqrt(-1.0);	/* NaN */
+          else if (ditherflag==2 && ipix[j]==-2147483646)
+            ((PIXTYPE *)ipix)[j] = 0.0;
+          else
+            {
+            dval = ditherflag?
+		((double)ipix[j] - randval[nextrand] + 0.5)*zscale + zzero
+		: (double)ipix[j]*zscale + zzero;
+            ((PIXTYPE *)ipix)[j] = (PIXTYPE)dval;
+            }
+          if (ditherflag && ++nextrand == TILE_NRANDOM)
+            {
+            if (++iseed == TILE_NRANDOM)
+              iseed = 0;
+            nextrand = (int)(randval[iseed]*500.0);
+            }
+          }
+        }
+      else
+        for (j=0; j<(int)tpix; j++)
+          ((PIXTYPE *)ipix)[j] = ipix[j]*bs + bz;
+/*---- Paste the tile into the image, line by line */
+      tilew = tdim[0];
+      nline = (int)(tpix/tilew);
+      for (j=0; j<nline; j++)
+        {
+        rem = j;
+        pos = tstart[0];
+        for (npix=tab->naxisn[0], d=1; d<naxis; d++)
+          {
+          pos += (tstart[d] + rem%tdim[d])*(int)npix;
+          rem /= tdim[d];
+          npix *= tab->naxisn[d];
+          }
+        for (x=0; x<tilew; x++)
+          pixt[pos+x] = ((PIXTYPE *)ipix)[j*tilew+x];
+        }
+      }
+    free(ipix);
+    free(gbuf);
+    free(tabbuf);
+    tab->compress_buf = (char *)pix;
+    tab->compress_bufptr = (char *)pix;
+    npix = 1;
+    for (d=0; d<tab->naxis; d++)
+      npix *= tab->naxisn[d];
+    tab->compress_npix = npix;
+    }
+
+/* Deliver pixels */
+  if (size > tab->compress_npix)
+    error(EXIT_FAILURE, "*Error*: reading beyond the end of ",
+	cat->filename);
+  memcpy(ptr, tab->compress_bufptr, size*sizeof(PIXTYPE));
+  tab->compress_bufptr += size*sizeof(PIXTYPE);
+  tab->compress_npix -= size;
+
+  return;
+  }
+
+
+/****** tile_compress *********************************************************
+PROTO	void tile_compress(tilesetstruct *tileset)
+PURPOSE	Compress a subset of tiles.
+INPUT	Pointer to the tile set.
+OUTPUT	-.
+NOTES	Thread tileset->id processes tiles id, id+nthreads, id+2*nthreads...
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	tile_compress(tilesetstruct *tileset)
+  {
+   tilejobstruct	*job;
+   tilebitstruct	bits;
+   float		*work;
+   int			*ipix,
+			t, npixmax;
+
+  npixmax = 1;
+  for (t=tileset->id; t<tileset->njob; t+=tileset->nthreads)
+    if (tileset->job[t].npix > npixmax)
+      npixmax = tileset->job[t].npix;
+  QMALLOC(ipix, int, npixmax);
+  QMALLOC(work, float, npixmax);
+  for (t=tileset->id; t<tileset->njob; t+=tileset->nthreads)
+    {
+    job = &tileset->job[t];
+    job->zscale = 1.0;
+    job->zzero = 0.0;
+    if (tileset->compress_type == COMPRESS_RICE)
+      {
+      tile_quantize(job->pix, job->npix, tileset->qlevel, ipix, work,
+		&job->zscale, &job->zzero);
+      bits.size = (size_t)job->npix*4 + 64;
+      QMALLOC(bits.buf, unsigned char, bits.size);
+      bits.pos = 0;
+      job->cbytes = tile_ricecomp(ipix, job->npix, &bits);
+      job->cbuf = bits.buf;
+      }
+#ifdef HAVE_ZLIB
+    else
+      {
+/*---- Lossless: big-endian pixel values are GZIP'ed */
+      if (bswapflag)
+        copyswapbytes(job->pix, work, 4, job->npix);
+      else
+        memcpy(work, job->pix, job->npix*sizeof(float));
+      job->cbytes = tile_gzip((unsigned char *)work, job->npix*4,
+		&job->cbuf);
+      }
+#endif
+    }
+  free(ipix);
+  free(work);
+
+  return;
+  }
+
+
+#ifdef USE_THREADS
+/****** pthread_tile_compress *************************************************
+PROTO	void *pthread_tile_compress(void *arg)
+PURPOSE	Thread wrapper for tile_compress().
+INPUT	Pointer to the tile set.
+OUTPUT	NULL void pointer.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	*pthread_tile_compress(void *arg)
+  {
+  tile_compress((tilesetstruct *)arg);
+
+  pthread_exit(NULL);
+
+  return (void *)NULL;
+  }
+#endif
+
+
+/****** tile_quantize *********************************************************
+PROTO	void tile_quantize(PIXTYPE *pix, int npix, double qlevel, int *ipix,
+			float *work, double *zscale, double *zzero)
+PURPOSE	Quantize floating-point pixel values in a tile.
+INPUT	Pointer to the input pixels,
+	number of pixels,
+	quantization level (number of levels per noise r.m.s.),
+	pointer to the output integer array,
+	pointer to a work array (npix elements),
+	pointer to the output scaling factor,
+	pointer to the output offset.
+OUTPUT	-.
+NOTES	The noise r.m.s. is estimated from the median absolute difference
+	between consecutive pixels. Non-finite values are set to
+	TILE_NULLVAL.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	tile_quantize(PIXTYPE *pix, int npix, double qlevel,
+			int *ipix, float *work, double *zscale, double *zzero)
+  {
+   double	sigma, dval, dval2, min,max, scale,zero;
+   float	prev;
+   int		i, n, nfinite;
+
+  min = 1e30;
+  max = -1e30;
+  n = nfinite = 0;
+  prev = 0.0;
+  dval2 = 0.0;
+  for (i=0; i<npix; i++)
+    {
+    if (!finite(pix[i]))
+      continue;
+    if (pix[i]<min)
+      min = pix[i];
+    if (pix[i]>max)
+      max = pix[i];
+    if (nfinite++)
+      {
+      dval = pix[i] - prev;
+      dval2 += dval*dval;
+      work[n++] = (float)fabs(dval);
+      }
+    prev = pix[i];
+    }
+
+  if (!nfinite || max<=min)
+    {
+/*-- Empty or constant tile */
+    scale = 1.0;
+    zero = nfinite? min : 0.0;
+    }
+  else
+    {
+    sigma = n? 1.4826*tile_median(work, n)/sqrt(2.0) : 0.0;
+    if (sigma<=0.0)
+      sigma = sqrt(dval2/n/2.0);
+    if (sigma<=0.0)
+      sigma = max - min;
+    scale = sigma/qlevel;
+    if ((max-min)/scale > TILE_QMAX)
+      scale = (max-min)/TILE_QMAX;
+    zero = min;
+    }
+
+  for (i=0; i<npix; i++)
+    ipix[i] = finite(pix[i])?
+		(int)floor((pix[i]-zero)/scale + 0.5) : TILE_NULLVAL;
+
+  *zscale = scale;
+  *zzero = zero;
+
+  return;
+  }
+
+
+/****** tile_median ***********************************************************
+PROTO	float tile_median(float *data, int n)
+PURPOSE	Find the median of an array (which is modified).
+INPUT	Pointer to the data,
+	number of elements.
+OUTPUT	Median value.
+NOTES	Wirth's selection algorithm.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static float	tile_median(float *data, int n)
+  {
+   float	x, t;
+   int		i,j,l,m,k;
+
+  k = n/2;
+  l = 0;
+  m = n-1;
+  while (l<m)
+    {
+    x = data[k];
+    i = l;
+    j = m;
+    do
+      {
+      while (data[i]<x)
+        i++;
+      while (x<data[j])
+        j--;
+      if (i<=j)
+        {
+        t = data[i];
+        data[i] = data[j];
+        data[j] = t;
+        i++;
+        j--;
+        }
+      } while (i<=j);
+    if (j<k)
+      l = i;
+    if (k<i)
+      m = j;
+    }
+
+  return data[k];
+  }
+
+
+/****** tile_putbits **********************************************************
+PROTO	void tile_putbits(tilebitstruct *bits, unsigned int val, int n)
+PURPOSE	Append the n lowest bits of a value to a bit stream.
+INPUT	Pointer to the bit stream,
+	value,
+	number of bits (<=32).
+OUTPUT	-.
+NOTES	The output buffer is expanded as needed.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	tile_putbits(tilebitstruct *bits, unsigned int val, int n)
+  {
+  if (!n)
+    return;
+  bits->acc = (bits->acc<<n) | ((unsigned long long)val & ((1ULL<<n)-1));
+  bits->nacc += n;
+  while (bits->nacc>=8)
+    {
+    if (bits->pos >= bits->size)
+      {
+      bits->size *= 2;
+      QREALLOC(bits->buf, unsigned char, bits->size);
+      }
+    bits->nacc -= 8;
+    bits->buf[bits->pos++] = (unsigned char)(bits->acc>>bits->nacc);
+    }
+
+  return;
+  }
+
+
+/****** tile_getbits **********************************************************
+PROTO	unsigned int tile_getbits(tilebitstruct *bits, int n)
+PURPOSE	Extract the next n bits from a bit stream.
+INPUT	Pointer to the bit stream,
+	number of bits (<=32).
+OUTPUT	Value.
+NOTES	Reading beyond the end of the stream returns 0's.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static unsigned int	tile_getbits(tilebitstruct *bits, int n)
+  {
+  if (!n)
+    return 0;
+  while (bits->nacc<n)
+    {
+    bits->acc = (bits->acc<<8)
+		| (bits->buf<bits->bufend? *(bits->buf++) : 0);
+    bits->nacc += 8;
+    }
+  bits->nacc -= n;
+
+  return (unsigned int)((bits->acc>>bits->nacc) & ((1ULL<<n)-1));
+  }
+
+
+/****** tile_ricecomp *********************************************************
+PROTO	int tile_ricecomp(int *ipix, int npix, tilebitstruct *bits)
+PURPOSE	Rice-compress an array of 32-bit integers.
+INPUT	Pointer to the integer array,
+	number of elements,
+	pointer to the (allocated) output bit stream.
+OUTPUT	Number of bytes in the compressed stream.
+NOTES	Follows the RICE_1 algorithm of the FITS tiled image convention
+	(BYTEPIX=4, BLOCKSIZE=TILE_RICEBLOCK).
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static int	tile_ricecomp(int *ipix, int npix, tilebitstruct *bits)
+  {
+   unsigned int	diff[TILE_RICEBLOCK],
+		psum, top, v, fsmask;
+   double	pixelsum, dpsum;
+   int		i,j, fs, lastpix, nextpix, pdiff, thisblock;
+   const int	fsbits = 5, fsmax = 25, bbits = 32;
+
+  bits->acc = 0;
+  bits->nacc = 0;
+  if (!npix)
+    return 0;
+  lastpix = ipix[0];
+  tile_putbits(bits, (unsigned int)lastpix, bbits);
+  for (i=0; i<npix; i+=TILE_RICEBLOCK)
+    {
+    thisblock = npix-i<TILE_RICEBLOCK? npix-i : TILE_RICEBLOCK;
+    pixelsum = 0.0;
+    for (j=0; j<thisblock; j++)
+      {
+      nextpix = ipix[i+j];
+      pdiff = (int)((unsigned int)nextpix - (unsigned int)lastpix);
+      diff[j] = pdiff<0? ~((unsigned int)pdiff<<1) : ((unsigned int)pdiff<<1);
+      pixelsum += diff[j];
+      lastpix = nextpix;
+      }
+    dpsum = (pixelsum - (thisblock/2) - 1)/thisblock;
+    if (dpsum < 0.0)
+      dpsum = 0.0;
+    psum = ((unsigned int)dpsum) >> 1;
+    for (fs=0; psum>0; fs++)
+      psum >>= 1;
+    if (fs >= fsmax)
+      {
+/*---- High entropy: raw differences */
+      tile_putbits(bits, fsmax+1, fsbits);
+      for (j=0; j<thisblock; j++)
+        tile_putbits(bits, diff[j], bbits);
+      }
+    else if (fs==0 && pixelsum==0.0)
+/*---- Low entropy: all differences are 0 */
+      tile_putbits(bits, 0, fsbits);
+    else
+      {
+      tile_putbits(bits, fs+1, fsbits);
+      fsmask = (1U<<fs) - 1;
+      for (j=0; j<thisblock; j++)
+        {
+        v = diff[j];
+/*------ Unary-coded top bits followed by the fs lowest bits */
+        for (top = v>>fs; top>=32; top-=32)
+          tile_putbits(bits, 0, 32);
+        tile_putbits(bits, 1, top+1);
+        tile_putbits(bits, v&fsmask, fs);
+        }
+      }
+    }
+
+/* Flush the remaining bits */
+  if (bits->nacc)
+    tile_putbits(bits, 0, 8-bits->nacc);
+
+  return (int)bits->pos;
+  }
+
+
+/****** tile_ricedecomp *******************************************************
+PROTO	int tile_ricedecomp(unsigned char *cbuf, int cbytes, int *ipix,
+			int npix, int bytepix, int nblock)
+PURPOSE	Decompress a Rice-compressed array of integers.
+INPUT	Pointer to the compressed stream,
+	size of the compressed stream,
+	pointer to the output integer array,
+	number of elements,
+	number of bytes per original pixel (1, 2 or 4),
+	block size.
+OUTPUT	RETURN_OK if everything went fine, RETURN_ERROR otherwise.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static int	tile_ricedecomp(unsigned char *cbuf, int cbytes, int *ipix,
+			int npix, int bytepix, int nblock)
+  {
+   tilebitstruct	bits;
+   unsigned int		diff, lastpix;
+   int			i,j, fs, fsbits, fsmax, bbits, thisblock, nzero;
+
+  switch(bytepix)
+    {
+    case 1:
+      fsbits = 3; fsmax = 6; bbits = 8;
+      break;
+    case 2:
+      fsbits = 4; fsmax = 14; bbits = 16;
+      break;
+    case 4:
+      fsbits = 5; fsmax = 25; bbits = 32;
+      break;
+    default:
+      error(EXIT_FAILURE, "*Error*: unsupported Rice BYTEPIX value", "");
+      return RETURN_ERROR;
+    }
+  bits.buf = cbuf;
+  bits.bufend = cbuf + cbytes;
+  bits.acc = 0;
+  bits.nacc = 0;
+  lastpix = tile_getbits(&bits, bbits);
+  for (i=0; i<npix; i+=nblock)
+    {
+    thisblock = npix-i<nblock? npix-i : nblock;
+    fs = (int)tile_getbits(&bits, fsbits) - 1;
+    for (j=0; j<thisblock; j++)
+      {
+      if (fs<0)
+        diff = 0;
+      else if (fs==fsmax)
+        diff = tile_getbits(&bits, bbits);
+      else
+        {
+        for (nzero=0; !tile_getbits(&bits, 1); nzero++)
+          if (bits.buf>=bits.bufend && !bits.nacc)
+            return RETURN_ERROR;
+        diff = ((unsigned int)nzero<<fs) | tile_getbits(&bits, fs);
+        }
+      diff = (diff&1)? ~(diff>>1) : (diff>>1);
+      lastpix += diff;
+      switch(bytepix)
+        {
+        case 1:
+          ipix[i+j] = (int)(unsigned char)lastpix;
+          break;
+        case 2:
+          ipix[i+j] = (int)(short)lastpix;
+          break;
+        default:
+          ipix[i+j] = (int)lastpix;
+          break;
+        }
+      }
+    }
+
+  return RETURN_OK;
+  }
+
+
+/****** tile_descval *********************************************************
+PROTO	size_t tile_descval(unsigned char *ptr, int nb)
+PURPOSE	Decode a big-endian unsigned integer from a table descriptor.
+INPUT	Pointer to the first byte,
+	number of bytes (4 or 8).
+OUTPUT	Value.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static size_t	tile_descval(unsigned char *ptr, int nb)
+  {
+   size_t	val;
+   int		i;
+
+  for (val=0, i=0; i<nb; i++)
+    val = (val<<8) | ptr[i];
+
+  return val;
+  }
+
+
+/****** tile_tformsize ********************************************************
+PROTO	int tile_tformsize(char *tform)
+PURPOSE	Return the size in bytes of a binary table field, including
+	variable-length array descriptors.
+INPUT	TFORM string.
+OUTPUT	Size in bytes.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static int	tile_tformsize(char *tform)
+  {
+   char	*str;
+   int	n;
+
+  n = (int)strtol(tform, &str, 10);
+  if (str==tform)
+    n = 1;
+  switch(*str)
+    {
+    case 'L':
+    case 'B':
+    case 'A':
+      return n;
+    case 'X':
+      return (n+7)/8;
+    case 'I':
+      return 2*n;
+    case 'J':
+    case 'E':
+      return 4*n;
+    case 'K':
+    case 'D':
+    case 'C':
+    case 'P':
+      return 8*n;
+    case 'M':
+    case 'Q':
+      return 16*n;
+    default:
+      return 0;
+    }
+  }
+
+
+#ifdef HAVE_ZLIB
+/****** tile_gzip *************************************************************
+PROTO	int tile_gzip(unsigned char *buf, int nbytes, unsigned char **cbuf)
+PURPOSE	GZIP a buffer.
+INPUT	Pointer to the input buffer,
+	number of bytes,
+	pointer to the output buffer pointer (allocated here).
+OUTPUT	Number of compressed bytes.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static int	tile_gzip(unsigned char *buf, int nbytes, unsigned char **cbuf)
+  {
+   z_stream	z;
+   int		size;
+
+  memset(&z, 0, sizeof(z));
+/* windowBits+16 selects the gzip format */
+  if (deflateInit2(&z, 1, Z_DEFLATED, 15+16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    error(EXIT_FAILURE, "*Error*: zlib initialization failed in ",
+	"tile_gzip()");
+  size = (int)deflateBound(&z, (uLong)nbytes);
+  QMALLOC(*cbuf, unsigned char, size);
+  z.next_in = buf;
+  z.avail_in = (uInt)nbytes;
+  z.next_out = *cbuf;
+  z.avail_out = (uInt)size;
+  if (deflate(&z, Z_FINISH) != Z_STREAM_END)
+    error(EXIT_FAILURE, "*Error*: GZIP compression failed in ",
+	"tile_gzip()");
+  size = (int)z.total_out;
+  deflateEnd(&z);
+
+  return size;
+  }
+
+
+/****** tile_gunzip ***********************************************************
+PROTO	int tile_gunzip(unsigned char *cbuf, int cbytes, unsigned char *buf,
+			int nbytes)
+PURPOSE	GUNZIP a buffer.
+INPUT	Pointer to the compressed buffer,
+	number of compressed bytes,
+	pointer to the output buffer,
+	expected number of output bytes.
+OUTPUT	RETURN_OK if everything went fine, RETURN_ERROR otherwise.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static int	tile_gunzip(unsigned char *cbuf, int cbytes, unsigned char *buf,
+			int nbytes)
+  {
+   z_stream	z;
+   int		status;
+
+  memset(&z, 0, sizeof(z));
+/* windowBits+32 enables automatic zlib/gzip header detection */
+  if (inflateInit2(&z, 15+32) != Z_OK)
+    error(EXIT_FAILURE, "*Error*: zlib initialization failed in ",
+	"tile_gunzip()");
+  z.next_in = cbuf;
+  z.avail_in = (uInt)cbytes;
+  z.next_out = buf;
+  z.avail_out = (uInt)nbytes;
+  status = inflate(&z, Z_FINISH);
+  inflateEnd(&z);
+  if (status != Z_STREAM_END || (int)z.total_out != nbytes)
+    error(EXIT_FAILURE, "*Error*: corrupted GZIP'ed tile", "");
+
+  return RETURN_OK;
+  }
+#endif
+
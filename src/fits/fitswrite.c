@@ -23,7 +23,7 @@
 *	along with AstrOmatic software.
 *	If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		09/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -86,9 +86,13 @@ PURPOSE	Save a FITS table.
 INPUT	pointer to the catalog structure,
 	pointer to the table structure.
 OUTPUT	-.
-NOTES	-.
+NOTES	Data are staged through a buffer of at most DATA_BUFSIZE bytes,
+	byte-swapped (if needed) while being copied, so that the source data
+	are left untouched, and written in large chunks.
+	Images with compress_type set to COMPRESS_RICE or COMPRESS_GZIP are
+	written as tile-compressed binary tables (see save_tiletab()).
 AUTHOR	E. Bertin (IAP & Leiden observatory)
-VERSION	02/11/2009
+VERSION	19/10/2026
  ***/
 void	save_tab(catstruct *cat, tabstruct *tab)
 
@@ -98,11 +102,18 @@ void	save_tab(catstruct *cat, tabstruct *tab)
    tabstruct	*keytab;
    KINGSIZE_T	tabsize;
    KINGLONG	size;
-   int		b,j,k,o, nbytes,nkey,nobj,spoonful,
+   int		j,k,o,r, nbytes,nkey,nobj,nrow,nrowmax,spoonful,
 		tabflag, larrayin,larrayout;
-   char		*buf, *inbuf, *outbuf, *fptr,*ptr;
+   char		*buf, *inbuf, *outbuf, *fptr,*ptr,*ptrin;
    int		esize;
 
+/*  Tile-compressed images are handled separately */
+  if ((tab->compress_type==COMPRESS_RICE || tab->compress_type==COMPRESS_GZIP)
+	&& !tab->nkey)
+    {
+    save_tiletab(cat, tab);
+    return;
+    }
 /*  The header itself*/
   tabflag = save_head(cat, tab)==RETURN_OK?1:0;
 /*  Allocate memory for the output buffer */
@@ -111,8 +122,14 @@ void	save_tab(catstruct *cat, tabstruct *tab)
   inbuf = NULL;		/* to satisfy gcc -Wall */
   if (tabflag)
     {
-/*-- If segment is a binary table, save it row by row */
-    QMALLOC(outbuf, char, (larrayout = tab->naxisn[0]));
+/*-- If segment is a binary table, save it by chunks of rows */
+    larrayout = tab->naxisn[0];
+    nrowmax = larrayout? DATA_BUFSIZE/larrayout : 1;
+    if (nrowmax<1)
+      nrowmax = 1;
+    if (nrowmax>tab->naxisn[1] && tab->naxisn[1]>0)
+      nrowmax = tab->naxisn[1];
+    QMALLOC(outbuf, char, (size_t)nrowmax*larrayout);
     nkey = tab->nkey;
     tabsize = larrayin = 0;
     for (j=tab->nseg; j--;)
@@ -130,31 +147,41 @@ void	save_tab(catstruct *cat, tabstruct *tab)
 /*---- If table contains some keys with no ptrs, we have to access a file */
       if (keytab)
         {
-        QMALLOC(inbuf, char, (larrayin = keytab->naxisn[0]));
+        QMALLOC(inbuf, char, (size_t)nrowmax*(larrayin = keytab->naxisn[0]));
         if (open_cat(tabcat, READ_ONLY) != RETURN_OK)
           error(EXIT_FAILURE, "*Error*: Cannot access ", tabcat->filename);
         QFSEEK(tabcat->file, keytab->bodypos, SEEK_SET, tabcat->filename);
         }
       nobj = tab->naxisn[1];
-      for (o=0; o<nobj; o++)
+      for (o=0; o<nobj; o+=nrow)
         {
+        nrow = nobj-o<nrowmax? nobj-o : nrowmax;
         if (keytab)
-          QFREAD(inbuf, larrayin, tabcat->file, tabcat->filename);
+          QFREAD(inbuf, (size_t)nrow*larrayin, tabcat->file,
+		tabcat->filename);
+/*------ Fill the staging buffer column by column */
         fptr = outbuf;
         for (k=nkey; k--; key = key->nextkey)
           {
           nbytes = key->nbytes;
-          ptr = key->ptr? (char *)key->ptr+nbytes*o:inbuf+key->pos;
-          for (b=nbytes; b--;)
-            *(fptr++) = *(ptr++);
-          if (bswapflag)
-            if (key->ptr)
-              {
-              esize = t_size[key->ttype];
-              swapbytes(fptr-nbytes, esize, nbytes/esize);
-              }
+          if (key->ptr)
+            {
+            ptrin = (char *)key->ptr+(size_t)nbytes*o;
+            esize = t_size[key->ttype];
+            if (bswapflag && esize>1)
+              for (ptr=fptr, r=nrow; r--; ptrin+=nbytes, ptr+=larrayout)
+                copyswapbytes(ptrin, ptr, esize, nbytes/esize);
+            else
+              for (ptr=fptr, r=nrow; r--; ptrin+=nbytes, ptr+=larrayout)
+                memcpy(ptr, ptrin, (size_t)nbytes);
+            }
+          else
+            for (ptrin=inbuf+key->pos, ptr=fptr, r=nrow; r--;
+			ptrin+=larrayin, ptr+=larrayout)
+              memcpy(ptr, ptrin, (size_t)nbytes);
+          fptr += nbytes;
           }
-        QFWRITE(outbuf, larrayout, cat->file, cat->filename);
+        QFWRITE(outbuf, (size_t)nrow*larrayout, cat->file, cat->filename);
         }
       if (keytab)
         {
@@ -178,11 +205,23 @@ void	save_tab(catstruct *cat, tabstruct *tab)
       if (tab->bodybuf)
         {
 /*------ A body is present in memory and needs to be written */
-        if (bswapflag)
-          swapbytes(tab->bodybuf, tab->bytepix, tabsize/tab->bytepix);
-        QFWRITE(tab->bodybuf, (size_t)tabsize, cat->file, cat->filename);
-        if (bswapflag)
-          swapbytes(tab->bodybuf, tab->bytepix, tabsize/tab->bytepix);
+        if (bswapflag && tab->bytepix>1)
+          {
+/*-------- Swap while copying to the staging buffer */
+          spoonful = size<DATA_BUFSIZE?size:DATA_BUFSIZE;
+          spoonful -= spoonful%tab->bytepix;
+          QMALLOC(buf, char, spoonful);
+          for (ptrin=tab->bodybuf; size>0; size -= spoonful, ptrin+=spoonful)
+            {
+            if (spoonful>size)
+              spoonful = size;
+            copyswapbytes(ptrin, buf, tab->bytepix, spoonful/tab->bytepix);
+            QFWRITE(buf, spoonful, cat->file, cat->filename);
+            }
+          free(buf);
+          }
+        else
+          QFWRITE(tab->bodybuf, (size_t)tabsize, cat->file, cat->filename);
         }
       else
 /*------ The body should be copied from the source tab */
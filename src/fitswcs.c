@@ -23,7 +23,7 @@
 *	along with AstrOmatic software.
 *	If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		10/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -47,7 +47,10 @@
 #include	"wcs/wcs.h"
 #include	"wcs/lin.h"
 #include	"wcs/tnx.h"
-#include	"wcs/poly.h"
+#include	"poly.h"
+
+static int	wcs_batchflag(wcsstruct *wcs);
+
 
 /******* copy_wcs ************************************************************
 PROTO	wcsstruct *copy_wcs(wcsstruct *wcsin)
@@ -918,7 +921,7 @@ INPUT	WCS structure.
 OUTPUT	-.
 NOTES	.
 AUTHOR	E. Bertin (IAP)
-VERSION	24/08/2010
+VERSION	19/10/2026
  ***/
 void	range_wcs(wcsstruct *wcs)
 
@@ -926,6 +929,7 @@ void	range_wcs(wcsstruct *wcs)
    double		step[NAXIS], raw[NAXIS], rawmin[NAXIS],
 			world[NAXIS], world2[NAXIS];
    double		*worldmin, *worldmax, *scale, *worldc,
+			*rawbuf,*rawt, *worldbuf,*worldt,
 			rad, radmax, lc;
    int			linecount[NAXIS];
    int			i,j, naxis, npoints, lng,lat;
@@ -992,33 +996,14 @@ void	range_wcs(wcsstruct *wcs)
     linecount[i] = 0;
     }
 
-  radmax = 0.0;
-  worldc = wcs->wcsscalepos;
-
-  for (j=npoints; j--;)
+/* Convert the whole grid at once */
+  QMALLOC(rawbuf, double, naxis*npoints);
+  QMALLOC(worldbuf, double, naxis*npoints);
+  rawt = rawbuf;
+  for (j=npoints; j--; rawt+=naxis)
     {
-    raw_to_wcs(wcs, raw, world);
-/*-- Compute maximum distance to center */
-    if ((rad=wcs_dist(wcs, world, worldc)) > radmax)
-      radmax = rad;
     for (i=0; i<naxis; i++)
-      {
-/*---- Handle longitudes around 0 */
-      if (i==lng)
-        {
-        world[i] -= lc;
-        if (world[i]>180.0)
-          world[i] -= 360.0;
-        else if (world[i] <= -180.0)
-          world[i] += 360.0;
-        }
-      if (world[i]<worldmin[i])
-        worldmin[i] = world[i];
-      if (world[i]>worldmax[i])
-        worldmax[i] = world[i];
-      }
-
-
+      rawt[i] = raw[i];
     for (i=0; i<naxis; i++)
       {
       raw[i] += step[i];
@@ -1031,6 +1016,37 @@ void	range_wcs(wcsstruct *wcs)
         }
       }
     }
+  raw_to_wcs_batch(wcs, rawbuf, worldbuf, npoints);
+
+  radmax = 0.0;
+  worldc = wcs->wcsscalepos;
+
+  worldt = worldbuf;
+  for (j=npoints; j--; worldt+=naxis)
+    {
+/*-- Compute maximum distance to center */
+    if ((rad=wcs_dist(wcs, worldt, worldc)) > radmax)
+      radmax = rad;
+    for (i=0; i<naxis; i++)
+      {
+/*---- Handle longitudes around 0 */
+      if (i==lng)
+        {
+        worldt[i] -= lc;
+        if (worldt[i]>180.0)
+          worldt[i] -= 360.0;
+        else if (worldt[i] <= -180.0)
+          worldt[i] += 360.0;
+        }
+      if (worldt[i]<worldmin[i])
+        worldmin[i] = worldt[i];
+      if (worldt[i]>worldmax[i])
+        worldmax[i] = worldt[i];
+      }
+    }
+
+  free(rawbuf);
+  free(worldbuf);
 
   wcs->wcsmaxradius = radmax;
 
@@ -1333,6 +1349,313 @@ int	wcs_to_raw(wcsstruct *wcs, double *wcspos, double *pixpos)
   }
 
 
+/******* raw_to_wcs_batch *****************************************************
+PROTO	int raw_to_wcs_batch(wcsstruct *wcs, double *pixpos, double *wcspos,
+			int npos)
+PURPOSE	Convert a series of raw (pixel) coordinates to WCS (World Coordinate
+	System).
+INPUT	WCS structure,
+	Pointer to the (pseudo)2D array of input coordinates (npos x naxis),
+	Pointer to the (pseudo)2D array of output coordinates (npos x naxis),
+	Number of positions.
+OUTPUT	RETURN_OK if all mappings were successful, RETURN_ERROR otherwise.
+NOTES	Celestial 2D gnomonic projections (TAN, with or without PV
+	distortions, and TNX) are processed directly: the linear and
+	spherical rotation matrices are set up once, and the native spherical
+	coordinates never need to be computed, which saves most of the
+	trigonometry. Other cases fall back to raw_to_wcs().
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+int	raw_to_wcs_batch(wcsstruct *wcs, double *pixpos, double *wcspos,
+			int npos)
+  {
+   struct linprm	*lin;
+   struct prjprm	*prj;
+   double		*eul,
+			cr[2], pi[4],
+			x,y, xp,yp, u,v, xx,yy,zz, c2,s2, r0, lngw;
+   int			p, naxis, lng,lat, tnxflag, status;
+
+  if (npos<1)
+    return RETURN_OK;
+  naxis = wcs->naxis;
+/* The first position also initializes the WCSLIB structures if needed */
+  status = raw_to_wcs(wcs, pixpos, wcspos);
+  if (!wcs_batchflag(wcs))
+    {
+    for (p=1; p<npos; p++)
+      if (raw_to_wcs(wcs, pixpos+p*naxis, wcspos+p*naxis) != RETURN_OK)
+        status = RETURN_ERROR;
+    return status;
+    }
+
+  lin = wcs->lin;
+  prj = wcs->prj;
+  eul = wcs->cel->euler;
+  lng = wcs->wcsprm->lng;
+  lat = wcs->wcsprm->lat;
+  tnxflag = (wcs->wcsprm->pcode[1] == 'N');
+  cr[0] = lin->crpix[0];
+  cr[1] = lin->crpix[1];
+  pi[0] = lin->piximg[0];
+  pi[1] = lin->piximg[1];
+  pi[2] = lin->piximg[2];
+  pi[3] = lin->piximg[3];
+  r0 = prj->r0;
+  c2 = cos(eul[2]*DEG);
+  s2 = sin(eul[2]*DEG);
+  for (p=1; p<npos; p++)
+    {
+    pixpos += 2;
+    wcspos += 2;
+/*-- Linear part */
+    x = pixpos[0] - cr[0];
+    y = pixpos[1] - cr[1];
+    xp = pi[0]*x + pi[1]*y;
+    yp = pi[2]*x + pi[3]*y;
+    x = lng? yp : xp;
+    y = lng? xp : yp;
+/*-- Distortions */
+    if (tnxflag)
+      {
+      xp = x + raw_to_tnxaxis(prj->tnx_lngcor, x, y);
+      yp = y + raw_to_tnxaxis(prj->tnx_latcor, x, y);
+      }
+    else if (prj->n)
+      raw_to_pv(prj, x, y, &xp, &yp);
+    else
+      {
+      xp = x;
+      yp = y;
+      }
+/*-- Gnomonic de-projection and rotation to celestial coordinates at once */
+    u = xp*s2 - yp*c2;
+    v = xp*c2 + yp*s2;
+    xx = r0*eul[4] - eul[3]*u;
+    yy = -v;
+    zz = r0*eul[3] + eul[4]*u;
+    if (xx == 0.0 && yy == 0.0)
+      {
+/*---- Pole: let WCSLIB handle the change of origin of longitude */
+      if (raw_to_wcs(wcs, pixpos, wcspos) != RETURN_OK)
+        status = RETURN_ERROR;
+      continue;
+      }
+    lngw = eul[0] + atan2(yy, xx)/DEG;
+    if (eul[0] >= 0.0)
+      {
+      if (lngw < 0.0)
+        lngw += 360.0;
+      }
+    else if (lngw > 0.0)
+      lngw -= 360.0;
+    if (lngw > 360.0)
+      lngw -= 360.0;
+    else if (lngw < -360.0)
+      lngw += 360.0;
+    wcspos[lng] = lngw;
+    wcspos[lat] = atan2(zz, sqrt(xx*xx+yy*yy))/DEG;
+/*-- If needed, convert from a different coordinate system to equatorial */
+    if (wcs->celsysconvflag)
+      celsys_to_eq(wcs, wcspos);
+    }
+
+  return status;
+  }
+
+
+/******* wcs_to_raw_batch *****************************************************
+PROTO	int wcs_to_raw_batch(wcsstruct *wcs, double *wcspos, double *pixpos,
+			int npos)
+PURPOSE	Convert a series of WCS (World Coordinate System) coords to raw
+	(pixel) coords.
+INPUT	WCS structure,
+	Pointer to the (pseudo)2D array of input coordinates (npos x naxis),
+	Pointer to the (pseudo)2D array of output coordinates (npos x naxis),
+	Number of positions.
+OUTPUT	RETURN_OK if all mappings were successful, RETURN_ERROR otherwise.
+NOTES	Same fast path as raw_to_wcs_batch(). Projection corrections are
+	computed by batches of POLY_NBATCH positions with poly_eval_batch().
+	Contrary to wcs_to_raw(), input coordinates are left untouched.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+int	wcs_to_raw_batch(wcsstruct *wcs, double *wcspos, double *pixpos,
+			int npos)
+  {
+   struct linprm	*lin;
+   struct prjprm	*prj;
+   double		xp[2*POLY_NBATCH],
+			world[NAXIS],
+			*eul, *basis,*basist, *coeff, *xpt, *pixt, *wcst,
+			cr[2], ip[4],
+			dl,cl, a,b,c, xx,yy,zz, c2,s2, r0, x,y;
+   int			bad[POLY_NBATCH],
+			i,j,p, nb,nc, naxis, lng,lat, ncoeff, status;
+
+  if (npos<1)
+    return RETURN_OK;
+  naxis = wcs->naxis;
+/* The first position also initializes the WCSLIB structures if needed */
+  for (i=0; i<naxis; i++)
+    world[i] = wcspos[i];
+  status = wcs_to_raw(wcs, world, pixpos);
+  if (!wcs_batchflag(wcs))
+    {
+    for (p=1; p<npos; p++)
+      {
+      for (i=0; i<naxis; i++)
+        world[i] = wcspos[p*naxis+i];
+      if (wcs_to_raw(wcs, world, pixpos+p*naxis) != RETURN_OK)
+        status = RETURN_ERROR;
+      }
+    return status;
+    }
+
+  lin = wcs->lin;
+  prj = wcs->prj;
+  eul = wcs->cel->euler;
+  lng = wcs->wcsprm->lng;
+  lat = wcs->wcsprm->lat;
+  cr[0] = lin->crpix[0];
+  cr[1] = lin->crpix[1];
+  ip[0] = lin->imgpix[0];
+  ip[1] = lin->imgpix[1];
+  ip[2] = lin->imgpix[2];
+  ip[3] = lin->imgpix[3];
+  r0 = prj->r0;
+  c2 = cos(eul[2]*DEG);
+  s2 = sin(eul[2]*DEG);
+  ncoeff = 0;
+  if (prj->inv_x)
+    ncoeff = prj->inv_x->ncoeff;
+  if (prj->inv_y && prj->inv_y->ncoeff > ncoeff)
+    ncoeff = prj->inv_y->ncoeff;
+  basis = NULL;
+  if (ncoeff)
+    QMALLOC(basis, double, ncoeff*POLY_NBATCH);
+
+  wcspos += 2;
+  pixpos += 2;
+  for (p=1; p<npos; p+=nb)
+    {
+    nb = npos-p;
+    if (nb > POLY_NBATCH)
+      nb = POLY_NBATCH;
+/*-- Rotation to native coordinates and gnomonic projection at once */
+    xpt = xp;
+    wcst = wcspos;
+    for (j=0; j<nb; j++, wcst+=2, xpt+=2)
+      {
+      world[lng] = wcst[lng];
+      world[lat] = wcst[lat];
+/*---- If needed, convert to a coordinate system different from equatorial */
+      if (wcs->celsysconvflag)
+        eq_to_celsys(wcs, world);
+      dl = (world[lng] - eul[0])*DEG;
+      cl = cos(world[lat]*DEG);
+      xx = cl*cos(dl);
+      yy = cl*sin(dl);
+      zz = sin(world[lat]*DEG);
+      a = eul[4]*zz - eul[3]*xx;
+      b = -yy;
+      c = eul[4]*xx + eul[3]*zz;
+      if ((bad[j] = (c == 0.0 || (prj->flag == PRJSET && c < 0.0))))
+        {
+        xpt[0] = xpt[1] = 0.0;
+        continue;
+        }
+      xpt[0] = r0*(b*c2 + a*s2)/c;
+      xpt[1] = -r0*(a*c2 - b*s2)/c;
+      }
+/*-- Projection corrections */
+    if (prj->inv_x)
+      {
+      poly_eval_batch(prj->inv_x, xp, nb, basis);
+      coeff = prj->inv_x->coeff;
+      nc = prj->inv_x->ncoeff;
+      basist = basis;
+      for (j=0; j<nb; j++)
+        {
+        x = 0.0;
+        for (i=0; i<nc; i++)
+          x += coeff[i]**(basist++);
+        pixpos[2*j] = x;
+        }
+      }
+    else
+      for (j=0; j<nb; j++)
+        pixpos[2*j] = xp[2*j];
+    if (prj->inv_y)
+      {
+      poly_eval_batch(prj->inv_y, xp, nb, basis);
+      coeff = prj->inv_y->coeff;
+      nc = prj->inv_y->ncoeff;
+      basist = basis;
+      for (j=0; j<nb; j++)
+        {
+        y = 0.0;
+        for (i=0; i<nc; i++)
+          y += coeff[i]**(basist++);
+        pixpos[2*j+1] = y;
+        }
+      }
+    else
+      for (j=0; j<nb; j++)
+        pixpos[2*j+1] = xp[2*j+1];
+/*-- Linear part */
+    pixt = pixpos;
+    for (j=0; j<nb; j++, pixt+=2)
+      {
+      if (bad[j])
+        {
+        pixt[0] = pixt[1] = WCS_NOCOORD;
+        status = RETURN_ERROR;
+        continue;
+        }
+      x = lng? pixt[1] : pixt[0];
+      y = lng? pixt[0] : pixt[1];
+      pixt[0] = ip[0]*x + ip[1]*y + cr[0];
+      pixt[1] = ip[2]*x + ip[3]*y + cr[1];
+      }
+    wcspos += 2*nb;
+    pixpos += 2*nb;
+    }
+
+  free(basis);
+
+  return status;
+  }
+
+
+/******* wcs_batchflag ********************************************************
+PROTO	int wcs_batchflag(wcsstruct *wcs)
+PURPOSE	Tell whether a WCS can be handled by the fast path of the batch
+	conversion functions.
+INPUT	WCS structure.
+OUTPUT	1 if it can, 0 otherwise.
+NOTES	WCSLIB structures must have been initialized by a first conversion.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static int	wcs_batchflag(wcsstruct *wcs)
+  {
+   struct wcsprm	*wcsprm;
+
+  wcsprm = wcs->wcsprm;
+
+  return wcs->naxis == 2
+	&& wcsprm->flag == WCSSET
+	&& wcsprm->lng+wcsprm->lat == 1
+	&& wcsprm->cubeface == -1
+	&& (!strcmp(wcsprm->pcode, "TAN") || !strcmp(wcsprm->pcode, "TNX"))
+	&& wcs->lin->flag == LINSET
+	&& wcs->cel->flag == CELSET
+	&& abs(wcs->prj->flag) == PRJSET;
+  }
+
+
 /******* red_to_raw **********************************************************
 PROTO	int red_to_raw(wcsstruct *, double *, double *)
 PURPOSE	Convert reduced (World Coordinate System) coords to raw (pixel)
@@ -23,7 +23,7 @@
 *	along with AstrOmatic software.
 *	If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		10/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -129,13 +129,17 @@ extern int		celsys_to_eq(wcsstruct *wcs, double *wcspos),
 				double *pixpos, double *redpos),
 			raw_to_wcs(wcsstruct *wcs,
 				double *pixpos, double *wcspos),
+			raw_to_wcs_batch(wcsstruct *wcs,
+				double *pixpos, double *wcspos, int npos),
 			reaxe_wcs(wcsstruct *wcs, int lng, int lat),
 			red_to_raw(wcsstruct *wcs,
 				double *redpos, double *pixpos),
 			wcs_chirality(wcsstruct *wcs),
 			wcs_supproj(char *name),
 			wcs_to_raw(wcsstruct *wcs,
-				double *wcspos, double *pixpos);
+				double *wcspos, double *pixpos),
+			wcs_to_raw_batch(wcsstruct *wcs,
+				double *wcspos, double *pixpos, int npos);
 
 extern char		*degtosexal(double alpha, char *str),
 			*degtosexde(double delta, char *str);
@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		10/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -46,7 +46,7 @@
 #include	"poly.h"
 #include	"psf.h"
 #include	"vignet.h"
-#include	ATLAS_LAPACK_H
+#include	"linalg.h"
 
 
 /****** psf_homo *******************************************************
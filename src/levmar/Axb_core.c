@@ -22,7 +22,7 @@
 *	along with AstrOmatic software.
 *	If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		25/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 /////////////////////////////////////////////////////////////////////////////////
@@ -1003,7 +1003,7 @@ int info, *ipiv, nrhs=1;
 #ifdef HAVE_CONFIG_H
 #include        "config.h"
 #endif
-#include        ATLAS_LAPACK_H
+#include        "../linalg.h"
 #define ATLAS_POTRF	LM_CAT_(clapack_, LM_ADD_PREFIX(potrf))
 #define ATLAS_POTRS	LM_CAT_(clapack_, LM_ADD_PREFIX(potrs))
 #define GETRF LM_ADD_PREFIX(getrf_)
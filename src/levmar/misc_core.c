@@ -22,7 +22,7 @@
 *	along with AstrOmatic software.
 *	If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		25/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 /////////////////////////////////////////////////////////////////////////////////
@@ -575,7 +575,7 @@ LM_REAL *a, *x, *work, max, sum, tmp;
 #ifdef HAVE_CONFIG_H
 #include        "config.h"
 #endif
-#include        ATLAS_LAPACK_H
+#include        "../linalg.h"
 #define ATLAS_POTRF	LM_CAT_(clapack_, LM_ADD_PREFIX(potrf))
 #define ATLAS_POTRI	LM_CAT_(clapack_, LM_ADD_PREFIX(potri))
 /* End added by EB */
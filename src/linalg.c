@@ -0,0 +1,278 @@
+/*
+*				linalg.c
+*
+* Linear algebra backend and thread budget.
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*
+*	This file part of:	PSFEx
+*
+*	Copyright:		(C) 2010-2026 Emmanuel Bertin -- IAP/CNRS/UPMC
+*
+*	License:		GNU General Public License
+*
+*	PSFEx is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+* 	(at your option) any later version.
+*	PSFEx is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*	You should have received a copy of the GNU General Public License
+*	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
+*
+*	Last modified:		19/10/2026
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+#ifdef HAVE_CONFIG_H
+#include	"config.h"
+#endif
+
+#include	<stdio.h>
+#include	<stdlib.h>
+
+#include	"define.h"
+#include	"linalg.h"
+#ifdef HAVE_LAPACKE
+#include	LAPACKE_H
+#endif
+
+static int	linalg_nthreads = 1,	/* Total thread budget */
+		linalg_nworkers = 1,	/* PSFEx threads currently running */
+		linalg_nblasthreads = 1;/* Threads currently left to BLAS */
+
+/****** linalg_init ***********************************************************
+PROTO	void linalg_init(int nthreads)
+PURPOSE	Set the global thread budget shared between PSFEx and the BLAS/LAPack
+	library.
+INPUT	Total number of threads (normally NTHREADS).
+OUTPUT	-.
+NOTES	As long as no PSFEx thread runs in the background, the whole budget
+	goes to BLAS.
+	Multithreaded ATLAS libraries have their number of threads frozen at
+	compile time and cannot be controlled.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+void	linalg_init(int nthreads)
+  {
+  linalg_nthreads = nthreads>0? nthreads : 1;
+  linalg_nworkers = 1;
+  linalg_share(0);
+
+  return;
+  }
+
+
+/****** linalg_share **********************************************************
+PROTO	int linalg_share(int nworkers)
+PURPOSE	Share the thread budget between PSFEx workers and BLAS/LAPack.
+INPUT	Number of PSFEx threads being started (>0) or stopped (<0).
+OUTPUT	Number of threads each worker may let BLAS/LAPack use.
+NOTES	The main thread always counts as one worker. Must be called from the
+	main thread, e.g. linalg_share(1) when a background thread is started
+	and linalg_share(-1) once it has been joined.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+int	linalg_share(int nworkers)
+  {
+  linalg_nworkers += nworkers;
+  if (linalg_nworkers<1)
+    linalg_nworkers = 1;
+  linalg_nblasthreads = linalg_nthreads/linalg_nworkers;
+  if (linalg_nblasthreads<1)
+    linalg_nblasthreads = 1;
+#ifdef HAVE_OPENBLAS
+  openblas_set_num_threads(linalg_nblasthreads);
+#endif
+
+  return linalg_nblasthreads;
+  }
+
+
+/****** linalg_getnthreads ****************************************************
+PROTO	int linalg_getnthreads(void)
+PURPOSE	Return the total thread budget.
+INPUT	-.
+OUTPUT	Total number of threads.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+int	linalg_getnthreads(void)
+  {
+  return linalg_nthreads;
+  }
+
+
+#ifdef HAVE_LAPACKE
+/*
+ATLAS-compatible shim over LAPACKE. Like ATLAS, the routines below accept
+row-major triangular/symmetric matrices, which are handled as their
+column-major transposes with the opposite triangle, while right-hand sides
+are always stored as column-major N x NRHS arrays with leading dimension ldb.
+*/
+#define	LINALG_UPLO(order, uplo) \
+	(((order)==CblasRowMajor) ^ ((uplo)==CblasUpper) ? 'U' : 'L')
+
+/****** clapack_dpotrf ********************************************************
+PROTO	int clapack_dpotrf(const enum CBLAS_ORDER order,
+			const enum CBLAS_UPLO uplo, const int n,
+			double *a, const int lda)
+PURPOSE	Cholesky factorisation of a symmetric positive-definite matrix.
+INPUT	Matrix storage order,
+	triangle to be used,
+	matrix order,
+	pointer to the matrix,
+	leading dimension of the matrix.
+OUTPUT	LAPack info code (0 if OK).
+NOTES	ATLAS clapack_dpotrf() replacement.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+int	clapack_dpotrf(const enum CBLAS_ORDER order,
+			const enum CBLAS_UPLO uplo, const int n,
+			double *a, const int lda)
+  {
+  return (int)LAPACKE_dpotrf(LAPACK_COL_MAJOR, LINALG_UPLO(order, uplo),
+		n, a, lda);
+  }
+
+
+/****** clapack_dpotrs ********************************************************
+PROTO	int clapack_dpotrs(const enum CBLAS_ORDER order,
+			const enum CBLAS_UPLO uplo, const int n, const int nrhs,
+			const double *a, const int lda, double *b, const int ldb)
+PURPOSE	Solve a linear system using a Cholesky factorisation.
+INPUT	Matrix storage order,
+	triangle to be used,
+	matrix order,
+	number of right-hand sides,
+	pointer to the factorised matrix,
+	leading dimension of the matrix,
+	pointer to the right-hand sides (overwritten by the solution),
+	leading dimension of the right-hand sides.
+OUTPUT	LAPack info code (0 if OK).
+NOTES	ATLAS clapack_dpotrs() replacement.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+int	clapack_dpotrs(const enum CBLAS_ORDER order,
+			const enum CBLAS_UPLO uplo, const int n, const int nrhs,
+			const double *a, const int lda, double *b, const int ldb)
+  {
+  return (int)LAPACKE_dpotrs(LAPACK_COL_MAJOR, LINALG_UPLO(order, uplo),
+		n, nrhs, a, lda, b, ldb);
+  }
+
+
+/****** clapack_dposv *********************************************************
+PROTO	int clapack_dposv(const enum CBLAS_ORDER order,
+			const enum CBLAS_UPLO uplo, const int n, const int nrhs,
+			double *a, const int lda, double *b, const int ldb)
+PURPOSE	Solve a symmetric positive-definite linear system.
+INPUT	Matrix storage order,
+	triangle to be used,
+	matrix order,
+	number of right-hand sides,
+	pointer to the matrix (overwritten by its Cholesky factor),
+	leading dimension of the matrix,
+	pointer to the right-hand sides (overwritten by the solution),
+	leading dimension of the right-hand sides.
+OUTPUT	LAPack info code (0 if OK).
+NOTES	ATLAS clapack_dposv() replacement.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+int	clapack_dposv(const enum CBLAS_ORDER order,
+			const enum CBLAS_UPLO uplo, const int n, const int nrhs,
+			double *a, const int lda, double *b, const int ldb)
+  {
+  return (int)LAPACKE_dposv(LAPACK_COL_MAJOR, LINALG_UPLO(order, uplo),
+		n, nrhs, a, lda, b, ldb);
+  }
+
+
+/****** clapack_dtrtri ********************************************************
+PROTO	int clapack_dtrtri(const enum CBLAS_ORDER order,
+			const enum CBLAS_UPLO uplo, const enum CBLAS_DIAG diag,
+			const int n, double *a, const int lda)
+PURPOSE	Invert a triangular matrix in place.
+INPUT	Matrix storage order,
+	triangle to be used,
+	unit or non-unit diagonal,
+	matrix order,
+	pointer to the matrix,
+	leading dimension of the matrix.
+OUTPUT	LAPack info code (0 if OK).
+NOTES	ATLAS clapack_dtrtri() replacement. The inverse of the transpose is
+	the transpose of the inverse, hence the row-major case maps directly
+	to the column-major routine with the opposite triangle.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+int	clapack_dtrtri(const enum CBLAS_ORDER order,
+			const enum CBLAS_UPLO uplo, const enum CBLAS_DIAG diag,
+			const int n, double *a, const int lda)
+  {
+  return (int)LAPACKE_dtrtri(LAPACK_COL_MAJOR, LINALG_UPLO(order, uplo),
+		diag==CblasUnit? 'U' : 'N', n, a, lda);
+  }
+
+
+/****** clapack_spotrf ********************************************************
+PROTO	int clapack_spotrf(const enum CBLAS_ORDER order,
+			const enum CBLAS_UPLO uplo, const int n,
+			float *a, const int lda)
+PURPOSE	Cholesky factorisation of a symmetric positive-definite matrix
+	(single precision).
+INPUT	Matrix storage order,
+	triangle to be used,
+	matrix order,
+	pointer to the matrix,
+	leading dimension of the matrix.
+OUTPUT	LAPack info code (0 if OK).
+NOTES	ATLAS clapack_spotrf() replacement, used by levmar.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+int	clapack_spotrf(const enum CBLAS_ORDER order,
+			const enum CBLAS_UPLO uplo, const int n,
+			float *a, const int lda)
+  {
+  return (int)LAPACKE_spotrf(LAPACK_COL_MAJOR, LINALG_UPLO(order, uplo),
+		n, a, lda);
+  }
+
+
+/****** clapack_spotrs ********************************************************
+PROTO	int clapack_spotrs(const enum CBLAS_ORDER order,
+			const enum CBLAS_UPLO uplo, const int n, const int nrhs,
+			const float *a, const int lda, float *b, const int ldb)
+PURPOSE	Solve a linear system using a Cholesky factorisation (single
+	precision).
+INPUT	Matrix storage order,
+	triangle to be used,
+	matrix order,
+	number of right-hand sides,
+	pointer to the factorised matrix,
+	leading dimension of the matrix,
+	pointer to the right-hand sides (overwritten by the solution),
+	leading dimension of the right-hand sides.
+OUTPUT	LAPack info code (0 if OK).
+NOTES	ATLAS clapack_spotrs() replacement, used by levmar.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+int	clapack_spotrs(const enum CBLAS_ORDER order,
+			const enum CBLAS_UPLO uplo, const int n, const int nrhs,
+			const float *a, const int lda, float *b, const int ldb)
+  {
+  return (int)LAPACKE_spotrs(LAPACK_COL_MAJOR, LINALG_UPLO(order, uplo),
+		n, nrhs, a, lda, b, ldb);
+  }
+
+#endif
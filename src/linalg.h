@@ -0,0 +1,71 @@
+/*
+*				linalg.h
+*
+* Include file for linalg.c.
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*
+*	This file part of:	PSFEx
+*
+*	Copyright:		(C) 2010-2026 Emmanuel Bertin -- IAP/CNRS/UPMC
+*
+*	License:		GNU General Public License
+*
+*	PSFEx is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+* 	(at your option) any later version.
+*	PSFEx is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*	You should have received a copy of the GNU General Public License
+*	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
+*
+*	Last modified:		19/10/2026
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+#ifdef HAVE_CONFIG_H
+#include	"config.h"
+#endif
+
+#ifndef _LINALG_H_
+#define _LINALG_H_
+
+/* The ATLAS clapack_*() interface is used throughout the code; with other */
+/* backends it is provided by a thin shim on top of LAPACKE (see linalg.c) */
+#ifdef HAVE_LAPACKE
+#include	BLAS_H
+#else
+#include	ATLAS_LAPACK_H
+#endif
+
+/*---------------------------------- protos --------------------------------*/
+#ifdef HAVE_LAPACKE
+extern int	clapack_dposv(const enum CBLAS_ORDER order,
+			const enum CBLAS_UPLO uplo, const int n, const int nrhs,
+			double *a, const int lda, double *b, const int ldb),
+		clapack_dpotrf(const enum CBLAS_ORDER order,
+			const enum CBLAS_UPLO uplo, const int n,
+			double *a, const int lda),
+		clapack_dpotrs(const enum CBLAS_ORDER order,
+			const enum CBLAS_UPLO uplo, const int n, const int nrhs,
+			const double *a, const int lda, double *b, const int ldb),
+		clapack_dtrtri(const enum CBLAS_ORDER order,
+			const enum CBLAS_UPLO uplo, const enum CBLAS_DIAG diag,
+			const int n, double *a, const int lda),
+		clapack_spotrf(const enum CBLAS_ORDER order,
+			const enum CBLAS_UPLO uplo, const int n,
+			float *a, const int lda),
+		clapack_spotrs(const enum CBLAS_ORDER order,
+			const enum CBLAS_UPLO uplo, const int n, const int nrhs,
+			const float *a, const int lda, float *b, const int ldb);
+#endif
+
+extern int	linalg_getnthreads(void),
+		linalg_share(int nworkers);
+
+extern void	linalg_init(int nthreads);
+
+#endif
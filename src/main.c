@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		10/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -46,6 +46,7 @@
 #include "fits/fitscat.h"
 #include "prefs.h"
 #include "cplot.h"
+#include "server.h"
 
 #define		SYNTAX \
 EXECUTABLE " catalog1 [catalog2,...][@catalog_list1 [@catalog_list2 ...]]\n" \
@@ -162,6 +163,18 @@ int main(int argc, char *argv[])
   free(argkey);
   free(argval);
 
+  if (*prefs.spool_dir)
+    {
+/*-- Server mode: catalogues are read from job descriptors */
+    if (nim)
+      warning("Input catalogues ignored in server mode: ",
+		"use job descriptors in SPOOL_DIR instead");
+    server_run();
+    free(listbuf);
+    NFPRINTF(OUTPUT, "");
+    exit(EXIT_SUCCESS);
+    }
+
   makeit();
 
   free(listbuf);
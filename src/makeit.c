@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		10/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -35,27 +35,43 @@
 #include	<stdlib.h>
 #include	<string.h>
 #include	<time.h>
+#include	<sys/time.h>
 
 #include	"define.h"
 #include	"types.h"
 #include	"globals.h"
 #include	"fits/fitscat.h"
 #include	"check.h"
+#include	"checkpoint.h"
 #include	"context.h"
 #include	"cplot.h"
 #include	"diagnostic.h"
 #include	"field.h"
 #include	"homo.h"
+#include	"linalg.h"
+#include	"misc.h"
 #include	"pca.h"
 #include	"prefs.h"
 #include	"psf.h"
 #include	"sample.h"
+#include	"shard.h"
 #include	"xml.h"
 
 psfstruct	*make_psf(setstruct *set, float psfstep,
-			float *basis, int nbasis, contextstruct *context);
+			float *basis, int nbasis, contextstruct *context,
+			shardstruct *shard);
 void		write_error(char *msg1, char *msg2);
+static int	make_psfload(fieldstruct *field, char *catname,
+			unsigned long long prefshash);
+static void	make_finish(fieldstruct **fields, int c,
+			contextstruct *context, setstruct **diagsets,
+			int diagflags, int loadflag, checkpointstruct *ckpt),
+		make_psfname(char *catname, char *filename),
+		make_save(fieldstruct *field, char *catname);
+static double	make_walltime(void);
 time_t		thetime, thetime2;
+static double	*make_refinesol;	/* Last psf_refine() solution */
+static int	make_nrefinesol;	/* Number of elements in make_refinesol */
 
 /********************************** makeit ***********************************/
 /*
@@ -63,23 +79,29 @@ time_t		thetime, thetime2;
 void	makeit(void)
 
   {
+   checkpointstruct	*ckpt;
    fieldstruct		**fields;
    psfstruct		**cpsf,
 			*psf;
-   setstruct		*set, *set2;
+   setstruct		*set, **diagsets;
+   shardstruct		*shard;
    contextstruct	*context, *fullcontext;
    struct tm		*tm;
+   unsigned long long	prefshash;
    char			str[MAXCHAR];
-   char			**incatnames,
-			*pstr;
+   char			**incatnames;
    float		**psfbasiss,
 			*psfsteps, *psfbasis, *basis,
 			psfstep, step;
-   int			c,i,p, ncat, ext, next, nmed, nbasis;
+   int			c,i,p, ncat, ext, next, nbasis, diagflags, incflag,
+			loadflag;
 
 /* Install error logging */
   error_installfunc(write_error);
 
+/* Hand the thread budget over to BLAS/LAPack until PSFEx needs it */
+  linalg_init(prefs.nthreads);
+
   incatnames = prefs.incat_name;
   ncat = prefs.ncat;
 
@@ -144,6 +166,10 @@ void	makeit(void)
   if (prefs.xml_flag)
     init_xml(ncat);  
 
+/* Resume from the results of an interrupted run */
+  ckpt = prefs.checkpoint_flag?
+	checkpoint_init(prefs.checkpoint_name, incatnames, ncat, next) : NULL;
+
   psfstep = prefs.psf_step;
   psfsteps = NULL;
   nbasis = 0;
@@ -168,17 +194,32 @@ void	makeit(void)
     warning("Hidden dependencies have no effect",
 	" in STABILITY_TYPE EXPOSURE mode");
 
+/* Up-to-date PSFs may be reused only if they do not depend on other inputs */
+  incflag = 0;
+  prefshash = 0;
+  if (prefs.incremental_flag)
+    {
+    if (prefs.stability_type == STABILITY_EXPOSURE && !context->npc
+	&& prefs.newbasis_type == NEWBASIS_NONE)
+      {
+      incflag = 1;
+      prefshash = prefs_hash(1);
+      }
+    else
+      warning("SKIP_UNCHANGED ignored: PSFs depend on all input catalogues",
+	" in this configuration");
+    }
+
 /* Compute PSF steps */
-  if (!prefs.psf_step)
+  if (!prefs.psf_step && !checkpoint_getsteps(ckpt, &psfstep, &psfsteps))
     {
     NFPRINTF(OUTPUT, "Computing optimum PSF sampling steps...");
     if (prefs.newbasis_type==NEWBASIS_PCACOMMON
 	|| (prefs.stability_type == STABILITY_SEQUENCE
 		&& prefs.psf_mef_type == PSF_MEF_COMMON))
       {
-      set = load_samples(incatnames, 0, ncat, ALL_EXTENSIONS, next, context);
-      psfstep = (float)((set->fwhm/2.35)*0.5);
-      end_set(set);
+      psfstep = (float)((sample_fwhm(incatnames, 0, ncat, ALL_EXTENSIONS,
+		next)/2.35)*0.5);
       }
 /*-- Need to derive a common pixel step for each ext */
     else if (prefs.newbasis_type == NEWBASIS_PCAINDEPENDENT
@@ -190,33 +231,38 @@ void	makeit(void)
       QMALLOC(psfsteps, float, next);
       for (ext=0 ; ext<next; ext++)
         {
-        set = load_samples(incatnames, 0, ncat, ext, next, context);
-        psfsteps[ext] = (float)(psfstep? psfstep : (set->fwhm/2.35)*0.5);
-        end_set(set);
+        psfsteps[ext] = (float)(psfstep? psfstep
+		: (sample_fwhm(incatnames, 0, ncat, ext, next)/2.35)*0.5);
         }
       }
+    checkpoint_putsteps(ckpt, psfstep, psfsteps, next);
     }
 
 /* Derive a new common PCA basis for all extensions */
   if (prefs.newbasis_type==NEWBASIS_PCACOMMON)
     {
-    QMALLOC(cpsf, psfstruct *, ncat*next);
-    for (ext=0 ; ext<next; ext++)
-      for (c=0; c<ncat; c++)
-        {
-        sprintf(str, "Computing new PCA image basis from %s...",
-		fields[c]->rtcatname);
-        NFPRINTF(OUTPUT, str);
-        set = load_samples(incatnames, c, 1, ext, next, context);
-        step = psfstep;
-        cpsf[c+ext*ncat] = make_psf(set, psfstep, NULL, 0, context);
-        end_set(set);
-        }
     nbasis = prefs.newbasis_number;
-    psfbasis = pca_onsnaps(cpsf, ncat*next, nbasis);
-    for (i=0 ; i<ncat*next; i++)
-      psf_end(cpsf[i]);
-    free(cpsf);
+    if (!(psfbasis = checkpoint_getbasis(ckpt, 0)))
+      {
+      QMALLOC(cpsf, psfstruct *, ncat*next);
+      for (ext=0 ; ext<next; ext++)
+        for (c=0; c<ncat; c++)
+          {
+          sprintf(str, "Computing new PCA image basis from %s...",
+		fields[c]->rtcatname);
+          NFPRINTF(OUTPUT, str);
+          set = load_samples(incatnames, c, 1, ext, next, context);
+          step = psfstep;
+          cpsf[c+ext*ncat] = make_psf(set, psfstep, NULL, 0, context, NULL);
+          end_set(set);
+          }
+      psfbasis = pca_onsnaps(cpsf, ncat*next, nbasis);
+      checkpoint_putbasis(ckpt, 0, psfbasis,
+		nbasis*cpsf[0]->size[0]*cpsf[0]->size[1]);
+      for (i=0 ; i<ncat*next; i++)
+        psf_end(cpsf[i]);
+      free(cpsf);
+      }
     }
 /* Derive a new PCA basis for each extension */
   else if (prefs.newbasis_type == NEWBASIS_PCAINDEPENDENT)
@@ -225,6 +271,8 @@ void	makeit(void)
     QMALLOC(psfbasiss, float *, next);
     for (ext=0; ext<next; ext++)
       {
+      if ((psfbasiss[ext] = checkpoint_getbasis(ckpt, ext)))
+        continue;
       if (psfsteps)
         step = psfsteps[ext];
       else
@@ -236,10 +284,12 @@ void	makeit(void)
 		fields[c]->rtcatname);
         NFPRINTF(OUTPUT, str);
         set = load_samples(incatnames, c, 1, ext, next, context);
-        cpsf[c] = make_psf(set, step, NULL, 0, context);
+        cpsf[c] = make_psf(set, step, NULL, 0, context, NULL);
         end_set(set);
         }
       psfbasiss[ext] = pca_onsnaps(cpsf, ncat, nbasis);
+      checkpoint_putbasis(ckpt, ext, psfbasiss[ext],
+		nbasis*cpsf[0]->size[0]*cpsf[0]->size[1]);
       for (c=0 ; c<ncat; c++)
         psf_end(cpsf[c]);
       free(cpsf);
@@ -249,45 +299,80 @@ void	makeit(void)
   if (context->npc && prefs.hidden_mef_type == HIDDEN_MEF_COMMON)
 /*-- Derive principal components of PSF variation from the whole mosaic */
     {
-    p = 0;
-    QMALLOC(cpsf, psfstruct *, ncat*next);
-    for (c=0; c<ncat; c++)
+    free(fullcontext->pc);
+    if (!(fullcontext->pc = checkpoint_getpc(ckpt, 0)))
       {
-      sprintf(str, "Computing hidden dependency parameter(s) from %s...",
-		fields[c]->rtcatname);
-      NFPRINTF(OUTPUT, str);
-      for (ext=0 ; ext<next; ext++)
+      p = 0;
+      QMALLOC(cpsf, psfstruct *, ncat*next);
+      for (c=0; c<ncat; c++)
         {
-        set = load_samples(incatnames, c, 1, ext, next, context);
-        if (psfsteps)
-          step = psfsteps[ext];
-        else
-          step = psfstep;
-        basis = psfbasiss? psfbasiss[ext] : psfbasis;
-        cpsf[p++] = make_psf(set, step, basis, nbasis, context);
-        end_set(set);
+        sprintf(str, "Computing hidden dependency parameter(s) from %s...",
+		fields[c]->rtcatname);
+        NFPRINTF(OUTPUT, str);
+        for (ext=0 ; ext<next; ext++)
+          {
+          set = load_samples(incatnames, c, 1, ext, next, context);
+          if (psfsteps)
+            step = psfsteps[ext];
+          else
+            step = psfstep;
+          basis = psfbasiss? psfbasiss[ext] : psfbasis;
+          cpsf[p++] = make_psf(set, step, basis, nbasis, context, NULL);
+          end_set(set);
+          }
         }
+      fullcontext->pc = pca_oncomps(cpsf, next, ncat, context->npc);
+      checkpoint_putpc(ckpt, 0, fullcontext->pc, ncat*context->npc);
+      for (c=0 ; c<ncat*next; c++)
+        psf_end(cpsf[c]);
+      free(cpsf);
       }
-    free(fullcontext->pc);
-    fullcontext->pc = pca_oncomps(cpsf, next, ncat, context->npc);
-    for (c=0 ; c<ncat*next; c++)
-      psf_end(cpsf[c]);
-    free(cpsf);
     }
 
+/* Samples of per-catalog, per-extension final fits can be reused */
+  diagsets = NULL;
+  if (prefs.sample_reuseflag && prefs.psf_mef_type == PSF_MEF_INDEPENDENT
+	&& prefs.stability_type == STABILITY_EXPOSURE)
+    QCALLOC(diagsets, setstruct *, ncat*next);
+
+/* Diagnostics and check-images are computed as soon as the PSFs of a */
+/* catalogue are final; check-images are written in the background while */
+/* the next extension is processed */
+  if (prefs.ncheck_type)
+    check_init();
+/* Only compute the diagnostics that will actually be output */
+  diagflags = diag_plan();
+#ifdef HAVE_PLPLOT
+  cplot_queueinit();
+#endif
+
 /* Compute "final" PSF models */
   if (prefs.psf_mef_type == PSF_MEF_COMMON)
     {
     if (prefs.stability_type == STABILITY_SEQUENCE)
       {
-/*---- Load all the samples at once */
-      set = load_samples(incatnames, 0, ncat, ALL_EXTENSIONS, next, context);
       step = psfstep;
       basis = psfbasis;
-      field_count(fields, set, COUNT_LOADED);
-      psf = make_psf(set, step, basis, nbasis, context);
-      field_count(fields, set, COUNT_ACCEPTED);
-      end_set(set);
+      if (prefs.nshard>1 && ncat>1)
+        {
+/*------ Share the samples between worker processes */
+        shard = shard_init(fields, incatnames, ncat, ALL_EXTENSIONS, next,
+		context);
+        shard_count(shard, COUNT_LOADED);
+        psf = make_psf(shard->set, step, basis, nbasis, context, shard);
+        shard_count(shard, COUNT_ACCEPTED);
+        shard_end(shard);
+        }
+      else
+        {
+/*------ Load all the samples at once */
+        set = load_samples(incatnames, 0, ncat, ALL_EXTENSIONS, next,
+		context);
+        field_count(fields, set, COUNT_LOADED);
+        psf = make_psf(set, step, basis, nbasis, context, NULL);
+        field_count(fields, set, COUNT_ACCEPTED);
+        end_set(set);
+        }
       NFPRINTF(OUTPUT, "Computing final PSF model...");
       context_apply(context, psf, fields, ALL_EXTENSIONS, 0, ncat);
       psf_end(psf);
@@ -295,62 +380,77 @@ void	makeit(void)
     else
       for (c=0; c<ncat; c++)
         {
-/*------ Load the samples for current exposure */
-        sprintf(str, "Computing final PSF model from %s...",
+/*------ Skip exposures saved in a previous run or whose PSF is up-to-date */
+        loadflag = 0;
+        if (!checkpoint_catdone(ckpt, c)
+		&& !(loadflag = incflag && make_psfload(fields[c],
+			incatnames[c], prefshash) == RETURN_OK))
+          {
+/*-------- Load the samples for current exposure */
+          sprintf(str, "Computing final PSF model from %s...",
 		fields[c]->rtcatname);
-        NFPRINTF(OUTPUT, str);
-        set = load_samples(incatnames, c, 1, ALL_EXTENSIONS, next, context);
-        if (psfstep)
-          step = psfstep;
-        else
-          step = (float)((set->fwhm/2.35)*0.5);
-        basis = psfbasis;
-        field_count(fields, set, COUNT_LOADED);
-        psf = make_psf(set, step, basis, nbasis, fullcontext);
-        field_count(fields, set, COUNT_ACCEPTED);
-        end_set(set);
-        context_apply(fullcontext, psf, fields, ALL_EXTENSIONS, c, 1);
-        psf_end(psf);
+          NFPRINTF(OUTPUT, str);
+          set = load_samples(incatnames, c, 1, ALL_EXTENSIONS, next,
+		context);
+          if (psfstep)
+            step = psfstep;
+          else
+            step = (float)((set->fwhm/2.35)*0.5);
+          basis = psfbasis;
+          field_count(fields, set, COUNT_LOADED);
+          psf = make_psf(set, step, basis, nbasis, fullcontext, NULL);
+          field_count(fields, set, COUNT_ACCEPTED);
+          end_set(set);
+          context_apply(fullcontext, psf, fields, ALL_EXTENSIONS, c, 1);
+          psf_end(psf);
+          }
+        make_finish(fields, c, context, diagsets, diagflags, loadflag,
+		ckpt);
         }
     }
   else
+    {
     for (ext=0 ; ext<next; ext++)
       {
       basis = psfbasiss? psfbasiss[ext] : psfbasis;
       if (context->npc && prefs.hidden_mef_type == HIDDEN_MEF_INDEPENDENT)
 /*------ Derive principal components of PSF components */
         {
-        QMALLOC(cpsf, psfstruct *, ncat);
-        if (psfsteps)
-          step = psfsteps[ext];
-        else
-          step = psfstep;
-        for (c=0; c<ncat; c++)
+        free(fullcontext->pc);
+        if (!(fullcontext->pc = checkpoint_getpc(ckpt, ext)))
           {
-          if (next>1)
-            sprintf(str,
+          QMALLOC(cpsf, psfstruct *, ncat);
+          if (psfsteps)
+            step = psfsteps[ext];
+          else
+            step = psfstep;
+          for (c=0; c<ncat; c++)
+            {
+            if (next>1)
+              sprintf(str,
 		"Computing hidden dependency parameter(s) from %s[%d/%d]...",
 		fields[c]->rtcatname, ext+1, next);
-          else
-            sprintf(str, "Computing hidden dependency parameter(s) from %s...",
+            else
+              sprintf(str,
+		"Computing hidden dependency parameter(s) from %s...",
 		fields[c]->rtcatname);
-          NFPRINTF(OUTPUT, str);
-          set = load_samples(incatnames, c, 1, ext, next, context);
-          field_count(fields, set, COUNT_LOADED);
-          cpsf[c] = make_psf(set, step, basis, nbasis, context);
-          field_count(fields, set, COUNT_ACCEPTED);
-          end_set(set);
+            NFPRINTF(OUTPUT, str);
+            set = load_samples(incatnames, c, 1, ext, next, context);
+            field_count(fields, set, COUNT_LOADED);
+            cpsf[c] = make_psf(set, step, basis, nbasis, context, NULL);
+            field_count(fields, set, COUNT_ACCEPTED);
+            end_set(set);
+            }
+          fullcontext->pc = pca_oncomps(cpsf, 1, ncat, context->npc);
+          checkpoint_putpc(ckpt, ext, fullcontext->pc, ncat*context->npc);
+          for (c=0 ; c<ncat; c++)
+            psf_end(cpsf[c]);
+          free(cpsf);
           }
-        free(fullcontext->pc);
-        fullcontext->pc = pca_oncomps(cpsf, 1, ncat, context->npc);
-        for (c=0 ; c<ncat; c++)
-          psf_end(cpsf[c]);
-        free(cpsf);
         }
 
       if (prefs.stability_type == STABILITY_SEQUENCE)
         {
-/*------ Load all the samples at once */
         if (next>1)
           {
           sprintf(str, "Computing final PSF model for extension [%d/%d]...",
@@ -359,47 +459,92 @@ void	makeit(void)
           }
         else
           NFPRINTF(OUTPUT, "Computing final PSF model...");
-        set = load_samples(incatnames, 0, ncat, ext, next, fullcontext);
+        if (prefs.nshard>1 && ncat>1)
+          {
+/*-------- Share the samples between worker processes */
+          shard = shard_init(fields, incatnames, ncat, ext, next,
+		fullcontext);
+          set = shard->set;
+          }
+        else
+          {
+/*-------- Load all the samples at once */
+          shard = NULL;
+          set = load_samples(incatnames, 0, ncat, ext, next, fullcontext);
+          }
         if (psfstep)
           step = psfstep;
         else if (psfsteps)
           step = psfsteps[ext];
         else
           step = (float)((set->fwhm/2.35)*0.5);
-        field_count(fields, set, COUNT_LOADED);
-        psf = make_psf(set, step, basis, nbasis, fullcontext);
-        field_count(fields, set, COUNT_ACCEPTED);
-        end_set(set);
-        context_apply(fullcontext, psf, fields, ext, 0, ncat);
-        psf_end(psf);
-        }
-      else
-        for (c=0; c<ncat; c++)
+        if (shard)
+          {
+          shard_count(shard, COUNT_LOADED);
+          psf = make_psf(set, step, basis, nbasis, fullcontext, shard);
+          shard_count(shard, COUNT_ACCEPTED);
+          shard_end(shard);
+          }
+        else
           {
-/*-------- Load the samples for current exposure */
-          if (next>1)
-            sprintf(str, "Computing final PSF model for %s[%d/%d]...",
-		fields[c]->rtcatname, ext+1, next);
-          else
-            sprintf(str, "Computing final PSF model for %s...",
-		fields[c]->rtcatname);
-          NFPRINTF(OUTPUT, str);
-          set = load_samples(incatnames, c, 1, ext, next, context);
-          if (psfstep)
-            step = psfstep;
-          else if (psfsteps)
-            step = psfsteps[ext];
-          else
-            step = (float)((set->fwhm/2.35)*0.5);
           field_count(fields, set, COUNT_LOADED);
-          psf = make_psf(set, step, basis, nbasis, context);
+          psf = make_psf(set, step, basis, nbasis, fullcontext, NULL);
           field_count(fields, set, COUNT_ACCEPTED);
           end_set(set);
-          context_apply(context, psf, fields, ext, c, 1);
-          psf_end(psf);
           }
+        context_apply(fullcontext, psf, fields, ext, 0, ncat);
+        psf_end(psf);
+        }
       }
 
+    if (prefs.stability_type == STABILITY_EXPOSURE)
+/*---- Fit the extensions of one exposure at a time, so that its PSF can be */
+/*---- saved before moving to the next one */
+      for (c=0; c<ncat; c++)
+        {
+/*------ Skip exposures saved in a previous run or whose PSF is up-to-date */
+        loadflag = 0;
+        if (!checkpoint_catdone(ckpt, c)
+		&& !(loadflag = incflag && make_psfload(fields[c],
+			incatnames[c], prefshash) == RETURN_OK))
+          for (ext=0 ; ext<next; ext++)
+            {
+/*---------- Load the samples for current exposure */
+            if (next>1)
+              sprintf(str, "Computing final PSF model for %s[%d/%d]...",
+		fields[c]->rtcatname, ext+1, next);
+            else
+              sprintf(str, "Computing final PSF model for %s...",
+		fields[c]->rtcatname);
+            NFPRINTF(OUTPUT, str);
+            set = load_samples(incatnames, c, 1, ext, next, context);
+            if (psfstep)
+              step = psfstep;
+            else if (psfsteps)
+              step = psfsteps[ext];
+            else
+              step = (float)((set->fwhm/2.35)*0.5);
+            basis = psfbasiss? psfbasiss[ext] : psfbasis;
+            field_count(fields, set, COUNT_LOADED);
+            psf = make_psf(set, step, basis, nbasis, context, NULL);
+            field_count(fields, set, COUNT_ACCEPTED);
+/*---------- Keep the cleaned samples for diagnostics */
+            if (diagsets)
+              diagsets[c*next+ext] = set;
+            else
+              end_set(set);
+            context_apply(context, psf, fields, ext, c, 1);
+            psf_end(psf);
+            }
+        make_finish(fields, c, context, diagsets, diagflags, loadflag, ckpt);
+        }
+    }
+
+/* Joint fits: all PSFs are final at once */
+  if (prefs.stability_type == STABILITY_SEQUENCE)
+    for (c=0; c<ncat; c++)
+      make_finish(fields, c, context, diagsets, diagflags, 0, ckpt);
+
   free(psfsteps);
   if (psfbasiss)
     {
@@ -410,44 +555,153 @@ void	makeit(void)
   else if (psfbasis)
     free(psfbasis);
 
-/* Compute diagnostics and check-images */
-  QIPRINTF(OUTPUT,
+  if (prefs.ncheck_type)
+    {
+    NFPRINTF(OUTPUT, "Flushing CHECK-images...");
+    check_end();
+    }
+  free(diagsets);
+
+#ifdef HAVE_PLPLOT
+  NFPRINTF(OUTPUT, "Flushing check-plots...");
+  cplot_queueend();
+#endif
+
+/* Processing end date and time */
+  thetime2 = time(NULL);
+  tm = localtime(&thetime2);
+  sprintf(prefs.sdate_end,"%04d-%02d-%02d",
+	tm->tm_year+1900, tm->tm_mon+1, tm->tm_mday);
+  sprintf(prefs.stime_end,"%02d:%02d:%02d",
+	tm->tm_hour, tm->tm_min, tm->tm_sec);
+  prefs.time_diff = difftime(thetime2, thetime);
+
+/* Write XML */
+  if (prefs.xml_flag)
+    {
+    NFPRINTF(OUTPUT, "Writing XML file...");
+    write_xml(prefs.xml_name);
+    end_xml();
+    }
+
+/* The run is complete: the checkpoint is no longer needed */
+  checkpoint_end(ckpt, 1);
+
+/* Free memory */
+  for (c=0; c<ncat; c++)
+    field_end(fields[c]);
+  free(fields);
+
+  if (context->npc)
+    context_end(fullcontext);   
+  context_end(context);   
+  free(make_refinesol);
+  make_refinesol = NULL;
+
+  return;
+  }
+
+
+/****** make_finish **********************************************************
+PROTO	void make_finish(fieldstruct **fields, int c, contextstruct *context,
+			setstruct **diagsets, int diagflags, int loadflag,
+			checkpointstruct *ckpt)
+PURPOSE	Compute diagnostics and check-images for the final PSFs of a
+	catalogue, save them and record the catalogue as done.
+INPUT	Pointer to the array of field structures,
+	catalogue index,
+	pointer to the context structure,
+	array of samples kept from the final fits (or NULL),
+	diagnostic flags (from diag_plan()),
+	flag set if the PSFs were loaded from an up-to-date PSF file,
+	pointer to the checkpoint structure (or NULL).
+OUTPUT	-.
+NOTES	Must be called in catalogue order, as it also updates the XML output.
+	Catalogues processed in a previous run only get their diagnostics
+	restored from the checkpoint. PSFs loaded from an up-to-date file get
+	their diagnostics recomputed, but are not saved again. Samples kept
+	from the final fits are not cleaned again, and the sample counts and
+	chi2 reported are those of the fit.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	make_finish(fieldstruct **fields, int c, contextstruct *context,
+			setstruct **diagsets, int diagflags, int loadflag,
+			checkpointstruct *ckpt)
+  {
+   fieldstruct	*field;
+   psfstruct	*psf;
+   setstruct	*set;
+   char		str[MAXCHAR];
+   double	chi2;
+   int		i, ext, next, doneflag, reuseflag, nloaded, naccepted;
+
+  field = fields[c];
+  next = field->next;
+  if (!c)
+    QIPRINTF(OUTPUT,
         "   filename      [ext] accepted/total samp. chi2/dof FWHM ellip."
 	" resi. asym.");
-  for (c=0; c<ncat; c++)
+/* The PSF of catalogues processed in a previous run is already saved */
+  if ((doneflag = checkpoint_catdone(ckpt, c)))
+    checkpoint_getcat(ckpt, c, field, context);
+  for (ext=0 ; ext<next; ext++)
     {
-    for (ext=0 ; ext<next; ext++)
+    psf = field->psf[ext];
+    set = NULL;
+    if (!doneflag)
       {
-      psf = fields[c]->psf[ext];
       if (next>1)
         sprintf(str, "Computing diagnostics for %s[%d/%d]...",
-		fields[c]->rtcatname, ext+1, next);
+		field->rtcatname, ext+1, next);
       else
-        sprintf(str, "Computing diagnostics for %s...",
-		fields[c]->rtcatname);
+        sprintf(str, "Computing diagnostics for %s...", field->rtcatname);
       NFPRINTF(OUTPUT, str);
+/*---- Statistics of loaded PSFs are those of the fit, stored with them */
+      nloaded = psf->samples_loaded;
+      naccepted = psf->samples_accepted;
+      chi2 = psf->chi2;
 /*---- Check PSF with individual datasets */
-      set2 = load_samples(incatnames, c, 1, ext, next, context);
-      psf->samples_loaded = set2->nsample;
-      if (set2->nsample>1)
+      if ((reuseflag = diagsets && diagsets[c*next+ext]))
+        {
+/*------ Samples from the final fit, already cleaned: the sample counts */
+/*------ and chi2 are those of the fit */
+        set = diagsets[c*next+ext];
+        diagsets[c*next+ext] = NULL;
+        }
+      else
+        {
+        set = load_samples(prefs.incat_name, c, 1, ext, next, context);
+        psf->samples_loaded = set->nsample;
+        }
+      if (loadflag)
+        field_count(fields, set, COUNT_LOADED);
+      if (set->nsample>1 && !reuseflag)
         {
 /*------ Remove bad PSF candidates */
-        psf_clean(psf, set2, prefs.prof_accuracy);
-        psf->chi2 = set2->nsample? psf_chi2(psf, set2) : 0.0;
+        psf_clean(psf, set, prefs.prof_accuracy);
+        psf->chi2 = set->nsample? psf_chi2(psf, set) : 0.0;
+        }
+      psf->samples_accepted = set->nsample;
+      if (loadflag)
+        {
+        field_count(fields, set, COUNT_ACCEPTED);
+        psf->samples_loaded = nloaded;
+        psf->samples_accepted = naccepted;
+        psf->chi2 = chi2;
         }
-      psf->samples_accepted = set2->nsample;
 /*---- Compute diagnostics and field statistics */
-      psf_diagnostic(psf);
-      nmed = psf->nmed;
-      field_stats(fields, set2);
-/*---- Display stats for current catalog/extension */
-      if (next>1)
-        sprintf(str, "[%d/%d]", ext+1, next);
-      else
-        str[0] = '\0';
-      QPRINTF(OUTPUT, "%-17.17s%-7.7s %5d/%-5d %6.2f %6.2f %6.2f  %4.2f"
+      psf_diagnostic(psf, diagflags);
+      field_stats(fields, set);
+      }
+/*-- Display stats for current catalog/extension */
+    if (next>1)
+      sprintf(str, "[%d/%d]", ext+1, next);
+    else
+      str[0] = '\0';
+    QPRINTF(OUTPUT, "%-17.17s%-7.7s %5d/%-5d %6.2f %6.2f %6.2f  %4.2f"
 	" %5.2f %5.2f\n",
-	ext==0? fields[c]->rtcatname : "",
+	ext==0? field->rtcatname : "",
 	str,
 	psf->samples_accepted, psf->samples_loaded,
 	psf->pixstep,
@@ -456,111 +710,161 @@ void	makeit(void)
 	psf->moffat_ellipticity,
 	psf->pfmoffat_residuals,
 	psf->sym_residuals);
-/*---- Save "Check-images" */
-      for (i=0; i<prefs.ncheck_type; i++)
-        if (prefs.check_type[i])
-          {
-          sprintf(str, "Saving CHECK-image #%d...", i+1);
-          NFPRINTF(OUTPUT, str);
-          check_write(fields[c], set2, prefs.check_name[i], prefs.check_type[i],
+    if (doneflag)
+      continue;
+    if (prefs.precision_type == PRECISION_VALIDATE)
+      QPRINTF(OUTPUT, "%24s max. relative PSF_MASK difference"
+		" (MIXED vs DOUBLE): %.3g\n", "", psf->mixed_reldiff);
+/*-- Save "Check-images" */
+    for (i=0; i<prefs.ncheck_type; i++)
+      if (prefs.check_type[i])
+        {
+        sprintf(str, "Saving CHECK-image #%d...", i+1);
+        NFPRINTF(OUTPUT, str);
+        check_write(field, set, prefs.check_name[i], prefs.check_type[i],
 		ext, next, prefs.check_cubeflag);
-          }
-/*---- Free memory */
-      end_set(set2);
-      }
+        }
+/*-- Free memory */
+    end_set(set);
     }
 
-/* Save result */
-  for (c=0; c<ncat; c++)
+  if (!doneflag)
     {
-    sprintf(str, "Saving PSF model and metadata for %s...",
-	fields[c]->rtcatname);
-    NFPRINTF(OUTPUT, str);
-/*-- Create a file name with a "PSF" extension */
-    if (*prefs.psf_dir)
-      {
-      if ((pstr = strrchr(incatnames[c], '/')))
-        pstr++;
-      else
-        pstr = incatnames[c];
-      sprintf(str, "%s/%s", prefs.psf_dir, pstr);
-      }
-    else
-      strcpy(str, incatnames[c]);
-    if (!(pstr = strrchr(str, '.')))
-      pstr = str+strlen(str);
-    sprintf(pstr, "%s", prefs.psf_suffix);
-    field_psfsave(fields[c], str);
-/* Create homogenisation kernels */
-    if (prefs.homobasis_type != HOMOBASIS_NONE)
-      {
-      for (ext=0; ext<next; ext++)
-        {
-        if (next>1)
-          sprintf(str, "Computing homogenisation kernel for %s[%d/%d]...",
-		fields[c]->rtcatname, ext+1, next);
-        else
-          sprintf(str, "Computing homogenisation kernel for %s...",
-		fields[c]->rtcatname);
-        NFPRINTF(OUTPUT, str);
-        if (*prefs.homokernel_dir)
-          {
-          if ((pstr = strrchr(incatnames[c], '/')))
-            pstr++;
-          else
-            pstr = incatnames[c];
-          sprintf(str, "%s/%s", prefs.homokernel_dir, pstr);
-          }
-        else
-          strcpy(str, incatnames[c]);
-        if (!(pstr = strrchr(str, '.')))
-          pstr = str+strlen(str);
-        sprintf(pstr, "%s", prefs.homokernel_suffix);
-        psf_homo(fields[c]->psf[ext], str, prefs.homopsf_params,
-		prefs.homobasis_number, prefs.homobasis_scale, ext, next);
-        }
-      }
+/*-- Save the PSF as soon as it is final */
+    if (!loadflag)
+      make_save(field, prefs.incat_name[c]);
+/*-- Its check-images must be on disk too before it is marked as done */
+    if (ckpt)
+      check_flush();
+    checkpoint_putcat(ckpt, c, field);
 #ifdef HAVE_PLPLOT
-/* Plot diagnostic maps for all catalogs */
-    cplot_ellipticity(fields[c]);
-    cplot_fwhm(fields[c]);
-    cplot_moffatresi(fields[c]);
-    cplot_asymresi(fields[c]);
-    cplot_counts(fields[c]);
-    cplot_countfrac(fields[c]);
-    cplot_modchi2(fields[c]);
-    cplot_modresi(fields[c]);
+/*-- Plot diagnostic maps in the background: the field is now final */
+    cplot_submit(field);
 #endif
-/*-- Update XML */
-    if (prefs.xml_flag)
-      update_xml(fields[c]);
     }
+/* Update XML */
+  if (prefs.xml_flag)
+    update_xml(field);
 
-/* Processing end date and time */
-  thetime2 = time(NULL);
-  tm = localtime(&thetime2);
-  sprintf(prefs.sdate_end,"%04d-%02d-%02d",
-	tm->tm_year+1900, tm->tm_mon+1, tm->tm_mday);
-  sprintf(prefs.stime_end,"%02d:%02d:%02d",
-	tm->tm_hour, tm->tm_min, tm->tm_sec);
-  prefs.time_diff = difftime(thetime2, thetime);
+  return;
+  }
 
-/* Write XML */
-  if (prefs.xml_flag)
+
+/****** make_psfname *********************************************************
+PROTO	void make_psfname(char *catname, char *filename)
+PURPOSE	Build the name of the PSF file associated with an input catalogue.
+INPUT	Input catalogue filename,
+	output PSF filename (MAXCHAR characters).
+OUTPUT	-.
+NOTES	The PSF file has a "PSF" extension and goes to PSF_DIR if set.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	make_psfname(char *catname, char *filename)
+  {
+   char		*pstr;
+
+  if (*prefs.psf_dir)
     {
-    NFPRINTF(OUTPUT, "Writing XML file...");
-    write_xml(prefs.xml_name);
-    end_xml();
+    if ((pstr = strrchr(catname, '/')))
+      pstr++;
+    else
+      pstr = catname;
+    sprintf(filename, "%s/%s", prefs.psf_dir, pstr);
     }
+  else
+    strcpy(filename, catname);
+  if (!(pstr = strrchr(filename, '.')))
+    pstr = filename+strlen(filename);
+  sprintf(pstr, "%s", prefs.psf_suffix);
 
-/* Free memory */
-  for (c=0; c<ncat; c++)
-    field_end(fields[c]);
-  free(fields);
+  return;
+  }
 
-  if (context->npc)
-    context_end(fullcontext);   
-  context_end(context);   
+
+/****** make_psfload *********************************************************
+PROTO	int make_psfload(fieldstruct *field, char *catname,
+			unsigned long long prefshash)
+PURPOSE	Set the input hash of a catalogue and load its PSFs from the PSF file
+	of a previous run if that hash has not changed.
+INPUT	Pointer to the field structure,
+	input catalogue filename,
+	hash of the configuration (from prefs_hash()).
+OUTPUT	RETURN_OK if the PSFs were loaded, RETURN_ERROR otherwise.
+NOTES	The input hash covers the catalogue content, the configuration and
+	the external PSF basis file (if any).
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static int	make_psfload(fieldstruct *field, char *catname,
+			unsigned long long prefshash)
+  {
+   unsigned long long	hash;
+   char			str[MAXCHAR];
+
+  snprintf(str, MAXCHAR, "Checking %.*s for changes...", MAXCHAR-32,
+	field->rtcatname);
+  NFPRINTF(OUTPUT, str);
+  hash = hash_buf(&prefshash, sizeof(prefshash), hash_file(catname));
+  if (prefs.basis_type == BASIS_FILE)
+    hash = hash_buf(&hash, sizeof(hash), hash_file(prefs.basis_name));
+/* 0 means "no hash" in PSF files */
+  field->inhash = hash? hash : 1;
+  make_psfname(catname, str);
+
+  return field_psfload(field, str);
+  }
+
+
+/****** make_save ************************************************************
+PROTO	void make_save(fieldstruct *field, char *catname)
+PURPOSE	Save the PSF models of a catalogue and the homogenisation kernels.
+INPUT	Pointer to the field structure,
+	input catalogue filename.
+OUTPUT	-.
+NOTES	Output filenames are derived from the input catalogue name.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	make_save(fieldstruct *field, char *catname)
+  {
+   char		str[MAXCHAR],
+		*pstr;
+   int		ext;
+
+  sprintf(str, "Saving PSF model and metadata for %s...",
+	field->rtcatname);
+  NFPRINTF(OUTPUT, str);
+/* Create a file name with a "PSF" extension */
+  make_psfname(catname, str);
+  field_psfsave(field, str);
+/* Create homogenisation kernels */
+  if (prefs.homobasis_type != HOMOBASIS_NONE)
+    for (ext=0; ext<field->next; ext++)
+      {
+      if (field->next>1)
+        sprintf(str, "Computing homogenisation kernel for %s[%d/%d]...",
+		field->rtcatname, ext+1, field->next);
+      else
+        sprintf(str, "Computing homogenisation kernel for %s...",
+		field->rtcatname);
+      NFPRINTF(OUTPUT, str);
+      if (*prefs.homokernel_dir)
+        {
+        if ((pstr = strrchr(catname, '/')))
+          pstr++;
+        else
+          pstr = catname;
+        sprintf(str, "%s/%s", prefs.homokernel_dir, pstr);
+        }
+      else
+        strcpy(str, catname);
+      if (!(pstr = strrchr(str, '.')))
+        pstr = str+strlen(str);
+      sprintf(pstr, "%s", prefs.homokernel_suffix);
+      psf_homo(field->psf[ext], str, prefs.homopsf_params,
+		prefs.homobasis_number, prefs.homobasis_scale, ext, field->next);
+      }
 
   return;
   }
@@ -568,36 +872,61 @@ void	makeit(void)
 
 /****** make_psf *************************************************************
 PROTO	psfstruct *make_psf(setstruct *set, float psfstep,
-			float *basis, int nbasis, contextstruct *context)
+			float *basis, int nbasis, contextstruct *context,
+			shardstruct *shard)
 PURPOSE	Make PSFs from a set of FITS binary catalogs.
 INPUT	Pointer to a sample set,
 	PSF sampling step,
 	Pointer to basis image vectors,
 	Number of basis vectors,
-	Pointer to context structure.
+	Pointer to context structure,
+	Pointer to the shard structure (or NULL).
 OUTPUT  Pointer to the PSF structure.
 NOTES   Diagnostics are computed only if diagflag != 0.
+	If shard is not NULL, the samples are held by the shard workers and
+	set must be shard->set.
+	An intermediate refit is skipped if the previous one changed the
+	PSF components by less than PSF_CONVERGENCE (relative to their
+	maximum) and the following cleaning rejected no sample.
+	The first psf_refine() starts from the solution of the previous PSF
+	(if the sizes match), the next ones from that of the previous pass.
 AUTHOR  E. Bertin (IAP)
-VERSION 03/09/2009
+VERSION 19/10/2026
  ***/
 psfstruct	*make_psf(setstruct *set, float psfstep,
-			float *basis, int nbasis, contextstruct *context)
+			float *basis, int nbasis, contextstruct *context,
+			shardstruct *shard)
   {
+   static double	fitaccu[PSF_NFITPASS] = {0.2, 0.1, 0.05};
    psfstruct		*psf;
    basistypenum		basistype;
-   float		pixsize[2];
+   float		*compold,*comp,*compt,
+			pixsize[2], diff,diffmax,valmax;
+   double		dtime;
+   int			i,p, ncomp, nsample, nskip, convflag;
 
   pixsize[0] = (float)prefs.psf_pixsize[0];
   pixsize[1] = (float)prefs.psf_pixsize[1];
 //  NFPRINTF(OUTPUT,"Initializing PSF modules...");
   psf = psf_init(context, prefs.psf_size, psfstep, pixsize, set->nsample);
+  if (shard)
+    shard_initpsf(shard, psfstep);
 
   psf->samples_loaded = set->nsample;
   psf->fwhm = set->fwhm;
+  dtime = make_walltime();
+
+/* Warm-start psf_refine() with the solution found for the previous PSF */
+  psf->refinesol = make_refinesol;
+  psf->nrefinesol = make_nrefinesol;
+  make_refinesol = NULL;
   
 /* Make the basic PSF-model (1st pass) */
 //  NFPRINTF(OUTPUT,"Modeling the PSF (1/3)...");
-  psf_make(psf, set, 0.2);
+  if (shard)
+    shard_make(shard, psf, fitaccu[0]);
+  else
+    psf_make(psf, set, fitaccu[0]);
   if (basis && nbasis)
     {
     QMEMCPY(basis, psf->basis, float, nbasis*psf->size[0]*psf->size[1]);
@@ -611,50 +940,119 @@ psfstruct	*make_psf(setstruct *set, float psfstep,
       basistype = (psf->fwhm < PSF_AUTO_FWHM)? BASIS_PIXEL : BASIS_NONE;
     psf_makebasis(psf, set, basistype, prefs.basis_number);
     }
-  psf_refine(psf, set);
+  if (shard)
+    shard_refine(shard, psf);
+  else
+    psf_refine(psf, set);
+  psf->npass = 1;
+
+/* Keep a copy of the PSF components to monitor convergence */
+  ncomp = psf->size[0]*psf->size[1]*psf->poly->ncoeff;
+  compold = NULL;
+  if (prefs.psf_convtol > 0.0)
+    QMEMCPY(psf->comp, compold, float, ncomp);
+  convflag = 0;
+  nskip = 0;
 
-/* Remove bad PSF candidates */
-  if (set->nsample>1)
+/* Remove bad PSF candidates and refit (2nd and 3rd passes) */
+  for (p=1; p<=PSF_NFITPASS && set->nsample>1; p++)
     {
-    psf_clean(psf, set, 0.2);
- 
-/*-- Make the basic PSF-model (2nd pass) */
-//    NFPRINTF(OUTPUT,"Modeling the PSF (2/3)...");
-    psf_make(psf, set, 0.1);
-    psf_refine(psf, set);
+    nsample = set->nsample;
+    if (shard)
+      shard_clean(shard, psf, fitaccu[p-1]);
+    else
+      psf_clean(psf, set, fitaccu[p-1]);
+    if (p==PSF_NFITPASS)
+      break;
+/*-- Nothing left to gain from this pass if nothing changed since the last */
+    if (convflag && set->nsample==nsample)
+      {
+      nskip++;
+      continue;
+      }
+    if (shard)
+      {
+      shard_make(shard, psf, fitaccu[p]);
+      shard_refine(shard, psf);
+      }
+    else
+      {
+      psf_make(psf, set, fitaccu[p]);
+      psf_refine(psf, set);
+      }
+    psf->npass++;
+    if (compold)
+      {
+      diffmax = valmax = 0.0;
+      for (comp=psf->comp, compt=compold, i=ncomp; i--; comp++, compt++)
+        {
+        if ((diff=fabsf(*comp - *compt)) > diffmax)
+          diffmax = diff;
+        if (fabsf(*comp) > valmax)
+          valmax = fabsf(*comp);
+        *compt = *comp;
+        }
+      convflag = (valmax>0.0 && diffmax < prefs.psf_convtol*valmax);
+      }
     }
+  free(compold);
+
+  psf->samples_accepted = set->nsample;
  
-/* Remove bad PSF candidates */
-  if (set->nsample>1)
+/* Refine the PSF-model */
+  if (shard)
     {
-    psf_clean(psf, set, 0.1);
- 
-/*-- Make the basic PSF-model (3rd pass) */
-//    NFPRINTF(OUTPUT,"Modeling the PSF (3/3)...");
-    psf_make(psf, set, 0.05);
+    shard_make(shard, psf, prefs.prof_accuracy);
+    shard_refine(shard, psf);
+    }
+  else
+    {
+    psf_make(psf, set, prefs.prof_accuracy);
     psf_refine(psf, set);
     }
- 
-/* Remove bad PSF candidates */
-  if (set->nsample>1)
-    psf_clean(psf, set, 0.05);
- 
-  psf->samples_accepted = set->nsample;
- 
-/* Refine the PSF-model */
-  psf_make(psf, set, prefs.prof_accuracy);
-  psf_refine(psf, set);
+  psf->npass++;
  
 /* Clip the PSF-model */
   psf_clip(psf);
 
 /*-- Just check the Chi2 */
-  psf->chi2 = set->nsample? psf_chi2(psf, set) : 0.0;
+  if (!set->nsample)
+    psf->chi2 = 0.0;
+  else
+    psf->chi2 = shard? shard_chi2(shard, psf) : psf_chi2(psf, set);
+
+/* Skipped passes are assumed to cost as much as the average pass run */
+  psf->fit_timesaved = (float)(nskip*(make_walltime() - dtime)/psf->npass);
+
+/* Hand the last solution over to the next PSF and free the factorisation */
+  make_refinesol = psf->refinesol;
+  make_nrefinesol = psf->nrefinesol;
+  psf->refinesol = NULL;
+  psf_freerefine(psf);
 
   return psf;
   }
 
 
+/****** make_walltime ********************************************************
+PROTO	double make_walltime(void)
+PURPOSE	Return the current wall-clock time with sub-second resolution.
+INPUT	-.
+OUTPUT	Time in seconds since the Epoch.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static double	make_walltime(void)
+  {
+   struct timeval	tv;
+
+  gettimeofday(&tv, NULL);
+
+  return tv.tv_sec + tv.tv_usec/1.0e6;
+  }
+
+
 /****** write_error ********************************************************
 PROTO	void    write_error(char *msg1, char *msg2)
 PURPOSE	Manage files in case of a catched error
@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		03/11/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -30,11 +30,13 @@
 #include        "config.h"
 #endif
 
+#include	<stdio.h>
 #include	<stdlib.h>
 
 #include	"define.h"
 #include	"types.h"
 #include	"globals.h"
+#include	"fits/fitscat.h"
 #include	"misc.h"
 
 
@@ -218,3 +220,59 @@ float	fqmedian(float *ra, int n)
   }
 
 
+/****** hash_buf **************************************************************
+PROTO	unsigned long long hash_buf(void *buf, size_t size,
+				unsigned long long hash)
+PURPOSE	Update a 64-bit FNV-1a hash with the content of a buffer.
+INPUT	Pointer to the buffer,
+	buffer size in bytes,
+	current hash value (HASH_INIT to start a new hash).
+OUTPUT	Updated hash value.
+NOTES	Not a cryptographic hash: it is only meant to detect changes.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+unsigned long long	hash_buf(void *buf, size_t size,
+				unsigned long long hash)
+  {
+   unsigned char	*cbuf;
+
+  cbuf = (unsigned char *)buf;
+  while (size--)
+    {
+    hash ^= (unsigned long long)*(cbuf++);
+    hash *= 0x100000001b3ULL;
+    }
+
+  return hash;
+  }
+
+
+/****** hash_file *************************************************************
+PROTO	unsigned long long hash_file(char *filename)
+PURPOSE	Compute the 64-bit FNV-1a hash of the content of a file.
+INPUT	File name.
+OUTPUT	Hash value.
+NOTES	Exits with an error if the file cannot be read.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+unsigned long long	hash_file(char *filename)
+  {
+   FILE			*file;
+   unsigned long long	hash;
+   unsigned char	buf[65536];
+   size_t		size;
+
+  if (!(file = fopen(filename, "rb")))
+    error(EXIT_FAILURE, "*Error*: cannot open for reading ", filename);
+  hash = HASH_INIT;
+  while ((size=fread(buf, 1, sizeof(buf), file)))
+    hash = hash_buf(buf, size, hash);
+  if (ferror(file))
+    error(EXIT_FAILURE, "*Error*: cannot read ", filename);
+  fclose(file);
+
+  return hash;
+  }
+
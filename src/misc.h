@@ -22,10 +22,14 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		03/11/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
+/*----------------------------- Internal constants --------------------------*/
+
+#define	HASH_INIT	0xcbf29ce484222325ULL	/* FNV-1a 64-bit offset basis */
+
 /*------------------------------- functions ---------------------------------*/
 
 extern double	dqmedian(double *ra, int n);
@@ -33,3 +37,6 @@ extern double	dqmedian(double *ra, int n);
 extern float	fast_median(float *arr, int n),
 		fqmedian(float *ra, int n);
 
+extern unsigned long long	hash_buf(void *buf, size_t size,
+					unsigned long long hash),
+				hash_file(char *filename);
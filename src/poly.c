@@ -23,7 +23,7 @@
 *	along with AstrOmatic software.
 *	If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		12/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -35,8 +35,8 @@
 #include	<stdio.h>
 #include	<stdlib.h>
 #include	<string.h>
-#ifdef HAVE_ATLAS
-#include	ATLAS_LAPACK_H
+#ifdef HAVE_LINALG
+#include	"linalg.h"
 #endif
 
 #include	"poly.h"
@@ -80,7 +80,7 @@ INPUT   1D array containing the group for each parameter,
 OUTPUT  polystruct pointer.
 NOTES   -.
 AUTHOR  E. Bertin (IAP)
-VERSION 08/03/2003
+VERSION 19/10/2026
  ***/
 polystruct	*poly_init(int *group, int ndim, int *degree, int ngroup)
   {
@@ -139,6 +139,9 @@ polystruct	*poly_init(int *group, int ndim, int *degree, int ngroup)
 
   QMALLOC(poly->basis, double, poly->ncoeff);
   QCALLOC(poly->coeff, double, poly->ncoeff);
+/* Precompute the exponent table used in batch evaluations */
+  if (ndim)
+    poly->powers = poly_powers(poly);
 
   return poly;
   }
@@ -151,7 +154,7 @@ INPUT   polystruct pointer.
 OUTPUT  -.
 NOTES   -.
 AUTHOR  E. Bertin (IAP)
-VERSION 04/11/2008
+VERSION 19/10/2026
  ***/
 void	poly_end(polystruct *poly)
   {
@@ -162,6 +165,7 @@ void	poly_end(polystruct *poly)
     free(poly->orthobasis);
     free(poly->degree);
     free(poly->group);
+    free(poly->powers);
     free(poly->orthomat);
     free(poly->deorthomat);
     free(poly);
@@ -178,7 +182,7 @@ INPUT   polystruct pointer.
 OUTPUT  -.
 NOTES   -.
 AUTHOR  E. Bertin (IAP)
-VERSION 04/11/2008
+VERSION 19/10/2026
  ***/
 polystruct *poly_copy(polystruct *poly)
   {
@@ -194,7 +198,10 @@ polystruct *poly_copy(polystruct *poly)
       QMEMCPY(poly->basis, newpoly->basis, double, poly->ncoeff);
       }
     if (poly->ndim)
+      {
       QMEMCPY(poly->group, newpoly->group, int, poly->ndim);
+      QMEMCPY(poly->powers, newpoly->powers, int, poly->ndim*poly->ncoeff);
+      }
     if (poly->ngroup)
       QMEMCPY(poly->degree, newpoly->degree, int, poly->ngroup);
     if (poly->orthomat)
@@ -291,6 +298,82 @@ double	poly_func(polystruct *poly, double *pos)
   }
 
 
+/****** poly_eval_batch ******************************************************
+PROTO   void poly_eval_batch(polystruct *poly, double *pos, int n,
+			double *basis)
+PURPOSE Evaluate the polynomial basis functions at a series of positions.
+INPUT   polystruct pointer,
+        pointer to the (pseudo)2D array of input vectors (n x ndim),
+        number of input vectors,
+        pointer to the (pseudo)2D output array of basis function values
+        (n x ncoeff).
+OUTPUT  -.
+NOTES   Contrary to poly_func(), poly->basis is left untouched, which makes
+	this function reentrant. Points are processed by batches of
+	POLY_NBATCH, for which power tables are built in each dimension and
+	combined according to the exponent table computed by poly_init().
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+ ***/
+void	poly_eval_batch(polystruct *poly, double *pos, int n, double *basis)
+  {
+   double	*ptab,*ptabt,*ptabt2, *post, *basist;
+   int		*powers,*powerst,
+		b,d,g,i,k,t, nb, ndim, ncoeff, ndeg;
+
+  ndim = poly->ndim;
+  ncoeff = poly->ncoeff;
+  if (!ndim)
+    {
+/*-- Constant polynomial */
+    for (i=n; i--;)
+      *(basis++) = 1.0;
+    return;
+    }
+
+  ndeg = 0;
+  for (g=0; g<poly->ngroup; g++)
+    if (poly->degree[g] > ndeg)
+      ndeg = poly->degree[g];
+  ndeg++;
+  powers = poly->powers;
+  QMALLOC(ptab, double, ndim*ndeg*POLY_NBATCH);
+  for (b=0; b<n; b+=POLY_NBATCH, pos+=POLY_NBATCH*ndim,
+	basis+=POLY_NBATCH*ncoeff)
+    {
+    nb = (n-b<POLY_NBATCH)? n-b : POLY_NBATCH;
+/*-- Power tables: ptab[(d*ndeg+k)*nb+i] = pos[i*ndim+d]^k */
+    for (d=0; d<ndim; d++)
+      {
+      ptabt = ptab + d*ndeg*nb;
+      for (i=0; i<nb; i++)
+        ptabt[i] = 1.0;
+      for (k=1; k<ndeg; k++, ptabt+=nb)
+        for (post=pos+d, ptabt2=ptabt+nb, i=0; i<nb; i++, post+=ndim)
+          ptabt2[i] = ptabt[i]**post;
+      }
+/*-- Products of powers for each term of the polynom */
+    for (powerst=powers, t=0; t<ncoeff; t++, powerst+=ndim)
+      {
+      ptabt = ptab + *powerst*nb;
+      for (basist=basis+t, i=0; i<nb; i++, basist+=ncoeff)
+        *basist = ptabt[i];
+      for (d=1; d<ndim; d++)
+        if (powerst[d])
+          {
+          ptabt = ptab + (d*ndeg+powerst[d])*nb;
+          for (basist=basis+t, i=0; i<nb; i++, basist+=ncoeff)
+            *basist *= ptabt[i];
+          }
+      }
+    }
+
+  free(ptab);
+
+  return;
+  }
+
+
 /****** poly_fit *************************************************************
 PROTO   double poly_fit(polystruct *poly, double *x, double *y, double *w,
         int ndata, double *extbasis)
@@ -306,66 +389,43 @@ NOTES   If different from NULL, extbasis can be provided to store the
         values of the basis functions. If x==NULL and extbasis!=NULL, the
         precomputed basis functions stored in extbasis are used (which saves
         CPU). If w is NULL, all points are given identical weight.
+	Basis functions are computed at once with poly_eval_batch().
 AUTHOR  E. Bertin (IAP)
-VERSION 26/03/2008
+VERSION 19/10/2026
  ***/
 void	poly_fit(polystruct *poly, double *x, double *y, double *w, int ndata,
 		double *extbasis)
   {
    void	qerror(char *msg1, char *msg2);
-   double	/*offset[POLY_MAXDIM],*/x2[POLY_MAXDIM],
-		*alpha,*alphat, *beta,*betat, *basis,*basis1,*basis2, *coeff,
-		*extbasist,*xt,
-		val,wval,yval;
-   int		ncoeff, ndim, matsize,
-		d,i,j,n;
+   double	*alpha,*alphat, *beta,*betat, *basis,*basis1,*basis2,*basis3,
+		*coeff, val,wval,yval;
+   int		ncoeff, matsize,
+		i,j,n;
 
   if (!x && !extbasis)
     qerror("*Internal Error*: One of x or extbasis should be "
 	"different from NULL\nin ", "poly_func()");
   ncoeff = poly->ncoeff;
-  ndim = poly->ndim;
   matsize = ncoeff*ncoeff;
-  basis = poly->basis;
-  extbasist = extbasis;
   QCALLOC(alpha, double, matsize);
   QCALLOC(beta, double, ncoeff);
-
-/* Subtract an average offset to maintain precision (droped for now ) */
-/*
+/* If x!=NULL, compute the basis functions (and store them in extbasis) */
   if (x)
     {
-    for (d=0; d<ndim; d++)
-      offset[d] = 0.0;
-    xt = x;
-    for (n=ndata; n--;)
-      for (d=0; d<ndim; d++)
-        offset[d] += *(xt++);
-    for (d=0; d<ndim; d++)
-      offset[d] /= (double)ndata;    
+    if (extbasis)
+      basis = extbasis;
+    else
+      QMALLOC(basis, double, ndata*ncoeff);
+    poly_eval_batch(poly, x, ndata, basis);
     }
-*/ 
+  else
+/*-- If x==NULL, then rely on pre-computed basis functions */
+    basis = extbasis;
+
 /* Build the covariance matrix */
-  xt = x;
-  for (n=ndata; n--;)
+  for (basis2=basis, n=ndata; n--; basis2+=ncoeff)
     {
-    if (x)
-      {
-/*---- If x!=NULL, compute the basis functions */
-      for (d=0; d<ndim; d++)
-        x2[d] = *(xt++)/* - offset[d]*/;     
-      poly_func(poly, x2);
-/*---- If, in addition, extbasis is provided, then fill it */
-      if (extbasis)
-        for (basis1=basis,j=ncoeff; j--;)
-          *(extbasist++) = *(basis1++);
-      }
-    else
-/*---- If x==NULL, then rely on pre-computed basis functions */
-      for (basis1=basis,j=ncoeff; j--;)
-        *(basis1++) = *(extbasist++);
-
-    basis1 = basis;
+    basis1 = basis2;
     wval = w? *(w++) : 1.0;
     yval = *(y++);
     betat = beta;
@@ -374,11 +434,14 @@ void	poly_fit(polystruct *poly, double *x, double *y, double *w, int ndata,
       {
       val = *(basis1++)*wval;
       *(betat++) += val*yval;
-      for (basis2=basis,i=ncoeff; i--;)
-        *(alphat++) += val**(basis2++);
+      for (basis3=basis2,i=ncoeff; i--;)
+        *(alphat++) += val**(basis3++);
       }
     }
 
+  if (x && !extbasis)
+    free(basis);
+
 /* Solve the system */
   poly_solve(alpha,beta,ncoeff);
 
@@ -497,7 +560,7 @@ void	poly_solve(double *a, double *b, int n)
   {
    double	*vmat,*wmat;
 
-#ifdef HAVE_ATLAS
+#ifdef HAVE_LINALG
   clapack_dposv(CblasRowMajor, CblasUpper, n, 1, a, n, b, n);
 #else
   if (cholsolve(a,b,n))
@@ -633,7 +696,7 @@ int	*poly_powers(polystruct *poly)
   }
 
 
-#ifdef HAVE_ATLAS
+#ifdef HAVE_LINALG
 
 /****** poly_initortho ********************************************************
 PROTO   void poly_initortho(polystruct *poly, double *data, int ndata)
@@ -698,7 +761,7 @@ void	poly_initortho(polystruct *poly, double *data, int ndata)
         invect2 = invect02;
         for (i=ndmc; i--;)
           *(invect2++) += s**(invect++);
-        }
+        }
       }
     rdiag[c] = -scale;
     }
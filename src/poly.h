@@ -23,7 +23,7 @@
 *	along with AstrOmatic software.
 *	If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		12/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -35,6 +35,7 @@
 #define	POLY_MAXDIM		4	/* Max dimensionality of polynom */
 #define POLY_MAXDEGREE		10	/* Max degree of the polynom */
 #define	POLY_TINY		1e-30	/* A tiny number */
+#define	POLY_NBATCH		256	/* Batch size for basis evaluations */
 
 /*---------------------------------- macros ---------------------------------*/
 
@@ -52,6 +53,7 @@ typedef struct poly
   int		ngroup;		/* Number of different groups */
   double	*orthomat;	/* Orthonormalization matrix */
   double	*deorthomat;	/* "Deorthonormalization" matrix */
+  int		*powers;	/* Exponents of each term (ncoeff x ndim) */
   }	polystruct;
 
 /*---------------------------------- protos --------------------------------*/
@@ -66,11 +68,13 @@ extern int		cholsolve(double *a, double *b, int n),
 
 extern void		poly_addcste(polystruct *poly, double *cste),
 			poly_end(polystruct *poly),
+			poly_eval_batch(polystruct *poly, double *pos, int n,
+				double *basis),
 			poly_fit(polystruct *poly, double *x, double *y,
 				double *w, int ndata, double *extbasis),
 			poly_solve(double *a, double *b, int n);
 
-#ifdef HAVE_ATLAS
+#ifdef HAVE_LINALG
 extern double		*poly_deortho(polystruct *poly, double *datain,
 				double *dataout),
 			*poly_ortho(polystruct *poly, double *datain,
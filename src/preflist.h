@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		07/11/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -63,9 +63,13 @@ pkeystruct key[] =
    {"NONE", "PIXEL", "GAUSS-LAGUERRE", "FILE", "PIXEL_AUTO", ""}},
   {"CENTER_KEYS", P_STRINGLIST, prefs.center_key, 0,0,0.0,0.0,
     {""}, 2, 2, &prefs.ncenter_key},
+  {"CHECKIMAGE_COMPRESS", P_KEY, &prefs.check_compress, 0,0, 0.0,0.0,
+   {"NONE", "RICE", "GZIP", ""}},
   {"CHECKIMAGE_CUBE", P_BOOL, &prefs.check_cubeflag},
   {"CHECKIMAGE_NAME", P_STRINGLIST, prefs.check_name, 0,0,0.0,0.0,
     {""}, 0, MAXCHECK, &prefs.ncheck_name},
+  {"CHECKIMAGE_QLEVEL", P_FLOAT, &prefs.check_qlevel, 0,0, 1.0,1.0e6},
+  {"CHECKIMAGE_TILEROWS", P_INT, &prefs.check_tilenrow, 1,65536},
   {"CHECKIMAGE_TYPE", P_KEYLIST, prefs.check_type, 0,0, 0.0,0.0,
    {"NONE", "BASIS", "CHI", "PROTOTYPES", "RESIDUALS", "SAMPLES",
 	"SNAPSHOTS", "SNAPSHOTS_IMRES", "WEIGHTS",
@@ -85,6 +89,7 @@ pkeystruct key[] =
     {"NONE", "FWHM", "ELLIPTICITY", "MOFFAT_RESIDUALS", "ASYMMETRY",
 	"COUNTS", "COUNT_FRACTION", "CHI2", "RESIDUALS", ""},
     0, MAXCHECK, &prefs.ncplot_type},
+  {"CHECKPOINT_NAME", P_STRING, prefs.checkpoint_name},
   {"HIDDENMEF_TYPE", P_KEY, &prefs.hidden_mef_type, 0,0, 0.0,0.0,
 	{"INDEPENDENT", "COMMON", ""}},
   {"HOMOBASIS_NUMBER", P_INT, &prefs.homobasis_number, 0,10000},
@@ -103,6 +108,8 @@ pkeystruct key[] =
   {"NTHREADS", P_INT, &prefs.nthreads, 0, THREADS_PREFMAX},
   {"PHOTFLUX_KEY", P_STRING, prefs.photflux_key},
   {"PHOTFLUXERR_KEY", P_STRING, prefs.photfluxerr_key},
+  {"PRECISION_TYPE", P_KEY, &prefs.precision_type, 0,0, 0.0,0.0,
+	{"DOUBLE", "MIXED", "VALIDATE", ""}},
   {"PSFVAR_DEGREES", P_INTLIST, prefs.group_deg, 0,32,0.0,0.0,
     {""}, 0, MAXCONTEXT, &prefs.ngroup_deg},
   {"PSFVAR_KEYS", P_STRINGLIST, prefs.context_name, 0,0,0.0,0.0,
@@ -111,6 +118,7 @@ pkeystruct key[] =
     {""}, 0, MAXCONTEXT, &prefs.ncontext_group},
   {"PSFVAR_NSNAP", P_INT, &prefs.context_nsnap, 1,256},
   {"PSF_ACCURACY", P_FLOAT, &prefs.prof_accuracy, 0,0, 0.0,1.0},
+  {"PSF_CONVERGENCE", P_FLOAT, &prefs.psf_convtol, 0,0, 0.0,1.0},
   {"PSF_DIR", P_STRING, prefs.psf_dir},
   {"PSF_PIXELSIZE", P_FLOATLIST, prefs.psf_pixsize, 0,0, 0.0,100.0, {""},
      1,2, &prefs.npsf_pixsize},
@@ -124,16 +132,23 @@ pkeystruct key[] =
   {"SAMPLE_FWHMRANGE", P_FLOATLIST, prefs.fwhmrange, 0,0, 0.0,1e3, {""},
      2,2, &prefs.nfwhmrange},
   {"SAMPLE_MAXELLIP", P_FLOAT, &prefs.maxellip, 0,0, 0.0, 1.0},
+  {"SAMPLE_MAXNUMBER", P_INT, &prefs.sample_maxnumber, 0,100000000},
   {"SAMPLE_MINSN", P_FLOAT, &prefs.minsn, 0,0, 1e-6,1e15},
+  {"SAMPLE_REUSE", P_BOOL, &prefs.sample_reuseflag},
   {"SAMPLE_VARIABILITY", P_FLOAT, &prefs.maxvar, 0,0, 0.0, BIG},
   {"SAMPLEVAR_TYPE", P_KEY, &prefs.var_type, 0,0, 0.0,0.0,
 	{"NONE", "SEEING",""}},
+  {"SHARD_DIR", P_STRING, prefs.shard_dir},
+  {"SHARD_NUMBER", P_INT, &prefs.nshard, 0,1024},
+  {"SKIP_UNCHANGED", P_BOOL, &prefs.incremental_flag},
+  {"SPOOL_DIR", P_STRING, prefs.spool_dir},
   {"STABILITY_TYPE", P_KEY, &prefs.stability_type, 0,0, 0.0,0.0,
 	{"EXPOSURE", "SEQUENCE", ""}},
   {"VERBOSE_TYPE", P_KEY, &prefs.verbose_type, 0,0, 0.0,0.0,
    {"QUIET","NORMAL","LOG","FULL",""}},
   {"XML_NAME", P_STRING, prefs.xml_name},
   {"XSL_URL", P_STRING, prefs.xsl_name},
+  {"WRITE_CHECKPOINT", P_BOOL, &prefs.checkpoint_flag},
   {"WRITE_XML", P_BOOL, &prefs.xml_flag},
   {""}
  };
@@ -161,6 +176,8 @@ char *default_prefs[] =
 "PSF_ACCURACY    0.01            # Accuracy to expect from PSF \"pixel\" values",
 "PSF_SIZE        25,25           # Image size of the PSF model",
 "*PSF_RECENTER    N               # Allow recentering of PSF-candidates Y/N ?",
+"*PSF_CONVERGENCE 0.01            # Max. rel. PSF change for skipping a refit",
+"*                                # (0 = always run all passes)",
 "*MEF_TYPE        INDEPENDENT     # INDEPENDENT or COMMON",
 " ",
 "#------------------------- Point source measurements -------------------------",
@@ -171,7 +188,7 @@ char *default_prefs[] =
 " ",
 "#----------------------------- PSF variability -------------------------------",
 " ",
-"PSFVAR_KEYS     X_IMAGE,Y_IMAGE # Catalogue or FITS (preceded by :) params",
+"PSFVAR_KEYS     X_IMAGE,Y_IMAGE # Catalogue, FITS (:KEY) or WCS (%KEY) params",
 "PSFVAR_GROUPS   1,1             # Group tag for each context key",
 "PSFVAR_DEGREES  2               # Polynom degree for each group",
 "*PSFVAR_NSNAP    9               # Number of PSF snapshots per axis",
@@ -187,6 +204,8 @@ char *default_prefs[] =
 "SAMPLE_MINSN       20           # Minimum S/N for a source to be used",
 "SAMPLE_MAXELLIP    0.3          # Maximum (A-B)/(A+B) for a source to be used",
 "*SAMPLE_FLAGMASK    0x00fe       # Rejection mask on SExtractor FLAGS",
+"*SAMPLE_MAXNUMBER   0            # Max. nb of samples per PSF (0 = no limit)",
+"*SAMPLE_REUSE       N            # Keep final-fit samples for diagnostics (Y/N)?",
 "*BADPIXEL_FILTER    N            # Filter bad-pixels in samples (Y/N) ?",
 "*BADPIXEL_NMAX      0            # Maximum number of bad pixels allowed",
 " ",
@@ -216,16 +235,27 @@ char *default_prefs[] =
 "CHECKIMAGE_NAME chi.fits,proto.fits,samp.fits,resi.fits,snap.fits",
 "                                # Check-image filenames",
 "*CHECKIMAGE_CUBE N               # Save check-images as datacubes (Y/N) ?",
+"*CHECKIMAGE_COMPRESS NONE       # Tile-compression: NONE, RICE or GZIP",
+"*CHECKIMAGE_QLEVEL 16.0         # RICE quantization levels per noise r.m.s.",
+"*CHECKIMAGE_TILEROWS 16         # Image rows per compressed tile",
 " ",
 "#----------------------------- Miscellaneous ---------------------------------",
 " ",
 "PSF_DIR                         # Where to write PSFs (empty=same as input)",
 "*PSF_SUFFIX      .psf            # Filename extension for output PSF filename",
+"*SKIP_UNCHANGED  N               # Skip up-to-date PSF files (Y/N)?",
 "VERBOSE_TYPE    NORMAL          # can be QUIET,NORMAL,LOG or FULL",
 "WRITE_XML       Y               # Write XML file (Y/N)?",
 "XML_NAME        psfex.xml       # Filename for XML output",
 "*XSL_URL         " XSL_URL,
 "*                                # Filename for XSL style-sheet",
+"*WRITE_CHECKPOINT N              # Save and resume from checkpoints (Y/N)?",
+"*CHECKPOINT_NAME psfex.chk       # Filename for the checkpoint state file",
+"*SPOOL_DIR                       # Directory of jobs to process in server mode",
+"*                                # (empty=no server mode)",
+"*SHARD_NUMBER    0               # Number of processes sharing SEQUENCE fits",
+"*                                # (0 = no sharding)",
+"*SHARD_DIR       .               # Directory for the shard work files",
 #ifdef USE_THREADS
 "NTHREADS        0               # Number of simultaneous threads for",
 "                                # the SMP version of " BANNER,
@@ -233,6 +263,8 @@ char *default_prefs[] =
 #else
 "NTHREADS        1               # 1 single thread",
 #endif
+"*PRECISION_TYPE  DOUBLE          # Numerical precision for building PSFs:",
+"*                                # DOUBLE, MIXED or VALIDATE",
 " ",
 ""
  };
@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		10/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -48,6 +48,7 @@
 #include	"types.h"
 #include	"globals.h"
 #include	"fits/fitscat.h"
+#include	"misc.h"
 #include	"prefs.h"
 #include	"preflist.h"
 
@@ -427,7 +428,7 @@ INPUT	File name.
 OUTPUT	Pointer to an allocated string, or NULL if something went wrong.
 NOTES	-.
 AUTHOR	E. Bertin (IAP)
-VERSION	06/02/2008
+VERSION	19/10/2026
  ***/
 char	*list_to_str(char *listname)
   {
@@ -440,6 +441,7 @@ char	*list_to_str(char *listname)
     error(EXIT_FAILURE, "*Error*: File not found: ", listname);
   bufsize = 8*MAXCHAR;
   QMALLOC(listbuf, char, bufsize);
+  *listbuf = '\0';
   for (bufpos=0; fgets(liststr,MAXCHAR,fp);)
     for (str=NULL; (str=strtok(str? NULL: liststr, "\n\r\t "));)
       {
@@ -515,10 +517,10 @@ void	useprefs()
 		"NTHREADS defaulted to 2");
       }
     }
-#ifndef HAVE_ATLAS_MP
+#if !defined(HAVE_ATLAS_MP) && !defined(HAVE_OPENBLAS)
    if (prefs.nthreads>1)
-     warning("This executable has been compiled using a version of the ATLAS "
-	"library without support for multithreading. ",
+     warning("This executable has been compiled using a version of the "
+	"BLAS/LAPack library without support for multithreading. ",
 	"Performance will be degraded.");
 #endif
 #ifndef HAVE_FFTWF_MP
@@ -601,6 +603,12 @@ void	useprefs()
   if ((i=strlen(prefs.homokernel_dir)-1) > 0
 	&& *(pstr=prefs.homokernel_dir+i) == (char)'/')
     *pstr = (char)'\0';
+  if ((i=strlen(prefs.spool_dir)-1) > 0
+	&& *(pstr=prefs.spool_dir+i) == (char)'/')
+    *pstr = (char)'\0';
+  if ((i=strlen(prefs.shard_dir)-1) > 0
+	&& *(pstr=prefs.shard_dir+i) == (char)'/')
+    *pstr = (char)'\0';
 
 /*----------------------------- CHECK-images -------------------------------*/
   flag = 0;
@@ -612,7 +620,84 @@ void	useprefs()
     error(EXIT_FAILURE, "*Error*: CHECKIMAGE_NAME(s) and CHECKIMAGE_TYPE(s)",
 		" are not in equal number");
 
+#ifndef HAVE_ZLIB
+  if (prefs.check_compress == CHECKCOMPRESS_GZIP)
+    {
+    prefs.check_compress = CHECKCOMPRESS_RICE;
+    warning("CHECKIMAGE_COMPRESS GZIP not available in this build: ",
+	"using RICE instead");
+    }
+#endif
+/* Check-image tiles are compressed in parallel */
+  set_tilenthreads(prefs.nthreads);
+
   return;
   }
 
 
+/********************************* prefs_hash ********************************/
+/*
+Return a hash of the software version and of the configuration parameters that
+may change the results, i.e. all of them except those that only affect speed or
+reporting. If modelflag is set, parameters that only affect check-images and
+check-plots are ignored too.
+*/
+unsigned long long	prefs_hash(int modelflag)
+
+  {
+   static char		*skipkeys[] = {"CHECKPOINT_NAME", "NTHREADS",
+				"SHARD_DIR", "SKIP_UNCHANGED", "SPOOL_DIR",
+				"VERBOSE_TYPE", "WRITE_CHECKPOINT", "WRITE_XML",
+				"XML_NAME", "XSL_URL", ""};
+   unsigned long long	hash;
+   char			**strs;
+   int			i,k,n;
+
+  hash = hash_buf(MYVERSION, strlen(MYVERSION), HASH_INIT);
+  for (k=0; key[k].name[0]; k++)
+    {
+    for (i=0; *skipkeys[i] && strcmp(key[k].name, skipkeys[i]); i++);
+    if (*skipkeys[i])
+      continue;
+    if (modelflag && (!strncmp(key[k].name, "CHECKIMAGE_", 11)
+		|| !strncmp(key[k].name, "CHECKPLOT_", 10)))
+      continue;
+    hash = hash_buf(key[k].name, strlen(key[k].name), hash);
+    n = key[k].nlistptr? *key[k].nlistptr : 1;
+    switch(key[k].type)
+      {
+      case P_FLOAT:
+        hash = hash_buf(key[k].ptr, sizeof(double), hash);
+        break;
+      case P_INT:
+      case P_BOOL:
+      case P_KEY:
+        hash = hash_buf(key[k].ptr, sizeof(int), hash);
+        break;
+      case P_STRING:
+        hash = hash_buf(key[k].ptr, strlen((char *)key[k].ptr), hash);
+        break;
+      case P_FLOATLIST:
+        hash = hash_buf(key[k].ptr, n*sizeof(double), hash);
+        break;
+      case P_INTLIST:
+      case P_BOOLLIST:
+      case P_KEYLIST:
+        hash = hash_buf(key[k].ptr, n*sizeof(int), hash);
+        break;
+      case P_STRINGLIST:
+        strs = (char **)key[k].ptr;
+        for (i=0; i<n; i++)
+          if (strs[i])
+            hash = hash_buf(strs[i], strlen(strs[i])+1, hash);
+        break;
+      default:
+        error(EXIT_FAILURE, "*Internal ERROR*: Type Unknown",
+		" in prefs_hash()");
+        break;
+      }
+    }
+
+  return hash;
+  }
+
@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		10/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -76,6 +76,7 @@ typedef struct
   int		nfwhmrange;	       		/* nb of params */
   int		flag_mask;			/* Rejection mask on SEx FLAGS*/
   double	prof_accuracy;			/* Required PSF accuracy */
+  double	psf_convtol;			/* Convergence tolerance */
   double	psf_step;			/* Oversampling (pixels) */
   double	psf_pixsize[2];			/* Eff. pixel size (pixels) */
   int		npsf_pixsize;			/* nb of params */
@@ -96,6 +97,8 @@ typedef struct
   char		*(center_key[2]);		/* Names of centering keys */
   int		ncenter_key;			/* nb of params */
   int		autoselect_flag;		/* Auto. select FWHMs ? */
+  int		sample_reuseflag;		/* Keep samples for diagnost.?*/
+  int		sample_maxnumber;		/* Max. nb of samples per PSF */
   int		recenter_flag;			/* Recenter PSF-candidates? */
 /* Check-images */
   checkenum	check_type[MAXCHECK];		/* check-image types */
@@ -103,6 +106,10 @@ typedef struct
   char		*(check_name[MAXCHECK]);	/* check-image names */
   int		ncheck_name;			/* nb of params */
   int		check_cubeflag;			/* check-images as datacubes?*/
+  enum {CHECKCOMPRESS_NONE, CHECKCOMPRESS_RICE, CHECKCOMPRESS_GZIP}
+		check_compress;			/* check-image compression */
+  double	check_qlevel;			/* Quantization level */
+  int		check_tilenrow;			/* Image rows per tile */
 /* PSF variability */
   enum {VAR_NONE, VAR_SEEING}	var_type;	/* PSF variability type */
   char		*(context_name[MAXCONTEXT]);	/* Names of context-keys */
@@ -140,11 +147,20 @@ typedef struct
   int		cplot_antialiasflag;		/* Anti-aliasing on/off */
 /* Multithreading */
   int		nthreads;			/* Number of active threads */
+/* Numerical precision */
+  enum {PRECISION_DOUBLE, PRECISION_MIXED, PRECISION_VALIDATE}
+		precision_type;			/* PSF building precision */
 /* Misc */
   enum {QUIET, NORM, LOG, FULL}	verbose_type;	/* How much it displays info */
   int		xml_flag;			/* Write XML file? */
   char		xml_name[MAXCHAR];		/* XML file name */
   char		xsl_name[MAXCHAR];		/* XSL file name (or URL) */
+  int		checkpoint_flag;		/* Save/resume checkpoints? */
+  char		checkpoint_name[MAXCHAR];	/* Checkpoint file name */
+  int		incremental_flag;		/* Skip up-to-date PSFs? */
+  char		spool_dir[MAXCHAR];		/* Server job spool directory */
+  int		nshard;				/* Number of shard workers */
+  char		shard_dir[MAXCHAR];		/* Shard work file directory */
   char		sdate_start[12];		/* PSFEx start date */
   char		stime_start[12];		/* PSFEx start time */
   char		sdate_end[12];			/* PSFEx end date */
@@ -159,6 +175,8 @@ extern char	*list_to_str(char *listname);
 
 extern int	cistrcmp(char *cs, char *ct, int mode);
 
+extern unsigned long long	prefs_hash(int modelflag);
+
 extern void	dumpprefs(int state),
 		readprefs(char *filename,char **argkey,char **argval,int narg),
 		useprefs(void);
@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		15/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -46,9 +46,19 @@
 #include	"psf.h"
 #include	"sample.h"
 #include	"vignet.h"
-#include	ATLAS_LAPACK_H
+#include	"linalg.h"
 
 static double	psf_laguerre(double x, int p, int q);
+static double	*psf_setbasis(psfstruct *psf, setstruct *set);
+static void	psf_makedouble(psfstruct *psf, setstruct *set,
+			double prof_accuracy),
+		psf_makemixed(psfstruct *psf, setstruct *set,
+			double prof_accuracy);
+static int	psf_pcgsolve(double *alphamat, double *betamat, double *sol,
+			char *blockmask, double *precfact, int npsf, int ncoeff,
+			int nitermax);
+static void	psf_blockmatvec(double *alphamat, int *blocki, int *blockj,
+			int nblock, int npsf, int ncoeff, double *x, double *y);
 
 /****** psf_clean *************************************************************
 PROTO	double	psf_clean(psfstruct *psf, setstruct *set)
@@ -59,16 +69,15 @@ INPUT	Pointer to the PSF,
 OUTPUT	Reduced chi2.
 NOTES	-
 AUTHOR	E. Bertin (IAP)
-VERSION	19/02/2009
+VERSION	19/10/2026
  ***/
 double	psf_clean(psfstruct *psf, setstruct *set, double prof_accuracy)
   {
-#define	EPS	(1e-4)  /* a small number */
    samplestruct	*sample;
-   double	chi2,chimean,chivar,chisig,chisig1,chival, locut,hicut;
-   float	*chi, *chit,*chit2,
-		chimed, chi2max;
-   int		i, n, nsample;
+   double	chi2;
+   float	*chi, *chit,
+		chi2max;
+   int		n, nsample;
 
 /* First compute residuals for each sample (chi^2) */
 //  NFPRINTF(OUTPUT,"Computing residuals...");
@@ -81,7 +90,38 @@ double	psf_clean(psfstruct *psf, setstruct *set, double prof_accuracy)
   chit = chi;
   for (sample=set->sample, n=nsample; n--; sample++)
     *(chit++) = (float)sqrt(sample->chi2);
+  chi2 = psf_chiclip(chi, nsample, &chi2max);
+  free(chi);
+
+/* Clip outliers */
+//  NFPRINTF(OUTPUT,"Filtering PSF-candidates...");
+  psf_rejectsamples(set, chi2max);
+
+  return chi2;
+  }
+
+
+/****** psf_chiclip ***********************************************************
+PROTO	double	psf_chiclip(float *chi, int nchi, float *chi2max)
+PURPOSE	Compute k-sigma-clipped statistics of the sample chi's.
+INPUT	Pointer to the array of sqrt(chi2) values,
+	number of values,
+	pointer to the chi2 threshold above which samples are rejected.
+OUTPUT	Reduced chi2 of the samples kept.
+NOTES	The content of the chi array is destroyed.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+double	psf_chiclip(float *chi, int nchi, float *chi2max)
+  {
+#define	EPS	(1e-4)  /* a small number */
+   double	chimean,chivar,chisig,chisig1,chival, locut,hicut;
+   float	*chit,*chit2,
+		chimed;
+   int		i, n, nsample;
+
 /* Produce k-sigma-clipped statistiscs */
+  nsample = nchi;
   locut = -BIG;
   hicut = BIG;
   chisig = BIG;
@@ -111,17 +151,33 @@ double	psf_clean(psfstruct *psf, setstruct *set, double prof_accuracy)
     hicut = chimed + 3.0*chisig;
     }
 
-  free(chi);
 /*
   NFPRINTF(OUTPUT, "");
   NPRINTF(OUTPUT, "<Chi2/dof> = %.3f\n",chivar/(nsample-(nsample>1?1:0)));
 */
-  chi2 = chivar/(nsample-(nsample>1?1:0));
+  *chi2max = (float)hicut;
+  *chi2max *= *chi2max;
+
+  return chivar/(nsample-(nsample>1?1:0));
+#undef EPS
+  }
+
+
+/****** psf_rejectsamples *****************************************************
+PROTO	void	psf_rejectsamples(setstruct *set, float chi2max)
+PURPOSE	Remove the PSF candidates with a chi2 above a threshold.
+INPUT	Pointer to the sample set,
+	chi2 threshold.
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+void	psf_rejectsamples(setstruct *set, float chi2max)
+  {
+   samplestruct	*sample;
+   int		n, nsample;
 
-/* Clip outliers */
-//  NFPRINTF(OUTPUT,"Filtering PSF-candidates...");
-  chi2max = (float)hicut;
-  chi2max *= chi2max;
   nsample=set->nsample;
   for (sample=set->sample, n=0; n<nsample;)
   if ((sample++)->chi2>chi2max)
@@ -132,8 +188,7 @@ double	psf_clean(psfstruct *psf, setstruct *set, double prof_accuracy)
   else
     n++;
 
-  return chi2;
-#undef EPS
+  return;
   }
 
 
@@ -231,8 +286,9 @@ INPUT	Pointer to context structure,
 	number of samples.
 OUTPUT  psfstruct pointer.
 NOTES   The maximum degrees and number of dimensions allowed are set in poly.h.
+	WCS-derived context names are stored without their prefix.
 AUTHOR  E. Bertin (IAP)
-VERSION 14/10/2009
+VERSION 19/10/2026
  ***/
 psfstruct	*psf_init(contextstruct *context, int *size,
 			float psfstep, float *pixsize, int nsample)
@@ -319,7 +375,9 @@ psfstruct	*psf_init(contextstruct *context, int *size,
       {
       nsnap *= psf->nsnap;
       QMALLOC(psf->contextname[d], char, 80);
-      strcpy(psf->contextname[d], *(names2t++));
+      strcpy(psf->contextname[d], **names2t==(char)SAMPLE_WCSPREFIX?
+		*names2t+1 : *names2t);
+      names2t++;
 /*---- Identify first spatial coordinates among contexts */
       if (!strcmp(psf->contextname[d], "X_IMAGE")
 		|| !strcmp(psf->contextname[d], "XWIN_IMAGE")
@@ -396,7 +454,7 @@ INPUT   psfstruct pointer.
 OUTPUT  -.
 NOTES   -.
 AUTHOR  E. Bertin (IAP, Leiden observatory & ESO)
-VERSION 14/10/2009
+VERSION 19/10/2026
  ***/
 void	psf_end(psfstruct *psf)
   {
@@ -419,20 +477,45 @@ void	psf_end(psfstruct *psf)
   free(psf->moffat);
   free(psf->pfmoffat);
   free(psf->homo_kernel);
+  psf_freerefine(psf);
   free(psf);
 
   return;
   }
 
 
+/****** psf_freerefine ********************************************************
+PROTO   void psf_freerefine(psfstruct *psf)
+PURPOSE Free the solution and factorisation kept from the last psf_refine().
+INPUT   psfstruct pointer.
+OUTPUT  -.
+NOTES   The next call to psf_refine() will then start from scratch.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+ ***/
+void	psf_freerefine(psfstruct *psf)
+  {
+  free(psf->refinesol);
+  psf->refinesol = NULL;
+  psf->nrefinesol = 0;
+  free(psf->refinecomp);
+  psf->refinecomp = NULL;
+  free(psf->refinefact);
+  psf->refinefact = NULL;
+  psf->nrefinefact = psf->refinensample = 0;
+
+  return;
+  }
+
+
 /****** psf_copy **************************************************************
 PROTO   psfstruct *psf_copy(psfstruct *psf)
 PURPOSE Copy a PSF structure and everything it contains.
 INPUT   psfstruct pointer.
 OUTPUT  psfstruct pointer.
-NOTES   -.
+NOTES   The psf_refine() solution and factorisation are not copied.
 AUTHOR  E. Bertin (IAP)
-VERSION 30/10/2009
+VERSION 19/10/2026
  ***/
 psfstruct *psf_copy(psfstruct *psf)
   {
@@ -475,11 +558,131 @@ psfstruct *psf_copy(psfstruct *psf)
   QMEMCPY(psf->pfmoffat, newpsf->pfmoffat, moffatstruct, nsnap);
   if (psf->homo_kernel)
     QMEMCPY(psf->homo_kernel, newpsf->homo_kernel, float, psf->npix);
+  newpsf->refinesol = newpsf->refinefact = NULL;
+  newpsf->refinecomp = NULL;
+  newpsf->nrefinesol = newpsf->nrefinefact = newpsf->refinensample = 0;
 
   return newpsf;
   }
 
 
+/****** psf_load **************************************************************
+PROTO	psfstruct *psf_load(char *filename, int ext)
+PURPOSE	Read a PSF model saved by field_psfsave().
+INPUT	PSF filename,
+	extension number.
+OUTPUT	Pointer to the new PSF structure, or NULL if the extension cannot be
+	read.
+NOTES	Only the model and the scalars saved with it (including the fit
+	statistics) are restored; diagnostics must be computed again.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+psfstruct	*psf_load(char *filename, int ext)
+  {
+   contextstruct	context;
+   catstruct		*cat;
+   tabstruct		*tab;
+   keystruct		*key;
+   psfstruct		*psf;
+   char			names[POLY_MAXDIM][80],
+			*pnames[POLY_MAXDIM],
+			*head,
+			str[80];
+   float		pixsize[2], step, fwhm;
+   int			group[POLY_MAXDIM], degree[POLY_MAXDIM],
+			size[PSF_NMASKDIM],
+			e,i, ndim, ngroup, naxis;
+
+  if (!(cat = read_cat(filename)))
+    return NULL;
+
+/* Go to the right PSF extension */
+  tab = cat->tab;
+  for (e=-1, i=cat->ntab; i--; tab=tab->nexttab)
+    if (!strcmp(tab->extname, "PSF_DATA") && ++e==ext)
+      break;
+  psf = NULL;
+  if (i<0)
+    goto exit;
+
+/* Polynom and PSF dimensions */
+  head = tab->headbuf;
+  if (fitsread(head, "POLNAXIS", &ndim, H_INT, T_LONG) != RETURN_OK
+	|| ndim<0 || ndim>POLY_MAXDIM
+	|| fitsread(head, "POLNGRP", &ngroup, H_INT, T_LONG) != RETURN_OK
+	|| ngroup<0 || ngroup>POLY_MAXDIM
+	|| fitsread(head, "PSFNAXIS", &naxis, H_INT, T_LONG) != RETURN_OK
+	|| naxis!=PSF_NMASKDIM
+	|| fitsread(head, "PSF_SAMP", &step, H_FLOAT, T_FLOAT) != RETURN_OK
+	|| step<=0.0
+	|| fitsread(head, "PSF_FWHM", &fwhm, H_FLOAT, T_FLOAT) != RETURN_OK)
+    goto exit;
+  for (i=0; i<ndim; i++)
+    {
+    sprintf(str, "POLGRP%1d", i+1);
+    if (fitsread(head, str, &group[i], H_INT, T_LONG) != RETURN_OK
+	|| group[i]<1 || group[i]>ngroup)
+      goto exit;
+    sprintf(str, "POLNAME%1d", i+1);
+    if (fitsread(head, str, names[i], H_STRING, T_STRING) != RETURN_OK)
+      goto exit;
+    pnames[i] = names[i];
+    }
+  for (i=0; i<ngroup; i++)
+    {
+    sprintf(str, "POLDEG%1d", i+1);
+    if (fitsread(head, str, &degree[i], H_INT, T_LONG) != RETURN_OK)
+      goto exit;
+    }
+  for (i=0; i<naxis; i++)
+    {
+    sprintf(str, "PSFAXIS%1d", i+1);
+    if (fitsread(head, str, &size[i], H_INT, T_LONG) != RETURN_OK
+	|| size[i]<1)
+      goto exit;
+    }
+
+/* Build the PSF structure from a context matching the saved polynom */
+  memset(&context, 0, sizeof(context));
+  context.name = pnames;
+  context.group = group;
+  context.ncontext = ndim;
+  context.degree = degree;
+  context.ngroup = ngroup;
+  pixsize[0] = (float)prefs.psf_pixsize[0];
+  pixsize[1] = (float)prefs.psf_pixsize[1];
+  psf = psf_init(&context, size, step, pixsize, 0x7fffffff);
+  if (psf->size[2] != size[2]
+	|| !(key = read_key(tab, "PSF_MASK"))
+	|| key->nbytes != psf->npix*t_size[T_FLOAT])
+    {
+    psf_end(psf);
+    psf = NULL;
+    goto exit;
+    }
+  memcpy(psf->comp, key->ptr, psf->npix*sizeof(float));
+  for (i=0; i<ndim; i++)
+    {
+    sprintf(str, "POLZERO%1d", i+1);
+    fitsread(head, str, &psf->contextoffset[i], H_EXPO, T_DOUBLE);
+    sprintf(str, "POLSCAL%1d", i+1);
+    fitsread(head, str, &psf->contextscale[i], H_EXPO, T_DOUBLE);
+    }
+  psf->fwhm = fwhm;
+  fitsread(head, "LOADED", &psf->samples_loaded, H_INT, T_LONG);
+  fitsread(head, "ACCEPTED", &psf->samples_accepted, H_INT, T_LONG);
+  fitsread(head, "CHI2", &psf->chi2, H_FLOAT, T_DOUBLE);
+  fitsread(head, "NPASS", &psf->npass, H_INT, T_LONG);
+  fitsread(head, "FITSAVED", &psf->fit_timesaved, H_FLOAT, T_FLOAT);
+
+exit:
+  free_cat(&cat, 1);
+
+  return psf;
+  }
+
+
 /****** psf_make **************************************************************
 PROTO	void	psf_make(psfstruct *psf, setstruct *set, double prof_accuracy)
 PURPOSE	Make the PSF.
@@ -487,32 +690,122 @@ INPUT	Pointer to the PSF,
 	Pointer to the sample set,
 	PSF accuracy.
 OUTPUT  -.
-NOTES   -.
+NOTES   The PRECISION_TYPE configuration parameter selects the double or
+	the mixed precision implementation. In VALIDATE mode both are run
+	and psf->mixed_reldiff is updated with the maximum relative
+	difference between the two PSF_MASKs; the double precision result
+	is kept.
 AUTHOR  E. Bertin (IAP)
-VERSION 03/11/2009
+VERSION 19/10/2026
  ***/
 void	psf_make(psfstruct *psf, setstruct *set, double prof_accuracy)
   {
-   polystruct	*poly;
-   samplestruct	*sample;
-   double	*pstack,*wstack, *basis, *pix,*wpix, *coeff, *pos, *post;
-   float	*comp,*image,*imaget, *weight,*weightt,
-		backnoise2, gain, norm, norm2, noise2, profaccu2, pixstep, val;
-   int		i,c,n, ncoeff,npix,nsample;
-
-  poly = psf->poly;
+   float	*comp,*compt,*compt2, diff,diffmax,valmax;
+   int		i, ncomp;
 
 /* First copy the offset and scaling information from the set structure */
-  for (i=0; i<poly->ndim; i++)
+  for (i=0; i<psf->poly->ndim; i++)
     {
     psf->contextoffset[i] = set->contextoffset[i];
     psf->contextscale[i] = set->contextscale[i];
     }
 
-  nsample = set->nsample;
-  if (!nsample)
+  if (!set->nsample)
     return;
 
+  switch(prefs.precision_type)
+    {
+    case PRECISION_MIXED:
+      psf_makemixed(psf, set, prof_accuracy);
+      break;
+    case PRECISION_VALIDATE:
+      ncomp = psf->size[0]*psf->size[1]*psf->poly->ncoeff;
+      psf_makemixed(psf, set, prof_accuracy);
+      QMALLOC(comp, float, ncomp);
+      memcpy(comp, psf->comp, ncomp*sizeof(float));
+      psf_makedouble(psf, set, prof_accuracy);
+/*---- Compare with the double precision PSF_MASK */
+      diffmax = valmax = 0.0;
+      for (compt=comp, compt2=psf->comp, i=ncomp; i--; compt2++)
+        {
+        if ((diff=fabsf(*(compt++) - *compt2)) > diffmax)
+          diffmax = diff;
+        if (fabsf(*compt2) > valmax)
+          valmax = fabsf(*compt2);
+        }
+      if (valmax>0.0 && diffmax/valmax > psf->mixed_reldiff)
+        psf->mixed_reldiff = diffmax/valmax;
+      free(comp);
+      break;
+    case PRECISION_DOUBLE:
+    default:
+      psf_makedouble(psf, set, prof_accuracy);
+      break;
+    }
+
+  return;
+  }
+
+
+/****** psf_setbasis **********************************************************
+PROTO	double *psf_setbasis(psfstruct *psf, setstruct *set)
+PURPOSE	Compute the polynomial basis functions at the context coordinates of
+	all samples in a set.
+INPUT	Pointer to the PSF,
+	Pointer to the sample set.
+OUTPUT  Pointer to a (pseudo)2D array of nsample x ncoeff basis function
+	values.
+NOTES   The returned pointer is mallocated.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+ ***/
+static double	*psf_setbasis(psfstruct *psf, setstruct *set)
+  {
+   polystruct	*poly;
+   samplestruct	*sample;
+   double	*basis, *pos,*post;
+   int		i,n, ndim;
+
+  poly = psf->poly;
+  ndim = poly->ndim;
+  QMALLOC(basis, double, (set->nsample? set->nsample:1)*poly->ncoeff);
+  QMALLOC(pos, double, ndim&&set->nsample? set->nsample*ndim : 1);
+  post = pos;
+  for (sample=set->sample, n=set->nsample; n--; sample++)
+    for (i=0; i<ndim; i++)
+      *(post++) = (sample->context[i]-set->contextoffset[i])
+		/set->contextscale[i];
+  poly_eval_batch(poly, pos, set->nsample, basis);
+  free(pos);
+
+  return basis;
+  }
+
+
+/****** psf_makedouble ********************************************************
+PROTO	void	psf_makedouble(psfstruct *psf, setstruct *set,
+			double prof_accuracy)
+PURPOSE	Make the PSF, stacking pixel values in double precision.
+INPUT	Pointer to the PSF,
+	Pointer to the sample set,
+	PSF accuracy.
+OUTPUT  -.
+NOTES   -.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+ ***/
+static void	psf_makedouble(psfstruct *psf, setstruct *set,
+			double prof_accuracy)
+  {
+   polystruct	*poly;
+   samplestruct	*sample;
+   double	*pstack,*wstack, *basis, *pix,*wpix, *coeff, *pos, *post;
+   float	*comp,*image,*imaget, *weight,*weightt,
+		backnoise2, gain, norm, norm2, noise2, profaccu2, pixstep, val;
+   int		i,c,n, ncoeff,npix,nsample;
+
+  poly = psf->poly;
+  nsample = set->nsample;
   ncoeff = poly->ncoeff;
   npix = psf->size[0]*psf->size[1];
   QCALLOC(image, float, nsample*npix);
@@ -586,6 +879,165 @@ void	psf_make(psfstruct *psf, setstruct *set, double prof_accuracy)
   }
 
 
+/****** psf_makemixed *********************************************************
+PROTO	void	psf_makemixed(psfstruct *psf, setstruct *set,
+			double prof_accuracy)
+PURPOSE	Make the PSF, keeping image and weight data in single precision.
+INPUT	Pointer to the PSF,
+	Pointer to the sample set,
+	PSF accuracy.
+OUTPUT  -.
+NOTES   Samples are streamed one at a time: each resampled vignet is folded
+	directly into the (double precision) normal equations of every PSF
+	pixel, so that no nsample x npix stack is ever built.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+ ***/
+static void	psf_makemixed(psfstruct *psf, setstruct *set,
+			double prof_accuracy)
+  {
+   double	*alpha, *beta;
+   int		ncoeff,npix;
+
+  ncoeff = psf->poly->ncoeff;
+  npix = psf->size[0]*psf->size[1];
+  QCALLOC(alpha, double, npix*ncoeff*(ncoeff+1)/2);
+  QCALLOC(beta, double, npix*ncoeff);
+  psf_makeaccu(psf, set, prof_accuracy, alpha, beta);
+  psf_makesolve(psf, alpha, beta);
+  free(alpha);
+  free(beta);
+
+  return;
+  }
+
+
+/****** psf_makeaccu **********************************************************
+PROTO	void	psf_makeaccu(psfstruct *psf, setstruct *set,
+			double prof_accuracy, double *alpha, double *beta)
+PURPOSE	Add the samples of a set to the normal equations of the per-pixel
+	polynomial fits of psf_make().
+INPUT	Pointer to the PSF,
+	Pointer to the sample set,
+	PSF accuracy,
+	pointer to the npix x ncoeff(ncoeff+1)/2 normal matrices,
+	pointer to the npix x ncoeff right-hand side vectors.
+OUTPUT  -.
+NOTES   Only the upper triangle of the symmetric normal matrices is
+	accumulated. Vignets are resampled in single precision unless
+	PRECISION_TYPE is DOUBLE. Normal equations from different subsets of
+	samples may simply be added before calling psf_makesolve().
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+ ***/
+void	psf_makeaccu(psfstruct *psf, setstruct *set, double prof_accuracy,
+			double *alpha, double *beta)
+  {
+   samplestruct	*sample;
+   double	*alphat, *betat,
+		*sbasis, *basis,*basist,*basist2, *outer,*outert, dval;
+   float	*image,*imaget,
+		backnoise2, gain, norm, norm2, noise2, profaccu2, pixstep,
+		val, wval;
+   int		c,c2,n,p, ncoeff,nouter,npix,nsample;
+   int		(*resample)(float *pix1, int w1, int h1, float *pix2,
+				int w2, int h2, double dx, double dy,
+				float step2, float stepi);
+
+  if (!set->nsample)
+    return;
+
+  nsample = set->nsample;
+  ncoeff = psf->poly->ncoeff;
+  nouter = ncoeff*(ncoeff+1)/2;
+  npix = psf->size[0]*psf->size[1];
+  resample = (prefs.precision_type==PRECISION_DOUBLE)?
+		vignet_resample : vignet_resample_mixed;
+  QMALLOC(outer, double, nouter);
+  QMALLOC(image, float, npix);
+  sbasis = psf_setbasis(psf, set);
+  pixstep = psf->pixstep>1.0? psf->pixstep : 1.0;
+  for (sample=set->sample, basis=sbasis, n=nsample; n--;
+	sample++, basis+=ncoeff)
+    {
+    norm = sample->norm;
+    norm2 = norm*norm;
+    profaccu2 = (float)(prof_accuracy*prof_accuracy)*norm2;
+    gain = sample->gain;
+    backnoise2 = sample->backnoise2;
+    resample(sample->vig, set->vigsize[0], set->vigsize[1],
+	image, psf->size[0], psf->size[1],
+	sample->dx, sample->dy, psf->pixstep, pixstep);
+/*-- Upper triangle of the outer product of the basis with itself */
+    outert = outer;
+    for (basist=basis, c=ncoeff; c--;)
+      for (dval=*basist, basist2=basist++, c2=c+1; c2--;)
+        *(outert++) = dval**(basist2++);
+/*-- Add the current sample to the normal equations of each pixel */
+    alphat = alpha;
+    betat = beta;
+    for (imaget=image, p=npix; p--;)
+      {
+      val = *(imaget++) / norm;
+      noise2 = backnoise2 + profaccu2*val*val;
+      if (val>0.0 && gain>0.0)
+        noise2 += val/gain;
+      wval = norm2/noise2;
+      for (outert=outer, c=nouter; c--;)
+        *(alphat++) += wval**(outert++);
+      dval = (double)(wval*val);
+      for (basist=basis, c=ncoeff; c--;)
+        *(betat++) += dval**(basist++);
+      }
+    }
+
+  free(outer);
+  free(image);
+  free(sbasis);
+
+  return;
+  }
+
+
+/****** psf_makesolve *********************************************************
+PROTO	void	psf_makesolve(psfstruct *psf, double *alpha, double *beta)
+PURPOSE	Solve the per-pixel normal equations built by psf_makeaccu() and
+	store the result in the PSF components.
+INPUT	Pointer to the PSF,
+	pointer to the npix x ncoeff(ncoeff+1)/2 normal matrices,
+	pointer to the npix x ncoeff right-hand side vectors.
+OUTPUT  -.
+NOTES   beta is overwritten with the solutions.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+ ***/
+void	psf_makesolve(psfstruct *psf, double *alpha, double *beta)
+  {
+   double	*alphat, *betat, *amat, *solt;
+   float	*comp;
+   int		c,c2,p, ncoeff,npix;
+
+  ncoeff = psf->poly->ncoeff;
+  npix = psf->size[0]*psf->size[1];
+  QMALLOC(amat, double, ncoeff*ncoeff);
+  alphat = alpha;
+  for (betat=beta, p=0; p<npix; p++, betat+=ncoeff)
+    {
+    for (c=0; c<ncoeff; c++)
+      for (c2=c; c2<ncoeff; c2++)
+        amat[c*ncoeff+c2] = amat[c2*ncoeff+c] = *(alphat++);
+    poly_solve(amat, betat, ncoeff);
+/*-- Store as a PSF component */
+    for (solt=betat, comp=psf->comp+p, c=ncoeff; c--; comp+=npix)
+      *comp = (float)*(solt++);
+    }
+
+  free(amat);
+
+  return;
+  }
+
+
 /****** psf_build *************************************************************
 PROTO	void	psf_build(psfstruct *psf, double *pos)
 PURPOSE	Build the local PSF (function of "coordinates").
@@ -594,11 +1046,29 @@ INPUT	Pointer to the PSF,
 OUTPUT  -.
 NOTES   -.
 AUTHOR  E. Bertin (IAP)
-VERSION 12/11/2007
+VERSION 19/10/2026
  ***/
 void	psf_build(psfstruct *psf, double *pos)
   {
-   double	*basis;
+  poly_func(psf->poly, pos);
+  psf_buildloc(psf, psf->poly->basis);
+
+  return;
+  }
+
+
+/****** psf_buildloc **********************************************************
+PROTO	void	psf_buildloc(psfstruct *psf, double *basis)
+PURPOSE	Build the local PSF from precomputed polynomial basis function values.
+INPUT	Pointer to the PSF,
+	Pointer to the basis function values.
+OUTPUT  -.
+NOTES   See poly_eval_batch() and psf_setbasis().
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+ ***/
+void	psf_buildloc(psfstruct *psf, double *basis)
+  {
    float	*ppc, *pl, fac;
    int		n,p, npix;
 
@@ -606,9 +1076,6 @@ void	psf_build(psfstruct *psf, double *pos)
 /* Reset the Local PSF mask */
   memset(psf->loc, 0, npix*sizeof(float));
 
-  poly_func(psf->poly, pos);
-  basis = psf->poly->basis;
-
   ppc = psf->comp;
 /* Sum each component */
   for (n = (psf->dim>2?psf->size[2]:1); n--;)
@@ -634,14 +1101,14 @@ INPUT	Pointer to the PSF,
 OUTPUT  -.
 NOTES   -.
 AUTHOR  E. Bertin (IAP)
-VERSION 08/04/2010
+VERSION 19/10/2026
  ***/
 void	psf_makeresi(psfstruct *psf, setstruct *set, int centflag,
 		double prof_accuracy)
   {
    samplestruct		*sample;
-   static double	pos[MAXCONTEXT], amat[9], bmat[3];
-   double		*dresi, *dresit, *amatt,
+   static double	amat[9], bmat[3];
+   double		*dresi, *dresit, *amatt, *sbasis,*sbasist,
 			*cvigx,*cvigxt, *cvigy,*cvigyt,
 			nm1, chi2, dx,dy, ddx,ddy, dval,dvalx,dvaly,dwval,
 			radmin2,radmax2, hcw,hch, yb, mx2,my2,mxy,
@@ -649,14 +1116,19 @@ void	psf_makeresi(psfstruct *psf, setstruct *set, int centflag,
    float		*vigresi, *vig, *vigw, *fresi,*fresit, *vigchi,
 			*cbasis,*cbasist, *cdata,*cdatat, *cvigw,*cvigwt,
 			norm, fval, vigstep, psf_extraccu2, wval, sval;
-   int			i,j,n,ix,iy, ndim,npix,nsample, cw,ch,ncpix, okflag,
+   int			i,j,n,ix,iy, ncoeff,npix,nsample, cw,ch,ncpix, okflag,
 			accuflag, nchi2;
+   int			(*resample)(float *pix1, int w1, int h1, float *pix2,
+				int w2, int h2, double dx, double dy,
+				float step2, float stepi);
 
+  resample = (prefs.precision_type==PRECISION_MIXED)?
+		vignet_resample_mixed : vignet_resample;
   accuflag = (prof_accuracy > 1.0/BIG);
   vigstep = 1/psf->pixstep;
   nsample = set->nsample;
   npix = set->vigsize[0]*set->vigsize[1];
-  ndim = psf->poly->ndim;
+  ncoeff = psf->poly->ncoeff;
   QCALLOC(dresi, double, npix);
 
   if (centflag)
@@ -703,13 +1175,12 @@ void	psf_makeresi(psfstruct *psf, setstruct *set, int centflag,
   mse = 0.0; 				/* To avoid gcc -Wall warnings */
 
 /* Compute the chi2 */
-  for (sample=set->sample, n=nsample; n--; sample++)
+  sbasis = psf_setbasis(psf, set);
+  for (sample=set->sample, sbasist=sbasis, n=nsample; n--;
+	sample++, sbasist+=ncoeff)
     {
 /*-- Build the local PSF */
-    for (i=0; i<ndim; i++)
-      pos[i] = (sample->context[i]-set->contextoffset[i])
-		/set->contextscale[i];
-    psf_build(psf, pos);
+    psf_buildloc(psf, sbasist);
 
 /*-- Delta-x and Delta-y in vignet-pixel units */
     dx = sample->dx;
@@ -730,7 +1201,7 @@ void	psf_makeresi(psfstruct *psf, setstruct *set, int centflag,
       for (j=0; j<PSF_NITER; j++)
         {
 /*------ Map the PSF model at the current position */
-        vignet_resample(psf->loc, psf->size[0], psf->size[1],
+        resample(psf->loc, psf->size[0], psf->size[1],
 		cbasis, cw,ch, -dx*vigstep, -dy*vigstep, vigstep, 1.0);
 
 /*------ Build the a and b matrices */
@@ -780,7 +1251,7 @@ void	psf_makeresi(psfstruct *psf, setstruct *set, int centflag,
 
 
 /*-- Map the PSF model at the current position */
-    vignet_resample(psf->loc, psf->size[0], psf->size[1],
+    resample(psf->loc, psf->size[0], psf->size[1],
 	sample->vigresi, set->vigsize[0], set->vigsize[1],
 	-dx*vigstep, -dy*vigstep, vigstep, 1.0);
 /*-- Fit the flux */
@@ -856,6 +1327,7 @@ void	psf_makeresi(psfstruct *psf, setstruct *set, int centflag,
 /* Free memory */
   free(dresi);
   free(fresi);
+  free(sbasis);
   if (centflag)
     {
     free(cvigx);
@@ -875,41 +1347,80 @@ PURPOSE	Refine PSF by solving a system to recover "aliased" components.
 INPUT	Pointer to the PSF,
 	Pointer to the sample set.
 OUTPUT  RETURN_OK if a PSF is succesfully computed, RETURN_ERROR otherwise.
-NOTES   -.
+NOTES   See psf_refineaccu() and psf_refinesolve().
 AUTHOR  E. Bertin (IAP)
-VERSION 19/11/2009
+VERSION 19/10/2026
  ***/
 int	psf_refine(psfstruct *psf, setstruct *set)
+  {
+   double		*alphamat, *betamat;
+   char			*blockmask;
+   int			npsf, nunknown;
+
+/* Exit if no pixel is to be "refined" or if no sample is available */
+  if (!set->nsample || !psf->basis)
+    return RETURN_ERROR;
+
+  npsf = psf->nbasis;
+  nunknown = psf->poly->ncoeff*npsf;
+  QCALLOC(alphamat, double, nunknown*nunknown);
+  QCALLOC(betamat, double, nunknown);
+  QCALLOC(blockmask, char, npsf*npsf);
+  psf_refineaccu(psf, set, alphamat, betamat, blockmask);
+
+  return psf_refinesolve(psf, alphamat, betamat, blockmask, set->nsample);
+  }
+
+
+/****** psf_refineaccu ********************************************************
+PROTO	void	psf_refineaccu(psfstruct *psf, setstruct *set,
+			double *alphamat, double *betamat, char *blockmask)
+PURPOSE	Add the samples of a set to the normal equations of psf_refine().
+INPUT	Pointer to the PSF,
+	Pointer to the sample set,
+	pointer to the nunknown x nunknown normal equation matrix,
+	pointer to the nunknown right-hand side vector,
+	pointer to the npsf*npsf map of non-empty ncoeff*ncoeff blocks.
+OUTPUT  -.
+NOTES   nunknown = ncoeff*nbasis. Only the upper triangle of alphamat is
+	filled. Normal equations from different subsets of samples may
+	simply be added before calling psf_refinesolve().
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+ ***/
+void	psf_refineaccu(psfstruct *psf, setstruct *set,
+			double *alphamat, double *betamat, char *blockmask)
   {
    polystruct		*poly;
    samplestruct		*sample;
-   double		pos[MAXCONTEXT];
    char			str[MAXCHAR];
    double		*desmat,*desmatt,*desmatt2, *desmat0,*desmat02,
-			*bmat,*bmatt, *basis,*basist, *basist2,
-			*sigvig,*sigvigt, *alphamat,*alphamatt,
-			*betamat,*betamatt,*betamat2, *coeffmat,*coeffmatt,
-			dx,dy, dval, norm, tikfac;
+			*bmat,*bmatt, *basis,*basist, *basist2, *sbasis,
+			*sigvig,*sigvigt, *alphamatt, *betamatt,
+			*coeffmat,*coeffmatt, dx,dy, dval, norm;
    float		*vig,*vigt,*vigt2, *wvig,
-			*vecvig,*vecvigt, *ppix, *vec, *bcoeff,
+			*vecvig,*vecvigt,
 			vigstep;
    int			*desindex,*desindext,*desindext2,
 			*desindex0,*desindex02;
-   int			i,j,jo,k,l,c,n, npix,nvpix, ndata,ncoeff,nsample,npsf,
-			ncontext, nunknown, matoffset, dindex;
+   int			i,j,jo,k,l,n, npix,nvpix, ndata,ncoeff,nsample,npsf,
+			nunknown, matoffset, dindex;
+   int			(*resample)(float *pix1, int w1, int h1, float *pix2,
+				int w2, int h2, double dx, double dy,
+				float step2, float stepi);
 
-/* Exit if no pixel is to be "refined" or if no sample is available */
-  if (!set->nsample || !psf->basis)
-    return RETURN_ERROR;
+  if (!set->nsample)
+    return;
 
   npix = psf->size[0]*psf->size[1];
   nvpix = set->vigsize[0]*set->vigsize[1];
   vigstep = 1/psf->pixstep;
+  resample = (prefs.precision_type==PRECISION_MIXED)?
+		vignet_resample_mixed : vignet_resample;
 
   npsf = psf->nbasis;
   ndata = psf->ndata? psf->ndata : set->vigsize[0]*set->vigsize[1]+1;
   poly = psf->poly;
-  ncontext = set->ncontext;
   ncoeff = poly->ncoeff;
   nsample = set->nsample;
   nunknown = ncoeff*npsf;
@@ -929,12 +1440,11 @@ int	psf_refine(psfstruct *psf, setstruct *set)
   QMALLOC(vig, float, nvpix);
 /* ... a vignet that will contain the current 1/sigma map... */
   QMALLOC(sigvig, double, nvpix);
-/* ... and allocate some more for storing the normal equations */
-  QCALLOC(alphamat, double, nunknown*nunknown);
-  QCALLOC(betamat, double, nunknown);
 /*
   psf_orthopoly(psf, set);
 */
+/* Compute the polynomial basis for all samples at once */
+  sbasis = psf_setbasis(psf, set);
 /* Go through each sample */
   for (sample=set->sample, n=0; n<nsample ; n++, sample++)
     {
@@ -946,13 +1456,10 @@ int	psf_refine(psfstruct *psf, setstruct *set)
     norm = (double)sample->norm;
 
 /*-- Build the local PSF */
-    for (i=0; i<ncontext; i++)
-      pos[i] = (sample->context[i]-set->contextoffset[i])
-		/set->contextscale[i];
-    psf_build(psf, pos);
+    psf_buildloc(psf, sbasis+n*ncoeff);
 
 /*-- Build the current context coefficient sub-matrix */
-    basis = poly_ortho(poly, poly->basis, poly->orthobasis);
+    basis = poly_ortho(poly, sbasis+n*ncoeff, poly->orthobasis);
     for (basist=basis, coeffmatt=coeffmat, l=ncoeff; l--;)
       for (dval=*(basist++), basist2=basis, i=ncoeff; i--;)
         *(coeffmatt++) = dval**(basist2++);
@@ -967,7 +1474,7 @@ int	psf_refine(psfstruct *psf, setstruct *set)
     if (psf->pixmask)
       {
 /*---- Map the PSF model at the current position */
-      vignet_resample(psf->loc, psf->size[0], psf->size[1],
+      resample(psf->loc, psf->size[0], psf->size[1],
 		vig, set->vigsize[0], set->vigsize[1], dx, dy, vigstep, 1.0);
 /*---- Subtract the PSF model */
       for (vigt=vig, vigt2=sample->vig, i=nvpix; i--; vigt++)
@@ -980,7 +1487,7 @@ int	psf_refine(psfstruct *psf, setstruct *set)
     for (i=0; i<npsf; i++)
       {
 /*---- Shift the current basis vector to the current PSF position */
-      vignet_resample(&psf->basis[i*npix], psf->size[0], psf->size[1],
+      resample(&psf->basis[i*npix], psf->size[0], psf->size[1],
 		vecvig, set->vigsize[0],set->vigsize[1], dx,dy, vigstep, 1.0);
 /*---- Retrieve coefficient for each relevant data pixel */
       for (vecvigt=vecvig, sigvigt=sigvig,
@@ -1036,6 +1543,7 @@ int	psf_refine(psfstruct *psf, setstruct *set)
           }
         if (fabs(dval) > (1/BIG))
           {
+          blockmask[j+k*npsf] = 1;
           alphamatt = alphamat+(j+k*npsf*ncoeff)*ncoeff;
           for (coeffmatt=coeffmat, l=ncoeff; l--; alphamatt+=matoffset)
             for (i=ncoeff; i--;)
@@ -1055,6 +1563,7 @@ int	psf_refine(psfstruct *psf, setstruct *set)
 
 /* Free some memory... */
   free(coeffmat);
+  free(sbasis);
   free(desmat);
   free(desindex);
   free(bmat);
@@ -1062,6 +1571,48 @@ int	psf_refine(psfstruct *psf, setstruct *set)
   free(vig);
   free(sigvig);
 
+  return;
+  }
+
+
+/****** psf_refinesolve *******************************************************
+PROTO	int	psf_refinesolve(psfstruct *psf, double *alphamat,
+			double *betamat, char *blockmask, int nsample)
+PURPOSE	Solve the normal equations of psf_refine() and update the PSF.
+INPUT	Pointer to the PSF,
+	pointer to the nunknown x nunknown normal equation matrix,
+	pointer to the nunknown right-hand side vector,
+	pointer to the npsf*npsf map of non-empty ncoeff*ncoeff blocks,
+	number of samples involved.
+OUTPUT  RETURN_OK if a PSF is succesfully computed, RETURN_ERROR otherwise.
+NOTES   Large systems are solved iteratively by psf_pcgsolve(), taking
+	advantage of their block-sparse structure; the dense Cholesky
+	factorisation is used as a fallback. The solution of the previous call,
+	corrected for the changes of the PSF model it is relative to, is the
+	starting point of the iterations. The Cholesky factor of small
+	systems is kept in the PSF structure and serves as a preconditioner in
+	the next call if the number of samples has changed by less than
+	PSF_REFACTORFRAC; the system is factorised again if this fails to
+	converge within PSF_REFINENITERMAX iterations. psf_freerefine() frees
+	them. alphamat, betamat and blockmask are taken over (and freed).
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+ ***/
+int	psf_refinesolve(psfstruct *psf, double *alphamat, double *betamat,
+			char *blockmask, int nsample)
+  {
+   polystruct		*poly;
+   double		*betamat2, *betamatt, *solmat,*solmatt, dval, norm,
+			tikfac;
+   float		*ppix,*ppixo, *vec, *bcoeff;
+   int			i,j,c, npix, ncoeff,npsf, nunknown, niter, factflag;
+
+  npix = psf->size[0]*psf->size[1];
+  npsf = psf->nbasis;
+  poly = psf->poly;
+  ncoeff = poly->ncoeff;
+  nunknown = ncoeff*npsf;
+
 /* Basic Tikhonov regularisation */
   if (psf->pixmask)
     {
@@ -1073,9 +1624,62 @@ int	psf_refine(psfstruct *psf, setstruct *set)
 
 //  NFPRINTF(OUTPUT,"Solving the system...");
 
-  clapack_dpotrf(CblasRowMajor, CblasUpper, nunknown, alphamat, nunknown);
-  clapack_dpotrs(CblasRowMajor, CblasUpper, nunknown, 1, alphamat, nunknown,
-	betamat, nunknown);
+/* Start from the previous solution if there is one */
+  QMALLOC(solmat, double, nunknown);
+  if (psf->refinesol && psf->nrefinesol==nunknown
+	&& (!psf->pixmask || psf->refinecomp))
+    {
+    memcpy(solmat, psf->refinesol, nunknown*sizeof(double));
+    if (psf->pixmask)
+/*---- Corrections apply to the current model: compensate for its changes */
+      for (solmatt=solmat, j=0; j<npsf; j++)
+        {
+        vec = &psf->basis[j*npix];
+        for (norm=0.0, i=npix; i--; vec++)
+          norm += *vec**vec;
+        if (norm <= 0.0)
+          {
+          solmatt += ncoeff;
+          continue;
+          }
+        for (c=0; c<ncoeff; c++)
+          {
+          vec = &psf->basis[j*npix];
+          ppix = psf->comp + c*npix;
+          ppixo = psf->refinecomp + c*npix;
+          for (dval=0.0, i=npix; i--;)
+            dval += *(vec++)*(*(ppixo++) - *(ppix++));
+          *(solmatt++) += dval/norm;
+          }
+        }
+    }
+  else
+    memset(solmat, 0, nunknown*sizeof(double));
+
+  niter = -1;
+  if (nunknown > PSF_NDIRECTMAX)
+/*-- Pixel-overlaps make the system block-sparse: solve it iteratively */
+    niter = psf_pcgsolve(alphamat, betamat, solmat, blockmask, NULL,
+		npsf, ncoeff, PSF_PCGNITERMAX);
+  else if (psf->refinefact && psf->nrefinefact==nunknown
+	&& abs(nsample - psf->refinensample)
+		<= (int)(PSF_REFACTORFRAC*psf->refinensample))
+/*-- Few samples have changed: precondition with the previous factorisation*/
+    niter = psf_pcgsolve(alphamat, betamat, solmat, blockmask,
+		psf->refinefact, npsf, ncoeff, PSF_REFINENITERMAX);
+  free(blockmask);
+
+  factflag = 0;
+  if (niter<0)
+    {
+    clapack_dpotrf(CblasRowMajor, CblasUpper, nunknown, alphamat, nunknown);
+    memcpy(solmat, betamat, nunknown*sizeof(double));
+    clapack_dpotrs(CblasRowMajor, CblasUpper, nunknown, 1, alphamat, nunknown,
+	solmat, nunknown);
+    factflag = (nunknown <= PSF_NDIRECTMAX);
+    }
+  free(betamat);
+  betamat = solmat;
 
 /* Check whether the result is coherent or not */
 #if defined(HAVE_ISNAN2) && defined(HAVE_ISINF)
@@ -1092,6 +1696,24 @@ int	psf_refine(psfstruct *psf, setstruct *set)
     return RETURN_ERROR;
     }
 
+/* Keep the solution and the factorisation for the next pass */
+  free(psf->refinesol);
+  QMEMCPY(betamat, psf->refinesol, double, nunknown);
+  psf->nrefinesol = nunknown;
+  if (psf->pixmask)
+    {
+    free(psf->refinecomp);
+    QMEMCPY(psf->comp, psf->refinecomp, float, npix*ncoeff);
+    }
+  if (factflag)
+    {
+    free(psf->refinefact);
+    psf->refinefact = alphamat;
+    psf->nrefinefact = nunknown;
+    psf->refinensample = nsample;
+    alphamat = NULL;
+    }
+
 //  NFPRINTF(OUTPUT,"Updating the PSF...");
   bcoeff = NULL;		/* To avoid gcc -Wall warnings */
   if (psf->basiscoeff)
@@ -1131,6 +1753,216 @@ int	psf_refine(psfstruct *psf, setstruct *set)
   }
 
 
+/****** psf_pcgsolve **********************************************************
+PROTO	int psf_pcgsolve(double *alphamat, double *betamat, double *sol,
+			char *blockmask, double *precfact, int npsf, int ncoeff,
+			int nitermax)
+PURPOSE	Solve the normal equations of psf_refine() using Conjugate Gradients
+	with a block-Jacobi or a Cholesky preconditioner.
+INPUT	Pointer to the normal equation matrix (upper triangle),
+	pointer to the right-hand side vector,
+	pointer to the solution vector (contains the initial guess on input),
+	pointer to the npsf*npsf map of non-empty ncoeff*ncoeff blocks,
+	pointer to the Cholesky factor of a nearby matrix (or NULL),
+	number of basis vectors,
+	number of polynomial coefficients,
+	maximum number of iterations.
+OUTPUT	Number of iterations, or -1 if the system could not be solved.
+NOTES	Each basis vector couples only with the few others it overlaps, hence
+	only the flagged blocks are involved in matrix products. alphamat and
+	betamat are left untouched. If precfact is NULL, the diagonal blocks
+	of alphamat are factorised to build the preconditioner.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static int	psf_pcgsolve(double *alphamat, double *betamat, double *sol,
+			char *blockmask, double *precfact, int npsf, int ncoeff,
+			int nitermax)
+  {
+   double	*precmat,*precmatt, *alphamatt, *resi,*zvec,*pvec,*qvec,
+		*solt,*resit,*zvect,*pvect,*qvect, *betamatt,
+		bnorm2,rnorm2, rz,rzo, pq, alpha,beta;
+   int		*blocki,*blockj,
+		i,j,k,l, nblock, nunknown, ncoeff2, niter;
+
+  nunknown = npsf*ncoeff;
+  ncoeff2 = ncoeff*ncoeff;
+
+/* List non-empty blocks in the upper triangle (diagonal ones included) */
+  QMALLOC(blocki, int, npsf*(npsf+1)/2);
+  QMALLOC(blockj, int, npsf*(npsf+1)/2);
+  nblock = 0;
+  for (k=0; k<npsf; k++)
+    for (j=k; j<npsf; j++)
+      if (j==k || blockmask[j+k*npsf])
+        {
+        blocki[nblock] = k;
+        blockj[nblock++] = j;
+        }
+
+/* Factorise the diagonal blocks to build the preconditioner, if needed */
+  precmat = NULL;
+  if (!precfact)
+    {
+    QMALLOC(precmat, double, npsf*ncoeff2);
+    for (precmatt=precmat, k=0; k<npsf; k++, precmatt+=ncoeff2)
+      {
+      alphamatt = alphamat + k*ncoeff*(nunknown+1);
+      for (l=0; l<ncoeff; l++)
+        memcpy(precmatt+l*ncoeff, alphamatt+l*nunknown,
+		ncoeff*sizeof(double));
+      if (clapack_dpotrf(CblasRowMajor, CblasUpper, ncoeff, precmatt, ncoeff))
+        {
+/*------ Not positive definite: leave it to the direct solver */
+        free(blocki);
+        free(blockj);
+        free(precmat);
+        return -1;
+        }
+      }
+    }
+
+  QMALLOC(resi, double, nunknown);
+  QMALLOC(zvec, double, nunknown);
+  QMALLOC(pvec, double, nunknown);
+  QMALLOC(qvec, double, nunknown);
+
+/* Initial residual r = b - A.x */
+  psf_blockmatvec(alphamat, blocki, blockj, nblock, npsf, ncoeff, sol,
+	qvec);
+  bnorm2 = rnorm2 = 0.0;
+  for (resit=resi, betamatt=betamat, qvect=qvec, i=nunknown; i--; betamatt++)
+    {
+    *resit = *betamatt - *(qvect++);
+    rnorm2 += *resit**resit;
+    resit++;
+    bnorm2 += *betamatt**betamatt;
+    }
+/* Fall back to a zero initial guess if it does worse */
+  if (rnorm2 > bnorm2)
+    {
+    memset(sol, 0, nunknown*sizeof(double));
+    memcpy(resi, betamat, nunknown*sizeof(double));
+    rnorm2 = bnorm2;
+    }
+
+  rz = 0.0;
+  for (niter=0; rnorm2 > PSF_PCGTOL*PSF_PCGTOL*bnorm2; niter++)
+    {
+    if (niter >= nitermax)
+      {
+      niter = -1;
+      break;
+      }
+/*-- Apply the preconditioner: z = M^-1.r */
+    memcpy(zvec, resi, nunknown*sizeof(double));
+    if (precfact)
+      clapack_dpotrs(CblasRowMajor, CblasUpper, nunknown, 1, precfact,
+		nunknown, zvec, nunknown);
+    else
+      for (precmatt=precmat, k=0; k<npsf; k++, precmatt+=ncoeff2)
+        clapack_dpotrs(CblasRowMajor, CblasUpper, ncoeff, 1, precmatt, ncoeff,
+		zvec+k*ncoeff, ncoeff);
+    rzo = rz;
+    rz = 0.0;
+    for (resit=resi, zvect=zvec, i=nunknown; i--;)
+      rz += *(resit++)**(zvect++);
+/*-- Update the search direction */
+    if (niter)
+      {
+      beta = rz/rzo;
+      for (pvect=pvec, zvect=zvec, i=nunknown; i--; pvect++)
+        *pvect = *(zvect++) + beta**pvect;
+      }
+    else
+      memcpy(pvec, zvec, nunknown*sizeof(double));
+    psf_blockmatvec(alphamat, blocki, blockj, nblock, npsf, ncoeff,
+	pvec, qvec);
+    pq = 0.0;
+    for (pvect=pvec, qvect=qvec, i=nunknown; i--;)
+      pq += *(pvect++)**(qvect++);
+    if (pq <= 0.0)
+      {
+/*---- Loss of positive-definiteness */
+      niter = -1;
+      break;
+      }
+    alpha = rz/pq;
+    rnorm2 = 0.0;
+    for (solt=sol, resit=resi, pvect=pvec, qvect=qvec, i=nunknown; i--;
+	resit++)
+      {
+      *(solt++) += alpha**(pvect++);
+      *resit -= alpha**(qvect++);
+      rnorm2 += *resit**resit;
+      }
+    }
+
+  free(blocki);
+  free(blockj);
+  free(precmat);
+  free(resi);
+  free(zvec);
+  free(pvec);
+  free(qvec);
+
+  return niter;
+  }
+
+
+/****** psf_blockmatvec *******************************************************
+PROTO	void psf_blockmatvec(double *alphamat, int *blocki, int *blockj,
+			int nblock, int npsf, int ncoeff, double *x, double *y)
+PURPOSE	Compute the product of a block-sparse symmetric matrix with a vector.
+INPUT	Pointer to the matrix (only the upper triangle is read),
+	pointer to the array of row block indices,
+	pointer to the array of column block indices,
+	number of non-empty blocks,
+	number of blocks per row or column,
+	block size,
+	pointer to the input vector,
+	pointer to the output vector.
+OUTPUT	-.
+NOTES	Blocks are listed for the upper triangle only (blocki <= blockj);
+	off-diagonal blocks are applied twice, through their transpose.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	psf_blockmatvec(double *alphamat, int *blocki, int *blockj,
+			int nblock, int npsf, int ncoeff, double *x, double *y)
+  {
+   double	*amat,*amatt, *xi,*xj,*yi,*yj,
+		dval, xval;
+   int		b,c,i,j,l, nunknown;
+
+  nunknown = npsf*ncoeff;
+  memset(y, 0, nunknown*sizeof(double));
+  for (b=0; b<nblock; b++)
+    {
+    i = blocki[b];
+    j = blockj[b];
+    amat = alphamat + (j+i*nunknown)*ncoeff;
+    xi = x + i*ncoeff;
+    xj = x + j*ncoeff;
+    yi = y + i*ncoeff;
+    yj = y + j*ncoeff;
+    for (l=0; l<ncoeff; l++, amat+=nunknown)
+      {
+      dval = 0.0;
+      for (amatt=amat, xval=xi[l], c=0; c<ncoeff; c++, amatt++)
+        {
+        dval += *amatt*xj[c];
+        if (j!=i)
+          yj[c] += *amatt*xval;
+        }
+      yi[l] += dval;
+      }
+    }
+
+  return;
+  }
+
+
 /****** psf_orthopoly *********************************************************
 PROTO	void	psf_orthopoly(psfstruct *psf)
 PURPOSE	Orthonormalize the polynomial basis over the range of possible contexts.
@@ -1138,33 +1970,25 @@ INPUT	PSF structure.
 OUTPUT  -.
 NOTES   -.
 AUTHOR  E. Bertin (IAP)
-VERSION 05/11/2008
+VERSION 19/10/2026
  ***/
 void psf_orthopoly(psfstruct *psf, setstruct *set)
   {
-   samplestruct	*sample;
    polystruct	*poly;
-   double	pos[POLY_MAXDIM],
-		*basis, *data,*datat,
+   double	*basis,*sbasis, *data,*datat,
 		norm;
-   int		c,i,n, ndim, ncoeff, ndata;
+   int		c,n, ncoeff, ndata;
 
   poly = psf->poly;
   ncoeff = poly->ncoeff;
-  ndim = poly->ndim;
   ndata = set->nsample;
   norm = -1.0/sqrt(ndata);
 
   QMALLOC(data, double, ndata*ncoeff);
+  sbasis = psf_setbasis(psf, set);
 /* Go through each sample */
-  for (sample=set->sample, n=0; n<ndata ; n++, sample++)
+  for (basis=sbasis, n=0; n<ndata ; n++)
     {
-/*-- Get the local context coordinates */
-    for (i=0; i<ndim; i++)
-      pos[i] = (sample->context[i]-set->contextoffset[i])
-		/set->contextscale[i];
-    poly_func(poly, pos);
-    basis = poly->basis;
     datat = data + n;
 /*-- Fill basis matrix as a series of row vectors */
     for (c=ncoeff; c--; datat+=ndata)
@@ -1173,6 +1997,7 @@ void psf_orthopoly(psfstruct *psf, setstruct *set)
 
   poly_initortho(poly, data, ndata);
   free(data);
+  free(sbasis);
 
   return;
   }
@@ -1448,7 +2273,7 @@ INPUT   Pointer to the PSF structure,
 OUTPUT  Number of basis vectors read.
 NOTES   The maximum degrees and number of dimensions allowed are set in poly.h.
 AUTHOR  E. Bertin (IAP)
-VERSION 13/11/2007
+VERSION 19/10/2026
  ***/
 int	psf_readbasis(psfstruct *psf, char *filename, int ext)
   {
@@ -1485,7 +2310,9 @@ int	psf_readbasis(psfstruct *psf, char *filename, int ext)
   npixin = tab->naxisn[0]*tab->naxisn[1];
   npixout = psf->size[0]*psf->size[1];
   QMALLOC(pixin, PIXTYPE, npixin);
-  ncomp = tab->tabsize/tab->bytepix/npixin;
+/* Works for both plain and tile-compressed datacubes */
+  for (ncomp=1, n=2; n<tab->naxis; n++)
+    ncomp *= tab->naxisn[n];
   QMALLOC(psf->basis, float, ncomp*npixout);
   QFSEEK(tab->cat->file, tab->bodypos, SEEK_SET, tab->cat->filename);
   for (n=0; n<ncomp; n++)
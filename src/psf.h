@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		10/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -50,6 +50,12 @@
 #define	GAUSS_LAG_OSAMP	3	/* Gauss-Laguerre oversampling factor */
 #define	PSF_AUTO_FWHM	3.0	/* FWHM theshold for PIXEL-AUTO mode */
 #define	PSF_NORTHOSTEP	16	/* Number of PSF orthonor. snapshots/dimension*/
+#define	PSF_NDIRECTMAX	1024	/* Max. nb of unknowns for a direct solve */
+#define	PSF_PCGTOL	1e-9	/* Relative residual target for PCG solves */
+#define	PSF_PCGNITERMAX	2000	/* Max. number of PCG iterations */
+#define	PSF_NFITPASS	3	/* Nb of clean/refit passes before final fit */
+#define	PSF_REFACTORFRAC 0.05	/* Max. sample change to reuse a factorisation*/
+#define	PSF_REFINENITERMAX 20	/* Max. PCG iterations w/ a reused factor */
 
 /*----------------------------- Type definitions --------------------------*/
 typedef enum {BASIS_NONE, BASIS_PIXEL, BASIS_GAUSS_LAGUERRE, BASIS_FILE,
@@ -89,6 +95,8 @@ typedef struct psf
   int		samples_loaded;	/* Number of detections loaded */
   int		samples_accepted;/* Number of detections accepted */
   double	chi2;		/* chi2/d.o.f. */
+  int		npass;		/* Number of make/refine passes run */
+  float		fit_timesaved;	/* Est. time saved by skipped passes (s) */
   float		fwhm;		/* Initial guess of the FWHM */
   int		*pixmask;	/* Pixel mask for local bases */
   float		*basis;		/* Basis vectors */
@@ -133,35 +141,53 @@ typedef struct psf
   float		*homo_kernel;		/* PSF homogenization kernel */
   double	homopsf_params[2];	/* Idealised Moffat PSF params*/
   int		homobasis_number;	/* nb of supersampled pixels */
+  float		mixed_reldiff;	/* Max. rel. PSF_MASK diff. MIXED vs DOUBLE */
+  double	*refinesol;	/* Last psf_refine() solution */
+  int		nrefinesol;	/* Number of elements in refinesol */
+  float		*refinecomp;	/* Components refinesol is relative to */
+  double	*refinefact;	/* Last psf_refine() Cholesky factor */
+  int		nrefinefact;	/* Size of the factorised system */
+  int		refinensample;	/* Number of samples in the factorised system */
   }	psfstruct;
 
 
 /*---------------------------------- protos --------------------------------*/
 extern void	psf_build(psfstruct *psf, double *pos),
+		psf_buildloc(psfstruct *psf, double *basis),
 		psf_clip(psfstruct *psf),
 		psf_end(psfstruct *psf),
+		psf_freerefine(psfstruct *psf),
 		psf_make(psfstruct *psf, setstruct *set, double prof_accuracy),
+		psf_makeaccu(psfstruct *psf, setstruct *set,
+			double prof_accuracy, double *alpha, double *beta),
 		psf_makebasis(psfstruct *psf, setstruct *set,
 			basistypenum basis_type,  int nvec),
 		psf_makeresi(psfstruct *psf, setstruct *set, int centflag,
 			double prof_accuracy),
 		psf_makemask(psfstruct *psf, setstruct *set, double chithresh),
+		psf_makesolve(psfstruct *psf, double *alpha, double *beta),
 		psf_orthopoly(psfstruct *psf, setstruct *set),
+		psf_refineaccu(psfstruct *psf, setstruct *set,
+			double *alphamat, double *betamat, char *blockmask),
+		psf_rejectsamples(setstruct *set, float chi2max),
 		psf_save(psfstruct *psf,  char *filename, int ext, int next);
 
 extern int	psf_pshapelet(float **shape, int w, int h, int nmax,
 			double beta),
 		psf_readbasis(psfstruct *psf, char *filename, int ext),
-		psf_refine(psfstruct *psf, setstruct *set);
+		psf_refine(psfstruct *psf, setstruct *set),
+		psf_refinesolve(psfstruct *psf, double *alphamat,
+			double *betamat, char *blockmask, int nsample);
 
 extern double	psf_chi2(psfstruct *psf, setstruct *set),
+		psf_chiclip(float *chi, int nchi, float *chi2max),
 		psf_clean(psfstruct *psf, setstruct *set, double prof_accuracy);
 
 extern psfstruct	*psf_copy(psfstruct *psf),
 			*psf_inherit(contextstruct *context, psfstruct *psf),
 			*psf_init(contextstruct *context, int *size,
 				float psfstep, float *pixsize, int nsample),
-			*psf_load(char *filename);
+			*psf_load(char *filename, int ext);
 
 #endif
 
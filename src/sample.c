@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		15/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -39,6 +39,7 @@
 #include "types.h"
 #include "globals.h"
 #include "fits/fitscat.h"
+#include "fitswcs.h"
 #include "prefs.h"
 #include "context.h"
 #include "misc.h"
@@ -48,6 +49,25 @@
 static float	compute_fwhmrange(float *fwhm, int nfwhm, float maxvar,
 		float minin, float maxin, float *minout, float *maxout);
 
+static sampwcsenum	wcs_contexttype(char *name);
+
+static void	read_focalref(catstruct *cat, char *filename, double *ref),
+		wcs_context(setstruct *set, int sample0, int nsample,
+			wcsstruct *wcs, double *ref, sampwcsenum *wcstype,
+			double *cmin, double *cmax);
+
+static wcsstruct	*read_samplewcs(char *head, char *filename);
+
+static int	sample_quota(setstruct *set, int ncall),
+		samplecand_cmp(const void *p1, const void *p2),
+		samplerank_cmp(const void *p1, const void *p2);
+
+static char	*select_samples(samplecandstruct *cand, int ncand, int nrow,
+			int nmax, char *head);
+
+static char	sampwcsname[][16] = {"", "ALPHA", "DELTA", "FOCAL_X", "FOCAL_Y",
+			""};
+
 /******************************** load_samples *******************************/
 /*
 Examine and load PSF candidates.
@@ -56,6 +76,86 @@ setstruct *load_samples(char **filename, int catindex, int ncat, int ext,
 			int next, contextstruct *context)
   {
    setstruct		*set;
+   float		*fwhmmin,*fwhmmax,*fwhmmode;
+   int			next2;
+
+//  NFPRINTF(OUTPUT,"Loading samples...");
+/* Allocate memory */
+  QMALLOC(fwhmmin, float, ncat);
+  QMALLOC(fwhmmax, float, ncat);
+  QMALLOC(fwhmmode, float, ncat);
+  next2 = scan_samples(filename, catindex, ncat, ext, next,
+		fwhmmin, fwhmmax, fwhmmode);
+  set = read_sampleset(filename, catindex, ncat, ext, next, next2, context,
+		fwhmmin, fwhmmax, fwhmmode);
+  free(fwhmmin);
+  free(fwhmmax);
+  free(fwhmmode);
+
+  return set;
+  }
+
+
+/****** sample_fwhm **********************************************************
+PROTO   float sample_fwhm(char **filename, int catindex, int ncat, int ext,
+			int next)
+PURPOSE Estimate the FWHM of the PSF candidates in a list of catalogues.
+INPUT   Array of catalogue file names,
+	index of the first catalogue,
+	number of catalogues,
+	extension (or ALL_EXTENSIONS),
+	number of extensions.
+OUTPUT  FWHM estimate (pixels).
+NOTES   Returns the same value as the fwhm member of the set produced by
+	load_samples(), without loading the vignets.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+*/
+float	sample_fwhm(char **filename, int catindex, int ncat, int ext, int next)
+  {
+   float		*fwhmmin,*fwhmmax,*fwhmmode,
+			mode;
+   int			i;
+
+  QMALLOC(fwhmmin, float, ncat);
+  QMALLOC(fwhmmax, float, ncat);
+  QMALLOC(fwhmmode, float, ncat);
+  scan_samples(filename, catindex, ncat, ext, next, fwhmmin,fwhmmax,fwhmmode);
+  mode = BIG;
+  for (i=0; i<ncat; i++)
+    if (fwhmmode[i]<mode)
+      mode = fwhmmode[i];
+  free(fwhmmin);
+  free(fwhmmax);
+  free(fwhmmode);
+
+  return mode;
+  }
+
+
+/****** scan_samples *********************************************************
+PROTO   int scan_samples(char **filename, int catindex, int ncat, int ext,
+			int next, float *fwhmmin, float *fwhmmax,
+			float *fwhmmode)
+PURPOSE Examine the PSF candidates of a list of catalogues to derive the range
+	of acceptable FWHMs.
+INPUT   Array of catalogue file names,
+	index of the first catalogue,
+	number of catalogues,
+	extension (or ALL_EXTENSIONS),
+	number of extensions,
+	array of ncat minimum FWHMs (output),
+	array of ncat maximum FWHMs (output),
+	array of ncat FWHM modes (output).
+OUTPUT  Number of extensions to be read by read_sampleset().
+NOTES   Only the FLUX_RADIUS, FLUX_MAX, FLAGS and ELONGATION columns are read.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+*/
+int	scan_samples(char **filename, int catindex, int ncat, int ext,
+			int next, float *fwhmmin, float *fwhmmax,
+			float *fwhmmode)
+  {
    catstruct		*cat;
    tabstruct		*tab;
    keystruct		*fkey, *(key[4]);
@@ -63,14 +163,12 @@ setstruct *load_samples(char **filename, int catindex, int ncat, int ext,
 					"ELONGATION"};
    char			str[MAXCHAR];
    char			*head, *(pkeynames[4]);
-   float		*fwhmmin,*fwhmmax,*fwhmmode,
-			*fwhm,*fwhmt, *hl, *fmax, *elong, *backnoises,
+   float		*fwhm,*fwhmt, *hl, *fmax, *elong, *backnoises,
 			backnoise, minsn, maxelong, min,max, mode,  fval;
    short		*flags;
    int			*fwhmindex,
-			e,i,j,n, icat, nobj,nobjmax, ldflag, ext2, next2;
+			e,i,j,k,n, icat, nobj,nobjmax, ldflag, ext2, next2;
 
-//  NFPRINTF(OUTPUT,"Loading samples...");
   minsn = (float)prefs.minsn;
   maxelong = (float)(prefs.maxellip < 1.0?
 	(prefs.maxellip + 1.0)/(1.0 - prefs.maxellip)
@@ -78,10 +176,6 @@ setstruct *load_samples(char **filename, int catindex, int ncat, int ext,
   min = (float)prefs.fwhmrange[0];
   max = (float)prefs.fwhmrange[1];
   fwhm = NULL;	/* To avoid gcc -Wall warnings */
-/* Allocate memory */
-  QMALLOC(fwhmmin, float, ncat);
-  QMALLOC(fwhmmax, float, ncat);
-  QMALLOC(fwhmmode, float, ncat);
   next2 = 1;
 
   if (prefs.autoselect_flag)
@@ -168,10 +262,10 @@ setstruct *load_samples(char **filename, int catindex, int ncat, int ext,
               break;
             ext2++;
             }
-          for (j=0; j<4; j++)
-            if (!(key[j]=name_to_key(tab, keynames[j])))
+          for (k=0; k<4; k++)
+            if (!(key[k]=name_to_key(tab, keynames[k])))
               {
-              sprintf(str, "%s not found in catalog %s", keynames[j],
+              sprintf(str, "%s not found in catalog %s", keynames[k],
 			filename[icat]);
               error(EXIT_FAILURE, "*Error*: ", str);
               }
@@ -252,20 +346,55 @@ setstruct *load_samples(char **filename, int catindex, int ncat, int ext,
       fwhmmode[i] = (fwhmmin[i] + fwhmmax[i]) / 2.0;
       }
 
+  return next2;
+  }
+
+
+/****** read_sampleset *******************************************************
+PROTO   setstruct *read_sampleset(char **filename, int catindex, int ncat,
+			int ext, int next, int next2, contextstruct *context,
+			float *fwhmmin, float *fwhmmax, float *fwhmmode)
+PURPOSE Load the PSF candidates of a list of catalogues.
+INPUT   Array of catalogue file names,
+	index of the first catalogue,
+	number of catalogues,
+	extension (or ALL_EXTENSIONS),
+	number of extensions,
+	number of extensions to read (from scan_samples()),
+	pointer to the context structure,
+	array of ncat minimum FWHMs,
+	array of ncat maximum FWHMs,
+	array of ncat FWHM modes.
+OUTPUT  Pointer to the new set.
+NOTES   The SAMPLE_MAXNUMBER budget is shared among the catalogues read.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+*/
+setstruct *read_sampleset(char **filename, int catindex, int ncat, int ext,
+			int next, int next2, contextstruct *context,
+			float *fwhmmin, float *fwhmmax, float *fwhmmode)
+  {
+   setstruct		*set;
+   char			str[MAXCHAR];
+   float		mode;
+   int			e,i, icat, ncall;
 
 /* Load the samples */
   set = NULL;
   mode = BIG;
+  ncall = (ext == ALL_EXTENSIONS? next2 : 1) * ncat;
   for (i=0; i<ncat; i++)
     {
     icat = catindex + i;
     if (ext == ALL_EXTENSIONS)
       for (e=0; e<next2; e++)
         set = read_samples(set, filename[icat], fwhmmin[i]/2.0, fwhmmax[i]/2.0,
-			e, next, icat, context, context->pc+i*context->npc);
+			e, next, icat, context, context->pc+icat*context->npc,
+			sample_quota(set, ncall--));
     else
       set = read_samples(set, filename[icat], fwhmmin[i]/2.0, fwhmmax[i]/2.0,
-			ext, next, icat, context, context->pc+i*context->npc);
+			ext, next, icat, context, context->pc+icat*context->npc,
+			sample_quota(set, ncall--));
     if (fwhmmode[i]<mode)
       mode = fwhmmode[i];
     }
@@ -278,9 +407,6 @@ setstruct *load_samples(char **filename, int catindex, int ncat, int ext,
   if (!set->nsample)
     warning("No appropriate source found!!","");
 
-  free(fwhmmin);
-  free(fwhmmax);
-  free(fwhmmode);
 /*
   if (set->badflags)
     printf("%d detections discarded with bad SExtractor flags\n",
@@ -365,33 +491,46 @@ static float	compute_fwhmrange(float *fwhm, int nfwhm, float maxvar,
 
 /******************************** read_samples *******************************/
 /*
+Context keys preceded by ':' are read from the FITS header; keys preceded by
+SAMPLE_WCSPREFIX ('%ALPHA', '%DELTA', '%FOCAL_X' and '%FOCAL_Y') are derived
+from the sample positions through the WCS of the current extension; the
+prefix is dropped from their names. FOCAL_X and FOCAL_Y are projected about
+the CRVAL of the first extension of the catalogue, whichever extension is
+read.
+At most nmax samples are added (no limit if nmax<0); these are picked among
+the candidates by select_samples().
 */
 setstruct *read_samples(setstruct *set, char *filename,
 			float frmin, float frmax,
 			int ext, int next, int catindex,
-			contextstruct *context, double *pcval)
+			contextstruct *context, double *pcval, int nmax)
 
   {
    catstruct		*cat;
    tabstruct		*tab, *keytab;
+   wcsstruct		*wcs;
    keystruct		*key, *vigkey;
    samplestruct		*sample;
    t_type		contexttyp[MAXCONTEXT];
+   sampwcsenum		wcstype[MAXCONTEXT];
    void			*contextvalp[MAXCONTEXT];
    static char		str[MAXCHAR], str2[MAXCHAR];
    char			**kstr,
-			*head, *buf;
+			*head, *buf, *sel;
    unsigned short	*flags;
+   samplecandstruct	*cand;
    double		contextval[MAXCONTEXT],
-			*dxm,*dym, *cmin, *cmax, dval, sn;
+			focalref[2],
+			*dxm,*dym, *cmin, *cmax, dval, sn, x,y;
    float		*xm, *ym, *vignet,*vignett, *flux, *fluxerr, *fluxrad,
 			*elong,
 			backnoise, backnoise2, gain, minsn,maxelong;
    static int		ncat;
    int			*lxm,*lym,
 			i,j, n, nsample,nsamplemax,
-			vigw, vigh, vigsize, nobj, nt,
-			maxbad, maxbadflag, ldflag, ext2, pc, contflag;
+			vigw, vigh, vigsize, nobj,
+			maxbad, maxbadflag, ldflag, ext2, pc, contflag,
+			nsample0, nrow, pass, ncand,ncandmax;
    short 		*sxm,*sym;
 
 
@@ -411,6 +550,8 @@ setstruct *read_samples(setstruct *set, char *filename,
     }
   else
     nsample = nsamplemax = set->nsample;
+  nsample0 = nsample;
+  ncandmax = 0;
 
   cmin = cmax = (double *)NULL;	/* To avoid gcc -Wall warnings */
   if (set->ncontext)
@@ -587,7 +728,10 @@ setstruct *read_samples(setstruct *set, char *filename,
 /* Try to load the set of context keys */
   kstr = context->name;
   pc = 0;
+  wcs = NULL;
   for (i=0; i<set->ncontext; i++, kstr++)
+    {
+    wcstype[i] = SAMPWCS_NONE;
     if (context->pcflag[i])
       {
       contextvalp[i] = &pcval[pc++];
@@ -605,6 +749,28 @@ setstruct *read_samples(setstruct *set, char *filename,
         error(EXIT_FAILURE, str, filename);
         }
       }
+    else if (**kstr==(char)SAMPLE_WCSPREFIX)
+      {
+      if ((wcstype[i] = wcs_contexttype(*kstr+1)) == SAMPWCS_NONE)
+        error(EXIT_FAILURE, "*Error*: unknown WCS-derived context key: ",
+		*kstr);
+/*---- Values are filled in one go once all samples have been read */
+      contextvalp[i] = NULL;
+      contexttyp[i] = T_DOUBLE;
+      strcpy(set->contextname[i], *kstr+1);
+      if (!wcs)
+        {
+        wcs = read_samplewcs(head, filename);
+/*------ Tangent point common to all the extensions of the catalogue */
+        if (ext)
+          read_focalref(cat, filename, focalref);
+        else
+          {
+          focalref[0] = wcs->crval[wcs->lng];
+          focalref[1] = wcs->crval[wcs->lat];
+          }
+        }
+      }
     else
       {
       if (!(key = name_to_key(keytab, *kstr)))
@@ -616,128 +782,179 @@ setstruct *read_samples(setstruct *set, char *filename,
       contexttyp[i] = key->ttype;
       strcpy(set->contextname[i], key->name);
       }
+    }
   if (next>1)
     sprintf(str2, "[%d/%d]", ext+1, next);
   else
     strcpy(str2, "");
 
 /* Now examine each vector of the shipment */
-  nt = keytab->naxisn[1];
-  for (n=0; nt; n++)
+/* If the number of samples is capped, a first pass only lists the candidates */
+/* and a stratified selection is made; the second pass reads back and stores */
+/* the selected rows only */
+  nrow = keytab->naxisn[1];
+  sel = NULL;
+  cand = NULL;
+  ncand = 0;
+  for (pass=(nmax>=0? 0:1); pass<2; pass++)
     {
-    nt = read_obj(keytab,tab, buf);
-    if (!(n%100))
+    for (n=0; n<nrow; n++)
       {
-      sprintf(str,"Catalog #%d %s: Object #%d / %d samples stored",
-	ncat, str2, n,nsample);
-//      NFPRINTF(OUTPUT, str);
-      }
-    sn = (double)(*fluxerr>0.0? *flux / *fluxerr : BIG);
+      if (sel)
+        {
+        if (!sel[n])
+          continue;
+        read_obj_at(keytab,tab, buf, n);
+        }
+      else
+        read_obj(keytab,tab, buf);
+      if (!(n%100))
+        {
+        sprintf(str,"Catalog #%d %s: Object #%d / %d samples stored",
+		ncat, str2, n,nsample);
+//        NFPRINTF(OUTPUT, str);
+        }
+      sn = (double)(*fluxerr>0.0? *flux / *fluxerr : BIG);
 /*---- Apply some selection over flags, fluxes... */
-    contflag = 0;
-    if (*flags&prefs.flag_mask)
-      {
-      contflag++;
-      set->badflags++;
-      }
-    if (sn<minsn)
-      {
-      contflag++;
-      set->badsn++;
-      }
-    if (*fluxrad<frmin)
-      {
-      contflag++;
-      set->badfrmin++;
-      }
-    if (*fluxrad>frmax)
-      {
-      contflag++;
-      set->badfrmax++;
-      }
-    if (*elong>maxelong)
-      {
-      contflag++;
-      set->badelong++;
-      }
-    if (contflag)
-      continue;
-/*-- ... and check the integrity of the sample */
-    j = 0;
-    vignett = vignet;
-    for (i=vigsize; i--; vignett++)
-      if (*vignett <= -BIG)
-        j++;
-    if (maxbadflag && j > maxbad)
-      {
-      set->badpix++;
-      continue; 
-      }
-    
-/*-- Allocate memory for the first shipment */
-    if (!set->sample)
-      {
-      nsample = 0;
-      nsamplemax = LSAMPLE_DEFSIZE;
-      malloc_samples(set, nsamplemax);
-      }
-    else
-      {
-      if (set->vigsize[0] != vigw || set->vigsize[1] != vigh)
-        error(EXIT_FAILURE, "*Error*: Incompatible VIGNET size found in ",
+      contflag = 0;
+      if (*flags&prefs.flag_mask)
+        {
+        contflag++;
+        set->badflags++;
+        }
+      if (sn<minsn)
+        {
+        contflag++;
+        set->badsn++;
+        }
+      if (*fluxrad<frmin)
+        {
+        contflag++;
+        set->badfrmin++;
+        }
+      if (*fluxrad>frmax)
+        {
+        contflag++;
+        set->badfrmax++;
+        }
+      if (*elong>maxelong)
+        {
+        contflag++;
+        set->badelong++;
+        }
+      if (contflag)
+        continue;
+/*---- ... and check the integrity of the sample */
+      j = 0;
+      vignett = vignet;
+      for (i=vigsize; i--; vignett++)
+        if (*vignett <= -BIG)
+          j++;
+      if (maxbadflag && j > maxbad)
+        {
+        set->badpix++;
+        continue; 
+        }
+
+      if (dxm)
+        x = *dxm;
+      else if (xm)
+        x = *xm;
+      else if (lxm)
+        x = *lxm;
+      else
+        x = *sxm;
+      if (dym)
+        y = *dym;
+      else if (ym)
+        y = *ym;
+      else if (lym)
+        y = *lym;
+      else
+        y = *sym;
+
+/*---- First pass: just record the candidate */
+      if (!pass)
+        {
+        if (ncand>=ncandmax)
+          {
+          ncandmax = ncandmax? 2*ncandmax : LSAMPLE_DEFSIZE;
+          QREALLOC(cand, samplecandstruct, ncandmax);
+          }
+        cand[ncand].row = n;
+        cand[ncand].x = (float)x;
+        cand[ncand].y = (float)y;
+        cand[ncand++].sn = (float)sn;
+        continue;
+        }
+
+/*---- Allocate memory for the first shipment */
+      if (!set->sample)
+        {
+        nsample = 0;
+        nsamplemax = LSAMPLE_DEFSIZE;
+        malloc_samples(set, nsamplemax);
+        }
+      else
+        {
+        if (set->vigsize[0] != vigw || set->vigsize[1] != vigh)
+          error(EXIT_FAILURE, "*Error*: Incompatible VIGNET size found in ",
 		filename);
-      }
+        }
 
-/*-- Increase storage space to receive new candidates if needed */
-    if (nsample>=nsamplemax)
-      {
-       int	nadd=(int)(1.62*nsamplemax);
-      nsamplemax = nadd>nsamplemax?nadd:nsamplemax+1;
-      realloc_samples(set, nsamplemax);
-      }
+/*---- Increase storage space to receive new candidates if needed */
+      if (nsample>=nsamplemax)
+        {
+         int	nadd=(int)(1.62*nsamplemax);
+        nsamplemax = nadd>nsamplemax?nadd:nsamplemax+1;
+        realloc_samples(set, nsamplemax);
+        }
 
-    sample = set->sample + nsample;
-    sample->catindex = catindex;
-    sample->extindex = ext;
-
-/*-- Copy the vignet to the training set */
-    memcpy(sample->vig, vignet, vigsize*sizeof(float));
-
-    sample->norm = *flux;
-    sample->backnoise2 = backnoise2;
-    sample->gain = gain;
-    if (dxm)
-      sample->x = *dxm;
-    else if (xm)
-      sample->x = *xm;
-    else if (lxm)
-      sample->x = *lxm;
-    else
-      sample->x = *sxm;
-    if (dym)
-      sample->y = *dym;
-    else if (ym)
-      sample->y = *ym;
-    else if (lym)
-      sample->y = *lym;
-    else
-      sample->y = *sym;
-    sample->dx = sample->x - (int)(sample->x+0.49999);
-    sample->dy = sample->y - (int)(sample->y+0.49999);
-    for (i=0; i<set->ncontext; i++)
+      sample = set->sample + nsample;
+      sample->catindex = catindex;
+      sample->extindex = ext;
+
+/*---- Copy the vignet to the training set */
+      memcpy(sample->vig, vignet, vigsize*sizeof(float));
+
+      sample->norm = *flux;
+      sample->backnoise2 = backnoise2;
+      sample->gain = gain;
+      sample->x = x;
+      sample->y = y;
+      sample->dx = sample->x - (int)(sample->x+0.49999);
+      sample->dy = sample->y - (int)(sample->y+0.49999);
+      for (i=0; i<set->ncontext; i++)
+        {
+        if (wcstype[i])
+          continue;
+        dval = sample->context[i];
+        ttypeconv(contextvalp[i], &dval, contexttyp[i], T_DOUBLE);
+        sample->context[i] = dval;
+/*------ Update min and max */
+        if (dval<cmin[i])
+          cmin[i] = dval;
+        if (dval>cmax[i])
+          cmax[i] = dval;
+        }
+      make_weights(set, sample);
+      recenter_sample(sample, set, *fluxrad);
+      nsample++;
+      }
+    if (!pass)
       {
-      dval = sample->context[i];
-      ttypeconv(contextvalp[i], &dval, contexttyp[i], T_DOUBLE);
-      sample->context[i] = dval;
-/*---- Update min and max */
-      if (dval<cmin[i])
-        cmin[i] = dval;
-      if (dval>cmax[i])
-        cmax[i] = dval;
+/*---- LDAC headers carry the original image dimensions */
+      sel = select_samples(cand, ncand, nrow, nmax, ldflag? NULL : head);
+      free(cand);
       }
-    make_weights(set, sample);
-    recenter_sample(sample, set, *fluxrad);
-    nsample++;
+    }
+  free(sel);
+
+/* Derive the WCS-based contexts of the new samples in a single batch */
+  if (wcs)
+    {
+    wcs_context(set, nsample0, nsample, wcs, focalref, wcstype, cmin, cmax);
+    end_wcs(wcs);
     }
 
 /* Update the scaling */
@@ -768,6 +985,396 @@ setstruct *read_samples(setstruct *set, char *filename,
   }
 
 
+/****** sample_quota *********************************************************
+PROTO   int sample_quota(setstruct *set, int ncall)
+PURPOSE Compute the maximum number of samples the next read_samples() call may
+	add to a set.
+INPUT   set structure pointer (may be NULL),
+	number of read_samples() calls left, including the next one.
+OUTPUT  Maximum number of samples, or -1 if unlimited.
+NOTES   The SAMPLE_MAXNUMBER budget left is shared evenly among the remaining
+	catalogues/extensions, so that budget unused by one goes to the next.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+*/
+static int	sample_quota(setstruct *set, int ncall)
+  {
+   int	nleft;
+
+  if (!prefs.sample_maxnumber)
+    return -1;
+  nleft = prefs.sample_maxnumber - (set? set->nsample : 0);
+  if (nleft<=0)
+    return 0;
+
+  return ncall>1? (nleft + ncall - 1) / ncall : nleft;
+  }
+
+
+/****** select_samples *******************************************************
+PROTO   char *select_samples(samplecandstruct *cand, int ncand, int nrow,
+			int nmax, char *head)
+PURPOSE Pick a spatially stratified subset of PSF candidates.
+INPUT   Pointer to the array of candidates,
+	number of candidates,
+	number of rows in the catalogue table,
+	maximum number of candidates to keep,
+	pointer to the image header (or NULL).
+OUTPUT  Selection mask (one element per table row).
+NOTES   The image is divided into PSFVAR_NSNAP x PSFVAR_NSNAP cells, as in
+	field_count(). Candidates are ranked by decreasing S/N within each
+	cell, and picked rank after rank across all cells, so that sparse
+	areas keep all their stars and dense ones keep their brightest.
+	The grid covers NAXIS1 x NAXIS2 if found in the header, and the
+	bounding box of the candidates otherwise. The input array is sorted.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+*/
+static char	*select_samples(samplecandstruct *cand, int ncand, int nrow,
+			int nmax, char *head)
+  {
+   samplecandstruct	*c;
+   char			*sel;
+   float		x0,y0, w,h;
+   int			i, nsnap, ix,iy, imw,imh, rank;
+
+  QCALLOC(sel, char, nrow);
+  if (!ncand)
+    return sel;
+
+  nsnap = prefs.context_nsnap>1? prefs.context_nsnap : 1;
+  imw = imh = 0;
+  if (head)
+    {
+    fitsread(head, "NAXIS1  ", &imw, H_INT, T_LONG);
+    fitsread(head, "NAXIS2  ", &imh, H_INT, T_LONG);
+    }
+  if (imw>0 && imh>0)
+    {
+    x0 = y0 = 0.5;
+    w = (float)imw;
+    h = (float)imh;
+    }
+  else
+    {
+    x0 = y0 = BIG;
+    w = h = -BIG;
+    for (i=ncand, c=cand; i--; c++)
+      {
+      if (c->x<x0)
+        x0 = c->x;
+      if (c->x>w)
+        w = c->x;
+      if (c->y<y0)
+        y0 = c->y;
+      if (c->y>h)
+        h = c->y;
+      }
+    w = w - x0 + 1.0;
+    h = h - y0 + 1.0;
+    }
+
+  for (i=ncand, c=cand; i--; c++)
+    {
+    ix = (int)((c->x - x0)*nsnap/w);
+    if (ix<0)
+      ix = 0;
+    else if (ix>=nsnap)
+      ix = nsnap-1;
+    iy = (int)((c->y - y0)*nsnap/h);
+    if (iy<0)
+      iy = 0;
+    else if (iy>=nsnap)
+      iy = nsnap-1;
+    c->cell = iy*nsnap + ix;
+    }
+
+/* Rank candidates by S/N within each cell */
+  qsort(cand, ncand, sizeof(samplecandstruct), samplecand_cmp);
+  rank = 0;
+  for (i=0, c=cand; i<ncand; i++, c++)
+    {
+    rank = (i && c->cell==(c-1)->cell)? rank+1 : 0;
+    c->rank = rank;
+    }
+
+/* Keep the nmax best-ranked candidates */
+  if (ncand>nmax)
+    {
+    qsort(cand, ncand, sizeof(samplecandstruct), samplerank_cmp);
+    ncand = nmax;
+    }
+  for (i=ncand, c=cand; i--; c++)
+    sel[c->row] = 1;
+
+  return sel;
+  }
+
+
+/*i**** samplecand_cmp *******************************************************
+PROTO   int samplecand_cmp(const void *p1, const void *p2)
+PURPOSE Sorting function for qsort(): by cell, then by decreasing S/N.
+INPUT   Pointer to first candidate,
+	pointer to second candidate.
+OUTPUT  1 if *p1 comes after *p2, -1 if before, 0 otherwise.
+NOTES   Ties are broken with the row number to make the selection stable.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+*/
+static int	samplecand_cmp(const void *p1, const void *p2)
+  {
+   samplecandstruct	*c1=(samplecandstruct *)p1,
+			*c2=(samplecandstruct *)p2;
+
+  if (c1->cell != c2->cell)
+    return c1->cell>c2->cell? 1 : -1;
+  if (c1->sn != c2->sn)
+    return c1->sn<c2->sn? 1 : -1;
+  return c1->row>c2->row? 1 : (c1->row<c2->row? -1 : 0);
+  }
+
+
+/*i**** samplerank_cmp *******************************************************
+PROTO   int samplerank_cmp(const void *p1, const void *p2)
+PURPOSE Sorting function for qsort(): by rank, then by decreasing S/N.
+INPUT   Pointer to first candidate,
+	pointer to second candidate.
+OUTPUT  1 if *p1 comes after *p2, -1 if before, 0 otherwise.
+NOTES   Ties are broken with the row number to make the selection stable.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+*/
+static int	samplerank_cmp(const void *p1, const void *p2)
+  {
+   samplecandstruct	*c1=(samplecandstruct *)p1,
+			*c2=(samplecandstruct *)p2;
+
+  if (c1->rank != c2->rank)
+    return c1->rank>c2->rank? 1 : -1;
+  if (c1->sn != c2->sn)
+    return c1->sn<c2->sn? 1 : -1;
+  return c1->row>c2->row? 1 : (c1->row<c2->row? -1 : 0);
+  }
+
+
+/****** read_samplewcs ******************************************************
+PROTO   wcsstruct *read_samplewcs(char *head, char *filename)
+PURPOSE Read the celestial WCS of a catalogue extension from its image header.
+INPUT   Pointer to the image header,
+	catalogue filename (for error messages).
+OUTPUT  Pointer to a new WCS structure.
+NOTES   Exits with an error if no celestial coordinates are found.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+*/
+static wcsstruct	*read_samplewcs(char *head, char *filename)
+  {
+   tabstruct	*imatab;
+   wcsstruct	*wcs;
+   int		n;
+
+  if ((n=fitsfind(head, "END     ")) == RETURN_ERROR)
+    error(EXIT_FAILURE, "*Error*: corrupted image header in ", filename);
+/* Create a new table from scratch to hold the image header */
+  imatab = new_tab("Image header");
+  free(imatab->headbuf);
+  imatab->headnblock = 1 + ((n+1)*80-1)/FBSIZE;
+  QCALLOC(imatab->headbuf, char, imatab->headnblock*FBSIZE);
+  memcpy(imatab->headbuf, head, (n+1)*80);
+  readbasic_head(imatab);
+  wcs = read_wcs(imatab);
+  free_tab(imatab);
+  if (wcs->naxis<2 || wcs->lng<0 || wcs->lat<0)
+    error(EXIT_FAILURE, "*Error*: no celestial WCS found in ", filename);
+
+  return wcs;
+  }
+
+
+/****** read_focalref ******************************************************
+PROTO   void read_focalref(catstruct *cat, char *filename, double *ref)
+PURPOSE Read the focal-plane tangent point of a catalogue.
+INPUT   Pointer to the catalogue,
+	catalogue filename (for error messages),
+	pointer to the tangent point (output, native celestial system, deg).
+OUTPUT  -.
+NOTES   The tangent point is the projection point (CRVAL) of the first
+	extension, so that FOCAL_X and FOCAL_Y share one frame across the
+	chips of a mosaic even if each chip has its own CRVAL. The current
+	position in the catalogue file is preserved, as object rows may be
+	being read from it.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+*/
+static void	read_focalref(catstruct *cat, char *filename, double *ref)
+  {
+   tabstruct	*tab;
+   keystruct	*key;
+   wcsstruct	*wcs;
+   char		*head;
+   OFF_T	pos;
+   float	backnoise;
+   int		j, ldflag;
+
+/* Same look-up as in read_samples(), for the first extension */
+  head = (char *)NULL;
+  ldflag = 1;
+  tab = cat->tab;
+  for (j=cat->ntab; j--; tab=tab->nexttab)
+    if (!(ldflag = strcmp("LDAC_IMHEAD",tab->extname))
+	  || fitsread(head=tab->headbuf,"SEXBKDEV",&backnoise,H_FLOAT,T_FLOAT)
+		==RETURN_OK)
+      break;
+  if (j<0)
+    error(EXIT_FAILURE, "*Error*: SExtractor table missing in ", filename);
+  if (!ldflag)
+    {
+    QFTELL(cat->file, pos, filename);
+    key = read_key(tab, "Field Header Card");
+    head = key->ptr;
+    QFSEEK(cat->file, pos, SEEK_SET, filename);
+    }
+  wcs = read_samplewcs(head, filename);
+  ref[0] = wcs->crval[wcs->lng];
+  ref[1] = wcs->crval[wcs->lat];
+  end_wcs(wcs);
+
+  return;
+  }
+
+
+/****** wcs_contexttype ******************************************************
+PROTO   sampwcsenum wcs_contexttype(char *name)
+PURPOSE Identify a WCS-derived context key.
+INPUT   Context key name, without prefix.
+OUTPUT  Type of WCS-derived context, or SAMPWCS_NONE if unknown.
+NOTES   -.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+*/
+static sampwcsenum	wcs_contexttype(char *name)
+  {
+   int	i;
+
+  for (i=1; *sampwcsname[i]; i++)
+    if (!wstrncmp(name, sampwcsname[i], 80))
+      return (sampwcsenum)i;
+
+  return SAMPWCS_NONE;
+  }
+
+
+/****** wcs_context **********************************************************
+PROTO   void wcs_context(setstruct *set, int sample0, int nsample,
+			wcsstruct *wcs, double *ref, sampwcsenum *wcstype,
+			double *cmin, double *cmax)
+PURPOSE Compute WCS-derived context values for a range of samples.
+INPUT   set structure pointer,
+	index of the first sample,
+	index of the last sample + 1,
+	WCS structure of the extension the samples come from,
+	focal-plane tangent point (native celestial system, deg),
+	array of WCS-derived context types (SAMPWCS_NONE for other contexts),
+	array of context minima (updated),
+	array of context maxima (updated).
+OUTPUT  -.
+NOTES   Sample positions are converted in a single raw_to_wcs_batch() call.
+	ALPHA is unwrapped around the tangent point to stay continuous
+	across RA=0. FOCAL_X and FOCAL_Y are gnomonic standard coordinates
+	(in deg) about the tangent point (see read_focalref()), which provides
+	a common focal-plane frame for MEF_TYPE COMMON models.
+AUTHOR  PSFEx contributors
+VERSION 19/10/2026
+*/
+static void	wcs_context(setstruct *set, int sample0, int nsample,
+			wcsstruct *wcs, double *ref, sampwcsenum *wcstype,
+			double *cmin, double *cmax)
+  {
+   samplestruct	*sample;
+   double	crval[NAXIS],
+		*pixpos,*pixpost, *wcspos,*wcspost,
+		a0,sind0,cosd0, da,sinda,cosda, sind,cosd, den, dval;
+   int		i,d,n, naxis, lng,lat, npos;
+
+  if ((npos = nsample - sample0) < 1)
+    return;
+  naxis = wcs->naxis;
+  lng = wcs->lng;
+  lat = wcs->lat;
+  QMALLOC(pixpos, double, npos*naxis);
+  QMALLOC(wcspos, double, npos*naxis);
+  sample = set->sample + sample0;
+  pixpost = pixpos;
+  for (n=npos; n--; sample++)
+    {
+    for (d=0; d<naxis; d++)
+      pixpost[d] = 1.0;
+    pixpost[0] = sample->x;
+    pixpost[1] = sample->y;
+    pixpost += naxis;
+    }
+  raw_to_wcs_batch(wcs, pixpos, wcspos, npos);
+
+/* The tangent point, in the same system as the output coordinates */
+  for (d=0; d<naxis; d++)
+    crval[d] = wcs->crval[d];
+  crval[lng] = ref[0];
+  crval[lat] = ref[1];
+  if (wcs->celsysconvflag)
+    celsys_to_eq(wcs, crval);
+  a0 = crval[lng]*DEG;
+  sind0 = sin(crval[lat]*DEG);
+  cosd0 = cos(crval[lat]*DEG);
+
+  sample = set->sample + sample0;
+  wcspost = wcspos;
+  for (n=npos; n--; sample++, wcspost+=naxis)
+    {
+    da = wcspost[lng]*DEG - a0;
+    sinda = sin(da);
+    cosda = cos(da);
+    sind = sin(wcspost[lat]*DEG);
+    cosd = cos(wcspost[lat]*DEG);
+    den = sind*sind0 + cosd*cosd0*cosda;
+    if (den < 1.0/BIG)
+      den = 1.0/BIG;
+    for (i=0; i<set->ncontext; i++)
+      {
+      switch(wcstype[i])
+        {
+        case SAMPWCS_ALPHA:
+          dval = crval[lng] + fmod(wcspost[lng] - crval[lng] + 540.0, 360.0)
+		- 180.0;
+          break;
+        case SAMPWCS_DELTA:
+          dval = wcspost[lat];
+          break;
+        case SAMPWCS_FOCALX:
+          dval = cosd*sinda/den/DEG;
+          break;
+        case SAMPWCS_FOCALY:
+          dval = (sind*cosd0 - cosd*sind0*cosda)/den/DEG;
+          break;
+        case SAMPWCS_NONE:
+        default:
+          continue;
+        }
+      sample->context[i] = dval;
+/*---- Update min and max */
+      if (dval<cmin[i])
+        cmin[i] = dval;
+      if (dval>cmax[i])
+        cmax[i] = dval;
+      }
+    }
+
+  free(pixpos);
+  free(wcspos);
+
+  return;
+  }
+
+
 /****** recenter_sample ******************************************************
 PROTO   void recenter_samples(samplestruct sample,
 		setstruct *set, float fluxrad)
@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		10/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -41,6 +41,12 @@
 #define	RECENTER_OVERSAMP	3	/* Oversampling for recentering */
 #define	RECENTER_STEPMIN	0.001	/* Min. recentering coordinate update */
 #define	RECENTER_GRADFAC	2.0	/* Gradient descent accel. factor */
+#define	SAMPLE_WCSPREFIX	'%'	/* Prefix of WCS-derived context keys */
+
+/*--------------------------------- typedefs --------------------------------*/
+
+typedef enum {SAMPWCS_NONE, SAMPWCS_ALPHA, SAMPWCS_DELTA, SAMPWCS_FOCALX,
+		SAMPWCS_FOCALY}	sampwcsenum;	/* WCS-derived contexts */
 
 /*--------------------------- structure definitions -------------------------*/
 
@@ -63,6 +69,15 @@ typedef struct sample
   double	*context;		/* Context vector */
   }	samplestruct;
 
+typedef struct samplecand
+  {
+  int		row;			/* Row in the catalogue table */
+  int		cell;			/* Cell in the grid of image areas */
+  int		rank;			/* S/N rank within the cell */
+  float		x,y;			/* Position in the image */
+  float		sn;			/* Signal-to-noise ratio */
+  }	samplecandstruct;
+
 typedef struct set
   {
   char		*head;			/* Table structure */
@@ -95,7 +110,17 @@ setstruct	*init_set(contextstruct *context),
 		*read_samples(setstruct *set, char *filename,
 			float frmin, float frmax,
 			int ext, int next, int catindex,
-			contextstruct *context, double *pcval);
+			contextstruct *context, double *pcval, int nmax),
+		*read_sampleset(char **filename, int catindex, int ncat,
+			int ext, int next, int next2, contextstruct *context,
+			float *fwhmmin, float *fwhmmax, float *fwhmmode);
+
+float		sample_fwhm(char **filename, int catindex, int ncat, int ext,
+			int next);
+
+int		scan_samples(char **filename, int catindex, int ncat, int ext,
+			int next, float *fwhmmin, float *fwhmmax,
+			float *fwhmmode);
 
 void		end_set(setstruct *set),
 		free_samples(setstruct *set),
@@ -0,0 +1,453 @@
+/*
+*				server.c
+*
+* Process a queue of jobs dropped in a spool directory.
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*
+*	This file part of:	PSFEx
+*
+*	Copyright:		(C) 2026 Emmanuel Bertin -- IAP/CNRS/UPMC
+*
+*	License:		GNU General Public License
+*
+*	PSFEx is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+* 	(at your option) any later version.
+*	PSFEx is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*	You should have received a copy of the GNU General Public License
+*	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
+*
+*	Last modified:		19/10/2026
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+#ifdef HAVE_CONFIG_H
+#include	"config.h"
+#endif
+
+#include	<dirent.h>
+#include	<errno.h>
+#include	<fcntl.h>
+#include	<signal.h>
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<unistd.h>
+#include	<sys/file.h>
+#include	<sys/types.h>
+#include	<sys/wait.h>
+
+#include	"define.h"
+#include	"types.h"
+#include	"globals.h"
+#include	"fits/fitscat.h"
+#include	"prefs.h"
+#include	"server.h"
+
+extern const char	notokstr[];
+extern void		makeit(void);
+
+static int		server_path(char *path, char *name, char *suffix),
+			server_scan(char ***pnames, char *suffix),
+			server_start(serverjobstruct *job, char *name),
+			server_strcmp(const void *str1, const void *str2);
+
+static void		server_end(serverjobstruct *job, int status),
+			server_job(char *name),
+			server_recover(void),
+			server_signal(int sig);
+
+static volatile sig_atomic_t	server_stopflag;
+
+/****** server_run ***********************************************************
+PROTO	void server_run(void)
+PURPOSE	Process the jobs dropped in the spool directory until the server is
+	asked to stop.
+INPUT	-.
+OUTPUT	-.
+NOTES	A job is a file named <job>.job in SPOOL_DIR, listing the input
+	catalogues like an @list on the command line. Jobs are taken in
+	name order and each is processed by a child process forked from the
+	server, so that the configuration is parsed once and a failing job
+	cannot affect the others. Up to NTHREADS jobs run concurrently, each on
+	a single thread. The descriptor is renamed to <job>.run while
+	processing, then to <job>.done or <job>.failed; the job log, XML
+	output and checkpoint go to <job>.log, <job>.xml and <job>.chk in the
+	spool directory. The server stops on SIGINT or SIGTERM once running
+	jobs are completed. Jobs left as <job>.run by a server that died are
+	put back in the queue at startup.
+	What stays warm across jobs is what the server holds when it forks:
+	the parsed configuration and the libraries initialised at load time.
+	PSF bases, contexts and FFTW plans depend on the catalogues of each
+	job (sampling step, number of extensions) and are built by the job.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+void	server_run(void)
+  {
+   struct sigaction	sa;
+   serverjobstruct	*jobs;
+   DIR			*dir;
+   char			**names;
+   pid_t		pid;
+   int			j,n, njob, nname, status, startflag;
+
+  if (!(dir = opendir(prefs.spool_dir)))
+    error(EXIT_FAILURE, "*Error*: cannot open spool directory ",
+	prefs.spool_dir);
+  closedir(dir);
+/* Job names are at most MAXCHAR/2 long: leave room for the longest path */
+  if (strlen(prefs.spool_dir) + MAXCHAR/2 + 16 > MAXCHAR)
+    error(EXIT_FAILURE, "*Error*: spool directory path too long: ",
+	prefs.spool_dir);
+
+/* Stop gracefully on request; running jobs are in their own process group */
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = server_signal;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+/* A job writing to a closed pipe gets EPIPE instead of being killed */
+  sa.sa_handler = SIG_IGN;
+  sigaction(SIGPIPE, &sa, NULL);
+
+  server_recover();
+
+  QCALLOC(jobs, serverjobstruct, prefs.nthreads);
+  NPRINTF(OUTPUT, "> Waiting for jobs in %s (%d at a time)\n",
+	prefs.spool_dir, prefs.nthreads);
+  njob = 0;
+  while (!server_stopflag || njob)
+    {
+/*-- Collect completed jobs */
+    while (njob && (pid = waitpid(-1, &status, WNOHANG)) > 0)
+      for (j=0; j<prefs.nthreads; j++)
+        if (jobs[j].pid == pid)
+          {
+          server_end(&jobs[j], status);
+          njob--;
+          break;
+          }
+/*-- Start pending jobs in the free slots */
+    startflag = 0;
+    if (!server_stopflag && njob<prefs.nthreads)
+      {
+      nname = server_scan(&names, SERVER_JOBSUFFIX);
+      for (n=0, j=0; n<nname && njob<prefs.nthreads; n++)
+        {
+        for (; jobs[j].pid; j++);
+        if (server_start(&jobs[j], names[n]) == RETURN_OK)
+          {
+          njob++;
+          startflag = 1;
+          }
+        }
+      for (n=0; n<nname; n++)
+        free(names[n]);
+      free(names);
+      }
+    if (!startflag)
+      usleep(SERVER_POLLTIME);
+    }
+
+  free(jobs);
+  NPRINTF(OUTPUT, "> Server stopped\n");
+
+  return;
+  }
+
+
+/****** server_recover *******************************************************
+PROTO	void server_recover(void)
+PURPOSE	Put back in the queue the jobs left running by a server that died.
+INPUT	-.
+OUTPUT	-.
+NOTES	A running job descriptor is locked by the process that processes the
+	job, and the lock goes away with the process: a <job>.run file that
+	can be locked belongs to no live job, even with several servers
+	sharing the spool directory.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	server_recover(void)
+  {
+   char		jobname[MAXCHAR], runname[MAXCHAR],
+		**names;
+   int		n, fd, nname;
+
+  nname = server_scan(&names, SERVER_RUNSUFFIX);
+  for (n=0; n<nname; n++)
+    {
+    if (server_path(jobname, names[n], SERVER_JOBSUFFIX) == RETURN_OK
+	&& server_path(runname, names[n], SERVER_RUNSUFFIX) == RETURN_OK
+	&& (fd = open(runname, O_RDONLY)) >= 0)
+      {
+      if (!flock(fd, LOCK_EX|LOCK_NB))
+        {
+        if (rename(runname, jobname))
+          warning("Cannot requeue orphaned job ", names[n]);
+        else
+          warning("Orphaned job requeued: ", names[n]);
+        }
+      close(fd);
+      }
+    free(names[n]);
+    }
+  free(names);
+
+  return;
+  }
+
+
+/****** server_scan **********************************************************
+PROTO	int server_scan(char ***pnames, char *suffix)
+PURPOSE	List the jobs with a given descriptor suffix in the spool directory.
+INPUT	Pointer to the array of job names to be allocated,
+	descriptor suffix (e.g. SERVER_JOBSUFFIX for pending jobs).
+OUTPUT	Number of jobs.
+NOTES	Job names are sorted in alphabetical order.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static int	server_scan(char ***pnames, char *suffix)
+  {
+   DIR			*dir;
+   struct dirent	*entry;
+   char			**names;
+   int			l, nname, nnamemax, suffixlen;
+
+  nname = 0;
+  nnamemax = 16;
+  QMALLOC(names, char *, nnamemax);
+  suffixlen = strlen(suffix);
+  if ((dir = opendir(prefs.spool_dir)))
+    {
+    while ((entry = readdir(dir)))
+      {
+      l = strlen(entry->d_name) - suffixlen;
+      if (l<1 || l>MAXCHAR/2
+	|| strcmp(entry->d_name+l, suffix))
+        continue;
+      if (nname>=nnamemax)
+        {
+        nnamemax *= 2;
+        QREALLOC(names, char *, nnamemax);
+        }
+      QMALLOC(names[nname], char, l+1);
+      strncpy(names[nname], entry->d_name, l);
+      names[nname++][l] = '\0';
+      }
+    closedir(dir);
+    }
+  qsort(names, nname, sizeof(char *), server_strcmp);
+  *pnames = names;
+
+  return nname;
+  }
+
+
+/****** server_start *********************************************************
+PROTO	int server_start(serverjobstruct *job, char *name)
+PURPOSE	Claim a pending job and start processing it in a child process.
+INPUT	Pointer to a free job slot,
+	job name.
+OUTPUT	RETURN_OK if the job was started, RETURN_ERROR otherwise.
+NOTES	The job is claimed by renaming its descriptor, which is atomic: a job
+	can be taken by only one of several servers sharing the spool
+	directory. The descriptor is locked before, and the lock is handed
+	over to the child process (see server_recover()).
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static int	server_start(serverjobstruct *job, char *name)
+  {
+   char		jobname[MAXCHAR], runname[MAXCHAR];
+   pid_t	pid;
+   int		fd;
+
+  if (server_path(jobname, name, SERVER_JOBSUFFIX) != RETURN_OK
+	|| server_path(runname, name, SERVER_RUNSUFFIX) != RETURN_OK)
+    {
+    warning("Job name too long: ", name);
+    return RETURN_ERROR;
+    }
+  if ((fd = open(jobname, O_RDONLY)) < 0)
+    return RETURN_ERROR;
+  if (flock(fd, LOCK_EX|LOCK_NB) || rename(jobname, runname))
+    {
+    close(fd);
+    return RETURN_ERROR;
+    }
+  fflush(NULL);
+  if ((pid = fork()) < 0)
+    {
+    warning("Cannot start a process for job ", name);
+    rename(runname, jobname);
+    close(fd);
+    return RETURN_ERROR;
+    }
+  if (!pid)
+    server_job(name);
+/* The child keeps the descriptor locked until it exits */
+  close(fd);
+
+  job->pid = pid;
+  strcpy(job->name, name);
+  NPRINTF(OUTPUT, "> Job %s started\n", name);
+
+  return RETURN_OK;
+  }
+
+
+/****** server_job ***********************************************************
+PROTO	void server_job(char *name)
+PURPOSE	Process a job in a child process.
+INPUT	Job name.
+OUTPUT	-.
+NOTES	Does not return: the exit status of the child is that of the job.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	server_job(char *name)
+  {
+   struct sigaction	sa;
+   char			str[MAXCHAR],
+			*listbuf, *cstr;
+   int			ncat, ntok;
+
+/* Keep running jobs out of reach of interrupts sent to the server */
+  setpgid(0, 0);
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = SIG_DFL;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+
+  if (server_path(str, name, ".log") != RETURN_OK
+	|| !freopen(str, "w", stderr) || !freopen(str, "a", stdout))
+    exit(EXIT_FAILURE);
+#ifdef HAVE_SETLINEBUF
+  setlinebuf(stderr);
+#endif
+
+/* Input catalogues */
+  if (server_path(str, name, SERVER_RUNSUFFIX) != RETURN_OK)
+    error(EXIT_FAILURE, "*Error*: job name too long: ", name);
+  listbuf = list_to_str(str);
+  cstr = listbuf;
+  for (ncat=0, ntok=0; (cstr=strtok(ntok?NULL:cstr, notokstr)); ncat++,ntok++)
+    if (ncat<MAXFILE)
+      prefs.incat_name[ncat] = cstr;
+    else
+      error(EXIT_FAILURE, "*Error*: Too many input catalogues: ", cstr);
+  if (!ncat)
+    error(EXIT_FAILURE, "*Error*: No input catalogue in ", str);
+  prefs.ncat = ncat;
+
+/* Job outputs */
+  if (server_path(prefs.xml_name, name, ".xml") != RETURN_OK
+	|| server_path(prefs.checkpoint_name, name, ".chk") != RETURN_OK)
+    error(EXIT_FAILURE, "*Error*: job name too long: ", name);
+  prefs.nthreads = 1;
+  set_tilenthreads(1);
+
+  makeit();
+
+  NFPRINTF(OUTPUT, "");
+  NPRINTF(OUTPUT, "> All done (in %.1f s)\n", prefs.time_diff);
+
+  exit(EXIT_SUCCESS);
+  }
+
+
+/****** server_end ***********************************************************
+PROTO	void server_end(serverjobstruct *job, int status)
+PURPOSE	Record the outcome of a job and free its slot.
+INPUT	Pointer to the job slot,
+	exit status of the child process (from waitpid()).
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	server_end(serverjobstruct *job, int status)
+  {
+   char		runname[MAXCHAR], endname[MAXCHAR];
+   int		okflag;
+
+  okflag = WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+  if (server_path(runname, job->name, SERVER_RUNSUFFIX) != RETURN_OK
+	|| server_path(endname, job->name,
+		okflag? SERVER_DONESUFFIX : SERVER_FAILSUFFIX) != RETURN_OK
+	|| rename(runname, endname))
+    warning("Cannot rename job descriptor ", runname);
+  if (okflag)
+    {
+    NPRINTF(OUTPUT, "> Job %s done\n", job->name);
+    }
+  else
+    warning("Job failed: ", job->name);
+  job->pid = 0;
+
+  return;
+  }
+
+
+/****** server_path **********************************************************
+PROTO	int server_path(char *path, char *name, char *suffix)
+PURPOSE	Build the path of a job file in the spool directory.
+INPUT	Output path (at least MAXCHAR bytes),
+	job name,
+	file name suffix.
+OUTPUT	RETURN_OK if the path fits in MAXCHAR bytes, RETURN_ERROR otherwise.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static int	server_path(char *path, char *name, char *suffix)
+  {
+  if (snprintf(path, MAXCHAR, "%s/%s%s", prefs.spool_dir, name, suffix)
+	>= MAXCHAR)
+    return RETURN_ERROR;
+
+  return RETURN_OK;
+  }
+
+
+/****** server_signal ********************************************************
+PROTO	void server_signal(int sig)
+PURPOSE	Ask the server to stop.
+INPUT	Signal number.
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	server_signal(int sig)
+  {
+  server_stopflag = 1;
+
+  return;
+  }
+
+
+/****** server_strcmp ********************************************************
+PROTO	int server_strcmp(const void *str1, const void *str2)
+PURPOSE	Compare two job names for qsort().
+INPUT	Pointer to the first name,
+	pointer to the second name.
+OUTPUT	Result of strcmp().
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static int	server_strcmp(const void *str1, const void *str2)
+  {
+  return strcmp(*(char **)str1, *(char **)str2);
+  }
+
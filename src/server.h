@@ -0,0 +1,58 @@
+/*
+*				server.h
+*
+* Include file for server.c.
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*
+*	This file part of:	PSFEx
+*
+*	Copyright:		(C) 2026 Emmanuel Bertin -- IAP/CNRS/UPMC
+*
+*	License:		GNU General Public License
+*
+*	PSFEx is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+* 	(at your option) any later version.
+*	PSFEx is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*	You should have received a copy of the GNU General Public License
+*	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
+*
+*	Last modified:		19/10/2026
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+#ifdef HAVE_CONFIG_H
+#include	"config.h"
+#endif
+
+#ifndef _SERVER_H_
+#define _SERVER_H_
+
+#include	<sys/types.h>
+
+/*----------------------------- Internal constants --------------------------*/
+
+#define	SERVER_JOBSUFFIX	".job"		/* Pending job descriptors */
+#define	SERVER_RUNSUFFIX	".run"		/* Jobs being processed */
+#define	SERVER_DONESUFFIX	".done"		/* Jobs completed */
+#define	SERVER_FAILSUFFIX	".failed"	/* Jobs that failed */
+#define	SERVER_POLLTIME		500000		/* Spool polling period (us) */
+
+/*--------------------------- structure definitions -------------------------*/
+/* Job being processed by a child process */
+typedef struct serverjob
+  {
+  pid_t		pid;			/* Child process ID (0=free slot) */
+  char		name[MAXCHAR];		/* Job name (descriptor w/o suffix) */
+  }	serverjobstruct;
+
+/*---------------------------------- protos --------------------------------*/
+extern void		server_run(void);
+
+#endif
+
@@ -0,0 +1,1043 @@
+/*
+*				shard.c
+*
+* Share the samples of a fit between several worker processes.
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*
+*	This file part of:	PSFEx
+*
+*	Copyright:		(C) 2026 Emmanuel Bertin -- IAP/CNRS/UPMC
+*
+*	License:		GNU General Public License
+*
+*	PSFEx is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+* 	(at your option) any later version.
+*	PSFEx is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*	You should have received a copy of the GNU General Public License
+*	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
+*
+*	Last modified:		19/10/2026
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+#ifdef HAVE_CONFIG_H
+#include	"config.h"
+#endif
+
+#include	<errno.h>
+#include	<math.h>
+#include	<signal.h>
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<unistd.h>
+#include	<sys/types.h>
+#include	<sys/wait.h>
+
+#include	"define.h"
+#include	"types.h"
+#include	"globals.h"
+#include	"fits/fitscat.h"
+#include	"context.h"
+#include	"field.h"
+#include	"linalg.h"
+#include	"prefs.h"
+#include	"psf.h"
+#include	"sample.h"
+#include	"shard.h"
+
+static FILE	*shard_open(shardstruct *shard, int k, shardcmdenum cmd,
+			char *mode);
+
+static int	shard_pipe(int fd, void *msg, int writeflag);
+
+static void	shard_close(FILE *file),
+		shard_command(shardstruct *shard, shardcmdenum cmd, int ival,
+			double dval),
+		shard_fail(shardstruct *shard, int k, char *what),
+		shard_filename(shardstruct *shard, int k, char *filename),
+		shard_getpsf(shardstruct *shard, shardcmdenum cmd),
+		shard_putpsf(shardstruct *shard, psfstruct *psf,
+			shardcmdenum cmd),
+		shard_read(FILE *file, void *ptr, size_t size, int n),
+		shard_work(shardstruct *shard, char **catnames, int ext,
+			int next2, float *fwhmmin, float *fwhmmax,
+			float *fwhmmode),
+		shard_write(FILE *file, void *ptr, size_t size, int n);
+
+static struct sigaction	shard_sigpipe;		/* Saved SIGPIPE action */
+
+/****** shard_init ***********************************************************
+PROTO	shardstruct *shard_init(fieldstruct **fields, char **catnames,
+			int ncat, int ext, int next, contextstruct *context)
+PURPOSE	Start the worker processes sharing the samples of a fit and have them
+	load their samples.
+INPUT	Pointer to the array of fields,
+	array of catalogue file names,
+	number of catalogues,
+	extension (or ALL_EXTENSIONS),
+	number of extensions per catalogue,
+	pointer to the context structure.
+OUTPUT	Pointer to the new shard structure.
+NOTES	Each of the SHARD_NUMBER workers reads a contiguous slice of the
+	catalogue list and gets the same share of SAMPLE_MAXNUMBER. FWHM
+	ranges and context scalings are derived from all catalogues, as in
+	load_samples(). The master keeps a set with no samples but the global
+	properties of the sample set (shard->set), to be used in place of the
+	full set by make_psf().
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+shardstruct	*shard_init(fieldstruct **fields, char **catnames, int ncat,
+			int ext, int next, contextstruct *context)
+  {
+   struct sigaction	sa;
+   shardstruct	*shard;
+   setstruct	*set;
+   FILE		*file;
+   double	*cmin,*cmax,*dbuf;
+   float	*fwhmmin,*fwhmmax,*fwhmmode,
+		fwhm;
+   int		cmdpipe[2],ackpipe[2], vigsize[2],
+		i,k, c0, nshard, next2, samplemax;
+
+  nshard = prefs.nshard<ncat? prefs.nshard : ncat;
+  QCALLOC(shard, shardstruct, 1);
+  shard->nshard = nshard;
+  shard->index = -1;
+  shard->next = next;
+  shard->fields = fields;
+  shard->context = context;
+  QCALLOC(shard->pid, pid_t, nshard);
+  QMALLOC(shard->cmdfd, int, nshard);
+  QMALLOC(shard->ackfd, int, nshard);
+  QMALLOC(shard->catindex, int, nshard);
+  QMALLOC(shard->ncat, int, nshard);
+  QCALLOC(shard->nsample, int, nshard);
+/* Leave room for the worker index and suffix of work file names */
+  if (snprintf(shard->filename, MAXCHAR-16, "%s/psfex_%ld",
+	*prefs.shard_dir? prefs.shard_dir : ".", (long)getpid())
+	>= MAXCHAR-16)
+    error(EXIT_FAILURE, "*Error*: shard directory path too long: ",
+	prefs.shard_dir);
+
+/* FWHM ranges are derived from the whole catalogue list */
+  QMALLOC(fwhmmin, float, ncat);
+  QMALLOC(fwhmmax, float, ncat);
+  QMALLOC(fwhmmode, float, ncat);
+  next2 = scan_samples(catnames, 0, ncat, ext, next,
+		fwhmmin, fwhmmax, fwhmmode);
+  fwhm = BIG;
+  for (i=0; i<ncat; i++)
+    if (fwhmmode[i]<fwhm)
+      fwhm = fwhmmode[i];
+
+/* Start the workers; a dead worker must show up as EPIPE, not kill us */
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = SIG_IGN;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGPIPE, &sa, &shard_sigpipe);
+  samplemax = prefs.sample_maxnumber;
+  fflush(NULL);
+  for (k=0; k<nshard; k++)
+    {
+    c0 = shard->catindex[k] = k*ncat/nshard;
+    shard->ncat[k] = (k+1)*ncat/nshard - c0;
+    if (pipe(cmdpipe) || pipe(ackpipe))
+      error(EXIT_FAILURE, "*Error*: cannot create pipes for ", "shards");
+    if ((shard->pid[k] = fork()) < 0)
+      error(EXIT_FAILURE, "*Error*: cannot start a process for ", "shards");
+    if (!shard->pid[k])
+      {
+/*---- Keep only the pipe ends of the current worker */
+      close(cmdpipe[1]);
+      close(ackpipe[0]);
+      for (i=0; i<k; i++)
+        {
+        close(shard->cmdfd[i]);
+        close(shard->ackfd[i]);
+        }
+      shard->index = k;
+      shard->cmdfd[k] = cmdpipe[0];
+      shard->ackfd[k] = ackpipe[1];
+      if (samplemax)
+        {
+        prefs.sample_maxnumber
+		= (int)((long long)samplemax*(c0+shard->ncat[k])/ncat)
+		- (int)((long long)samplemax*c0/ncat);
+        if (prefs.sample_maxnumber<1)
+          prefs.sample_maxnumber = 1;
+        }
+      shard_work(shard, catnames, ext, next2,
+		fwhmmin+c0, fwhmmax+c0, fwhmmode+c0);
+      }
+    close(cmdpipe[0]);
+    close(ackpipe[1]);
+    shard->cmdfd[k] = cmdpipe[1];
+    shard->ackfd[k] = ackpipe[0];
+    }
+
+  free(fwhmmin);
+  free(fwhmmax);
+  free(fwhmmode);
+
+/* Load the samples and merge vignet sizes and context ranges */
+  shard_command(shard, SHARD_LOAD, 0, 0.0);
+  set = shard->set = init_set(context);
+  set->fwhm = fwhm;
+  set->vigsize[0] = set->vigsize[1] = 0;
+  QMALLOC(cmin, double, set->ncontext? set->ncontext : 1);
+  QMALLOC(cmax, double, set->ncontext? set->ncontext : 1);
+  QMALLOC(dbuf, double, set->ncontext? 2*set->ncontext : 1);
+  for (i=0; i<set->ncontext; i++)
+    {
+    cmin[i] = BIG;
+    cmax[i] = -BIG;
+    }
+  for (k=0; k<nshard; k++)
+    {
+    if (!shard->nsample[k])
+      continue;
+    file = shard_open(shard, k, SHARD_LOAD, "rb");
+    shard_read(file, vigsize, sizeof(int), 2);
+    if (set->nsample
+	&& (vigsize[0]!=set->vigsize[0] || vigsize[1]!=set->vigsize[1]))
+      error(EXIT_FAILURE, "*Error*: VIGNET sizes differ between ",
+		"catalogues");
+    set->vigsize[0] = vigsize[0];
+    set->vigsize[1] = vigsize[1];
+    shard_read(file, dbuf, sizeof(double), 2*set->ncontext);
+    shard_close(file);
+    for (i=0; i<set->ncontext; i++)
+      {
+      if (dbuf[2*i]<cmin[i])
+        cmin[i] = dbuf[2*i];
+      if (dbuf[2*i+1]>cmax[i])
+        cmax[i] = dbuf[2*i+1];
+      }
+    set->nsample += shard->nsample[k];
+    }
+  for (i=0; i<set->ncontext; i++)
+    if (set->nsample)
+      {
+      set->contextscale[i] = cmax[i] - cmin[i];
+      set->contextoffset[i] = (cmin[i] + cmax[i])/2.0;
+      }
+    else
+      {
+      set->contextscale[i] = 1.0;
+      set->contextoffset[i] = 0.0;
+      }
+  free(cmin);
+  free(cmax);
+  free(dbuf);
+
+/* Have all the workers share the global scalings */
+  file = shard_open(shard, -1, SHARD_SETUP, "wb");
+  shard_write(file, set->contextoffset, sizeof(double), set->ncontext);
+  shard_write(file, set->contextscale, sizeof(double), set->ncontext);
+  shard_close(file);
+  shard_command(shard, SHARD_SETUP, 0, fwhm);
+
+  return shard;
+  }
+
+
+/****** shard_end ************************************************************
+PROTO	void shard_end(shardstruct *shard)
+PURPOSE	Stop the workers, remove the work files and free a shard structure.
+INPUT	Pointer to the shard structure.
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+void	shard_end(shardstruct *shard)
+  {
+   char		filename[MAXCHAR];
+   int		k;
+
+  shard_command(shard, SHARD_END, 0, 0.0);
+  for (k=0; k<shard->nshard; k++)
+    {
+    close(shard->cmdfd[k]);
+    close(shard->ackfd[k]);
+    waitpid(shard->pid[k], NULL, 0);
+    shard_filename(shard, k, filename);
+    remove(filename);
+    }
+  shard_filename(shard, -1, filename);
+  remove(filename);
+  sigaction(SIGPIPE, &shard_sigpipe, NULL);
+
+  end_set(shard->set);
+  free(shard->pid);
+  free(shard->cmdfd);
+  free(shard->ackfd);
+  free(shard->catindex);
+  free(shard->ncat);
+  free(shard->nsample);
+  free(shard);
+
+  return;
+  }
+
+
+/****** shard_initpsf ********************************************************
+PROTO	void shard_initpsf(shardstruct *shard, float psfstep)
+PURPOSE	Have the workers initialize a PSF model identical to that of the
+	master.
+INPUT	Pointer to the shard structure,
+	PSF sampling step.
+OUTPUT	-.
+NOTES	The master PSF must have been initialized by psf_init() with the
+	same context, PSF_SIZE, PSF_PIXELSIZE and the total number of samples.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+void	shard_initpsf(shardstruct *shard, float psfstep)
+  {
+  shard_command(shard, SHARD_INITPSF, shard->set->nsample, psfstep);
+
+  return;
+  }
+
+
+/****** shard_make ***********************************************************
+PROTO	void shard_make(shardstruct *shard, psfstruct *psf,
+			double prof_accuracy)
+PURPOSE	Sharded equivalent of psf_make().
+INPUT	Pointer to the shard structure,
+	pointer to the PSF,
+	PSF accuracy.
+OUTPUT	-.
+NOTES	Each worker accumulates the per-pixel normal equations of its samples
+	with psf_makeaccu(); the master adds them in worker order, so that
+	results do not depend on timing, and solves them.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+void	shard_make(shardstruct *shard, psfstruct *psf, double prof_accuracy)
+  {
+   FILE		*file;
+   double	*alpha,*alphat, *beta,*betat, *buf,*buft;
+   int		i,k, ncoeff, nalpha,nbeta;
+
+  for (i=0; i<psf->poly->ndim; i++)
+    {
+    psf->contextoffset[i] = shard->set->contextoffset[i];
+    psf->contextscale[i] = shard->set->contextscale[i];
+    }
+
+  if (!shard->set->nsample)
+    return;
+
+  shard_command(shard, SHARD_MAKE, 0, prof_accuracy);
+  ncoeff = psf->poly->ncoeff;
+  nbeta = psf->size[0]*psf->size[1]*ncoeff;
+  nalpha = nbeta*(ncoeff+1)/2;
+  QCALLOC(alpha, double, nalpha);
+  QCALLOC(beta, double, nbeta);
+  QMALLOC(buf, double, nalpha);
+  for (k=0; k<shard->nshard; k++)
+    {
+    file = shard_open(shard, k, SHARD_MAKE, "rb");
+    shard_read(file, buf, sizeof(double), nalpha);
+    for (alphat=alpha, buft=buf, i=nalpha; i--;)
+      *(alphat++) += *(buft++);
+    shard_read(file, buf, sizeof(double), nbeta);
+    for (betat=beta, buft=buf, i=nbeta; i--;)
+      *(betat++) += *(buft++);
+    shard_close(file);
+    }
+  free(buf);
+
+  psf_makesolve(psf, alpha, beta);
+  free(alpha);
+  free(beta);
+
+  return;
+  }
+
+
+/****** shard_refine *********************************************************
+PROTO	int shard_refine(shardstruct *shard, psfstruct *psf)
+PURPOSE	Sharded equivalent of psf_refine().
+INPUT	Pointer to the shard structure,
+	pointer to the PSF.
+OUTPUT	RETURN_OK if a PSF is succesfully computed, RETURN_ERROR otherwise.
+NOTES	Each worker accumulates the normal equations of its samples with
+	psf_refineaccu() and saves only the non-empty blocks; the master adds
+	them in worker order and solves the system with psf_refinesolve().
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+int	shard_refine(shardstruct *shard, psfstruct *psf)
+  {
+   FILE		*file;
+   double	*alphamat,*alphamatt, *betamat, *buf,*buft;
+   char		*blockmask, *mask;
+   int		b,i,k,l, ncoeff,npsf,nunknown;
+
+  if (!shard->set->nsample || !psf->basis)
+    return RETURN_ERROR;
+
+  shard_putpsf(shard, psf, SHARD_REFINE);
+  shard_command(shard, SHARD_REFINE, 0, 0.0);
+  npsf = psf->nbasis;
+  ncoeff = psf->poly->ncoeff;
+  nunknown = ncoeff*npsf;
+  QCALLOC(alphamat, double, nunknown*nunknown);
+  QCALLOC(betamat, double, nunknown);
+  QCALLOC(blockmask, char, npsf*npsf);
+  QMALLOC(mask, char, npsf*npsf);
+  QMALLOC(buf, double, nunknown>ncoeff*ncoeff? nunknown : ncoeff*ncoeff);
+  for (k=0; k<shard->nshard; k++)
+    {
+    file = shard_open(shard, k, SHARD_REFINE, "rb");
+    shard_read(file, mask, sizeof(char), npsf*npsf);
+    shard_read(file, buf, sizeof(double), nunknown);
+    for (buft=buf, i=0; i<nunknown; i++)
+      betamat[i] += *(buft++);
+/*-- Block b couples basis vectors b/npsf and b%npsf */
+    for (b=0; b<npsf*npsf; b++)
+      if (mask[b])
+        {
+        blockmask[b] = 1;
+        shard_read(file, buf, sizeof(double), ncoeff*ncoeff);
+        alphamatt = alphamat + (b/npsf)*ncoeff*nunknown + (b%npsf)*ncoeff;
+        for (buft=buf, l=ncoeff; l--; alphamatt+=nunknown-ncoeff)
+          for (i=ncoeff; i--;)
+            *(alphamatt++) += *(buft++);
+        }
+    shard_close(file);
+    }
+  free(mask);
+  free(buf);
+
+  return psf_refinesolve(psf, alphamat, betamat, blockmask,
+		shard->set->nsample);
+  }
+
+
+/****** shard_clean **********************************************************
+PROTO	double shard_clean(shardstruct *shard, psfstruct *psf,
+			double prof_accuracy)
+PURPOSE	Sharded equivalent of psf_clean().
+INPUT	Pointer to the shard structure,
+	pointer to the PSF,
+	PSF accuracy.
+OUTPUT	Reduced chi2.
+NOTES	The clipping statistics are computed by the master from the chi2 of
+	all samples, gathered in worker order.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+double	shard_clean(shardstruct *shard, psfstruct *psf, double prof_accuracy)
+  {
+   FILE		*file;
+   double	chi2;
+   float	*chi,*chit,
+		chi2max;
+   int		i,k, nsample;
+
+  shard_putpsf(shard, psf, SHARD_RESI);
+  shard_command(shard, SHARD_RESI, prefs.recenter_flag, prof_accuracy);
+  nsample = shard->set->nsample;
+  QMALLOC(chi, float, nsample? nsample : 1);
+  for (chit=chi, k=0; k<shard->nshard; chit+=shard->nsample[k++])
+    {
+    file = shard_open(shard, k, SHARD_RESI, "rb");
+    shard_read(file, chit, sizeof(float), shard->nsample[k]);
+    shard_close(file);
+    }
+/* Store the chi's (sqrt(chi2) pdf close to Gaussian) */
+  for (chit=chi, i=nsample; i--; chit++)
+    *chit = (float)sqrt(*chit);
+  chi2 = psf_chiclip(chi, nsample, &chi2max);
+  free(chi);
+
+/* Clip outliers */
+  shard_command(shard, SHARD_REJECT, 0, chi2max);
+  for (shard->set->nsample=k=0; k<shard->nshard; k++)
+    shard->set->nsample += shard->nsample[k];
+
+  return chi2;
+  }
+
+
+/****** shard_chi2 ***********************************************************
+PROTO	double shard_chi2(shardstruct *shard, psfstruct *psf)
+PURPOSE	Sharded equivalent of psf_chi2().
+INPUT	Pointer to the shard structure,
+	pointer to the PSF.
+OUTPUT	Reduced chi2.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+double	shard_chi2(shardstruct *shard, psfstruct *psf)
+  {
+   FILE		*file;
+   double	chi2;
+   float	*chi,*chit;
+   int		i,k, nsample;
+
+  shard_putpsf(shard, psf, SHARD_RESI);
+  shard_command(shard, SHARD_RESI, prefs.recenter_flag, prefs.prof_accuracy);
+  nsample = shard->set->nsample;
+  QMALLOC(chi, float, nsample? nsample : 1);
+  chi2 = 0.0;
+  for (k=0; k<shard->nshard; k++)
+    {
+    file = shard_open(shard, k, SHARD_RESI, "rb");
+    shard_read(file, chi, sizeof(float), shard->nsample[k]);
+    shard_close(file);
+    for (chit=chi, i=shard->nsample[k]; i--;)
+      chi2 += *(chit++);
+    }
+  free(chi);
+
+  return chi2/(nsample-(nsample>1?1:0));
+  }
+
+
+/****** shard_count **********************************************************
+PROTO	void shard_count(shardstruct *shard, int counttype)
+PURPOSE	Sharded equivalent of field_count().
+INPUT	Pointer to the shard structure,
+	count type (COUNT_LOADED and/or COUNT_ACCEPTED).
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+void	shard_count(shardstruct *shard, int counttype)
+  {
+   FILE		*file;
+   int		*count, *countt,*countt2,
+		c,e,i,k, nsnap2;
+
+  shard_command(shard, SHARD_COUNT, counttype, 0.0);
+  nsnap2 = prefs.context_nsnap*prefs.context_nsnap;
+  QMALLOC(count, int, nsnap2);
+  for (k=0; k<shard->nshard; k++)
+    {
+    file = shard_open(shard, k, SHARD_COUNT, "rb");
+    for (c=shard->catindex[k]; c<shard->catindex[k]+shard->ncat[k]; c++)
+      for (e=0; e<shard->next; e++)
+        {
+        if ((counttype & COUNT_LOADED))
+          {
+          shard_read(file, count, sizeof(int), nsnap2);
+          countt2 = shard->fields[c]->lcount[e];
+          for (countt=count, i=nsnap2; i--;)
+            *(countt2++) += *(countt++);
+          }
+        if ((counttype & COUNT_ACCEPTED))
+          {
+          shard_read(file, count, sizeof(int), nsnap2);
+          countt2 = shard->fields[c]->acount[e];
+          for (countt=count, i=nsnap2; i--;)
+            *(countt2++) += *(countt++);
+          }
+        }
+    shard_close(file);
+    }
+  free(count);
+
+  return;
+  }
+
+
+/****** shard_command ********************************************************
+PROTO	void shard_command(shardstruct *shard, shardcmdenum cmd, int ival,
+			double dval)
+PURPOSE	Send a command to all workers and wait for its completion.
+INPUT	Pointer to the shard structure,
+	command,
+	integer argument,
+	floating-point argument.
+OUTPUT	-.
+NOTES	The current number of samples of each worker is updated. A worker
+	that dies (e.g. after an error) is fatal, and is reported with its
+	exit status.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	shard_command(shardstruct *shard, shardcmdenum cmd, int ival,
+			double dval)
+  {
+   shardmsgstruct	msg;
+   int			k;
+
+  memset(&msg, 0, sizeof(msg));
+  msg.cmd = cmd;
+  msg.ival = ival;
+  msg.dval = dval;
+  for (k=0; k<shard->nshard; k++)
+    if (shard_pipe(shard->cmdfd[k], &msg, 1) != RETURN_OK)
+      shard_fail(shard, k, "stopped taking commands");
+  for (k=0; k<shard->nshard; k++)
+    {
+    if (shard_pipe(shard->ackfd[k], &msg, 0) != RETURN_OK)
+      shard_fail(shard, k, "stopped responding");
+    if (msg.cmd != cmd)
+      shard_fail(shard, k, "sent an unexpected reply");
+    shard->nsample[k] = msg.ival;
+    }
+
+  return;
+  }
+
+
+/****** shard_fail ***********************************************************
+PROTO	void shard_fail(shardstruct *shard, int k, char *what)
+PURPOSE	Report a worker that failed, with its exit status, and exit.
+INPUT	Pointer to the shard structure,
+	worker index,
+	description of the failure.
+OUTPUT	-.
+NOTES	Does not return. The worker is reaped first: it is either dead or
+	has closed its pipes on its way out. The other workers see their
+	command pipe closed when the master exits, and exit too.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	shard_fail(shardstruct *shard, int k, char *what)
+  {
+   char		str[MAXCHAR];
+   int		status;
+
+  close(shard->cmdfd[k]);
+  close(shard->ackfd[k]);
+  if (waitpid(shard->pid[k], &status, 0) != shard->pid[k])
+    sprintf(str, "shard worker #%d %s", k+1, what);
+  else if (WIFSIGNALED(status))
+    sprintf(str, "shard worker #%d %s (killed by signal %d)",
+	k+1, what, WTERMSIG(status));
+  else
+    sprintf(str, "shard worker #%d %s (exit status %d)",
+	k+1, what, WIFEXITED(status)? WEXITSTATUS(status) : -1);
+  error(EXIT_FAILURE, "*Error*: ", str);
+  }
+
+
+/****** shard_pipe ***********************************************************
+PROTO	int shard_pipe(int fd, void *msg, int writeflag)
+PURPOSE	Transfer a complete command message through a pipe.
+INPUT	File descriptor,
+	pointer to the message,
+	0 to read, 1 to write.
+OUTPUT	RETURN_OK if the whole message went through, RETURN_ERROR at end of
+	file or on error (including EPIPE).
+NOTES	Short transfers are resumed, as are transfers interrupted by signals.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static int	shard_pipe(int fd, void *msg, int writeflag)
+  {
+   char		*buf;
+   ssize_t	n;
+   size_t	left;
+
+  buf = (char *)msg;
+  for (left=sizeof(shardmsgstruct); left; left-=(size_t)n, buf+=n)
+    {
+    n = writeflag? write(fd, buf, left) : read(fd, buf, left);
+    if (n<0 && errno==EINTR)
+      n = 0;
+    else if (n<=0)
+      return RETURN_ERROR;
+    }
+
+  return RETURN_OK;
+  }
+
+
+/****** shard_work ***********************************************************
+PROTO	void shard_work(shardstruct *shard, char **catnames, int ext,
+			int next2, float *fwhmmin, float *fwhmmax,
+			float *fwhmmode)
+PURPOSE	Main loop of a worker: execute the commands of the master.
+INPUT	Pointer to the shard structure,
+	array of catalogue file names,
+	extension (or ALL_EXTENSIONS),
+	number of extensions to read (from scan_samples()),
+	array of minimum FWHMs for the catalogues of the worker,
+	array of maximum FWHMs for the catalogues of the worker,
+	array of FWHM modes for the catalogues of the worker.
+OUTPUT	-.
+NOTES	Does not return. Results go to the work file of the worker; the
+	number of samples left is sent back with each acknowledgement.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	shard_work(shardstruct *shard, char **catnames, int ext,
+			int next2, float *fwhmmin, float *fwhmmax,
+			float *fwhmmode)
+  {
+   shardmsgstruct	msg;
+   setstruct		*set;
+   psfstruct		*psf;
+   samplestruct		*sample;
+   FILE			*file;
+   double		*alpha, *beta, *dbuf;
+   char			*blockmask;
+   float		*fbuf,*fbuft,
+			pixsize[2];
+   int			b,c,e,i,k,l, c0, ncoeff, npix,npsf,nunknown, nsnap2;
+
+  k = shard->index;
+  c0 = shard->catindex[k];
+  set = NULL;
+  psf = NULL;
+  prefs.nthreads = 1;
+  set_tilenthreads(1);
+  linalg_init(1);
+  while (shard_pipe(shard->cmdfd[k], &msg, 0) == RETURN_OK)
+    {
+    switch(msg.cmd)
+      {
+      case SHARD_LOAD:
+        set = shard->set = read_sampleset(catnames, c0, shard->ncat[k], ext,
+		shard->next, next2, shard->context, fwhmmin, fwhmmax, fwhmmode);
+        file = shard_open(shard, k, SHARD_LOAD, "wb");
+        shard_write(file, set->vigsize, sizeof(int), 2);
+        QMALLOC(dbuf, double, set->ncontext? 2*set->ncontext : 1);
+        for (i=0; i<set->ncontext; i++)
+          {
+          dbuf[2*i] = set->contextoffset[i] - set->contextscale[i]/2.0;
+          dbuf[2*i+1] = dbuf[2*i] + set->contextscale[i];
+          }
+        shard_write(file, dbuf, sizeof(double), 2*set->ncontext);
+        free(dbuf);
+        shard_close(file);
+        break;
+      case SHARD_SETUP:
+        file = shard_open(shard, -1, SHARD_SETUP, "rb");
+        shard_read(file, set->contextoffset, sizeof(double), set->ncontext);
+        shard_read(file, set->contextscale, sizeof(double), set->ncontext);
+        shard_close(file);
+        set->fwhm = (float)msg.dval;
+        break;
+      case SHARD_INITPSF:
+        if (psf)
+          psf_end(psf);
+        pixsize[0] = (float)prefs.psf_pixsize[0];
+        pixsize[1] = (float)prefs.psf_pixsize[1];
+        psf = shard->psf = psf_init(shard->context, prefs.psf_size,
+		(float)msg.dval, pixsize, msg.ival);
+        psf->fwhm = set->fwhm;
+        for (i=0; i<psf->poly->ndim; i++)
+          {
+          psf->contextoffset[i] = set->contextoffset[i];
+          psf->contextscale[i] = set->contextscale[i];
+          }
+        break;
+      case SHARD_MAKE:
+        ncoeff = psf->poly->ncoeff;
+        npix = psf->size[0]*psf->size[1];
+        QCALLOC(alpha, double, npix*ncoeff*(ncoeff+1)/2);
+        QCALLOC(beta, double, npix*ncoeff);
+        psf_makeaccu(psf, set, msg.dval, alpha, beta);
+        file = shard_open(shard, k, SHARD_MAKE, "wb");
+        shard_write(file, alpha, sizeof(double), npix*ncoeff*(ncoeff+1)/2);
+        shard_write(file, beta, sizeof(double), npix*ncoeff);
+        shard_close(file);
+        free(alpha);
+        free(beta);
+        break;
+      case SHARD_REFINE:
+        shard_getpsf(shard, SHARD_REFINE);
+        ncoeff = psf->poly->ncoeff;
+        npsf = psf->nbasis;
+        nunknown = ncoeff*npsf;
+        QCALLOC(alpha, double, nunknown*nunknown);
+        QCALLOC(beta, double, nunknown);
+        QCALLOC(blockmask, char, npsf*npsf);
+        psf_refineaccu(psf, set, alpha, beta, blockmask);
+        file = shard_open(shard, k, SHARD_REFINE, "wb");
+        shard_write(file, blockmask, sizeof(char), npsf*npsf);
+        shard_write(file, beta, sizeof(double), nunknown);
+/*------ Only non-empty blocks are saved */
+        for (b=0; b<npsf*npsf; b++)
+          if (blockmask[b])
+            for (l=0; l<ncoeff; l++)
+              shard_write(file, alpha + ((b/npsf)*ncoeff+l)*nunknown
+			+ (b%npsf)*ncoeff, sizeof(double), ncoeff);
+        shard_close(file);
+        free(alpha);
+        free(beta);
+        free(blockmask);
+        break;
+      case SHARD_RESI:
+        shard_getpsf(shard, SHARD_RESI);
+        if (set->nsample)
+          psf_makeresi(psf, set, msg.ival, msg.dval);
+        QMALLOC(fbuf, float, set->nsample? set->nsample : 1);
+        for (sample=set->sample, fbuft=fbuf, i=set->nsample; i--; sample++)
+          *(fbuft++) = sample->chi2;
+        file = shard_open(shard, k, SHARD_RESI, "wb");
+        shard_write(file, fbuf, sizeof(float), set->nsample);
+        shard_close(file);
+        free(fbuf);
+        break;
+      case SHARD_REJECT:
+        psf_rejectsamples(set, (float)msg.dval);
+        break;
+      case SHARD_COUNT:
+        nsnap2 = prefs.context_nsnap*prefs.context_nsnap;
+        for (c=c0; c<c0+shard->ncat[k]; c++)
+          for (e=0; e<shard->next; e++)
+            {
+            if ((msg.ival & COUNT_LOADED))
+              memset(shard->fields[c]->lcount[e], 0, nsnap2*sizeof(int));
+            if ((msg.ival & COUNT_ACCEPTED))
+              memset(shard->fields[c]->acount[e], 0, nsnap2*sizeof(int));
+            }
+        field_count(shard->fields, set, msg.ival);
+        file = shard_open(shard, k, SHARD_COUNT, "wb");
+        for (c=c0; c<c0+shard->ncat[k]; c++)
+          for (e=0; e<shard->next; e++)
+            {
+            if ((msg.ival & COUNT_LOADED))
+              shard_write(file, shard->fields[c]->lcount[e], sizeof(int),
+			nsnap2);
+            if ((msg.ival & COUNT_ACCEPTED))
+              shard_write(file, shard->fields[c]->acount[e], sizeof(int),
+			nsnap2);
+            }
+        shard_close(file);
+        break;
+      case SHARD_END:
+        break;
+      default:
+        error(EXIT_FAILURE, "*Internal Error*: unknown command in ",
+		"shard_work()");
+      }
+    msg.ival = set? set->nsample : 0;
+    if (shard_pipe(shard->ackfd[k], &msg, 1) != RETURN_OK
+	|| msg.cmd == SHARD_END)
+      break;
+    }
+
+/* Leave the files and stdio buffers of the master alone */
+  fflush(NULL);
+  _exit(msg.cmd == SHARD_END? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+
+/****** shard_putpsf *********************************************************
+PROTO	void shard_putpsf(shardstruct *shard, psfstruct *psf,
+			shardcmdenum cmd)
+PURPOSE	Save the current PSF model for the workers.
+INPUT	Pointer to the shard structure,
+	pointer to the PSF,
+	command the model is intended for.
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	shard_putpsf(shardstruct *shard, psfstruct *psf,
+			shardcmdenum cmd)
+  {
+   FILE		*file;
+   int		npix, pixmaskflag;
+
+  npix = psf->size[0]*psf->size[1];
+  pixmaskflag = psf->pixmask? 1 : 0;
+  file = shard_open(shard, -1, cmd, "wb");
+  shard_write(file, psf->comp, sizeof(float), npix*psf->poly->ncoeff);
+  shard_write(file, &psf->nbasis, sizeof(int), 1);
+  shard_write(file, &psf->ndata, sizeof(int), 1);
+  shard_write(file, &pixmaskflag, sizeof(int), 1);
+  if (psf->basis)
+    shard_write(file, psf->basis, sizeof(float), npix*psf->nbasis);
+  if (pixmaskflag)
+    shard_write(file, psf->pixmask, sizeof(int), npix);
+  shard_close(file);
+
+  return;
+  }
+
+
+/****** shard_getpsf *********************************************************
+PROTO	void shard_getpsf(shardstruct *shard, shardcmdenum cmd)
+PURPOSE	Update the PSF model of a worker with that of the master.
+INPUT	Pointer to the shard structure,
+	command the model is intended for.
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	shard_getpsf(shardstruct *shard, shardcmdenum cmd)
+  {
+   psfstruct	*psf;
+   FILE		*file;
+   int		npix, pixmaskflag;
+
+  psf = shard->psf;
+  npix = psf->size[0]*psf->size[1];
+  file = shard_open(shard, -1, cmd, "rb");
+  shard_read(file, psf->comp, sizeof(float), npix*psf->poly->ncoeff);
+  shard_read(file, &psf->nbasis, sizeof(int), 1);
+  shard_read(file, &psf->ndata, sizeof(int), 1);
+  shard_read(file, &pixmaskflag, sizeof(int), 1);
+  free(psf->basis);
+  psf->basis = NULL;
+  if (psf->nbasis)
+    {
+    QMALLOC(psf->basis, float, npix*psf->nbasis);
+    shard_read(file, psf->basis, sizeof(float), npix*psf->nbasis);
+    }
+  free(psf->pixmask);
+  psf->pixmask = NULL;
+  if (pixmaskflag)
+    {
+    QMALLOC(psf->pixmask, int, npix);
+    shard_read(file, psf->pixmask, sizeof(int), npix);
+    }
+  shard_close(file);
+
+  return;
+  }
+
+
+/****** shard_open ***********************************************************
+PROTO	FILE *shard_open(shardstruct *shard, int k, shardcmdenum cmd,
+			char *mode)
+PURPOSE	Open a work file and write or check its header.
+INPUT	Pointer to the shard structure,
+	worker index (-1 for the file written by the master),
+	command the file content relates to,
+	fopen() mode ("rb" or "wb").
+OUTPUT	File pointer.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static FILE	*shard_open(shardstruct *shard, int k, shardcmdenum cmd,
+			char *mode)
+  {
+   FILE		*file;
+   char		filename[MAXCHAR], magic[8];
+   int		icmd;
+
+  shard_filename(shard, k, filename);
+  if (!(file = fopen(filename, mode)))
+    error(EXIT_FAILURE, "*Error*: cannot open shard work file ", filename);
+  icmd = (int)cmd;
+  if (*mode == 'w')
+    {
+    shard_write(file, SHARD_MAGIC, 1, 8);
+    shard_write(file, &icmd, sizeof(int), 1);
+    }
+  else
+    {
+    shard_read(file, magic, 1, 8);
+    shard_read(file, &icmd, sizeof(int), 1);
+    if (strncmp(magic, SHARD_MAGIC, 8) || icmd != (int)cmd)
+      error(EXIT_FAILURE, "*Error*: unexpected content in ", filename);
+    }
+
+  return file;
+  }
+
+
+/****** shard_close **********************************************************
+PROTO	void shard_close(FILE *file)
+PURPOSE	Close a work file.
+INPUT	File pointer.
+OUTPUT	-.
+NOTES	Buffered data that cannot be flushed (e.g. on a full disk) is fatal.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	shard_close(FILE *file)
+  {
+  if (fclose(file))
+    error(EXIT_FAILURE, "*Error*: cannot write shard work file", "");
+
+  return;
+  }
+
+
+/****** shard_filename *******************************************************
+PROTO	void shard_filename(shardstruct *shard, int k, char *filename)
+PURPOSE	Build the name of a work file.
+INPUT	Pointer to the shard structure,
+	worker index (-1 for the file written by the master),
+	output file name (at least MAXCHAR bytes).
+OUTPUT	-.
+NOTES	shard_init() keeps the file name root short enough for the result to
+	fit; truncation is an error anyway.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	shard_filename(shardstruct *shard, int k, char *filename)
+  {
+   int		len;
+
+  if (k<0)
+    len = snprintf(filename, MAXCHAR, "%s%s", shard->filename, SHARD_SUFFIX);
+  else
+    len = snprintf(filename, MAXCHAR, "%s_%d%s", shard->filename, k,
+		SHARD_SUFFIX);
+  if (len >= MAXCHAR)
+    error(EXIT_FAILURE, "*Error*: shard work file name too long: ",
+	shard->filename);
+
+  return;
+  }
+
+
+/****** shard_read ***********************************************************
+PROTO	void shard_read(FILE *file, void *ptr, size_t size, int n)
+PURPOSE	Read an array from a work file.
+INPUT	File pointer,
+	pointer to the array,
+	element size,
+	number of elements.
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	shard_read(FILE *file, void *ptr, size_t size, int n)
+  {
+  if (n>0 && fread(ptr, size, (size_t)n, file) != (size_t)n)
+    error(EXIT_FAILURE, "*Error*: shard work file ", "truncated");
+
+  return;
+  }
+
+
+/****** shard_write **********************************************************
+PROTO	void shard_write(FILE *file, void *ptr, size_t size, int n)
+PURPOSE	Write an array to a work file.
+INPUT	File pointer,
+	pointer to the array,
+	element size,
+	number of elements.
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	shard_write(FILE *file, void *ptr, size_t size, int n)
+  {
+  if (n>0 && fwrite(ptr, size, (size_t)n, file) != (size_t)n)
+    error(EXIT_FAILURE, "*Error*: cannot write shard work file", "");
+
+  return;
+  }
+
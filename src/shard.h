@@ -0,0 +1,110 @@
+/*
+*				shard.h
+*
+* Include file for shard.c.
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+*
+*	This file part of:	PSFEx
+*
+*	Copyright:		(C) 2026 Emmanuel Bertin -- IAP/CNRS/UPMC
+*
+*	License:		GNU General Public License
+*
+*	PSFEx is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+* 	(at your option) any later version.
+*	PSFEx is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*	You should have received a copy of the GNU General Public License
+*	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
+*
+*	Last modified:		19/10/2026
+*
+*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+#ifdef HAVE_CONFIG_H
+#include	"config.h"
+#endif
+
+#ifndef _SHARD_H_
+#define _SHARD_H_
+
+#include	<sys/types.h>
+
+#ifndef _CONTEXT_H_
+#include	"context.h"
+#endif
+
+#ifndef _PSFMEF_H_
+#include	"field.h"
+#endif
+
+#ifndef _PSF_H_
+#include	"psf.h"
+#endif
+
+#ifndef _SAMPLE_H_
+#include	"sample.h"
+#endif
+
+/*----------------------------- Internal constants --------------------------*/
+
+#define	SHARD_MAGIC	"PSFEXSHD"	/* Shard work file signature */
+#define	SHARD_SUFFIX	".shd"		/* Shard work file extension */
+
+/*--------------------------------- typedefs --------------------------------*/
+typedef enum {SHARD_LOAD, SHARD_SETUP, SHARD_INITPSF, SHARD_MAKE,
+		SHARD_REFINE, SHARD_RESI, SHARD_REJECT, SHARD_COUNT, SHARD_END}
+		shardcmdenum;
+
+/*--------------------------- structure definitions -------------------------*/
+/* Message exchanged between the master and a worker */
+typedef struct shardmsg
+  {
+  shardcmdenum	cmd;			/* Command (or command acknowledged) */
+  int		ival;			/* Integer argument or result */
+  double	dval;			/* Floating-point argument */
+  }	shardmsgstruct;
+
+/* Workers sharing a fit */
+typedef struct shard
+  {
+  int		nshard;			/* Number of worker processes */
+  int		index;			/* Worker index (-1 for the master) */
+  pid_t		*pid;			/* Worker process IDs */
+  int		*cmdfd;			/* Command pipes (master to workers) */
+  int		*ackfd;			/* Reply pipes (workers to master) */
+  int		*catindex;		/* First catalogue of each worker */
+  int		*ncat;			/* Number of catalogues per worker */
+  int		*nsample;		/* Number of samples per worker */
+  int		next;			/* Number of extensions per catalogue */
+  fieldstruct	**fields;		/* Pointer to the array of fields */
+  contextstruct	*context;		/* Pointer to the context */
+  setstruct	*set;			/* Master: sample-less set; worker: set*/
+  psfstruct	*psf;			/* Worker copy of the PSF model */
+  char		filename[MAXCHAR];	/* Work file name root */
+  }	shardstruct;
+
+/*---------------------------------- protos --------------------------------*/
+extern shardstruct	*shard_init(fieldstruct **fields, char **catnames,
+				int ncat, int ext, int next,
+				contextstruct *context);
+
+extern double		shard_chi2(shardstruct *shard, psfstruct *psf),
+			shard_clean(shardstruct *shard, psfstruct *psf,
+				double prof_accuracy);
+
+extern int		shard_refine(shardstruct *shard, psfstruct *psf);
+
+extern void		shard_count(shardstruct *shard, int counttype),
+			shard_end(shardstruct *shard),
+			shard_initpsf(shardstruct *shard, float psfstep),
+			shard_make(shardstruct *shard, psfstruct *psf,
+				double prof_accuracy);
+
+#endif
+
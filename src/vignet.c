@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		10/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -41,6 +41,10 @@
 #include	"fits/fitscat.h"
 #include	"vignet.h"
 
+static int	vignet_doresample(float *pix1, int w1, int h1,
+			float *pix2, int w2, int h2, double dx, double dy,
+			float step2, float stepi, int mixedflag);
+
 
 /****** vignet_resample ******************************************************
 PROTO	int	vignet_resample(float *pix1, int w1, int h1,
@@ -62,16 +66,76 @@ INPUT	Input raster,
 OUTPUT	RETURN_ERROR if the images do not overlap, RETURN_OK otherwise.
 NOTES	-.
 AUTHOR	E. Bertin (IAP)
-VERSION	13/09/2010
+VERSION	19/10/2026
  ***/
 int	vignet_resample(float *pix1, int w1, int h1,
 		float *pix2, int w2, int h2, double dx, double dy, float step2,
 		float stepi)
+  {
+  return vignet_doresample(pix1, w1, h1, pix2, w2, h2, dx, dy, step2, stepi,
+		0);
+  }
+
+
+/****** vignet_resample_mixed ************************************************
+PROTO	int	vignet_resample_mixed(float *pix1, int w1, int h1,
+		float *pix2, int w2, int h2, double dx, double dy, float step2,
+		float stepi)
+PURPOSE	Same as vignet_resample(), with interpolation masks and inner
+	products computed in single precision.
+INPUT	Input raster,
+	input raster width,
+	input raster height,
+	output raster,
+	output raster width,
+	output raster height,
+	shift in x,
+	shift in y,
+	output pixel scale.	
+OUTPUT	RETURN_ERROR if the images do not overlap, RETURN_OK otherwise.
+NOTES	Each output pixel is a sum of at most INTERPW/stepi normalized terms,
+	hence single precision accumulators lose no significant accuracy.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+int	vignet_resample_mixed(float *pix1, int w1, int h1,
+		float *pix2, int w2, int h2, double dx, double dy, float step2,
+		float stepi)
+  {
+  return vignet_doresample(pix1, w1, h1, pix2, w2, h2, dx, dy, step2, stepi,
+		1);
+  }
+
+
+/****** vignet_doresample ****************************************************
+PROTO	int	vignet_doresample(float *pix1, int w1, int h1,
+		float *pix2, int w2, int h2, double dx, double dy, float step2,
+		float stepi, int mixedflag)
+PURPOSE	Resampling engine for vignet_resample() and vignet_resample_mixed().
+INPUT	Input raster,
+	input raster width,
+	input raster height,
+	output raster,
+	output raster width,
+	output raster height,
+	shift in x,
+	shift in y,
+	output pixel scale,
+	single precision flag.
+OUTPUT	RETURN_ERROR if the images do not overlap, RETURN_OK otherwise.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static int	vignet_doresample(float *pix1, int w1, int h1,
+			float *pix2, int w2, int h2, double dx, double dy,
+			float step2, float stepi, int mixedflag)
   {
    static float	*statpix2;
    double	*mask,*maskt, mx1,mx2,my1,my2, xs1,ys1, x1,y1, x,y, dxm,dym,
 		val, dstepi, norm;
-   float	*pix12, *pixin,*pixin0, *pixout,*pixout0;
+   float	*pix12, *pixin,*pixin0, *pixout,*pixout0,
+		*fmask,*fmaskt, fval;
    int		i,j,k,n,t, *start,*startt, *nmask,*nmaskt,
 		ixs2,iys2, ix2,iy2, dix2,diy2, nx2,ny2, iys1a, ny1, hmw,hmh,
 		ix,iy, ix1,iy1, interpw, interph;
@@ -175,19 +239,45 @@ int	vignet_resample(float *pix1, int w1, int h1,
 /* Make the interpolation in x (this includes transposition) */
   pixin0 = pix1+iys1a*w1;
   pixout0 = pix12;
-  for (k=ny1; k--; pixin0+=w1, pixout0++)
+  if (mixedflag)
+    {
+/*-- Single precision copy of the x-interpolants */
+    QMALLOC(fmask, float, nx2*interpw);
+    for (maskt=mask, fmaskt=fmask, i=nx2*interpw; i--;)
+      *(fmaskt++) = (float)*(maskt++);
+    for (k=ny1; k--; pixin0+=w1, pixout0++)
+      {
+      fmaskt = fmask;
+      nmaskt = nmask;
+      startt = start;
+      pixout = pixout0;
+      for (j=nx2; j--; pixout+=ny1)
+        {
+        pixin = pixin0+*(startt++);
+        fval = 0.0f;
+        for (i=*(nmaskt++); i--;)
+          fval += *(fmaskt++)**(pixin++);
+        *pixout = fval;
+        }
+      }
+    }
+  else
     {
-    maskt = mask;
-    nmaskt = nmask;
-    startt = start;
-    pixout = pixout0;
-    for (j=nx2; j--; pixout+=ny1)
+    fmask = NULL;
+    for (k=ny1; k--; pixin0+=w1, pixout0++)
       {
-      pixin = pixin0+*(startt++);
-      val = 0.0; 
-      for (i=*(nmaskt++); i--;)
-        val += *(maskt++)*(double)*(pixin++);
-      *pixout = (float)val;
+      maskt = mask;
+      nmaskt = nmask;
+      startt = start;
+      pixout = pixout0;
+      for (j=nx2; j--; pixout+=ny1)
+        {
+        pixin = pixin0+*(startt++);
+        val = 0.0; 
+        for (i=*(nmaskt++); i--;)
+          val += *(maskt++)*(double)*(pixin++);
+        *pixout = (float)val;
+        }
       }
     }
 
@@ -238,21 +328,45 @@ int	vignet_resample(float *pix1, int w1, int h1,
 /* Make the interpolation in y  and transpose once again */
   pixin0 = pix12;
   pixout0 = pix2+ixs2+iys2*w2;
-  for (k=nx2; k--; pixin0+=ny1, pixout0++)
+  if (mixedflag)
     {
-    maskt = mask;
-    nmaskt = nmask;
-    startt = start;
-    pixout = pixout0;
-    for (j=ny2; j--; pixout+=w2)
+/*-- Single precision copy of the y-interpolants */
+    QREALLOC(fmask, float, ny2*interph);
+    for (maskt=mask, fmaskt=fmask, i=ny2*interph; i--;)
+      *(fmaskt++) = (float)*(maskt++);
+    for (k=nx2; k--; pixin0+=ny1, pixout0++)
       {
-      pixin = pixin0+*(startt++);
-      val = 0.0; 
-      for (i=*(nmaskt++); i--;)
-        val += *(maskt++)*(double)*(pixin++);
-      *pixout = (float)val;
+      fmaskt = fmask;
+      nmaskt = nmask;
+      startt = start;
+      pixout = pixout0;
+      for (j=ny2; j--; pixout+=w2)
+        {
+        pixin = pixin0+*(startt++);
+        fval = 0.0f;
+        for (i=*(nmaskt++); i--;)
+          fval += *(fmaskt++)**(pixin++);
+        *pixout = fval;
+        }
       }
+    free(fmask);
     }
+  else
+    for (k=nx2; k--; pixin0+=ny1, pixout0++)
+      {
+      maskt = mask;
+      nmaskt = nmask;
+      startt = start;
+      pixout = pixout0;
+      for (j=ny2; j--; pixout+=w2)
+        {
+        pixin = pixin0+*(startt++);
+        val = 0.0; 
+        for (i=*(nmaskt++); i--;)
+          val += *(maskt++)*(double)*(pixin++);
+        *pixout = (float)val;
+        }
+      }
 
 /* Free memory */
   free(pix12);
@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		10/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -56,7 +56,10 @@ extern int	vignet_copy(float *pix1, int w1, int h1,
 			vigopenum vigop),
 		vignet_resample(float *pix1, int w1, int h1, float *pix2,
 			int w2, int h2, double dx, double dy, float step2,
-			float stepi);
+			float stepi),
+		vignet_resample_mixed(float *pix1, int w1, int h1,
+			float *pix2, int w2, int h2, double dx, double dy,
+			float step2, float stepi);
 
 extern float	vignet_aperflux(float *ima, float *var, int w, int h,
 			float dxc, float dyc, float aper,
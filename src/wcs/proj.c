@@ -24,7 +24,7 @@
 *	along with AstrOmatic software.
 *	If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		10/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 /*============================================================================
@@ -235,7 +235,7 @@
 #endif
 #include <stdio.h>
 #include <stdlib.h>
-#include "poly.h"
+#include "../poly.h"
 #include "proj.h"
 #include "tnx.h"
 #include "wcsmath.h"
@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		10/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -49,48 +49,93 @@
 extern time_t		thetime,thetime2;	/* from makeit.c */
 extern pkeystruct	key[];			/* from preflist.h */
 extern char		keylist[][32];		/* from preflist.h */
- 
-fieldstruct		**field_xml;
+
 int			nxml, nxmlmax;
 
+static FILE		*xml_file;		/* Streamed XML file */
+static xmlstatstruct	*xml_extstat;		/* Running stats per extension*/
+static long		xml_slotpos[XML_NSLOT];	/* Positions of patched slots */
+static int		xml_next, xml_nplot;
+#ifdef HAVE_PLPLOT
+static int		xml_cp[CPLOT_NTYPES];
+#endif
+static const int	xml_slotsize[XML_NSLOT] = {XML_SLOTSIZE_DATE,
+				0, XML_SLOTSIZE_CURRFIELD};
+
+static void		xml_addstat(xmlstatstruct *stat, psfstruct *psf),
+			xml_close(char *error),
+			xml_endstat(xmlstatstruct *stat),
+			xml_initstat(xmlstatstruct *stat),
+			xml_insert(int slot, char *str),
+			xml_patch(int slot, char *str),
+			xml_printstat(FILE *file, xmlstatstruct *stat),
+			xml_settime(void),
+			xml_slot(FILE *file, int slot, char *str),
+			xml_write_fieldrow(FILE *file, fieldstruct *field,
+				xmlstatstruct *stat),
+			xml_write_fieldshead(FILE *file),
+			xml_write_metahead(FILE *file, char *error),
+			xml_write_metatail(FILE *file, char *error);
+
+static char		*xml_sprintcurrfield(char *str),
+			*xml_sprintdate(char *str),
+			*xml_sprinterror(char *str, char *error);
+
 
 /****** init_xml ************************************************************
 PROTO	int init_xml(int ncat)
-PURPOSE	Initialize a set of meta-data kept in memory before being written to the
-	XML file
+PURPOSE	Initialize the XML meta-data output.
 INPUT	Number of catalogues.
-OUTPUT	-.
-NOTES	-.
+OUTPUT	RETURN_OK if everything went fine, RETURN_ERROR otherwise.
+NOTES	If there are catalogues to process, the XML file is opened right away
+	and the VOTable header written, so that field rows can be streamed by
+	update_xml() as soon as each field is done.
 AUTHOR	E. Bertin (IAP)
-VERSION	04/07/2008
+VERSION	19/10/2026
  ***/
 int	init_xml(int ncat)
   {
-  if (ncat)
-    {
-    QMALLOC(field_xml, fieldstruct *, ncat);
-    }
-  else
-    field_xml = NULL;
   nxml = 0;
   nxmlmax = ncat;
+  xml_extstat = NULL;
+  xml_next = 0;
+  xml_file = NULL;
+  if (!ncat)
+    return RETURN_OK;
+
+  if (!(xml_file = fopen(prefs.xml_name, "w+")))
+    {
+    warning("Cannot open XML file for writing: ", prefs.xml_name);
+    return RETURN_ERROR;
+    }
+
+  write_xml_header(xml_file);
+  xml_write_metahead(xml_file, (char *)NULL);
+  xml_write_fieldshead(xml_file);
+  fflush(xml_file);
 
-  return EXIT_SUCCESS;
+  return RETURN_OK;
   }
 
 
 /****** end_xml ************************************************************
 PROTO	void end_xml(void)
-PURPOSE	Free the set of meta-data kept in memory.
+PURPOSE	Free the XML meta-data resources.
 INPUT	-.
 OUTPUT	.
-NOTES	-.
+NOTES	An XML stream still open at this point is closed as is.
 AUTHOR	E. Bertin (IAP)
-VERSION	04/07/2008
+VERSION	19/10/2026
  ***/
 void	end_xml(void)
   {
-  free(field_xml);
+  if (xml_file)
+    {
+    fclose(xml_file);
+    xml_file = NULL;
+    }
+  free(xml_extstat);
+  xml_extstat = NULL;
 
   return;
   }
@@ -98,20 +143,48 @@ void	end_xml(void)
 
 /****** update_xml ***********************************************************
 PROTO	int update_xml(fieldstruct *field)
-PURPOSE	Update a set of meta-data kept in memory before being written to the
-	XML file
+PURPOSE	Write the meta-data row of a processed field to the XML stream and
+	update the running per-extension statistics.
 INPUT	Pointer to the current field.
 OUTPUT	RETURN_OK if everything went fine, RETURN_ERROR otherwise.
-NOTES	Global preferences are used.
+NOTES	Global preferences are used. Only fixed-size running statistics are
+	kept in memory, whatever the number of fields.
 AUTHOR	E. Bertin (IAP)
-VERSION	04/07/2008
+VERSION	19/10/2026
  ***/
 int	update_xml(fieldstruct *field)
   {
-  field_xml[nxml] = field;
+   xmlstatstruct	stat;
+   char			str[XML_SLOTSIZE_CURRFIELD];
+   int			e;
+
   nxml++;
+  if (!xml_file)
+    return RETURN_ERROR;
+
+/* Per-field row */
+  xml_initstat(&stat);
+  for (e=0; e<field->next; e++)
+    xml_addstat(&stat, field->psf[e]);
+  xml_endstat(&stat);
+  xml_write_fieldrow(xml_file, field, &stat);
+
+/* Running per-extension statistics */
+  if (!xml_extstat)
+    {
+    xml_next = field->next;
+    QMALLOC(xml_extstat, xmlstatstruct, xml_next);
+    for (e=0; e<xml_next; e++)
+      xml_initstat(&xml_extstat[e]);
+    }
+  for (e=0; e<xml_next && e<field->next; e++)
+    xml_addstat(&xml_extstat[e], field->psf[e]);
 
-  return EXIT_SUCCESS;
+/* Keep the field counter up to date for monitoring */
+  xml_patch(XML_SLOT_CURRFIELD, xml_sprintcurrfield(str));
+  fflush(xml_file);
+
+  return RETURN_OK;
   }
 
 
@@ -120,14 +193,20 @@ PROTO	int	write_xml(char *filename)
 PURPOSE	Save meta-data to an XML file/stream.
 INPUT	XML file name.
 OUTPUT	RETURN_OK if everything went fine, RETURN_ERROR otherwise.
-NOTES	-.
+NOTES	If the XML file is being streamed, it is just completed and closed.
 AUTHOR	E. Bertin (IAP)
-VERSION	06/10/2006
+VERSION	19/10/2026
  ***/
 int	write_xml(char *filename)
   {
    FILE		*file;
 
+  if (xml_file)
+    {
+    xml_close((char *)NULL);
+    return RETURN_OK;
+    }
+
   if (!(file = fopen(prefs.xml_name, "w")))
     return RETURN_ERROR;
 
@@ -181,54 +260,273 @@ int	write_xml_header(FILE *file)
 
 /****** write_xml_meta ********************************************************
 PROTO	int	write_xml_meta(FILE *file, char *error)
-PURPOSE	Save meta-data to an XML-VOTable file or stream
+PURPOSE	Save meta-data to an XML-VOTable file or stream in one go
 INPUT	Pointer to the output file (or stream),
 	Pointer to an error msg (or NULL).
 OUTPUT	RETURN_OK if everything went fine, RETURN_ERROR otherwise.
-NOTES	-.
+NOTES	Only used when no XML stream is open (e.g. no input catalogue, or
+	error before init_xml()); the field table is then empty.
 AUTHOR	E. Bertin (IAP)
-VERSION	27/10/2009
+VERSION	19/10/2026
  ***/
 int	write_xml_meta(FILE *file, char *error)
   {
-   fieldstruct		*field;
-   psfstruct		*psf;
-   struct tm		*tm;
-   char			*pspath,*psuser, *pshost, *str;
-   double		minrad_min,minrad_mean,minrad_max,
-			sampling_min,sampling_mean,sampling_max,
-			chi2_min,chi2_mean,chi2_max,
-			fwhm_min,fwhm_mean,fwhm_max,
-			ellipticity_min,ellipticity_mean,ellipticity_max,
-			beta_min,beta_mean,beta_max,
-			residuals_min,residuals_mean,residuals_max,
-			pffwhm_min,pffwhm_mean,pffwhm_max,
-			pfellipticity_min,pfellipticity_mean,pfellipticity_max,
-			pfbeta_min,pfbeta_mean,pfbeta_max,
-			pfresiduals_min,pfresiduals_mean,pfresiduals_max,
-			symresiduals_min,symresiduals_mean,symresiduals_max,
-			nloaded_mean,naccepted_mean;
-   int			d,n,e,
-			nloaded_min,nloaded_max,nloaded_total,
-			naccepted_min,naccepted_max,naccepted_total, neff, next;
-#ifdef HAVE_PLPLOT
-   char			plotfilename[MAXCHAR],
-			*pstr;
-   int			cp[CPLOT_NTYPES],
-			j,t, nplot, pnplot, pngindex, pngflag;
-#endif
-
 /* Processing date and time if msg error present */
   if (error)
-    {
-    thetime2 = time(NULL);
-    tm = localtime(&thetime2);
-    sprintf(prefs.sdate_end,"%04d-%02d-%02d",
+    xml_settime();
+
+  xml_write_metahead(file, error);
+  xml_write_fieldshead(file);
+  xml_write_metatail(file, error);
+
+  return RETURN_OK;
+  }
+
+
+/****** xml_close ************************************************************
+PROTO	void xml_close(char *error)
+PURPOSE	Complete and close the streamed XML file.
+INPUT	Pointer to an error msg (or NULL).
+OUTPUT	-.
+NOTES	The end date and time and the field counter are patched into the
+	slots reserved at the beginning of the file; the error message (if
+	any) is inserted.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	xml_close(char *error)
+  {
+   char		str[XML_SLOTSIZE_ERROR];
+
+  if (error)
+    xml_settime();
+
+  xml_write_metatail(xml_file, error);
+  fprintf(xml_file, "</RESOURCE>\n");
+  fprintf(xml_file, "</VOTABLE>\n");
+
+  xml_patch(XML_SLOT_DATE, xml_sprintdate(str));
+  xml_patch(XML_SLOT_CURRFIELD, xml_sprintcurrfield(str));
+  if (error)
+    xml_insert(XML_SLOT_ERROR, xml_sprinterror(str, error));
+
+  fclose(xml_file);
+  xml_file = NULL;
+
+  return;
+  }
+
+
+/****** xml_settime **********************************************************
+PROTO	void xml_settime(void)
+PURPOSE	Set the processing end date and time in case of a catched error.
+INPUT	-.
+OUTPUT	-.
+NOTES	Global preferences are updated.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	xml_settime(void)
+  {
+   struct tm		*tm;
+
+  thetime2 = time(NULL);
+  tm = localtime(&thetime2);
+  sprintf(prefs.sdate_end,"%04d-%02d-%02d",
         tm->tm_year+1900, tm->tm_mon+1, tm->tm_mday);
-    sprintf(prefs.stime_end,"%02d:%02d:%02d",
+  sprintf(prefs.stime_end,"%02d:%02d:%02d",
         tm->tm_hour, tm->tm_min, tm->tm_sec);
-    prefs.time_diff = difftime(thetime2, thetime);
+  prefs.time_diff = difftime(thetime2, thetime);
+
+  return;
+  }
+
+
+/****** xml_slot *************************************************************
+PROTO	void xml_slot(FILE *file, int slot, char *str)
+PURPOSE	Write a piece of XML that may have to be patched later.
+INPUT	Pointer to the output file (or stream),
+	slot index,
+	XML string.
+OUTPUT	-.
+NOTES	In the XML stream, the string is padded with blanks to the full size of
+	the slot, and the position of the slot recorded. Zero-size slots are
+	not padded; they can only be filled later with xml_insert().
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	xml_slot(FILE *file, int slot, char *str)
+  {
+   int		n;
+
+  if (file != xml_file)
+    {
+    if (*str)
+      fprintf(file, "%s\n", str);
+    return;
+    }
+
+  xml_slotpos[slot] = ftell(file);
+  if (!xml_slotsize[slot])
+    {
+    if (*str)
+      fprintf(file, "%s\n", str);
+    return;
+    }
+  fputs(str, file);
+  for (n=xml_slotsize[slot]-1-strlen(str); n>0; n--)
+    putc(' ', file);
+  putc('\n', file);
+
+  return;
+  }
+
+
+/****** xml_patch ************************************************************
+PROTO	void xml_patch(int slot, char *str)
+PURPOSE	Overwrite a slot of the XML stream.
+INPUT	slot index,
+	XML string.
+OUTPUT	-.
+NOTES	The file pointer is moved back to the end of the stream.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	xml_patch(int slot, char *str)
+  {
+  fseek(xml_file, xml_slotpos[slot], SEEK_SET);
+  xml_slot(xml_file, slot, str);
+  fseek(xml_file, 0L, SEEK_END);
+
+  return;
+  }
+
+
+/****** xml_insert ***********************************************************
+PROTO	void xml_insert(int slot, char *str)
+PURPOSE	Insert a string at the position of a slot of the XML stream.
+INPUT	slot index,
+	XML string.
+OUTPUT	-.
+NOTES	The end of the stream is read back and moved, hence this is meant for
+	unpadded slots filled at most once, on rare occasions (errors). The
+	positions of the slots that follow are not updated.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	xml_insert(int slot, char *str)
+  {
+   char		*buf;
+   long		size;
+
+  fseek(xml_file, 0L, SEEK_END);
+  size = ftell(xml_file) - xml_slotpos[slot];
+  QMALLOC(buf, char, size+1);
+  fseek(xml_file, xml_slotpos[slot], SEEK_SET);
+  if (fread(buf, 1, (size_t)size, xml_file) != (size_t)size)
+    {
+    warning("Cannot read back XML file ", prefs.xml_name);
+    free(buf);
+    fseek(xml_file, 0L, SEEK_END);
+    return;
     }
+  fseek(xml_file, xml_slotpos[slot], SEEK_SET);
+  fprintf(xml_file, "%s\n", str);
+  fwrite(buf, 1, (size_t)size, xml_file);
+  free(buf);
+
+  return;
+  }
+
+
+/****** xml_sprintdate *******************************************************
+PROTO	char *xml_sprintdate(char *str)
+PURPOSE	Print the end date, time and duration PARAMs to a string.
+INPUT	Output string (at least XML_SLOTSIZE_DATE bytes).
+OUTPUT	Pointer to the output string.
+NOTES	Global preferences are used.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static char	*xml_sprintdate(char *str)
+  {
+  snprintf(str, XML_SLOTSIZE_DATE,
+	"  <PARAM name=\"Date\" datatype=\"char\" arraysize=\"*\""
+	" ucd=\"time.event.end;meta.software\" value=\"%s\"/>\n"
+	"  <PARAM name=\"Time\" datatype=\"char\" arraysize=\"*\""
+	" ucd=\"time.event.end;meta.software\" value=\"%s\"/>\n"
+	"  <PARAM name=\"Duration\" datatype=\"float\""
+	" ucd=\"time.event;meta.software\" value=\"%.0f\" unit=\"s\"/>",
+	prefs.sdate_end, prefs.stime_end, prefs.time_diff);
+
+  return str;
+  }
+
+
+/****** xml_sprintcurrfield **************************************************
+PROTO	char *xml_sprintcurrfield(char *str)
+PURPOSE	Print the current field number PARAM to a string.
+INPUT	Output string (at least XML_SLOTSIZE_CURRFIELD bytes).
+OUTPUT	Pointer to the output string.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static char	*xml_sprintcurrfield(char *str)
+  {
+  snprintf(str, XML_SLOTSIZE_CURRFIELD,
+	"   <PARAM name=\"CurrField\" datatype=\"int\""
+	" ucd=\"meta.number;meta.dataset\" value=\"%d\"/>", nxml);
+
+  return str;
+  }
+
+
+/****** xml_sprinterror ******************************************************
+PROTO	char *xml_sprinterror(char *str, char *error)
+PURPOSE	Print the error message block to a string.
+INPUT	Output string (at least XML_SLOTSIZE_ERROR bytes),
+	error message.
+OUTPUT	Pointer to the output string.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static char	*xml_sprinterror(char *str, char *error)
+  {
+  snprintf(str, XML_SLOTSIZE_ERROR,
+	"\n  <!-- !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!"
+	"!!!!!!!!!!!!!!!!!!!! -->\n"
+	"  <!-- !!!!!!!!!!!!!!!!!!!!!! an Error occured"
+	" !!!!!!!!!!!!!!!!!!!!! -->\n"
+	"  <!-- !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!"
+	"!!!!!!!!!!!!!!!!!!!! -->\n"
+	"  <PARAM name=\"Error_Msg\" datatype=\"char\" arraysize=\"*\""
+	" ucd=\"meta\" value=\"%.*s\"/>\n"
+	"  <!-- !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!"
+	"!!!!!!!!!!!!!!!!!!!! -->\n"
+	"  <!-- !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!"
+	"!!!!!!!!!!!!!!!!!!!! -->\n",
+	MAXCHAR, error);
+
+  return str;
+  }
+
+
+/****** xml_write_metahead ***************************************************
+PROTO	void xml_write_metahead(FILE *file, char *error)
+PURPOSE	Write the software and processing PARAMs of the meta-data resource.
+INPUT	Pointer to the output file (or stream),
+	Pointer to an error msg (or NULL).
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	xml_write_metahead(FILE *file, char *error)
+  {
+   char			str[XML_SLOTSIZE_ERROR],
+			*pspath,*psuser, *pshost;
 
 /* Username */
   psuser = pspath = pshost = NULL;
@@ -260,15 +558,7 @@ int	write_xml_meta(FILE *file, char *error)
   fprintf(file, "  <PARAM name=\"NThreads\" datatype=\"int\""
 	" ucd=\"meta.number;meta.software\" value=\"%d\"/>\n",
     	prefs.nthreads);
-  fprintf(file, "  <PARAM name=\"Date\" datatype=\"char\" arraysize=\"*\""
-	" ucd=\"time.event.end;meta.software\" value=\"%s\"/>\n",
-	prefs.sdate_end);
-  fprintf(file, "  <PARAM name=\"Time\" datatype=\"char\" arraysize=\"*\""
-	" ucd=\"time.event.end;meta.software\" value=\"%s\"/>\n",
-	prefs.stime_end);
-  fprintf(file, "  <PARAM name=\"Duration\" datatype=\"float\""
-	" ucd=\"time.event;meta.software\" value=\"%.0f\" unit=\"s\"/>\n",
-	prefs.time_diff);
+  xml_slot(file, XML_SLOT_DATE, xml_sprintdate(str));
 
   fprintf(file, "  <PARAM name=\"User\" datatype=\"char\" arraysize=\"*\""
 	" ucd=\"meta.curation\" value=\"%s\"/>\n",
@@ -280,25 +570,35 @@ int	write_xml_meta(FILE *file, char *error)
 	" ucd=\"meta.dataset\" value=\"%s\"/>\n",
 	pspath);
 
-  if (error)
-    {
-    fprintf(file, "\n  <!-- !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!"
-	"!!!!!!!!!!!!!!!!!!!! -->\n");
-    fprintf(file, "  <!-- !!!!!!!!!!!!!!!!!!!!!! an Error occured"
-	" !!!!!!!!!!!!!!!!!!!!! -->\n");
-    fprintf(file, "  <!-- !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!"
-	"!!!!!!!!!!!!!!!!!!!! -->\n");
-    fprintf(file,"  <PARAM name=\"Error_Msg\" datatype=\"char\" arraysize=\"*\""
-	" ucd=\"meta\" value=\"%s\"/>\n", error);
-    fprintf(file, "  <!-- !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!"
-	"!!!!!!!!!!!!!!!!!!!! -->\n");
-    fprintf(file, "  <!-- !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!"
-	"!!!!!!!!!!!!!!!!!!!! -->\n\n");
-    }
+  xml_slot(file, XML_SLOT_ERROR, error? xml_sprinterror(str, error) : "");
+
+  return;
+  }
+
+
+/****** xml_write_fieldshead *************************************************
+PROTO	void xml_write_fieldshead(FILE *file)
+PURPOSE	Write the header of the per-field meta-data table, up to the opening
+	of the TABLEDATA element.
+INPUT	Pointer to the output file (or stream).
+OUTPUT	-.
+NOTES	The list of PNG check-plots referenced in the table is recorded for
+	xml_write_fieldrow().
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	xml_write_fieldshead(FILE *file)
+  {
+   char			str[XML_SLOTSIZE_CURRFIELD];
+   int			d;
+#ifdef HAVE_PLPLOT
+   int			j, pngindex, pngflag;
+#endif
 
 /* Test if PNG plots are being produced */
+  xml_nplot = 0;
 #ifdef HAVE_PLPLOT
-  nplot = pnplot = pngflag = 0;
+  pngflag = 0;
   for (j=0; j<prefs.ncplot_device; j++)
     if ((prefs.cplot_device[j] == CPLOT_PNG))
       {
@@ -317,8 +617,7 @@ int	write_xml_meta(FILE *file, char *error)
 	" ucd=\"meta.number;meta.dataset\" value=\"%d\"/>\n", nxmlmax);
   fprintf(file, "   <!-- CurrField may differ from NFields"
 	" if an error occurred -->\n");
-  fprintf(file, "   <PARAM name=\"CurrField\" datatype=\"int\""
-	" ucd=\"meta.number;meta.dataset\" value=\"%d\"/>\n", nxml);
+  xml_slot(file, XML_SLOT_CURRFIELD, xml_sprintcurrfield(str));
   fprintf(file, "   <PARAM name=\"NSnapshots\" datatype=\"int\""
 	" arraysize=\"%d\" ucd=\"meta.number;meta.dataset\""
 	" value=\"%d",
@@ -434,174 +733,303 @@ int	write_xml_meta(FILE *file, char *error)
 	" ucd=\"stat.fit.residual;stat.mean;instr.det.psf\"/>\n");
   fprintf(file, "   <FIELD name=\"Asymmetry_Max\" datatype=\"float\""
 	" ucd=\"stat.fit.residual;stat.max;instr.det.psf\"/>\n");
+  fprintf(file, "   <FIELD name=\"NFitPasses_Min\" datatype=\"int\""
+	" ucd=\"meta.number;stat.min;meta.code\"/>\n");
+  fprintf(file, "   <FIELD name=\"NFitPasses_Mean\" datatype=\"float\""
+	" ucd=\"meta.number;stat.mean;meta.code\"/>\n");
+  fprintf(file, "   <FIELD name=\"NFitPasses_Max\" datatype=\"int\""
+	" ucd=\"meta.number;stat.max;meta.code\"/>\n");
+  fprintf(file, "   <FIELD name=\"FitTime_Saved\" unit=\"s\""
+	" datatype=\"float\" ucd=\"time.duration;meta.code\"/>\n");
 /*-- Checkplots */
 #ifdef HAVE_PLPLOT
   if (pngflag)
     {
-    pnplot = nplot;
     if ((pngindex=cplot_check(CPLOT_COUNTS)) != RETURN_ERROR)
       {
       fprintf(file, "   <FIELD name=\"Plot_Counts\" datatype=\"char\""
         " arraysize=\"*\" ucd=\"meta.id;meta.file\"/>\n");
-      cp[nplot++] = pngindex;
+      xml_cp[xml_nplot++] = pngindex;
       }
     if ((pngindex=cplot_check(CPLOT_COUNTFRAC)) != RETURN_ERROR)
       {
       fprintf(file, "   <FIELD name=\"Plot_Count_Fraction\" datatype=\"char\""
         " arraysize=\"*\" ucd=\"meta.id;meta.file\"/>\n");
-      cp[nplot++] = pngindex;
+      xml_cp[xml_nplot++] = pngindex;
       }
     if ((pngindex=cplot_check(CPLOT_FWHM)) != RETURN_ERROR)
       {
       fprintf(file, "   <FIELD name=\"Plot_FWHM\" datatype=\"char\""
         " arraysize=\"*\" ucd=\"meta.id;meta.file\"/>\n");
-      cp[nplot++] = pngindex;
+      xml_cp[xml_nplot++] = pngindex;
       }
     if ((pngindex=cplot_check(CPLOT_ELLIPTICITY)) != RETURN_ERROR)
       {
       fprintf(file, "   <FIELD name=\"Plot_Ellipticity\" datatype=\"char\""
         " arraysize=\"*\" ucd=\"meta.id;meta.file\"/>\n");
-      cp[nplot++] = pngindex;
+      xml_cp[xml_nplot++] = pngindex;
       }
     }
 #endif
 
   fprintf(file, "   <DATA><TABLEDATA>\n");
-  for (n=0; n<nxml; n++)
+
+  return;
+  }
+
+
+/****** xml_write_fieldrow ***************************************************
+PROTO	void xml_write_fieldrow(FILE *file, fieldstruct *field,
+		xmlstatstruct *stat)
+PURPOSE	Write the meta-data row of a field.
+INPUT	Pointer to the output file (or stream),
+	pointer to the field,
+	pointer to the field statistics.
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	xml_write_fieldrow(FILE *file, fieldstruct *field,
+			xmlstatstruct *stat)
+  {
+#ifdef HAVE_PLPLOT
+   char			plotfilename[MAXCHAR],
+			*pstr;
+   int			t;
+#endif
+
+  fprintf(file, "    <TR>\n"
+	"     <TD>%s</TD><TD>%s</TD><TD>%d</TD>\n",
+	field->rcatname, field->ident, field->next);
+  xml_printstat(file, stat);
+/* Check-plots */
+#ifdef HAVE_PLPLOT
+  for (t=0; t<xml_nplot; t++)
     {
-/*-- Compute min,average and max of Moffat fitted parameters */
-    nloaded_min = naccepted_min = 2<<29;
-    nloaded_max = naccepted_max = nloaded_total = naccepted_total = 0;
-    minrad_min = sampling_min = chi2_min = fwhm_min = ellipticity_min
-	= beta_min = residuals_min = pffwhm_min = pfellipticity_min
-	= pfbeta_min = pfresiduals_min = symresiduals_min = BIG;
-    minrad_mean = sampling_mean = chi2_mean = fwhm_mean = ellipticity_mean
-	= beta_mean = residuals_mean = pffwhm_mean = pfellipticity_mean
-	= pfbeta_mean = pfresiduals_mean = symresiduals_mean
-	= nloaded_mean = naccepted_mean = 0.0;
-    minrad_max = sampling_max = chi2_max = fwhm_max = ellipticity_max
-	= beta_max = residuals_max = pffwhm_max = pfellipticity_max
-	= pfbeta_max = pfresiduals_max = symresiduals_max = -BIG;
-    neff = 0;
-    field = field_xml[n];
-    for (e=0; e<field->next; e++)
-      {
-      psf = field->psf[e];
-      nloaded_total += psf->samples_loaded;
-      if (psf->samples_loaded < nloaded_min)
-        nloaded_min = psf->samples_loaded ;
-      nloaded_mean += (double)psf->samples_loaded;
-      if (psf->samples_loaded > nloaded_max)
-        nloaded_max = psf->samples_loaded;
-      naccepted_total += psf->samples_accepted;
-      if (psf->samples_accepted < naccepted_min)
-        naccepted_min = psf->samples_accepted;
-      naccepted_mean += (double)psf->samples_accepted;
-      if (psf->samples_accepted > naccepted_max)
-        naccepted_max = psf->samples_accepted ;
-/*---- Drop it if no valid stars have been kept */
-      if (!psf->samples_accepted)
-        continue;
-      neff++;
-      if (psf->fwhm < minrad_min)
-        minrad_min = psf->fwhm;
-      minrad_mean += psf->fwhm;
-      if (psf->fwhm > minrad_max)
-        minrad_max = psf->fwhm;
-      if (psf->pixstep < sampling_min)
-        sampling_min = psf->pixstep;
-      sampling_mean += psf->pixstep;
-      if (psf->pixstep > sampling_max)
-        sampling_max = psf->pixstep;
-      if (psf->chi2 < chi2_min)
-        chi2_min = psf->chi2;
-      chi2_mean += psf->chi2;
-      if (psf->chi2 > chi2_max)
-        chi2_max = psf->chi2;
-/*---- Moffat fit */
-      if (psf->moffat_fwhm_min < fwhm_min)
-        fwhm_min = psf->moffat_fwhm_min;
-      fwhm_mean += psf->moffat_fwhm;
-      if (psf->moffat_fwhm_max > fwhm_max)
-        fwhm_max = psf->moffat_fwhm_max;
-      if (psf->moffat_ellipticity_min < ellipticity_min)
-        ellipticity_min = psf->moffat_ellipticity_min;
-      ellipticity_mean += psf->moffat_ellipticity;
-      if (psf->moffat_ellipticity_max > ellipticity_max)
-        ellipticity_max = psf->moffat_ellipticity_max;
-      if (psf->moffat_beta_min < beta_min)
-        beta_min = psf->moffat_beta_min;
-      beta_mean += psf->moffat_beta;
-      if (psf->moffat_beta_max > beta_max)
-        beta_max = psf->moffat_beta_max;
-      if (psf->moffat_residuals_min < residuals_min)
-        residuals_min = psf->moffat_residuals_min;
-      residuals_mean += psf->moffat_residuals;
-      if (psf->moffat_residuals_max > residuals_max)
-        residuals_max = psf->moffat_residuals_max;
-/*---- Pixel-free Moffat fit */
-      if (psf->pfmoffat_fwhm_min < pffwhm_min)
-        pffwhm_min = psf->pfmoffat_fwhm_min;
-      pffwhm_mean += psf->pfmoffat_fwhm;
-      if (psf->pfmoffat_fwhm_max > pffwhm_max)
-        pffwhm_max = psf->pfmoffat_fwhm_max;
-      if (psf->pfmoffat_ellipticity_min < pfellipticity_min)
-        pfellipticity_min = psf->pfmoffat_ellipticity_min;
-      pfellipticity_mean += psf->pfmoffat_ellipticity;
-      if (psf->pfmoffat_ellipticity_max > pfellipticity_max)
-        pfellipticity_max = psf->pfmoffat_ellipticity_max;
-      if (psf->pfmoffat_beta_min < pfbeta_min)
-        pfbeta_min = psf->pfmoffat_beta_min;
-      pfbeta_mean += psf->pfmoffat_beta;
-      if (psf->pfmoffat_beta_max > pfbeta_max)
-        pfbeta_max = psf->pfmoffat_beta_max;
-      if (psf->pfmoffat_residuals_min < pfresiduals_min)
-        pfresiduals_min = psf->pfmoffat_residuals_min;
-      pfresiduals_mean += psf->pfmoffat_residuals;
-      if (psf->pfmoffat_residuals_max > pfresiduals_max)
-        pfresiduals_max = psf->pfmoffat_residuals_max;
-/*---- Asymmetry measurement */
-      if (psf->sym_residuals_min < symresiduals_min)
-        symresiduals_min = psf->sym_residuals_min;
-      symresiduals_mean += psf->sym_residuals;
-      if (psf->sym_residuals_max > symresiduals_max)
-        symresiduals_max = psf->sym_residuals_max;
-      }
+    strcpy(plotfilename, field->rcatname);
+    if (!(pstr = strrchr(plotfilename, '.')))
+      pstr = plotfilename+strlen(plotfilename);
+    sprintf(pstr, ".png");
+    fprintf(file, "     <TD>%s_%s</TD>\n",
+		prefs.cplot_name[xml_cp[t]], plotfilename);
+    }
+#endif
+  fprintf(file, "    </TR>\n");
 
-    if (field->next>1)
-      {
-      nloaded_mean /= (double)field->next;
-      naccepted_mean /= (double)field->next;
-      }
+  return;
+  }
 
-    if (neff>1)
-      {
-      minrad_mean /= (double)neff;
-      sampling_mean /= (double)neff;
-      chi2_mean /= (double)neff;
-      fwhm_mean /= (double)neff;
-      ellipticity_mean /= (double)neff;
-      beta_mean /= (double)neff;
-      residuals_mean /= (double)neff;
-      pffwhm_mean /= (double)neff;
-      pfellipticity_mean /= (double)neff;
-      pfbeta_mean /= (double)neff;
-      pfresiduals_mean /= (double)neff;
-      symresiduals_mean /= (double)neff;
-      }
-    else if (neff==0)
-      minrad_min = sampling_min = chi2_min = fwhm_min = ellipticity_min
-	= beta_min = residuals_min = pffwhm_min = pfellipticity_min
-	= pfbeta_min = pfresiduals_min = symresiduals_min
-	= minrad_mean = sampling_mean = chi2_mean = fwhm_mean = ellipticity_mean
-	= beta_mean = residuals_mean = pffwhm_mean = pfellipticity_mean
-	= pfbeta_mean = pfresiduals_mean = symresiduals_mean
-	= minrad_max = sampling_max = chi2_max = fwhm_max = ellipticity_max
-	= beta_max = residuals_max = pffwhm_max = pfellipticity_max
-	= pfbeta_max = pfresiduals_max = symresiduals_max = 0.0;
 
-    fprintf(file, "    <TR>\n"
-	"     <TD>%s</TD><TD>%s</TD><TD>%d</TD>\n"
+/****** xml_initstat *********************************************************
+PROTO	void xml_initstat(xmlstatstruct *stat)
+PURPOSE	Reset running PSF statistics.
+INPUT	Pointer to the statistics.
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	xml_initstat(xmlstatstruct *stat)
+  {
+  stat->npsf = stat->neff = 0;
+  stat->nloaded_min = stat->naccepted_min = 2<<29;
+  stat->nloaded_max = stat->naccepted_max = stat->nloaded_total
+	= stat->naccepted_total = 0;
+  stat->npass_min = 2<<29;
+  stat->npass_max = 0;
+  stat->npass_mean = stat->fittimesaved_total = 0.0;
+  stat->minrad_min = stat->sampling_min = stat->chi2_min = stat->fwhm_min
+	= stat->ellipticity_min = stat->beta_min = stat->residuals_min
+	= stat->pffwhm_min = stat->pfellipticity_min = stat->pfbeta_min
+	= stat->pfresiduals_min = stat->symresiduals_min = BIG;
+  stat->minrad_mean = stat->sampling_mean = stat->chi2_mean = stat->fwhm_mean
+	= stat->ellipticity_mean = stat->beta_mean = stat->residuals_mean
+	= stat->pffwhm_mean = stat->pfellipticity_mean = stat->pfbeta_mean
+	= stat->pfresiduals_mean = stat->symresiduals_mean
+	= stat->nloaded_mean = stat->naccepted_mean = 0.0;
+  stat->minrad_max = stat->sampling_max = stat->chi2_max = stat->fwhm_max
+	= stat->ellipticity_max = stat->beta_max = stat->residuals_max
+	= stat->pffwhm_max = stat->pfellipticity_max = stat->pfbeta_max
+	= stat->pfresiduals_max = stat->symresiduals_max = -BIG;
+
+  return;
+  }
+
+
+/****** xml_addstat **********************************************************
+PROTO	void xml_addstat(xmlstatstruct *stat, psfstruct *psf)
+PURPOSE	Accumulate the min, mean and max of PSF parameters.
+INPUT	Pointer to the statistics,
+	pointer to the PSF.
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	xml_addstat(xmlstatstruct *stat, psfstruct *psf)
+  {
+  stat->npsf++;
+  stat->nloaded_total += psf->samples_loaded;
+  if (psf->samples_loaded < stat->nloaded_min)
+    stat->nloaded_min = psf->samples_loaded ;
+  stat->nloaded_mean += (double)psf->samples_loaded;
+  if (psf->samples_loaded > stat->nloaded_max)
+    stat->nloaded_max = psf->samples_loaded;
+  stat->naccepted_total += psf->samples_accepted;
+  if (psf->samples_accepted < stat->naccepted_min)
+    stat->naccepted_min = psf->samples_accepted;
+  stat->naccepted_mean += (double)psf->samples_accepted;
+  if (psf->samples_accepted > stat->naccepted_max)
+    stat->naccepted_max = psf->samples_accepted ;
+  if (psf->npass < stat->npass_min)
+    stat->npass_min = psf->npass;
+  stat->npass_mean += (double)psf->npass;
+  if (psf->npass > stat->npass_max)
+    stat->npass_max = psf->npass;
+  stat->fittimesaved_total += psf->fit_timesaved;
+/* Drop it if no valid stars have been kept */
+  if (!psf->samples_accepted)
+    return;
+  stat->neff++;
+  if (psf->fwhm < stat->minrad_min)
+    stat->minrad_min = psf->fwhm;
+  stat->minrad_mean += psf->fwhm;
+  if (psf->fwhm > stat->minrad_max)
+    stat->minrad_max = psf->fwhm;
+  if (psf->pixstep < stat->sampling_min)
+    stat->sampling_min = psf->pixstep;
+  stat->sampling_mean += psf->pixstep;
+  if (psf->pixstep > stat->sampling_max)
+    stat->sampling_max = psf->pixstep;
+  if (psf->chi2 < stat->chi2_min)
+    stat->chi2_min = psf->chi2;
+  stat->chi2_mean += psf->chi2;
+  if (psf->chi2 > stat->chi2_max)
+    stat->chi2_max = psf->chi2;
+/* Moffat fit */
+  if (psf->moffat_fwhm_min < stat->fwhm_min)
+    stat->fwhm_min = psf->moffat_fwhm_min;
+  stat->fwhm_mean += psf->moffat_fwhm;
+  if (psf->moffat_fwhm_max > stat->fwhm_max)
+    stat->fwhm_max = psf->moffat_fwhm_max;
+  if (psf->moffat_ellipticity_min < stat->ellipticity_min)
+    stat->ellipticity_min = psf->moffat_ellipticity_min;
+  stat->ellipticity_mean += psf->moffat_ellipticity;
+  if (psf->moffat_ellipticity_max > stat->ellipticity_max)
+    stat->ellipticity_max = psf->moffat_ellipticity_max;
+  if (psf->moffat_beta_min < stat->beta_min)
+    stat->beta_min = psf->moffat_beta_min;
+  stat->beta_mean += psf->moffat_beta;
+  if (psf->moffat_beta_max > stat->beta_max)
+    stat->beta_max = psf->moffat_beta_max;
+  if (psf->moffat_residuals_min < stat->residuals_min)
+    stat->residuals_min = psf->moffat_residuals_min;
+  stat->residuals_mean += psf->moffat_residuals;
+  if (psf->moffat_residuals_max > stat->residuals_max)
+    stat->residuals_max = psf->moffat_residuals_max;
+/* Pixel-free Moffat fit */
+  if (psf->pfmoffat_fwhm_min < stat->pffwhm_min)
+    stat->pffwhm_min = psf->pfmoffat_fwhm_min;
+  stat->pffwhm_mean += psf->pfmoffat_fwhm;
+  if (psf->pfmoffat_fwhm_max > stat->pffwhm_max)
+    stat->pffwhm_max = psf->pfmoffat_fwhm_max;
+  if (psf->pfmoffat_ellipticity_min < stat->pfellipticity_min)
+    stat->pfellipticity_min = psf->pfmoffat_ellipticity_min;
+  stat->pfellipticity_mean += psf->pfmoffat_ellipticity;
+  if (psf->pfmoffat_ellipticity_max > stat->pfellipticity_max)
+    stat->pfellipticity_max = psf->pfmoffat_ellipticity_max;
+  if (psf->pfmoffat_beta_min < stat->pfbeta_min)
+    stat->pfbeta_min = psf->pfmoffat_beta_min;
+  stat->pfbeta_mean += psf->pfmoffat_beta;
+  if (psf->pfmoffat_beta_max > stat->pfbeta_max)
+    stat->pfbeta_max = psf->pfmoffat_beta_max;
+  if (psf->pfmoffat_residuals_min < stat->pfresiduals_min)
+    stat->pfresiduals_min = psf->pfmoffat_residuals_min;
+  stat->pfresiduals_mean += psf->pfmoffat_residuals;
+  if (psf->pfmoffat_residuals_max > stat->pfresiduals_max)
+    stat->pfresiduals_max = psf->pfmoffat_residuals_max;
+/* Asymmetry measurement */
+  if (psf->sym_residuals_min < stat->symresiduals_min)
+    stat->symresiduals_min = psf->sym_residuals_min;
+  stat->symresiduals_mean += psf->sym_residuals;
+  if (psf->sym_residuals_max > stat->symresiduals_max)
+    stat->symresiduals_max = psf->sym_residuals_max;
+
+  return;
+  }
+
+
+/****** xml_endstat **********************************************************
+PROTO	void xml_endstat(xmlstatstruct *stat)
+PURPOSE	Turn accumulated PSF parameter sums into means.
+INPUT	Pointer to the statistics.
+OUTPUT	-.
+NOTES	All statistics are set to 0 if no PSF has valid stars.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	xml_endstat(xmlstatstruct *stat)
+  {
+   double	dneff;
+
+  if (stat->npsf>1)
+    {
+    stat->nloaded_mean /= (double)stat->npsf;
+    stat->naccepted_mean /= (double)stat->npsf;
+    stat->npass_mean /= (double)stat->npsf;
+    }
+  else if (stat->npsf==0)
+    stat->npass_min = 0;
+
+  if (stat->neff>1)
+    {
+    dneff = (double)stat->neff;
+    stat->minrad_mean /= dneff;
+    stat->sampling_mean /= dneff;
+    stat->chi2_mean /= dneff;
+    stat->fwhm_mean /= dneff;
+    stat->ellipticity_mean /= dneff;
+    stat->beta_mean /= dneff;
+    stat->residuals_mean /= dneff;
+    stat->pffwhm_mean /= dneff;
+    stat->pfellipticity_mean /= dneff;
+    stat->pfbeta_mean /= dneff;
+    stat->pfresiduals_mean /= dneff;
+    stat->symresiduals_mean /= dneff;
+    }
+  else if (stat->neff==0)
+    stat->minrad_min = stat->sampling_min = stat->chi2_min = stat->fwhm_min
+	= stat->ellipticity_min = stat->beta_min = stat->residuals_min
+	= stat->pffwhm_min = stat->pfellipticity_min = stat->pfbeta_min
+	= stat->pfresiduals_min = stat->symresiduals_min
+	= stat->minrad_mean = stat->sampling_mean = stat->chi2_mean
+	= stat->fwhm_mean = stat->ellipticity_mean = stat->beta_mean
+	= stat->residuals_mean = stat->pffwhm_mean = stat->pfellipticity_mean
+	= stat->pfbeta_mean = stat->pfresiduals_mean = stat->symresiduals_mean
+	= stat->minrad_max = stat->sampling_max = stat->chi2_max
+	= stat->fwhm_max = stat->ellipticity_max = stat->beta_max
+	= stat->residuals_max = stat->pffwhm_max = stat->pfellipticity_max
+	= stat->pfbeta_max = stat->pfresiduals_max = stat->symresiduals_max
+	= 0.0;
+
+  return;
+  }
+
+
+/****** xml_printstat ********************************************************
+PROTO	void xml_printstat(FILE *file, xmlstatstruct *stat)
+PURPOSE	Write PSF statistics as a series of table cells.
+INPUT	Pointer to the output file (or stream),
+	pointer to the statistics.
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	xml_printstat(FILE *file, xmlstatstruct *stat)
+  {
+  fprintf(file,
         "     <TD>%d</TD><TD>%d</TD><TD>%.6g</TD><TD>%d</TD>\n"
         "     <TD>%d</TD><TD>%d</TD><TD>%.6g</TD><TD>%d</TD>\n"
 	"     <TD>%.6g</TD><TD>%.6g</TD><TD>%.6g</TD>\n"
@@ -615,51 +1043,60 @@ int	write_xml_meta(FILE *file, char *error)
 	"     <TD>%.6g</TD><TD>%.6g</TD><TD>%.6g</TD>\n"
 	"     <TD>%.6g</TD><TD>%.6g</TD><TD>%.6g</TD>\n"
 	"     <TD>%.6g</TD><TD>%.6g</TD><TD>%.6g</TD>\n"
-	"     <TD>%.6g</TD><TD>%.6g</TD><TD>%.6g</TD>\n",
-	field->rcatname, field->ident, field->next,
-	nloaded_total, nloaded_min, nloaded_mean, nloaded_max,
-	naccepted_total, naccepted_min, naccepted_mean, naccepted_max,
-	minrad_min, minrad_mean, minrad_max,
-	sampling_min, sampling_mean, sampling_max,
-	chi2_min, chi2_mean, chi2_max,
-	fwhm_min, fwhm_mean, fwhm_max,
-	ellipticity_min, ellipticity_mean, ellipticity_max,
-	beta_min, beta_mean, beta_max,
-	residuals_min, residuals_mean, residuals_max,
-	pffwhm_min, pffwhm_mean, pffwhm_max,
-	pfellipticity_min, pfellipticity_mean, pfellipticity_max,
-	pfbeta_min, pfbeta_mean, pfbeta_max,
-	pfresiduals_min, pfresiduals_mean, pfresiduals_max,
-	symresiduals_min, symresiduals_mean, symresiduals_max);
-/*-- Check-plots */
-#ifdef HAVE_PLPLOT
-    if (pngflag)
-      {
-      for (t=pnplot; t<nplot; t++)
-        {
-        strcpy(plotfilename, field->rcatname);
-        if (!(pstr = strrchr(plotfilename, '.')))
-          pstr = plotfilename+strlen(plotfilename);
-        sprintf(pstr, ".png");
-        fprintf(file, "     <TD>%s_%s</TD>\n",
-		prefs.cplot_name[cp[t]], plotfilename);        
-        }
-      }
-#endif
-    fprintf(file, "    </TR>\n");
-    }
+	"     <TD>%.6g</TD><TD>%.6g</TD><TD>%.6g</TD>\n"
+	"     <TD>%d</TD><TD>%.6g</TD><TD>%d</TD><TD>%.6g</TD>\n",
+	stat->nloaded_total, stat->nloaded_min, stat->nloaded_mean,
+	stat->nloaded_max,
+	stat->naccepted_total, stat->naccepted_min, stat->naccepted_mean,
+	stat->naccepted_max,
+	stat->minrad_min, stat->minrad_mean, stat->minrad_max,
+	stat->sampling_min, stat->sampling_mean, stat->sampling_max,
+	stat->chi2_min, stat->chi2_mean, stat->chi2_max,
+	stat->fwhm_min, stat->fwhm_mean, stat->fwhm_max,
+	stat->ellipticity_min, stat->ellipticity_mean, stat->ellipticity_max,
+	stat->beta_min, stat->beta_mean, stat->beta_max,
+	stat->residuals_min, stat->residuals_mean, stat->residuals_max,
+	stat->pffwhm_min, stat->pffwhm_mean, stat->pffwhm_max,
+	stat->pfellipticity_min, stat->pfellipticity_mean,
+	stat->pfellipticity_max,
+	stat->pfbeta_min, stat->pfbeta_mean, stat->pfbeta_max,
+	stat->pfresiduals_min, stat->pfresiduals_mean, stat->pfresiduals_max,
+	stat->symresiduals_min, stat->symresiduals_mean,
+	stat->symresiduals_max,
+	stat->npass_min, stat->npass_mean, stat->npass_max,
+	stat->fittimesaved_total);
+
+  return;
+  }
+
+
+/****** xml_write_metatail ***************************************************
+PROTO	void xml_write_metatail(FILE *file, char *error)
+PURPOSE	Close the per-field table and write the per-extension, warning and
+	configuration tables of the meta-data resource.
+INPUT	Pointer to the output file (or stream),
+	Pointer to an error msg (or NULL).
+OUTPUT	-.
+NOTES	-.
+AUTHOR	PSFEx contributors
+VERSION	19/10/2026
+ ***/
+static void	xml_write_metatail(FILE *file, char *error)
+  {
+   char			*str;
+   int			e,n;
+
   fprintf(file, "   </TABLEDATA></DATA>\n");
   fprintf(file, "  </TABLE>\n");
 
 /* PSF meta-data per extension*/
-  next = nxml? field_xml[0]->next : 0;
   fprintf(file, "  <TABLE ID=\"PSF_Extensions\" name=\"PSF_Extensions\">\n");
   fprintf(file, "   <DESCRIPTION>PSF metadata and stats per extension gathered"
 	" by %s</DESCRIPTION>\n", BANNER);
   fprintf(file, "   <!-- NExtensions may be 0"
 	" if an error occurred early in the processing -->\n");
   fprintf(file, "   <PARAM name=\"NExtensions\" datatype=\"int\""
-	" ucd=\"meta.number;meta.dataset\" value=\"%d\"/>\n", next);
+	" ucd=\"meta.number;meta.dataset\" value=\"%d\"/>\n", xml_next);
   fprintf(file, "   <FIELD name=\"Extension\" datatype=\"int\""
         " ucd=\"meta.record\"/>\n");
   fprintf(file, "   <FIELD name=\"NStars_Loaded_Total\" datatype=\"int\""
@@ -762,175 +1199,25 @@ int	write_xml_meta(FILE *file, char *error)
 	" ucd=\"stat.fit.residual;stat.mean;instr.det.psf\"/>\n");
   fprintf(file, "   <FIELD name=\"Asymmetry_Max\" datatype=\"float\""
 	" ucd=\"stat.fit.residual;stat.max;instr.det.psf\"/>\n");
+  fprintf(file, "   <FIELD name=\"NFitPasses_Min\" datatype=\"int\""
+	" ucd=\"meta.number;stat.min;meta.code\"/>\n");
+  fprintf(file, "   <FIELD name=\"NFitPasses_Mean\" datatype=\"float\""
+	" ucd=\"meta.number;stat.mean;meta.code\"/>\n");
+  fprintf(file, "   <FIELD name=\"NFitPasses_Max\" datatype=\"int\""
+	" ucd=\"meta.number;stat.max;meta.code\"/>\n");
+  fprintf(file, "   <FIELD name=\"FitTime_Saved\" unit=\"s\""
+	" datatype=\"float\" ucd=\"time.duration;meta.code\"/>\n");
+
 
   fprintf(file, "   <DATA><TABLEDATA>\n");
-  for (e=0; e<next; e++)
+  for (e=0; e<xml_next; e++)
     {
-/*-- Compute min,average and max of Moffat fitted parameters */
-    nloaded_min = naccepted_min = 2<<29;
-    nloaded_max = naccepted_max = nloaded_total = naccepted_total = 0;
-    minrad_min = sampling_min = chi2_min = fwhm_min = ellipticity_min
-	= beta_min = residuals_min = pffwhm_min = pfellipticity_min
-	= pfbeta_min = pfresiduals_min = symresiduals_min = BIG;
-    minrad_mean = sampling_mean = chi2_mean = fwhm_mean = ellipticity_mean
-	= beta_mean = residuals_mean = pffwhm_mean = pfellipticity_mean
-	= pfbeta_mean = pfresiduals_mean = symresiduals_mean
-	= nloaded_mean = naccepted_mean = 0.0;
-    minrad_max = sampling_max = chi2_max = fwhm_max = ellipticity_max
-	= beta_max = residuals_max = pffwhm_max = pfellipticity_max
-	= pfbeta_max = pfresiduals_max = symresiduals_max = -BIG;
-    neff = 0;
-    for (n=0; n<nxml; n++)
-      {
-      field = field_xml[n];
-      psf = field->psf[e];
-      nloaded_total += psf->samples_loaded;
-      if (psf->samples_loaded < nloaded_min)
-        nloaded_min = psf->samples_loaded ;
-      nloaded_mean += (double)psf->samples_loaded;
-      if (psf->samples_loaded > nloaded_max)
-        nloaded_max = psf->samples_loaded;
-      naccepted_total += psf->samples_accepted;
-      if (psf->samples_accepted < naccepted_min)
-        naccepted_min = psf->samples_accepted;
-      naccepted_mean += (double)psf->samples_accepted;
-      if (psf->samples_accepted > naccepted_max)
-        naccepted_max = psf->samples_accepted ;
-/*---- Drop it if no valid stars have been kept */
-      if (!psf->samples_accepted)
-        continue;
-      neff++;
-      if (psf->fwhm < minrad_min)
-        minrad_min = psf->fwhm;
-      minrad_mean += psf->fwhm;
-      if (psf->fwhm > minrad_max)
-        minrad_max = psf->fwhm;
-      if (psf->pixstep < sampling_min)
-        sampling_min = psf->pixstep;
-      sampling_mean += psf->pixstep;
-      if (psf->pixstep > sampling_max)
-        sampling_max = psf->pixstep;
-      if (psf->chi2 < chi2_min)
-        chi2_min = psf->chi2;
-      chi2_mean += psf->chi2;
-      if (psf->chi2 > chi2_max)
-        chi2_max = psf->chi2;
-/*---- Moffat fit */
-      if (psf->moffat_fwhm_min < fwhm_min)
-        fwhm_min = psf->moffat_fwhm_min;
-      fwhm_mean += psf->moffat_fwhm;
-      if (psf->moffat_fwhm_max > fwhm_max)
-        fwhm_max = psf->moffat_fwhm_max;
-      if (psf->moffat_ellipticity_min < ellipticity_min)
-        ellipticity_min = psf->moffat_ellipticity_min;
-      ellipticity_mean += psf->moffat_ellipticity;
-      if (psf->moffat_ellipticity_max > ellipticity_max)
-        ellipticity_max = psf->moffat_ellipticity_max;
-      if (psf->moffat_beta_min < beta_min)
-        beta_min = psf->moffat_beta_min;
-      beta_mean += psf->moffat_beta;
-      if (psf->moffat_beta_max > beta_max)
-        beta_max = psf->moffat_beta_max;
-      if (psf->moffat_residuals_min < residuals_min)
-        residuals_min = psf->moffat_residuals_min;
-      residuals_mean += psf->moffat_residuals;
-      if (psf->moffat_residuals_max > residuals_max)
-        residuals_max = psf->moffat_residuals_max;
-/*---- Pixel-free Moffat fit */
-      if (psf->pfmoffat_fwhm_min < pffwhm_min)
-        pffwhm_min = psf->pfmoffat_fwhm_min;
-      pffwhm_mean += psf->pfmoffat_fwhm;
-      if (psf->pfmoffat_fwhm_max > pffwhm_max)
-        pffwhm_max = psf->pfmoffat_fwhm_max;
-      if (psf->pfmoffat_ellipticity_min < pfellipticity_min)
-        pfellipticity_min = psf->pfmoffat_ellipticity_min;
-      pfellipticity_mean += psf->pfmoffat_ellipticity;
-      if (psf->pfmoffat_ellipticity_max > pfellipticity_max)
-        pfellipticity_max = psf->pfmoffat_ellipticity_max;
-      if (psf->pfmoffat_beta_min < pfbeta_min)
-        pfbeta_min = psf->pfmoffat_beta_min;
-      pfbeta_mean += psf->pfmoffat_beta;
-      if (psf->pfmoffat_beta_max > pfbeta_max)
-        pfbeta_max = psf->pfmoffat_beta_max;
-      if (psf->pfmoffat_residuals_min < pfresiduals_min)
-        pfresiduals_min = psf->pfmoffat_residuals_min;
-      pfresiduals_mean += psf->pfmoffat_residuals;
-      if (psf->pfmoffat_residuals_max > pfresiduals_max)
-        pfresiduals_max = psf->pfmoffat_residuals_max;
-/*---- Asymmetry measurement */
-      if (psf->sym_residuals_min < symresiduals_min)
-        symresiduals_min = psf->sym_residuals_min;
-      symresiduals_mean += psf->sym_residuals;
-      if (psf->sym_residuals_max > symresiduals_max)
-        symresiduals_max = psf->sym_residuals_max;
-      }
-
-    if (nxml>1)
-      {
-      nloaded_mean /= (double)nxml;
-      naccepted_mean /= (double)nxml;
-      }
-
-    if (neff>1)
-      {
-      minrad_mean /= (double)neff;
-      sampling_mean /= (double)neff;
-      chi2_mean /= (double)neff;
-      fwhm_mean /= (double)neff;
-      ellipticity_mean /= (double)neff;
-      beta_mean /= (double)neff;
-      residuals_mean /= (double)neff;
-      pffwhm_mean /= (double)neff;
-      pfellipticity_mean /= (double)neff;
-      pfbeta_mean /= (double)neff;
-      pfresiduals_mean /= (double)neff;
-      symresiduals_mean /= (double)neff;
-      }
-    else if (neff==0)
-      minrad_min = sampling_min = chi2_min = fwhm_min = ellipticity_min
-	= beta_min = residuals_min = pffwhm_min = pfellipticity_min
-	= pfbeta_min = pfresiduals_min = symresiduals_min
-	= minrad_mean = sampling_mean = chi2_mean = fwhm_mean = ellipticity_mean
-	= beta_mean = residuals_mean = pffwhm_mean = pfellipticity_mean
-	= pfbeta_mean = pfresiduals_mean = symresiduals_mean
-	= minrad_max = sampling_max = chi2_max = fwhm_max = ellipticity_max
-	= beta_max = residuals_max = pffwhm_max = pfellipticity_max
-	= pfbeta_max = pfresiduals_max = symresiduals_max = 0.0;
-
+    xml_endstat(&xml_extstat[e]);
     fprintf(file, "    <TR>\n"
-	"     <TD>%d</TD>\n"
-        "     <TD>%d</TD><TD>%d</TD><TD>%.6g</TD><TD>%d</TD>\n"
-        "     <TD>%d</TD><TD>%d</TD><TD>%.6g</TD><TD>%d</TD>\n"
-	"     <TD>%.6g</TD><TD>%.6g</TD><TD>%.6g</TD>\n"
-	"     <TD>%.6g</TD><TD>%.6g</TD><TD>%.6g</TD>\n"
-	"     <TD>%.6g</TD><TD>%.6g</TD><TD>%.6g</TD>\n"
-	"     <TD>%.6g</TD><TD>%.6g</TD><TD>%.6g</TD>\n"
-	"     <TD>%.6g</TD><TD>%.6g</TD><TD>%.6g</TD>\n"
-	"     <TD>%.6g</TD><TD>%.6g</TD><TD>%.6g</TD>\n"
-	"     <TD>%.6g</TD><TD>%.6g</TD><TD>%.6g</TD>\n"
-	"     <TD>%.6g</TD><TD>%.6g</TD><TD>%.6g</TD>\n"
-	"     <TD>%.6g</TD><TD>%.6g</TD><TD>%.6g</TD>\n"
-	"     <TD>%.6g</TD><TD>%.6g</TD><TD>%.6g</TD>\n"
-	"     <TD>%.6g</TD><TD>%.6g</TD><TD>%.6g</TD>\n"
-	"     <TD>%.6g</TD><TD>%.6g</TD><TD>%.6g</TD>\n"
-        "    </TR>\n",
-	e+1,
-	nloaded_total, nloaded_min, nloaded_mean, nloaded_max,
-	naccepted_total, naccepted_min, naccepted_mean, naccepted_max,
-	minrad_min, minrad_mean, minrad_max,
-	sampling_min, sampling_mean, sampling_max,
-	chi2_min, chi2_mean, chi2_max,
-	fwhm_min, fwhm_mean, fwhm_max,
-	ellipticity_min, ellipticity_mean, ellipticity_max,
-	beta_min, beta_mean, beta_max,
-	residuals_min, residuals_mean, residuals_max,
-	pffwhm_min, pffwhm_mean, pffwhm_max,
-	pfellipticity_min, pfellipticity_mean, pfellipticity_max,
-	pfbeta_min, pfbeta_mean, pfbeta_max,
-	pfresiduals_min, pfresiduals_mean, pfresiduals_max,
-	symresiduals_min, symresiduals_mean, symresiduals_max);
+	"     <TD>%d</TD>\n", e+1);
+    xml_printstat(file, &xml_extstat[e]);
+    fprintf(file, "    </TR>\n");
     }
-
   fprintf(file, "   </TABLEDATA></DATA>\n");
   fprintf(file, "  </TABLE>\n");
 
@@ -1052,7 +1339,7 @@ int	write_xml_meta(FILE *file, char *error)
   fprintf(file, "  </RESOURCE>\n");
   fprintf(file, " </RESOURCE>\n");
 
-  return RETURN_OK;
+  return;
   }
 
 
@@ -1061,15 +1348,22 @@ PROTO	int	write_xmlerror(char *error)
 PURPOSE	Save meta-data to a simplified XML file in case of a catched error
 INPUT	a character string.
 OUTPUT	RETURN_OK if everything went fine, RETURN_ERROR otherwise.
-NOTES	-.
+NOTES	If the XML file is being streamed, the rows written so far are kept and
+	the error message is patched in.
 AUTHOR	E. Bertin (IAP)
-VERSION	26/07/2008
+VERSION	19/10/2026
  ***/
 void	write_xmlerror(char *filename, char *error)
   {
    FILE			*file;
    int			pipe_flag;
 
+  if (xml_file)
+    {
+    xml_close(error);
+    return;
+    }
+
   pipe_flag = 0;
   if (!strcmp(filename, "STDOUT"))
     {
@@ -22,7 +22,7 @@
 *	You should have received a copy of the GNU General Public License
 *	along with PSFEx.  If not, see <http://www.gnu.org/licenses/>.
 *
-*	Last modified:		10/10/2010
+*	Last modified:		19/10/2026
 *
 *%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
 
@@ -34,11 +34,48 @@
 #include "field.h"
 #endif
 
+#ifndef _PSF_H_
+#include "psf.h"
+#endif
+
 /*----------------------------- Internal constants --------------------------*/
 #ifndef XSL_URL
 #define	XSL_URL	"."
 #endif
+
+/* Sizes of the XML slots patched at the end of streaming (in bytes); */
+/* the error slot is not reserved but inserted only if an error occurs */
+#define	XML_SLOTSIZE_DATE	512
+#define	XML_SLOTSIZE_ERROR	(MAXCHAR+1024)
+#define	XML_SLOTSIZE_CURRFIELD	128
+
 /*--------------------------------- typedefs --------------------------------*/
+typedef enum {XML_SLOT_DATE, XML_SLOT_ERROR, XML_SLOT_CURRFIELD, XML_NSLOT}
+		xmlslotenum;
+
+typedef struct xmlstat
+  {
+  int		npsf;				/* Number of PSFs */
+  int		neff;				/* Number with valid stars */
+  int		nloaded_total, nloaded_min, nloaded_max;
+  int		naccepted_total, naccepted_min, naccepted_max;
+  double	nloaded_mean, naccepted_mean;
+  double	minrad_min, minrad_mean, minrad_max;
+  double	sampling_min, sampling_mean, sampling_max;
+  double	chi2_min, chi2_mean, chi2_max;
+  double	fwhm_min, fwhm_mean, fwhm_max;
+  double	ellipticity_min, ellipticity_mean, ellipticity_max;
+  double	beta_min, beta_mean, beta_max;
+  double	residuals_min, residuals_mean, residuals_max;
+  double	pffwhm_min, pffwhm_mean, pffwhm_max;
+  double	pfellipticity_min, pfellipticity_mean, pfellipticity_max;
+  double	pfbeta_min, pfbeta_mean, pfbeta_max;
+  double	pfresiduals_min, pfresiduals_mean, pfresiduals_max;
+  double	symresiduals_min, symresiduals_mean, symresiduals_max;
+  int		npass_min, npass_max;
+  double	npass_mean, fittimesaved_total;
+  }	xmlstatstruct;
+
 /*------------------------------- functions ---------------------------------*/
 
 extern int	init_xml(int ncat),